@@ -10,7 +10,7 @@ layout(set = 0, binding = 0) uniform GlobalUBO
     mat4 InvView;
     mat4 InvProjection;
     vec4 CameraPosition;
-    ivec4 ScreenResolution_NumRaysPerPixel_FrameNumber;
+    ivec4 ScreenResolution;
 }  u_UBO;
 
 layout (input_attachment_index = 0, set = 1, binding = 1) uniform subpassInput u_Current;
@@ -0,0 +1,36 @@
+// Images shared by the denoiser passes. Include after path_tracing.glsl, with DENOISE defined.
+// The history, previous feature and filter images are ping-ponged on the host, so every pass sees
+// this frame's as "current" and the last frame's as "previous".
+
+// The tracer's running average.
+layout(set = 1, binding = 1, rgba32f) uniform readonly image2D u_Accumulation;
+
+// Primary hit through the pixel centre. xyz: world normal, w: view depth, 0 where the ray escaped.
+layout(set = 1, binding = 2, rgba32f) uniform image2D u_NormalDepth;
+layout(set = 1, binding = 3, rgba32f) uniform readonly image2D u_PreviousNormalDepth;
+layout(set = 1, binding = 4, rgba16f) uniform image2D u_Albedo;
+
+// Temporally integrated demodulated colour. a: frames it covers.
+layout(set = 1, binding = 5, rgba32f) uniform image2D u_History;
+layout(set = 1, binding = 6, rgba32f) uniform readonly image2D u_PreviousHistory;
+// History reprojected on the frame accumulation last restarted, which the following frames' accumulation
+// is merged with. a: frames it covers.
+layout(set = 1, binding = 7, rgba16f) uniform image2D u_Prior;
+
+// A-trous ping-pong. a: luminance variance.
+layout(set = 1, binding = 8, rgba16f) uniform image2D u_FilterA;
+layout(set = 1, binding = 9, rgba16f) uniform image2D u_FilterB;
+
+// Handed to the graphics queue for compositing while the next frame is traced.
+layout(set = 1, binding = 10, rgba16f) uniform writeonly image2D u_Output;
+
+// Filtering happens on lighting alone, so texture detail survives; black albedo is left modulated.
+vec3 DemodulationFactor(vec3 albedo)
+{
+    return max(albedo, vec3(0.01));
+}
+
+bool IsInside(ivec2 pixelCoord, ivec2 numPixels)
+{
+    return all(greaterThanEqual(pixelCoord, ivec2(0))) && all(lessThan(pixelCoord, numPixels));
+}
@@ -0,0 +1,521 @@
+// Shared scene layout, RNG and shading for the compute path tracers.
+// Expects GL_EXT_nonuniform_qualifier to be enabled by the including shader.
+// Define WAVEFRONT or DENOISE before including to get the per-stage push constant fields.
+
+layout(set = 0, binding = 0) uniform GlobalUBO
+{
+    mat4 Projection;
+    mat4 View;
+    mat4 InvView;
+    mat4 InvProjection;
+    vec4 CameraPosition;
+    ivec4 ScreenResolution;
+}  u_UBO;
+
+struct EmitterEntry
+{
+    uint SphereIndex;
+    float Probability;              // Chance of sampling this emitter, proportional to its power
+    float AliasThreshold;           // Keep this entry below the threshold, else take Alias
+    uint Alias;
+};
+
+// Alias table over the emissive spheres, built on the CPU (see EmitterTable).
+layout(std430, set = 0, binding = 1) readonly buffer Emitters
+{
+    uint EmitterCount;
+    float TotalPower;
+    uint Pad0;
+    uint Pad1;
+    EmitterEntry Entries[];
+} u_Emitters;
+
+const uint SOBOL_DIMENSION_COUNT = 4;
+
+// Built once on the CPU (see SamplerTables). Only the low-discrepancy samplers read it.
+layout(std430, set = 0, binding = 2) readonly buffer SamplerTables
+{
+    uint BlueNoiseSize;
+    uint BlueNoiseChannelCount;
+    uint SobolDimensionCount;
+    uint Pad;
+    uint SobolMatrices[SOBOL_DIMENSION_COUNT * 32];     // Direction numbers, most significant bit first
+    float BlueNoise[];                                  // BlueNoiseChannelCount tiles of BlueNoiseSize^2
+} u_SamplerTables;
+
+layout(push_constant) uniform FramePushConstants
+{
+    uint FrameNumber;
+    uint AccumulationIndex;
+    uint SampleCount;
+    uint TransformIndex;
+    uint MaxBounceCount;
+    uint NextEventEstimation;
+#ifdef WAVEFRONT
+    uint Bounce;
+    uint SampleIndex;
+    uint SortRays;
+#endif
+#ifdef DENOISE
+    uint Iteration;
+    uint IterationCount;
+    mat4 PreviousViewProjection;
+    uint HistoryValid;
+#endif
+} u_Frame;
+
+struct RayTracingMaterial
+{
+    vec4 Color_Smoothness;
+    vec4 EmissionColor_Strength;
+    vec4 SpecularColor_Probability;
+    uvec4 TextureHandles;
+};
+
+struct Sphere
+{
+    vec4 Position_Radius;
+    RayTracingMaterial Material;
+};
+
+layout(std430, set = 1, binding = 0) readonly buffer Spheres
+{
+    Sphere Spheres[];
+} u_Spheres;
+
+layout(set = 2, binding = 0) uniform sampler2D u_BindlessTextures[];
+
+#include "virtual_texture.glsl"
+
+const uint INVALID_BINDLESS_HANDLE = 0xFFFFFFFFu;
+const float PI = 3.1415926;
+
+struct Ray
+{
+    vec3 Origin;
+    vec3 Dir;
+};
+
+struct HitInfo
+{
+    bool DidHit;
+    float Distance;
+    vec3 HitPoint;
+    vec3 Normal;
+    vec2 UV;
+    uint SphereIndex;
+};
+
+// --- RNG Stuff ---
+
+// PCG (permuted congruential generator). Thanks to:
+// www.pcg-random.org and www.shadertoy.com/view/XlGcRh
+uint NextRandom(inout uint state)
+{
+    state = state * 747796405 + 2891336453;
+    uint result = ((state >> ((state >> 28) + 4)) ^ state) * 277803737;
+    result = (result >> 22) ^ result;
+    return result;
+}
+
+float RandomValue(inout uint state)
+{
+    return NextRandom(state) / 4294967295.0; // 2^32 - 1
+}
+
+// Uniform direction on the unit sphere from two uniform numbers.
+vec3 UniformSphereDirection(vec2 u)
+{
+    float z = 1.0 - 2.0 * u.x;
+    float r = sqrt(max(0.0, 1.0 - z * z));
+    float phi = 2.0 * PI * u.y;
+    return vec3(r * cos(phi), r * sin(phi), z);
+}
+
+uint PixelSeed(ivec2 pixelCoord, ivec2 numPixels, uint frameNumber)
+{
+    uint pixelIndex = uint(pixelCoord.y * numPixels.x + pixelCoord.x);
+    return pixelIndex + frameNumber * 719393;
+}
+
+// --- Sampler ---
+
+// Chosen per pipeline (see SamplerType). The random sampler draws from the PCG state passed around as
+// rngState; the others ignore it and index the tables by pixel, sample and dimension instead.
+layout(constant_id = 0) const uint SAMPLER_TYPE = 0;
+const uint SAMPLER_RANDOM = 0;
+const uint SAMPLER_SOBOL = 1;
+const uint SAMPLER_BLUE_NOISE = 2;
+
+// Every sample uses a fixed dimension for each decision, so the megakernel and the wavefront stages agree.
+// Dimensions come in groups of four sharing one Sobol point: pairs that form a direction start a group.
+const uint SAMPLE_DIMENSION_CAMERA = 0;
+const uint SAMPLE_DIMENSION_BOUNCE = 4;
+const uint SAMPLE_DIMENSIONS_PER_BOUNCE = 8;
+
+// Offsets from the camera dimension
+const uint SAMPLE_PIXEL_JITTER = 0;         // 2D
+// Offsets from a bounce's first dimension
+const uint SAMPLE_DIFFUSE_DIRECTION = 0;    // 2D
+const uint SAMPLE_LOBE = 2;
+const uint SAMPLE_LIGHT_DIRECTION = 4;      // 2D
+const uint SAMPLE_LIGHT_PICK = 6;
+
+struct SamplerState
+{
+    uvec2 Pixel;
+    uint Seed;              // Per pixel for Sobol; shared by every pixel for blue noise
+    uint SampleIndex;       // Position in the sequence, counted from the last accumulation reset
+    uint BaseDimension;
+};
+
+SamplerState g_Sampler;
+
+void BeginSample(ivec2 pixelCoord, ivec2 numPixels, uint sampleIndex)
+{
+    uint pixelIndex = uint(pixelCoord.y * numPixels.x + pixelCoord.x);
+    g_Sampler.Pixel = uvec2(pixelCoord);
+    g_Sampler.Seed = SAMPLER_TYPE == SAMPLER_BLUE_NOISE ? 0x5eed5eedu : NextRandom(pixelIndex);
+    g_Sampler.SampleIndex = sampleIndex;
+    g_Sampler.BaseDimension = SAMPLE_DIMENSION_CAMERA;
+}
+
+void BeginBounceSamples(uint bounce)
+{
+    g_Sampler.BaseDimension = SAMPLE_DIMENSION_BOUNCE + bounce * SAMPLE_DIMENSIONS_PER_BOUNCE;
+}
+
+uint HashCombine(uint seed, uint value)
+{
+    return seed ^ (value + 0x9e3779b9u + (seed << 6) + (seed >> 2));
+}
+
+// Hash-based Owen scrambling (Burley, "Practical Hash-based Owen Scrambling", 2020). Every output bit
+// depends only on the input bits above it, so aligned power-of-two blocks stay stratified.
+uint LaineKarrasPermutation(uint x, uint seed)
+{
+    x += seed;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+    return x;
+}
+
+uint NestedUniformScramble(uint x, uint seed)
+{
+    return bitfieldReverse(LaineKarrasPermutation(bitfieldReverse(x), seed));
+}
+
+// Owen-scrambled Sobol. Each group of four dimensions walks the sequence in its own shuffled order, which
+// decorrelates the groups while keeping every group a (0, 2)-sequence in its first two dimensions.
+float SobolSample(uint sampleIndex, uint dimension, uint seed)
+{
+    uint groupSeed = HashCombine(seed, dimension / SOBOL_DIMENSION_COUNT);
+    uint component = dimension % SOBOL_DIMENSION_COUNT;
+
+    uint index = NestedUniformScramble(sampleIndex, groupSeed);
+    uint value = 0;
+    for (uint bit = 0; index != 0; bit++, index >>= 1)
+    {
+        if ((index & 1u) != 0)
+            value ^= u_SamplerTables.SobolMatrices[component * 32 + bit];
+    }
+
+    value = NestedUniformScramble(value, HashCombine(groupSeed, component + 1));
+    // 24 bits, so the float stays below 1.
+    return float(value >> 8) * (1.0 / 16777216.0);
+}
+
+float BlueNoise(uvec2 pixel, uint dimension)
+{
+    uint size = u_SamplerTables.BlueNoiseSize;
+    uint channelCount = u_SamplerTables.BlueNoiseChannelCount;
+    // Dimensions that share a channel read it at R2 offsets, so they are not the same noise.
+    uint reuse = dimension / channelCount;
+    uvec2 offset = uvec2(fract(vec2(0.7548776662, 0.5698402910) * float(reuse)) * float(size));
+    uvec2 texel = (pixel + offset) % size;
+    return u_SamplerTables.BlueNoise[((dimension % channelCount) * size + texel.y) * size + texel.x];
+}
+
+// One number in [0, 1) for the dimension at offset from the current base dimension.
+float SampleDimension(uint offset, inout uint rngState)
+{
+    if (SAMPLER_TYPE == SAMPLER_RANDOM)
+        return RandomValue(rngState);
+
+    uint dimension = g_Sampler.BaseDimension + offset;
+    float value = SobolSample(g_Sampler.SampleIndex, dimension, g_Sampler.Seed);
+    // Every pixel shares the sequence; rotating it by blue noise turns the error between pixels into blue noise.
+    if (SAMPLER_TYPE == SAMPLER_BLUE_NOISE)
+        value = fract(value + BlueNoise(g_Sampler.Pixel, dimension));
+    return value;
+}
+
+vec2 SampleDimension2D(uint offset, inout uint rngState)
+{
+    float x = SampleDimension(offset, rngState);
+    float y = SampleDimension(offset + 1, rngState);
+    return vec2(x, y);
+}
+
+// uv runs over the screen from 0 to 1.
+Ray GenerateCameraRay(vec2 uv)
+{
+    vec3 ndcCoords = vec3(uv * 2.0 - 1.0, 0.0);
+
+    vec3 viewPosition = (u_UBO.InvProjection * vec4(ndcCoords, 1.0)).xyz;
+
+    Ray ray;
+    ray.Origin = u_UBO.CameraPosition.xyz;
+    ray.Dir = normalize((u_UBO.InvView * vec4(viewPosition, 0.0)).xyz);
+    return ray;
+}
+
+// Call BeginSample first.
+Ray GenerateCameraRay(ivec2 pixelCoord, ivec2 numPixels, inout uint rngState)
+{
+    // Jitter inside the pixel so accumulation also anti-aliases.
+    vec2 jitter = SampleDimension2D(SAMPLE_PIXEL_JITTER, rngState);
+    return GenerateCameraRay((vec2(pixelCoord) + jitter) / vec2(numPixels));
+}
+
+HitInfo RaySphere(Ray ray, vec3 sphereCentre, float sphereRadius)
+{
+    HitInfo hitInfo;
+    hitInfo.DidHit = false;
+    vec3 offsetRayOrigin = ray.Origin - sphereCentre;
+    // From the equation: sqrLength(rayOrigin + rayDir * dst) = radius^2
+    // Solving for dst results in a quadratic equation with coefficients:
+    float a = dot(ray.Dir, ray.Dir); // a = 1 (assuming unit vector)
+    float b = 2 * dot(offsetRayOrigin, ray.Dir);
+    float c = dot(offsetRayOrigin, offsetRayOrigin) - sphereRadius * sphereRadius;
+    // Quadratic discriminant
+    float discriminant = b * b - 4 * a * c;
+
+    // No solution when d < 0 (ray misses sphere)
+    if (discriminant >= 0)
+    {
+        // Distance to nearest intersection point (from quadratic formula)
+        float dst = (-b - sqrt(discriminant)) / (2 * a);
+
+        // Ignore intersections that occur behind the ray
+        if (dst >= 0)
+        {
+            hitInfo.DidHit = true;
+            hitInfo.Distance = dst;
+            hitInfo.HitPoint = ray.Origin + ray.Dir * dst;
+            hitInfo.Normal = normalize(hitInfo.HitPoint - sphereCentre);
+            hitInfo.UV = vec2(
+                    0.5 + atan(hitInfo.Normal.z, hitInfo.Normal.x) / (2 * PI),
+                    0.5 - asin(hitInfo.Normal.y) / PI);
+        }
+    }
+    return hitInfo;
+}
+
+// Find the first point that the given ray collides with, and return hit info
+HitInfo CalculateRayCollision(Ray ray)
+{
+    HitInfo closestHit;
+    closestHit.DidHit = false;
+    // We haven't hit anything yet, so 'closest' hit is infinitely far away
+    closestHit.Distance = 1e6;
+
+    // Raycast against all spheres and keep info about the closest hit
+    for (uint i = 0; i < uint(u_Spheres.Spheres.length()); i++)
+    {
+        vec4 position_radius = u_Spheres.Spheres[i].Position_Radius;
+        HitInfo hitInfo = RaySphere(ray, position_radius.xyz, position_radius.w);
+
+        if (hitInfo.DidHit && hitInfo.Distance < closestHit.Distance)
+        {
+            closestHit = hitInfo;
+            closestHit.SphereIndex = i;
+        }
+    }
+    return closestHit;
+}
+
+// --- Light sampling ---
+
+float Luminance(vec3 color)
+{
+    return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
+
+// Must match EmitterTable::GetEmittedPower, since the shaders recompute sampling probabilities from it.
+float EmittedPower(Sphere sphere)
+{
+    vec3 radiance = sphere.Material.EmissionColor_Strength.xyz * sphere.Material.EmissionColor_Strength.w;
+    float radius = sphere.Position_Radius.w;
+    return Luminance(radiance) * 4.0 * PI * PI * radius * radius;
+}
+
+// 1 - cos of the half angle of the cone a sphere subtends from point, or 0 from inside it.
+float SphereConeOneMinusCos(vec3 point, vec4 position_radius)
+{
+    vec3 toCentre = position_radius.xyz - point;
+    float distanceSquared = dot(toCentre, toCentre);
+    float radiusSquared = position_radius.w * position_radius.w;
+    if (distanceSquared <= radiusSquared)
+        return 0.0;
+
+    // sin^2 / (1 + cos) keeps its precision for small, distant lights, where 1 - cos would cancel to 0.
+    float sinThetaMaxSquared = radiusSquared / distanceSquared;
+    float cosThetaMax = sqrt(max(0.0, 1.0 - sinThetaMaxSquared));
+    return sinThetaMaxSquared / (1.0 + cosThetaMax);
+}
+
+// Solid angle density of sampling a direction uniformly inside the cone toward the sphere.
+float SphereConePdf(vec3 point, vec4 position_radius)
+{
+    float oneMinusCos = SphereConeOneMinusCos(point, position_radius);
+    return oneMinusCos > 0.0 ? 1.0 / (2.0 * PI * oneMinusCos) : 0.0;
+}
+
+// Uniform direction inside the cone toward the sphere. point must be outside it.
+vec3 SampleSphereCone(vec3 point, vec4 position_radius, vec2 u)
+{
+    vec3 axis = normalize(position_radius.xyz - point);
+    float cosTheta = 1.0 - u.x * SphereConeOneMinusCos(point, position_radius);
+    float sinTheta = sqrt(max(0.0, 1.0 - cosTheta * cosTheta));
+    float phi = 2.0 * PI * u.y;
+
+    vec3 tangent = normalize(cross(abs(axis.x) > 0.9 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0), axis));
+    vec3 bitangent = cross(axis, tangent);
+    return normalize(tangent * (cos(phi) * sinTheta) + bitangent * (sin(phi) * sinTheta) + axis * cosTheta);
+}
+
+// Picks an emitter in proportion to its power with one lookup into the alias table.
+uint SampleEmitter(float u, out float probability)
+{
+    uint emitterCount = u_Emitters.EmitterCount;
+    float scaled = u * float(emitterCount);
+    uint index = min(uint(scaled), emitterCount - 1);
+    uint picked = scaled - float(index) < u_Emitters.Entries[index].AliasThreshold ? index : u_Emitters.Entries[index].Alias;
+
+    probability = u_Emitters.Entries[picked].Probability;
+    return u_Emitters.Entries[picked].SphereIndex;
+}
+
+float PowerHeuristic(float pdf, float otherPdf)
+{
+    float pdfSquared = pdf * pdf;
+    return pdfSquared / (pdfSquared + otherPdf * otherPdf);
+}
+
+// Next-event estimation for the diffuse lobe: one shadow ray toward a point on an emitter, weighted against the
+// chance that the cosine-weighted bounce finds the same light. Returns the reflected radiance.
+vec3 SampleDirectLight(HitInfo hitInfo, vec3 albedo, inout uint rngState, inout uint raysTraced)
+{
+    if (u_Emitters.EmitterCount == 0)
+        return vec3(0.0);
+
+    float emitterProbability;
+    uint lightIndex = SampleEmitter(SampleDimension(SAMPLE_LIGHT_PICK, rngState), emitterProbability);
+    // A sphere never sees its own surface.
+    if (lightIndex == hitInfo.SphereIndex)
+        return vec3(0.0);
+
+    Sphere light = u_Spheres.Spheres[lightIndex];
+    Ray shadowRay;
+    shadowRay.Origin = hitInfo.HitPoint + hitInfo.Normal * 1e-4;
+    float conePdf = SphereConePdf(shadowRay.Origin, light.Position_Radius);
+    if (conePdf == 0.0)
+        return vec3(0.0);
+
+    shadowRay.Dir = SampleSphereCone(shadowRay.Origin, light.Position_Radius, SampleDimension2D(SAMPLE_LIGHT_DIRECTION, rngState));
+    float cosTheta = dot(hitInfo.Normal, shadowRay.Dir);
+    if (cosTheta <= 0.0)
+        return vec3(0.0);
+
+    // Visible when the closest hit along the sampled direction is the light itself.
+    HitInfo shadowHit = CalculateRayCollision(shadowRay);
+    raysTraced++;
+    if (!shadowHit.DidHit || shadowHit.SphereIndex != lightIndex)
+        return vec3(0.0);
+
+    float lightPdf = emitterProbability * conePdf;
+    float bsdfPdf = cosTheta / PI;
+    vec3 emittedLight = light.Material.EmissionColor_Strength.xyz * light.Material.EmissionColor_Strength.w;
+    return emittedLight * albedo * (cosTheta / PI) * (PowerHeuristic(lightPdf, bsdfPdf) / lightPdf);
+}
+
+// UV extent along u of one pixel's footprint at the hit. Bounces measure from their own origin, so later hits
+// pick finer mips than a ray cone would.
+float UvFootprint(HitInfo hitInfo, float sphereRadius)
+{
+    float pixelWorldSize = hitInfo.Distance * 2.0 / (abs(u_UBO.Projection[1][1]) * float(u_UBO.ScreenResolution.y));
+    return pixelWorldSize / (2.0 * PI * sphereRadius);
+}
+
+vec3 SampleAlbedo(RayTracingMaterial mat, vec2 uv, float uvFootprint)
+{
+    if (mat.TextureHandles.y != INVALID_BINDLESS_HANDLE)
+        return mat.Color_Smoothness.xyz * SampleVirtualTexture(mat.TextureHandles.yzw, uv, uvFootprint).rgb;
+
+    uint albedoHandle = mat.TextureHandles.x;
+    if (albedoHandle == INVALID_BINDLESS_HANDLE)
+        return mat.Color_Smoothness.xyz;
+
+    return mat.Color_Smoothness.xyz * textureLod(u_BindlessTextures[nonuniformEXT(albedoHandle)], uv, 0.0).rgb;
+}
+
+// Adds the surface emission to radiance, attenuates throughput and picks the next ray direction.
+// Call BeginBounceSamples first.
+// bsdfPdf is the solid angle density with which the previous diffuse bounce picked ray, or 0 after the camera
+// and specular bounces, whose emission next-event estimation cannot have counted. It is updated for the next hit.
+void ScatterRay(inout Ray ray, HitInfo hitInfo, inout vec3 throughput, inout vec3 radiance, inout float bsdfPdf, inout uint rngState, inout uint raysTraced)
+{
+    Sphere sphere = u_Spheres.Spheres[hitInfo.SphereIndex];
+    RayTracingMaterial mat = sphere.Material;
+    bool sampleLights = u_Frame.NextEventEstimation != 0 && u_Emitters.TotalPower > 0.0;
+
+    vec3 emittedLight = mat.EmissionColor_Strength.xyz * mat.EmissionColor_Strength.w;
+    float emissionWeight = 1.0;
+    if (sampleLights && bsdfPdf > 0.0)
+    {
+        float lightPdf = EmittedPower(sphere) / u_Emitters.TotalPower * SphereConePdf(ray.Origin, sphere.Position_Radius);
+        emissionWeight = PowerHeuristic(bsdfPdf, lightPdf);
+    }
+    radiance += emittedLight * throughput * emissionWeight;
+
+    float isSpecularBounce = mat.SpecularColor_Probability.w >= SampleDimension(SAMPLE_LOBE, rngState) ? 1.0 : 0.0;
+    ray.Origin = hitInfo.HitPoint + hitInfo.Normal * 1e-4;
+    // Normal plus a uniform point on the unit sphere is cosine-distributed about the normal.
+    vec3 diffuseDir = hitInfo.Normal + UniformSphereDirection(SampleDimension2D(SAMPLE_DIFFUSE_DIRECTION, rngState));
+    diffuseDir = dot(diffuseDir, diffuseDir) > 1e-8 ? normalize(diffuseDir) : hitInfo.Normal;
+    vec3 specularDir = reflect(ray.Dir, hitInfo.Normal);
+    ray.Dir = normalize(mix(diffuseDir, specularDir, mat.Color_Smoothness.w * isSpecularBounce));
+
+    vec3 albedo = SampleAlbedo(mat, hitInfo.UV, UvFootprint(hitInfo, sphere.Position_Radius.w));
+
+    // Only the diffuse lobe has a density to weigh light samples against.
+    bool diffuseBounce = isSpecularBounce == 0.0;
+    if (sampleLights && diffuseBounce)
+        radiance += throughput * SampleDirectLight(hitInfo, albedo, rngState, raysTraced);
+    bsdfPdf = diffuseBounce ? max(dot(hitInfo.Normal, ray.Dir), 0.0) / PI : 0.0;
+
+    throughput *= mix(albedo, mat.SpecularColor_Probability.xyz, isSpecularBounce);
+}
+
+vec3 Trace(Ray ray, uint maxBounceCount, inout uint rngState, inout uint raysTraced)
+{
+    vec3 radiance = vec3(0.0);
+    vec3 throughput = vec3(1.0);
+    float bsdfPdf = 0.0;
+
+    for (uint bounce = 0; bounce <= maxBounceCount; bounce++)
+    {
+        HitInfo hitInfo = CalculateRayCollision(ray);
+        raysTraced++;
+        if (!hitInfo.DidHit)
+            break;
+
+        BeginBounceSamples(bounce);
+        ScatterRay(ray, hitInfo, throughput, radiance, bsdfPdf, rngState, raysTraced);
+    }
+
+    return radiance;
+}
@@ -0,0 +1,75 @@
+// Virtual texture lookups through an indirection texture and a physical page cache.
+// Every lookup records the page it wanted in a per-frame feedback bitset, which the CPU turns into page loads.
+// Expects u_BindlessTextures (set 2, binding 0) to be declared by the including file.
+
+layout(std430, set = 2, binding = 1) buffer VirtualTextureFeedback
+{
+    // x: width, y: height, z: mip count, w: page size | border << 16
+    uvec4 Info;
+    // One bit per grid page, levels packed from mip 0.
+    uint RequestedPages[];
+} u_VirtualTextureFeedback[];
+
+uvec2 VirtualPageCount(uvec2 extent, uint mip, uint pageSize)
+{
+    return (max(extent >> mip, uvec2(1u)) + pageSize - 1u) / pageSize;
+}
+
+// The indirection grid is a power of two at mip 0, so its levels follow the indirection image's mips.
+uvec2 VirtualGridExtent(uvec2 extent, uint mip, uint pageSize)
+{
+    uvec2 pages = VirtualPageCount(extent, 0u, pageSize);
+    uvec2 grid = uvec2(1u) << uvec2(findMSB(pages - 1u) + 1);
+    return max(grid >> mip, uvec2(1u));
+}
+
+uint VirtualGridIndex(uvec2 extent, uint mip, uvec2 page, uint pageSize)
+{
+    uint index = 0u;
+    for (uint level = 0u; level < mip; level++)
+    {
+        uvec2 grid = VirtualGridExtent(extent, level, pageSize);
+        index += grid.x * grid.y;
+    }
+    return index + page.y * VirtualGridExtent(extent, mip, pageSize).x + page.x;
+}
+
+// handles: indirection texture, physical texture, this frame's feedback buffer.
+// uvFootprint is the UV extent one pixel covers along u, which picks the mip.
+vec4 SampleVirtualTexture(uvec3 handles, vec2 uv, float uvFootprint)
+{
+    uvec4 info = u_VirtualTextureFeedback[nonuniformEXT(handles.z)].Info;
+    uvec2 extent = info.xy;
+    uint pageSize = info.w & 0xFFFFu;
+    uint border = info.w >> 16;
+
+    uv = fract(uv);
+    float level = floor(log2(max(uvFootprint * float(extent.x), 1.0)));
+    uint mip = uint(clamp(level, 0.0, float(info.z - 1u)));
+
+    uvec2 levelExtent = max(extent >> mip, uvec2(1u));
+    uvec2 page = min(uvec2(uv * vec2(levelExtent)) / pageSize, VirtualPageCount(extent, mip, pageSize) - 1u);
+
+    // Test before setting so pages that are already requested cost a read instead of an atomic.
+    uint gridIndex = VirtualGridIndex(extent, mip, page, pageSize);
+    uint word = gridIndex >> 5;
+    uint bit = 1u << (gridIndex & 31u);
+    if ((u_VirtualTextureFeedback[nonuniformEXT(handles.z)].RequestedPages[word] & bit) == 0u)
+        atomicOr(u_VirtualTextureFeedback[nonuniformEXT(handles.z)].RequestedPages[word], bit);
+
+    // (slot x, slot y, resident mip, 255), or zero alpha while nothing is resident.
+    uvec4 entry = uvec4(round(texelFetch(u_BindlessTextures[nonuniformEXT(handles.x)], ivec2(page), int(mip)) * 255.0));
+    if (entry.w == 0u)
+        return vec4(1.0);
+
+    // The resident page is an ancestor; halving clamps to the last page of each level, as on the CPU.
+    uint residentMip = entry.z;
+    uvec2 residentExtent = max(extent >> residentMip, uvec2(1u));
+    uvec2 residentPage = min(page >> (residentMip - mip), VirtualPageCount(extent, residentMip, pageSize) - 1u);
+    vec2 inPage = uv * vec2(residentExtent) - vec2(residentPage * pageSize);
+
+    float paddedSize = float(pageSize + 2u * border);
+    vec2 texel = vec2(entry.xy) * paddedSize + float(border) + inPage;
+    vec2 physicalSize = vec2(textureSize(u_BindlessTextures[nonuniformEXT(handles.y)], 0));
+    return textureLod(u_BindlessTextures[nonuniformEXT(handles.y)], texel / physicalSize, 0.0);
+}
@@ -0,0 +1,108 @@
+// Buffers shared by the wavefront path tracing stages. Include after path_tracing.glsl.
+
+#define WAVEFRONT_GROUP_SIZE 64
+#define SORT_BIN_COUNT 1024
+#define INVALID_SPHERE_INDEX 0xFFFFFFFFu
+
+// One path per pixel, so a path's index is also its pixel index. Every live path is on the
+// same bounce, which comes from the push constants rather than the path.
+struct PathState
+{
+    vec4 Origin;                    // w: solid angle pdf of the bounce that chose Direction, 0 if specular
+    vec4 Direction_RngState;        // w: rng state (uint bits)
+    vec4 Throughput;
+    vec4 Radiance;
+};
+
+struct HitRecord
+{
+    float Distance;
+    uint SphereIndex;               // INVALID_SPHERE_INDEX on a miss
+    uint SortKey;
+    uint Pad;
+};
+
+layout(set = 1, binding = 1, rgba32f) uniform image2D u_AccumulationImage;
+
+layout(std430, set = 1, binding = 2) buffer Paths
+{
+    PathState u_Paths[];
+};
+
+layout(std430, set = 1, binding = 3) buffer Hits
+{
+    HitRecord u_Hits[];
+};
+
+// Path indices to process this bounce
+layout(std430, set = 1, binding = 4) buffer InQueue
+{
+    uint u_InQueue[];
+};
+
+// Compacted path indices that survive to the next bounce
+layout(std430, set = 1, binding = 5) buffer OutQueue
+{
+    uint u_OutQueue[];
+};
+
+layout(std430, set = 1, binding = 6) buffer Counters
+{
+    uint ActiveCount;
+    uint NextCount;
+    uint RaysTraced;
+    uint Pad;
+    uvec4 ExtendDispatch;
+} u_Counters;
+
+layout(std430, set = 1, binding = 7) buffer SortBins
+{
+    uint u_SortBins[SORT_BIN_COUNT];
+};
+
+layout(std430, set = 1, binding = 8) buffer SortRanks
+{
+    uint u_SortRanks[];
+};
+
+// u_InQueue reordered so rays with the same material and direction octant are adjacent
+layout(std430, set = 1, binding = 9) buffer SortedQueue
+{
+    uint u_SortedQueue[];
+};
+
+// Handed to the graphics queue for compositing while the next frame is traced
+layout(set = 1, binding = 10, rgba16f) uniform writeonly image2D u_DisplayImage;
+
+Ray GetPathRay(PathState path)
+{
+    Ray ray;
+    ray.Origin = path.Origin.xyz;
+    ray.Dir = path.Direction_RngState.xyz;
+    return ray;
+}
+
+uint ComputeSortKey(uint sphereIndex, vec3 direction)
+{
+    if (sphereIndex == INVALID_SPHERE_INDEX)
+        return SORT_BIN_COUNT - 1;
+
+    uint octant = (direction.x < 0.0 ? 1u : 0u) | (direction.y < 0.0 ? 2u : 0u) | (direction.z < 0.0 ? 4u : 0u);
+    return min(sphereIndex, (SORT_BIN_COUNT / 8) - 2) * 8 + octant;
+}
+
+HitInfo ReconstructHit(Ray ray, HitRecord record)
+{
+    vec3 sphereCentre = u_Spheres.Spheres[record.SphereIndex].Position_Radius.xyz;
+
+    HitInfo hitInfo;
+    hitInfo.DidHit = true;
+    hitInfo.Distance = record.Distance;
+    hitInfo.HitPoint = ray.Origin + ray.Dir * record.Distance;
+    hitInfo.Normal = normalize(hitInfo.HitPoint - sphereCentre);
+    hitInfo.UV = vec2(
+            0.5 + atan(hitInfo.Normal.z, hitInfo.Normal.x) / (2 * PI),
+            0.5 - asin(hitInfo.Normal.y) / PI);
+    hitInfo.SphereIndex = record.SphereIndex;
+    return hitInfo;
+}
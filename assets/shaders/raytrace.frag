@@ -1,4 +1,5 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout (location = 0) in vec2 v_UV;
 layout (location = 1) in vec3 v_Ro;
@@ -13,15 +14,25 @@ layout(set = 0, binding = 0) uniform GlobalUBO
     mat4 InvView;
     mat4 InvProjection;
     vec4 CameraPosition;
-    ivec4 ScreenResolution_NumRaysPerPixel_FrameNumber;
+    ivec4 ScreenResolution;
 }  u_UBO;
 
+layout(push_constant) uniform FramePushConstants
+{
+    uint FrameNumber;
+    uint AccumulationIndex;
+    uint SampleCount;
+    uint TransformIndex;
+    uint MaxBounceCount;
+} u_Frame;
+
 
 struct RayTracingMaterial
 {
     vec4 Color_Smoothness;
     vec4 EmissionColor_Strength;
     vec4 SpecularColor_Probability;
+    uvec4 TextureHandles;
 };
 
 struct Sphere
@@ -35,6 +46,10 @@ layout(std430, set = 1, binding = 0) buffer Spheres
     Sphere Spheres[];
 } u_Spheres;
 
+layout(set = 2, binding = 0) uniform sampler2D u_BindlessTextures[];
+
+const uint INVALID_BINDLESS_HANDLE = 0xFFFFFFFFu;
+
 struct Ray
 {
     vec3 Origin;
@@ -47,6 +62,7 @@ struct HitInfo
     float Distance;
     vec3 HitPoint;
     vec3 Normal;
+    vec2 UV;
     RayTracingMaterial Material;
 };
 // --- RNG Stuff ---
@@ -119,6 +135,9 @@ HitInfo RaySphere(Ray ray, vec3 sphereCentre, float sphereRadius)
             hitInfo.Distance = dst;
             hitInfo.HitPoint = ray.Origin + ray.Dir * dst;
             hitInfo.Normal = normalize(hitInfo.HitPoint - sphereCentre);
+            hitInfo.UV = vec2(
+                    0.5 + atan(hitInfo.Normal.z, hitInfo.Normal.x) / (2 * PI),
+                    0.5 - asin(hitInfo.Normal.y) / PI);
         }
     }
     return hitInfo;
@@ -147,6 +166,15 @@ HitInfo CalculateRayCollision(Ray ray)
     return closestHit;
 }
 
+vec3 SampleAlbedo(RayTracingMaterial mat, vec2 uv)
+{
+    uint albedoHandle = mat.TextureHandles.x;
+    if (albedoHandle == INVALID_BINDLESS_HANDLE)
+        return mat.Color_Smoothness.xyz;
+
+    return mat.Color_Smoothness.xyz * texture(u_BindlessTextures[nonuniformEXT(albedoHandle)], uv).rgb;
+}
+
 
 vec3 Trace(Ray ray, inout uint rngState)
 {
@@ -171,7 +199,7 @@ vec3 Trace(Ray ray, inout uint rngState)
     // Update light calculations
     vec3 emittedLight = mat.EmissionColor_Strength.xyz * mat.EmissionColor_Strength.w;
     incomingLight += emittedLight * rayColor;
-    rayColor *= mix(mat.Color_Smoothness.xyz, mat.SpecularColor_Probability.xyz, isSpecularBounce);
+    rayColor *= mix(SampleAlbedo(mat, hitInfo.UV), mat.SpecularColor_Probability.xyz, isSpecularBounce);
 
     return incomingLight;
 }
@@ -182,25 +210,24 @@ void main()
     ray.Origin = v_Ro;
     ray.Dir = normalize(v_Rd);
 
-    ivec2 numPixels = u_UBO.ScreenResolution_NumRaysPerPixel_FrameNumber.xy;
+    ivec2 numPixels = u_UBO.ScreenResolution.xy;
     ivec2 pixelCoord = ivec2(v_UV) * numPixels;
     uint pixelIndex = pixelCoord.y * numPixels.x + pixelCoord.x;
 
-    int frameNumber = u_UBO.ScreenResolution_NumRaysPerPixel_FrameNumber.w;
-    uint rngState = pixelIndex + frameNumber * 719393;
+    uint rngState = pixelIndex + u_Frame.FrameNumber * 719393;
 
     vec3 cameraRight = vec3(u_UBO.View[0][0], u_UBO.View[1][0], u_UBO.View[2][0]);
     vec3 cameraUp = vec3(u_UBO.View[0][1], u_UBO.View[1][1], u_UBO.View[2][1]);
     vec3 cameraForward = -vec3(u_UBO.View[0][2], u_UBO.View[1][2], u_UBO.View[2][2]);
 
     vec3 incomingLight = vec3(0.0);
-    int raysPerPixel = u_UBO.ScreenResolution_NumRaysPerPixel_FrameNumber.z;
-    for(int i = 0; i < raysPerPixel; i++)
+    uint raysPerPixel = u_Frame.SampleCount;
+    for(uint i = 0; i < raysPerPixel; i++)
     {
         incomingLight += Trace(ray, rngState);
     }
 
-    vec3 color = incomingLight / raysPerPixel;
+    vec3 color = incomingLight / float(raysPerPixel);
 
     o_Color = vec4(color, 1.0);
 }
\ No newline at end of file
@@ -11,7 +11,7 @@ layout(set = 0, binding = 0) uniform GlobalUBO
     mat4 InvView;
     mat4 InvProjection;
     vec4 CameraPosition;
-    ivec4 ScreenResolution_NumRaysPerPixel_FrameNumber;
+    ivec4 ScreenResolution;
 }  u_UBO;
 
 void main()
@@ -3,7 +3,7 @@
 layout (location = 0) in vec2 v_UV;
 layout (location = 0) out vec4 o_FragColor;
 
-layout (set = 0, binding = 0) uniform sampler2D u_Texture;
+layout (set = 1, binding = 0) uniform sampler2D u_Texture;
 
 void main()
 {
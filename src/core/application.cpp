@@ -1,12 +1,16 @@
 #include "application.h"
 #include "../../renderer.h"
 #include "renderer/scratch_renderer.h"
+#include "core/profiler.h"
+#include "renderer/vulkan/vulkan_gpu_profiler.h"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 
 #include <glm/glm.hpp>
 #include <chrono>
+#include <fstream>
+#include <iostream>
 
 Application::Application()
 {
@@ -16,8 +20,9 @@ Application::Application()
 
 Application::~Application() = default;
 
-void Application::Run()
+void Application::Run(const std::string& profilePath)
 {
+    PROFILE_THREAD_NAME("Main");
     RTRenderer renderer(m_Window, m_VulkanDevice);
     renderer.Initialize();
     auto currentTime = std::chrono::high_resolution_clock::now();
@@ -25,7 +30,11 @@ void Application::Run()
 
     while(!m_Window.ShouldClose())
     {
-        glfwPollEvents();
+        PROFILE_ZONE("Frame");
+        {
+            PROFILE_ZONE("PollEvents");
+            glfwPollEvents();
+        }
 
         auto newTime = std::chrono::high_resolution_clock::now();
         float frameTime = std::chrono::duration<float>(newTime - currentTime).count();
@@ -36,4 +45,28 @@ void Application::Run()
     }
 
     vkDeviceWaitIdle(m_VulkanDevice.GetDevice());
+
+    if (!profilePath.empty())
+    {
+        VulkanGpuProfiler& profiler = m_VulkanDevice.GetGpuProfiler();
+        profiler.Flush();
+
+        std::ofstream statistics(profilePath + ".json");
+        profiler.WriteJson(statistics);
+        std::ofstream trace(profilePath + ".trace.json");
+        profiler.WriteChromeTrace(trace);
+        std::cout << "Wrote profile to " << profilePath << ".json and " << profilePath << ".trace.json\n";
+    }
+}
+
+void Application::RunTracerComparison()
+{
+    RTRenderer renderer(m_Window, m_VulkanDevice);
+    renderer.Initialize();
+    m_Camera.SetPerspectiveProjection(glm::radians(50.0f), renderer.GetAspectRatio(), 0.1f, 100.0f);
+
+    constexpr uint32_t FrameCount = 64;
+    renderer.CompareTracers(m_Camera, { 1, 4, 16 }, FrameCount);
+
+    vkDeviceWaitIdle(m_VulkanDevice.GetDevice());
 }
\ No newline at end of file
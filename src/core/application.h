@@ -1,5 +1,6 @@
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include "renderer/vulkan/vulkan_device.h"
@@ -20,7 +21,11 @@ public:
     Application(const Application&) = delete;
     Application& operator=(const Application&) = delete;
 
-    void Run();
+    // With a profile path, writes the GPU profiler's statistics to <path>.json and the CPU zones merged with
+    // the GPU timeline to <path>.trace.json on exit.
+    void Run(const std::string& profilePath = {});
+    // Prints megakernel vs wavefront rays/sec at 1, 4 and 16 bounces, then returns.
+    void RunTracerComparison();
 
     static Application* GetInstance() { return s_ApplicationInstance; }
     [[nodiscard]] const Camera& GetCamera() const { return m_Camera; }
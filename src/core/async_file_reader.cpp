@@ -0,0 +1,323 @@
+#include "async_file_reader.h"
+#include "profiler.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define RE_COO_IO_URING 1
+#endif
+#endif
+
+#ifndef RE_COO_IO_URING
+#define RE_COO_IO_URING 0
+#endif
+
+// The raw ring interface, so the engine does not need liburing. Only the reader's thread touches the ring.
+struct AsyncFileReader::IoUring
+{
+#if RE_COO_IO_URING
+    int Fd = -1;
+    void* SqRing = nullptr;
+    size_t SqRingSize = 0;
+    void* CqRing = nullptr;
+    size_t CqRingSize = 0;
+    io_uring_sqe* Sqes = nullptr;
+    size_t SqesSize = 0;
+
+    unsigned* SqTail = nullptr;
+    const unsigned* SqMask = nullptr;
+    unsigned* SqArray = nullptr;
+    unsigned* CqHead = nullptr;
+    const unsigned* CqTail = nullptr;
+    const unsigned* CqMask = nullptr;
+    const io_uring_cqe* Cqes = nullptr;
+
+    static std::unique_ptr<IoUring> Create(uint32_t entries)
+    {
+        io_uring_params params{};
+        const int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0)
+            return nullptr;
+
+        auto ring = std::make_unique<IoUring>();
+        ring->Fd = fd;
+        ring->SqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        ring->CqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMapping)
+            ring->SqRingSize = ring->CqRingSize = std::max(ring->SqRingSize, ring->CqRingSize);
+
+        ring->SqRing = Map(fd, ring->SqRingSize, IORING_OFF_SQ_RING);
+        if (ring->SqRing == nullptr)
+            return nullptr;
+        ring->CqRing = singleMapping ? ring->SqRing : Map(fd, ring->CqRingSize, IORING_OFF_CQ_RING);
+        if (ring->CqRing == nullptr)
+            return nullptr;
+        ring->SqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        ring->Sqes = static_cast<io_uring_sqe*>(Map(fd, ring->SqesSize, IORING_OFF_SQES));
+        if (ring->Sqes == nullptr)
+            return nullptr;
+
+        auto* sq = static_cast<uint8_t*>(ring->SqRing);
+        ring->SqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        ring->SqMask = reinterpret_cast<const unsigned*>(sq + params.sq_off.ring_mask);
+        ring->SqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        auto* cq = static_cast<uint8_t*>(ring->CqRing);
+        ring->CqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        ring->CqTail = reinterpret_cast<const unsigned*>(cq + params.cq_off.tail);
+        ring->CqMask = reinterpret_cast<const unsigned*>(cq + params.cq_off.ring_mask);
+        ring->Cqes = reinterpret_cast<const io_uring_cqe*>(cq + params.cq_off.cqes);
+        return ring;
+    }
+
+    ~IoUring()
+    {
+        if (Sqes != nullptr)
+            munmap(Sqes, SqesSize);
+        if (CqRing != nullptr && CqRing != SqRing)
+            munmap(CqRing, CqRingSize);
+        if (SqRing != nullptr)
+            munmap(SqRing, SqRingSize);
+        if (Fd >= 0)
+            close(Fd);
+    }
+
+    static void* Map(int fd, size_t size, off_t offset)
+    {
+        void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+        return mapping == MAP_FAILED ? nullptr : mapping;
+    }
+
+    // The caller keeps no more entries queued than the ring holds. iov must stay alive until submitted.
+    void QueueRead(int fd, const iovec* iov, uint64_t offset, uint64_t userData)
+    {
+        const unsigned tail = *SqTail;
+        const unsigned index = tail & *SqMask;
+        io_uring_sqe& sqe = Sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        // READV rather than READ keeps kernels back to 5.1 working.
+        sqe.opcode = IORING_OP_READV;
+        sqe.fd = fd;
+        sqe.off = offset;
+        sqe.addr = reinterpret_cast<uint64_t>(iov);
+        sqe.len = 1;
+        sqe.user_data = userData;
+        SqArray[index] = index;
+        __atomic_store_n(SqTail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    // Submits queued entries and waits for at least minComplete completions. Returns the number submitted.
+    int Enter(unsigned submitCount, unsigned minComplete)
+    {
+        while (true)
+        {
+            const int result = static_cast<int>(syscall(__NR_io_uring_enter, Fd, submitCount, minComplete, IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (result >= 0 || errno != EINTR)
+                return result;
+        }
+    }
+
+    template<typename Fn>
+    void ForEachCompletion(Fn&& fn)
+    {
+        unsigned head = *CqHead;
+        const unsigned tail = __atomic_load_n(CqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++)
+            fn(Cqes[head & *CqMask]);
+        __atomic_store_n(CqHead, head, __ATOMIC_RELEASE);
+    }
+#endif
+};
+
+namespace
+{
+    bool ReadWholeFile(const std::string& filepath, AsyncFileReader::Result& result)
+    {
+        std::ifstream file{filepath, std::ios::ate | std::ios::binary};
+        if (!file.is_open())
+        {
+            result.Data.clear();
+            return false;
+        }
+
+        result.Data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(result.Data.data()), static_cast<std::streamsize>(result.Data.size()));
+        if (!file)
+        {
+            result.Data.clear();
+            return false;
+        }
+        return true;
+    }
+}
+
+AsyncFileReader::AsyncFileReader(uint32_t queueDepth)
+    : m_QueueDepth(std::max(1u, queueDepth))
+{
+#if RE_COO_IO_URING
+    m_Ring = IoUring::Create(m_QueueDepth);
+#endif
+    if (m_Ring == nullptr)
+        m_Workers = std::make_unique<ThreadPool>(std::min(m_QueueDepth, ThreadPool::GetDefaultWorkerCount()));
+}
+
+AsyncFileReader::~AsyncFileReader() = default;
+
+std::vector<AsyncFileReader::Result> AsyncFileReader::ReadFiles(const std::vector<std::string>& filepaths)
+{
+    std::vector<Result> results;
+    ReadFiles(filepaths, results);
+    return results;
+}
+
+void AsyncFileReader::ReadFiles(const std::vector<std::string>& filepaths, std::vector<Result>& results)
+{
+    PROFILE_ZONE("AsyncFileReader::ReadFiles");
+    results.resize(filepaths.size());
+    for (Result& result : results)
+        result.Success = false;
+
+    if (m_Ring != nullptr)
+        ReadFilesWithIoUring(filepaths, results);
+    else
+        ReadFilesWithThreads(filepaths, results);
+}
+
+void AsyncFileReader::ReadFilesWithIoUring(const std::vector<std::string>& filepaths, std::vector<Result>& results)
+{
+#if RE_COO_IO_URING
+    // Linux transfers at most ~2 GiB per read; bigger files take several.
+    constexpr uint64_t MaxReadSize = 1ull << 30;
+
+    struct PendingFile
+    {
+        int Fd = -1;
+        uint64_t Offset = 0;
+        iovec Target{};
+    };
+    std::vector<PendingFile> files(filepaths.size());
+
+    unsigned queuedCount = 0;
+    auto queueRead = [&](size_t index)
+    {
+        PendingFile& file = files[index];
+        const uint64_t remaining = results[index].Data.size() - file.Offset;
+        file.Target.iov_base = results[index].Data.data() + file.Offset;
+        file.Target.iov_len = static_cast<size_t>(std::min(remaining, MaxReadSize));
+        m_Ring->QueueRead(file.Fd, &file.Target, file.Offset, index);
+        queuedCount++;
+    };
+    auto finish = [&](size_t index, bool success)
+    {
+        close(files[index].Fd);
+        files[index].Fd = -1;
+        results[index].Success = success;
+        if (!success)
+            results[index].Data.clear();
+    };
+
+    size_t nextFile = 0;
+    uint32_t inFlight = 0;
+    while (nextFile < filepaths.size() || inFlight > 0)
+    {
+        // Open files only as queue slots free up, so a large batch never holds more than queueDepth descriptors.
+        while (inFlight < m_QueueDepth && nextFile < filepaths.size())
+        {
+            const size_t index = nextFile++;
+            const int fd = open(filepaths[index].c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+            {
+                results[index].Data.clear();
+                continue;
+            }
+
+            files[index].Fd = fd;
+            struct stat status{};
+            if (fstat(fd, &status) != 0)
+            {
+                finish(index, false);
+                continue;
+            }
+            results[index].Data.resize(static_cast<size_t>(status.st_size));
+            if (results[index].Data.empty())
+            {
+                finish(index, true);
+                continue;
+            }
+
+            queueRead(index);
+            inFlight++;
+        }
+        if (inFlight == 0)
+            break;
+
+        const int submitted = m_Ring->Enter(queuedCount, 1);
+        if (submitted < 0)
+        {
+            const int error = errno;
+            for (PendingFile& file : files)
+            {
+                if (file.Fd >= 0)
+                    close(file.Fd);
+            }
+            throw std::runtime_error(std::string("io_uring_enter failed: ") + std::strerror(error));
+        }
+        queuedCount -= static_cast<unsigned>(submitted);
+
+        m_Ring->ForEachCompletion([&](const io_uring_cqe& completion)
+        {
+            const auto index = static_cast<size_t>(completion.user_data);
+            if (completion.res == -EINTR || completion.res == -EAGAIN)
+            {
+                queueRead(index);
+                return;
+            }
+            // Zero bytes before the end means the file shrank after fstat.
+            if (completion.res <= 0)
+            {
+                finish(index, false);
+                inFlight--;
+                return;
+            }
+
+            files[index].Offset += static_cast<uint64_t>(completion.res);
+            if (files[index].Offset < results[index].Data.size())
+            {
+                queueRead(index);
+                return;
+            }
+            finish(index, true);
+            inFlight--;
+        });
+    }
+#else
+    (void)filepaths;
+    (void)results;
+#endif
+}
+
+void AsyncFileReader::ReadFilesWithThreads(const std::vector<std::string>& filepaths, std::vector<Result>& results)
+{
+    for (size_t index = 0; index < filepaths.size(); index++)
+    {
+        m_Workers->Submit([&filepaths, &results, index]()
+        {
+            results[index].Success = ReadWholeFile(filepaths[index], results[index]);
+        });
+    }
+    m_Workers->WaitIdle();
+}
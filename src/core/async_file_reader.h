@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// Reads batches of whole files with many reads in flight at once, which is what keeps an NVMe drive busy
+// when a scene pulls in hundreds of textures and meshes. On Linux the reads go through one io_uring owned by
+// the reader; where io_uring is missing or disabled (older kernels, containers, other platforms) a small
+// thread pool issues blocking reads instead. For a single file consumed in place, prefer MappedFile.
+class AsyncFileReader
+{
+public:
+    struct Result
+    {
+        std::vector<uint8_t> Data;
+        bool Success = false;
+    };
+
+    // queueDepth bounds the reads in flight, i.e. the files open at once.
+    explicit AsyncFileReader(uint32_t queueDepth = 64);
+    ~AsyncFileReader();
+
+    AsyncFileReader(const AsyncFileReader&) = delete;
+    AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+    // Blocks until every file is read. Results are in the order of filepaths; a file that cannot be opened
+    // or read leaves its result empty with Success false.
+    std::vector<Result> ReadFiles(const std::vector<std::string>& filepaths);
+    // Same, reusing the buffers already in results. Faulting in fresh pages for every batch costs more than
+    // the reads themselves when the files are cached, so loaders reading batch after batch should keep theirs.
+    void ReadFiles(const std::vector<std::string>& filepaths, std::vector<Result>& results);
+
+    [[nodiscard]] bool IsUsingIoUring() const { return m_Ring != nullptr; }
+
+private:
+    void ReadFilesWithIoUring(const std::vector<std::string>& filepaths, std::vector<Result>& results);
+    void ReadFilesWithThreads(const std::vector<std::string>& filepaths, std::vector<Result>& results);
+
+private:
+    struct IoUring;
+
+    uint32_t m_QueueDepth;
+    std::unique_ptr<IoUring> m_Ring;
+    std::unique_ptr<ThreadPool> m_Workers;
+};
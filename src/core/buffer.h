@@ -1,141 +1,201 @@
 #pragma once
+#include "buffer_allocator.h"
+
 #include <cstdint>
 #include <cstring>
 #include <cassert>
 #include <span>
+#include <utility>
 
 using byte = uint8_t;
 
-struct Buffer
+// Non-owning view of bytes someone else keeps alive. Cheap to pass by value.
+struct BufferView
 {
-    void* Data;
-    uint64_t Size;
+    const void* Data = nullptr;
+    uint64_t Size = 0;
 
-    Buffer()
-            : Data(nullptr), Size(0)
+    BufferView() = default;
+    BufferView(const void* data, uint64_t size)
+            : Data(data), Size(size)
     {
     }
 
-    Buffer(const void* data, uint64_t size = 0)
-            : Data((void*)data), Size(size)
+    template<typename T, size_t N>
+    std::span<const T> ReadSpan(uint64_t offset = 0) const
     {
+        return std::span<const T>((const T*)((const byte*)Data + offset), N);
     }
 
-    static Buffer Copy(const Buffer& other)
+    template<typename T>
+    const T& Read(uint64_t offset = 0) const
     {
-        Buffer buffer;
-        buffer.Allocate(other.Size);
-        memcpy(buffer.Data, other.Data, other.Size);
+        return *(const T*)((const byte*)Data + offset);
+    }
+
+    template<typename T>
+    const T* As() const
+    {
+        return (const T*)Data;
+    }
+
+    explicit operator bool() const
+    {
+        return Data;
+    }
+
+    [[nodiscard]] inline uint64_t GetSize() const { return Size; }
+};
+
+// Owns its bytes and returns them to the allocator they came from. Move-only; copy explicitly with Copy.
+// The allocator must outlive the buffer, which for an arena also means not resetting it first.
+class Buffer
+{
+public:
+    Buffer() = default;
+
+    explicit Buffer(uint64_t size, BufferAllocator& allocator = HeapAllocator::Get())
+            : m_Allocator(&allocator)
+    {
+        Allocate(size);
+    }
+
+    ~Buffer()
+    {
+        Release();
+    }
+
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+
+    Buffer(Buffer&& other) noexcept
+            : m_Data(std::exchange(other.m_Data, nullptr)),
+              m_Size(std::exchange(other.m_Size, 0)),
+              m_Allocator(other.m_Allocator)
+    {
+    }
+
+    Buffer& operator=(Buffer&& other) noexcept
+    {
+        if (this == &other)
+            return *this;
+
+        Release();
+        m_Data = std::exchange(other.m_Data, nullptr);
+        m_Size = std::exchange(other.m_Size, 0);
+        m_Allocator = other.m_Allocator;
+        return *this;
+    }
+
+    static Buffer Copy(BufferView other, BufferAllocator& allocator = HeapAllocator::Get())
+    {
+        Buffer buffer(other.Size, allocator);
+        if (other.Size > 0)
+            memcpy(buffer.m_Data, other.Data, other.Size);
         return buffer;
     }
 
-    static Buffer Copy(const void* data, uint64_t size)
+    // Takes ownership of memory that was allocated from allocator outside any Buffer.
+    static Buffer Adopt(void* data, uint64_t size, BufferAllocator& allocator)
     {
         Buffer buffer;
-        buffer.Allocate(size);
-        memcpy(buffer.Data, data, size);
+        buffer.m_Allocator = &allocator;
+        if (!data)
+            return buffer;
+
+        allocator.Adopt(size);
+        buffer.m_Data = data;
+        buffer.m_Size = size;
         return buffer;
     }
 
+    // Replaces the contents with size uninitialized bytes from the buffer's allocator.
     void Allocate(uint64_t size)
     {
-        delete[] (byte*)Data;
-        Data = nullptr;
-
+        Release();
         if (size == 0)
             return;
 
-        Data = new byte[size];
-        Size = size;
+        m_Data = m_Allocator->Allocate(size);
+        m_Size = size;
     }
 
     void Release()
     {
-        delete[] (byte*)Data;
-        Data = nullptr;
-        Size = 0;
+        if (m_Data)
+            m_Allocator->Free(m_Data, m_Size);
+        m_Data = nullptr;
+        m_Size = 0;
     }
 
     void ZeroInitialize() const
     {
-        if (Data)
-            memset(Data, 0, Size);
+        if (m_Data)
+            memset(m_Data, 0, m_Size);
     }
 
     template<typename T, size_t N>
     std::span<T> ReadSpan(uint64_t offset = 0)
     {
-        return std::span<T>((T*)((byte*)Data + offset), N);
+        return std::span<T>((T*)((byte*)m_Data + offset), N);
     }
 
     template<typename T, size_t N>
     std::span<const T> ReadSpan(uint64_t offset = 0) const
     {
-        return std::span<const T>((const T*)((byte*)Data + offset), N);
+        return std::span<const T>((const T*)((byte*)m_Data + offset), N);
     }
 
     template<typename T>
     T& Read(uint64_t offset = 0)
     {
-        return *(T*)((byte*)Data + offset);
+        return *(T*)((byte*)m_Data + offset);
     }
 
     template<typename T>
     const T& Read(uint64_t offset = 0) const
     {
-        return *(T*)((byte*)Data + offset);
+        return *(T*)((byte*)m_Data + offset);
     }
 
-    [[nodiscard]] byte* CopyBytes(uint64_t size, uint64_t offset) const
+    void Write(const void* data, uint64_t size, uint64_t offset = 0) const
     {
-        assert(offset + size <= Size && "Buffer overflow!");
-        byte* buffer = new byte[size];
-        memcpy(buffer, (byte*)Data + offset, size);
-        return buffer;
+        assert(offset + size <= m_Size && "Buffer overflow!");
+        memcpy((byte*)m_Data + offset, data, size);
     }
 
-    void Write(const void* data, uint64_t size, uint64_t offset = 0) const
+    explicit operator bool() const
     {
-        assert(offset + size <= Size && "Buffer overflow!");
-        memcpy((byte*)Data + offset, data, size);
+        return m_Data;
     }
 
-    explicit operator bool() const
+    operator BufferView() const
     {
-        return Data;
+        return { m_Data, m_Size };
     }
 
     byte& operator[](int index)
     {
-        return ((byte*)Data)[index];
+        return ((byte*)m_Data)[index];
     }
 
     byte operator[](int index) const
     {
-        return ((byte*)Data)[index];
+        return ((byte*)m_Data)[index];
     }
 
     template<typename T>
     T* As() const
     {
-        return (T*)Data;
+        return (T*)m_Data;
     }
 
-    [[nodiscard]] inline uint64_t GetSize() const { return Size; }
-};
-
-struct BufferSafe : public Buffer
-{
-    ~BufferSafe()
-    {
-        Release();
-    }
+    [[nodiscard]] inline void* GetData() const { return m_Data; }
+    [[nodiscard]] inline uint64_t GetSize() const { return m_Size; }
+    [[nodiscard]] inline BufferAllocator& GetAllocator() const { return *m_Allocator; }
 
-    static BufferSafe Copy(const void* data, uint64_t size)
-    {
-        BufferSafe buffer;
-        buffer.Allocate(size);
-        memcpy(buffer.Data, data, size);
-        return buffer;
-    }
+private:
+    void* m_Data = nullptr;
+    uint64_t m_Size = 0;
+    BufferAllocator* m_Allocator = &HeapAllocator::Get();
 };
@@ -0,0 +1,236 @@
+#include "buffer_allocator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    uint64_t AlignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+AllocationStatistics BufferAllocator::GetStatistics() const
+{
+    AllocationStatistics statistics;
+    statistics.Allocations = m_Allocations.load(std::memory_order_relaxed);
+    statistics.Frees = m_Frees.load(std::memory_order_relaxed);
+    statistics.AllocatedBytes = m_AllocatedBytes.load(std::memory_order_relaxed);
+    statistics.LiveBytes = m_LiveBytes.load(std::memory_order_relaxed);
+    statistics.PeakLiveBytes = m_PeakLiveBytes.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+void BufferAllocator::CountAllocation(uint64_t size)
+{
+    m_Allocations.fetch_add(1, std::memory_order_relaxed);
+    m_AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    const uint64_t live = m_LiveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    uint64_t peak = m_PeakLiveBytes.load(std::memory_order_relaxed);
+    while (live > peak && !m_PeakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+}
+
+void BufferAllocator::CountFree(uint64_t size)
+{
+    m_Frees.fetch_add(1, std::memory_order_relaxed);
+    m_LiveBytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+HeapAllocator& HeapAllocator::Get()
+{
+    static HeapAllocator s_Instance;
+    return s_Instance;
+}
+
+void* HeapAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+    // One alignment for everything, so Free does not need to be told which one was used.
+    assert(alignment <= MaxAlignment && "Alignment exceeds BufferAllocator::MaxAlignment");
+    (void)alignment;
+    void* data = ::operator new(static_cast<size_t>(size), std::align_val_t{MaxAlignment});
+    CountAllocation(size);
+    return data;
+}
+
+void HeapAllocator::Free(void* data, uint64_t size)
+{
+    if (data == nullptr)
+        return;
+    ::operator delete(data, std::align_val_t{MaxAlignment});
+    CountFree(size);
+}
+
+MallocAllocator& MallocAllocator::Get()
+{
+    static MallocAllocator s_Instance;
+    return s_Instance;
+}
+
+void* MallocAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+    assert(alignment <= alignof(std::max_align_t) && "malloc only guarantees max_align_t alignment");
+    (void)alignment;
+    void* data = std::malloc(static_cast<size_t>(std::max<uint64_t>(size, 1)));
+    if (data == nullptr)
+        throw std::bad_alloc();
+    CountAllocation(size);
+    return data;
+}
+
+void MallocAllocator::Free(void* data, uint64_t size)
+{
+    if (data == nullptr)
+        return;
+    std::free(data);
+    CountFree(size);
+}
+
+LinearArena::LinearArena(const char* name, uint64_t blockSize)
+    : BufferAllocator(name), m_BlockSize(blockSize)
+{
+}
+
+LinearArena::~LinearArena()
+{
+    for (const Block& block : m_Blocks)
+        HeapAllocator::Get().Free(block.Data, block.Size);
+}
+
+void* LinearArena::Allocate(uint64_t size, uint64_t alignment)
+{
+    assert(alignment <= MaxAlignment && (alignment & (alignment - 1)) == 0 && "Alignment must be a power of two up to MaxAlignment");
+
+    // Live bytes follow GetUsedBytes, padding and skipped block tails included, so Reset and Rewind can
+    // give back exactly what they release.
+    const uint64_t usedBefore = GetUsedBytes();
+    while (m_CurrentBlock < m_Blocks.size())
+    {
+        const Block& block = m_Blocks[m_CurrentBlock];
+        const uint64_t offset = AlignUp(m_Offset, alignment);
+        if (offset + size <= block.Size)
+        {
+            m_Offset = offset + size;
+            CountAllocation(GetUsedBytes() - usedBefore);
+            return block.Data + offset;
+        }
+        // Move on to a retained block, or fall through to grow.
+        m_CurrentBlock++;
+        m_Offset = 0;
+    }
+
+    // Blocks start MaxAlignment-aligned, so an oversized request only needs its own size.
+    Block block;
+    block.Size = std::max(m_BlockSize, size);
+    block.Data = static_cast<uint8_t*>(HeapAllocator::Get().Allocate(block.Size, MaxAlignment));
+    m_Blocks.push_back(block);
+    m_CurrentBlock = m_Blocks.size() - 1;
+    m_Offset = size;
+    CountAllocation(GetUsedBytes() - usedBefore);
+    return block.Data;
+}
+
+void LinearArena::Free(void*, uint64_t)
+{
+    // Nothing comes back until Reset or Rewind, which count what they release.
+}
+
+void LinearArena::Reset()
+{
+    const uint64_t released = GetUsedBytes();
+    m_CurrentBlock = 0;
+    m_Offset = 0;
+    if (released > 0)
+        CountFree(released);
+}
+
+void LinearArena::Rewind(const Marker& marker)
+{
+    assert((marker.Block < m_CurrentBlock || (marker.Block == m_CurrentBlock && marker.Offset <= m_Offset)) && "Marker is ahead of the arena");
+    const uint64_t usedBefore = GetUsedBytes();
+    m_CurrentBlock = marker.Block;
+    m_Offset = marker.Offset;
+    if (usedBefore > GetUsedBytes())
+        CountFree(usedBefore - GetUsedBytes());
+}
+
+uint64_t LinearArena::GetCapacity() const
+{
+    uint64_t capacity = 0;
+    for (const Block& block : m_Blocks)
+        capacity += block.Size;
+    return capacity;
+}
+
+uint64_t LinearArena::GetUsedBytes() const
+{
+    uint64_t used = m_Offset;
+    for (size_t i = 0; i < m_CurrentBlock && i < m_Blocks.size(); i++)
+        used += m_Blocks[i].Size;
+    return used;
+}
+
+LinearArena& LinearArena::GetThreadScratch()
+{
+    // A larger request, such as a decoded mip chain, gets a block of its own that later loads reuse.
+    static thread_local LinearArena s_Scratch("Scratch", 4ull << 20);
+    return s_Scratch;
+}
+
+PoolAllocator::PoolAllocator(const char* name, uint64_t blockSize, uint32_t blocksPerChunk)
+    : BufferAllocator(name),
+      m_BlockSize(AlignUp(std::max<uint64_t>(blockSize, sizeof(FreeBlock)), alignof(std::max_align_t))),
+      m_BlocksPerChunk(std::max(1u, blocksPerChunk))
+{
+}
+
+PoolAllocator::~PoolAllocator()
+{
+    for (void* chunk : m_Chunks)
+        HeapAllocator::Get().Free(chunk, m_BlockSize * m_BlocksPerChunk);
+}
+
+void* PoolAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+    assert(size <= m_BlockSize && "Allocation exceeds the pool's block size");
+    assert(alignment <= alignof(std::max_align_t) && "Pool blocks are only max_align_t aligned");
+    (void)alignment;
+
+    std::lock_guard lock(m_Mutex);
+    if (m_FreeList == nullptr)
+    {
+        auto* chunk = static_cast<uint8_t*>(HeapAllocator::Get().Allocate(m_BlockSize * m_BlocksPerChunk, MaxAlignment));
+        m_Chunks.push_back(chunk);
+        // Thread the new blocks back to front so they are handed out in address order.
+        for (uint32_t i = m_BlocksPerChunk; i-- > 0;)
+        {
+            auto* block = reinterpret_cast<FreeBlock*>(chunk + i * m_BlockSize);
+            block->Next = m_FreeList;
+            m_FreeList = block;
+        }
+    }
+
+    FreeBlock* block = m_FreeList;
+    m_FreeList = block->Next;
+    CountAllocation(size);
+    return block;
+}
+
+void PoolAllocator::Free(void* data, uint64_t size)
+{
+    if (data == nullptr)
+        return;
+
+    std::lock_guard lock(m_Mutex);
+    auto* block = static_cast<FreeBlock*>(data);
+    block->Next = m_FreeList;
+    m_FreeList = block;
+    CountFree(size);
+}
+
+uint64_t PoolAllocator::GetBlockCount() const
+{
+    std::lock_guard lock(m_Mutex);
+    return static_cast<uint64_t>(m_Chunks.size()) * m_BlocksPerChunk;
+}
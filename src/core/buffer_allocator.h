@@ -0,0 +1,184 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+// Snapshot of an allocator's counters. Deltas across a frame show its heap traffic, which should be zero
+// once everything transient comes from an arena or a pool.
+struct AllocationStatistics
+{
+    uint64_t Allocations = 0;
+    uint64_t Frees = 0;
+    uint64_t AllocatedBytes = 0;
+    uint64_t LiveBytes = 0;
+    uint64_t PeakLiveBytes = 0;
+};
+
+// Where a Buffer's memory comes from and goes back to. Allocate never returns null; it throws
+// std::bad_alloc like operator new.
+class BufferAllocator
+{
+public:
+    static constexpr uint64_t MaxAlignment = 64;
+
+    explicit BufferAllocator(const char* name) : m_Name(name) {}
+    virtual ~BufferAllocator() = default;
+
+    BufferAllocator(const BufferAllocator&) = delete;
+    BufferAllocator& operator=(const BufferAllocator&) = delete;
+
+    virtual void* Allocate(uint64_t size, uint64_t alignment = alignof(std::max_align_t)) = 0;
+    virtual void Free(void* data, uint64_t size) = 0;
+
+    // Counts memory that was allocated from this allocator's source outside any Buffer and is now its to free.
+    void Adopt(uint64_t size) { CountAllocation(size); }
+
+    [[nodiscard]] const char* GetName() const { return m_Name; }
+    [[nodiscard]] AllocationStatistics GetStatistics() const;
+
+protected:
+    void CountAllocation(uint64_t size);
+    void CountFree(uint64_t size);
+
+private:
+    const char* m_Name;
+    std::atomic<uint64_t> m_Allocations{0};
+    std::atomic<uint64_t> m_Frees{0};
+    std::atomic<uint64_t> m_AllocatedBytes{0};
+    std::atomic<uint64_t> m_LiveBytes{0};
+    std::atomic<uint64_t> m_PeakLiveBytes{0};
+};
+
+// operator new with MaxAlignment. The default for Buffers that outlive any frame or load.
+class HeapAllocator final : public BufferAllocator
+{
+public:
+    static HeapAllocator& Get();
+
+    void* Allocate(uint64_t size, uint64_t alignment = alignof(std::max_align_t)) override;
+    void Free(void* data, uint64_t size) override;
+
+private:
+    HeapAllocator() : BufferAllocator("Heap") {}
+};
+
+// malloc/free, for memory C libraries hand over, e.g. stb_image's decoded pixels, so it can be adopted by a
+// Buffer without a copy.
+class MallocAllocator final : public BufferAllocator
+{
+public:
+    static MallocAllocator& Get();
+
+    void* Allocate(uint64_t size, uint64_t alignment = alignof(std::max_align_t)) override;
+    void Free(void* data, uint64_t size) override;
+
+private:
+    MallocAllocator() : BufferAllocator("Malloc") {}
+};
+
+// Bump allocation out of large blocks, released all at once by Reset or back to a Marker by Rewind.
+// Free does nothing. Blocks are kept across resets, so a warmed-up arena makes no heap calls at all.
+// Not thread safe: use one per thread, e.g. GetThreadScratch, or one owned by the thread that records frames.
+class LinearArena final : public BufferAllocator
+{
+public:
+    struct Marker
+    {
+        size_t Block = 0;
+        uint64_t Offset = 0;
+    };
+
+    explicit LinearArena(const char* name, uint64_t blockSize = 1 << 20);
+    ~LinearArena() override;
+
+    void* Allocate(uint64_t size, uint64_t alignment = alignof(std::max_align_t)) override;
+    // A no-op: memory is only released, and taken off the live byte count, by Reset and Rewind.
+    void Free(void* data, uint64_t size) override;
+
+    // Value-initialized; only for types that need no destructor, since the arena never runs one.
+    template<typename T>
+    T* AllocateArray(size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "Arena memory is released without running destructors");
+        T* data = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+        std::uninitialized_value_construct_n(data, count);
+        return data;
+    }
+
+    // Invalidates everything allocated from the arena.
+    void Reset();
+    [[nodiscard]] Marker GetMarker() const { return { m_CurrentBlock, m_Offset }; }
+    // Invalidates everything allocated since the marker was taken.
+    void Rewind(const Marker& marker);
+
+    [[nodiscard]] uint64_t GetCapacity() const;
+    // Bytes handed out since the last reset, including alignment padding.
+    [[nodiscard]] uint64_t GetUsedBytes() const;
+
+    // Per-thread arena for transient work such as decoding an asset; use through ScratchScope.
+    static LinearArena& GetThreadScratch();
+
+private:
+    struct Block
+    {
+        uint8_t* Data = nullptr;
+        uint64_t Size = 0;
+    };
+
+    uint64_t m_BlockSize;
+    std::vector<Block> m_Blocks;
+    size_t m_CurrentBlock = 0;
+    uint64_t m_Offset = 0;
+};
+
+// Rewinds the calling thread's scratch arena when it goes out of scope. Scopes nest.
+class ScratchScope
+{
+public:
+    ScratchScope() : m_Arena(LinearArena::GetThreadScratch()), m_Marker(m_Arena.GetMarker()) {}
+    ~ScratchScope() { m_Arena.Rewind(m_Marker); }
+
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+
+    [[nodiscard]] LinearArena& GetArena() { return m_Arena; }
+
+private:
+    LinearArena& m_Arena;
+    LinearArena::Marker m_Marker;
+};
+
+// Fixed-size blocks recycled through a free list, for many same-sized buffers that come and go, such as
+// streamed texture pages. Chunks are only returned to the heap on destruction. Thread safe.
+class PoolAllocator final : public BufferAllocator
+{
+public:
+    PoolAllocator(const char* name, uint64_t blockSize, uint32_t blocksPerChunk = 64);
+    ~PoolAllocator() override;
+
+    // size must not exceed the block size.
+    void* Allocate(uint64_t size, uint64_t alignment = alignof(std::max_align_t)) override;
+    void Free(void* data, uint64_t size) override;
+
+    [[nodiscard]] uint64_t GetBlockSize() const { return m_BlockSize; }
+    [[nodiscard]] uint64_t GetBlockCount() const;
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock* Next;
+    };
+
+    uint64_t m_BlockSize;
+    uint32_t m_BlocksPerChunk;
+
+    mutable std::mutex m_Mutex;
+    std::vector<void*> m_Chunks;
+    FreeBlock* m_FreeList = nullptr;
+};
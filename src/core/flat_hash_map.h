@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Open-addressing hash map with linear probing over one contiguous slot array, for hot build-once tables
+// such as vertex deduplication. Each slot has a one-byte tag holding the top bits of its hash, so most
+// probes that miss never compare keys. Entries cannot be erased. Reserve the expected entry count up front
+// to avoid rehashing; Key and Value must be default constructible.
+template<typename Key, typename Value, typename KeyHash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class FlatHashMap
+{
+public:
+    FlatHashMap() = default;
+    explicit FlatHashMap(size_t expectedCount) { Reserve(expectedCount); }
+
+    // Sizes the table so expectedCount entries fit under the maximum load factor.
+    void Reserve(size_t expectedCount)
+    {
+        size_t capacity = MinCapacity;
+        while (capacity * MaxLoadNumerator < expectedCount * MaxLoadDenominator)
+            capacity *= 2;
+        if (capacity > m_Tags.size())
+            Rehash(capacity);
+    }
+
+    // Inserts the entry unless the key is present. Returns the key's value and whether it was inserted.
+    std::pair<Value*, bool> TryEmplace(const Key& key, const Value& value)
+    {
+        if ((m_Size + 1) * MaxLoadDenominator > m_Tags.size() * MaxLoadNumerator)
+            Rehash(m_Tags.empty() ? MinCapacity : m_Tags.size() * 2);
+
+        const size_t hash = KeyHash{}(key);
+        const uint8_t tag = GetTag(hash);
+        for (size_t slot = hash & m_Mask;; slot = (slot + 1) & m_Mask)
+        {
+            if (m_Tags[slot] == EmptyTag)
+            {
+                m_Tags[slot] = tag;
+                m_Slots[slot] = { key, value };
+                m_Size++;
+                return { &m_Slots[slot].second, true };
+            }
+            if (m_Tags[slot] == tag && KeyEqual{}(m_Slots[slot].first, key))
+                return { &m_Slots[slot].second, false };
+        }
+    }
+
+    [[nodiscard]] const Value* Find(const Key& key) const
+    {
+        if (m_Size == 0)
+            return nullptr;
+
+        const size_t hash = KeyHash{}(key);
+        const uint8_t tag = GetTag(hash);
+        for (size_t slot = hash & m_Mask; m_Tags[slot] != EmptyTag; slot = (slot + 1) & m_Mask)
+        {
+            if (m_Tags[slot] == tag && KeyEqual{}(m_Slots[slot].first, key))
+                return &m_Slots[slot].second;
+        }
+        return nullptr;
+    }
+
+    [[nodiscard]] Value* Find(const Key& key) { return const_cast<Value*>(std::as_const(*this).Find(key)); }
+
+    // Keeps the capacity.
+    void Clear()
+    {
+        std::fill(m_Tags.begin(), m_Tags.end(), EmptyTag);
+        m_Size = 0;
+    }
+
+    [[nodiscard]] size_t Size() const { return m_Size; }
+    [[nodiscard]] size_t Capacity() const { return m_Tags.size(); }
+
+    // Mean slots visited to find a present key; 1 is perfect. For benchmarking hash quality.
+    [[nodiscard]] double GetAverageProbeLength() const
+    {
+        if (m_Size == 0)
+            return 0.0;
+
+        size_t totalProbes = 0;
+        for (size_t slot = 0; slot < m_Tags.size(); slot++)
+        {
+            if (m_Tags[slot] != EmptyTag)
+                totalProbes += ((slot - (KeyHash{}(m_Slots[slot].first) & m_Mask)) & m_Mask) + 1;
+        }
+        return static_cast<double>(totalProbes) / static_cast<double>(m_Size);
+    }
+
+private:
+    static constexpr uint8_t EmptyTag = 0;
+    static constexpr size_t MinCapacity = 16;
+    // Linear probing degrades quickly past this.
+    static constexpr size_t MaxLoadNumerator = 3;
+    static constexpr size_t MaxLoadDenominator = 4;
+
+    static uint8_t GetTag(size_t hash)
+    {
+        // Slots are picked with the low bits; tag with the high ones. The top bit keeps tags non-empty.
+        return static_cast<uint8_t>(0x80 | (static_cast<uint64_t>(hash) >> 57));
+    }
+
+    void Rehash(size_t capacity)
+    {
+        assert((capacity & (capacity - 1)) == 0 && "Capacity must be a power of two");
+
+        std::vector<uint8_t> oldTags = std::move(m_Tags);
+        std::vector<std::pair<Key, Value>> oldSlots = std::move(m_Slots);
+        m_Tags.assign(capacity, EmptyTag);
+        m_Slots.assign(capacity, {});
+        m_Mask = capacity - 1;
+
+        for (size_t slot = 0; slot < oldTags.size(); slot++)
+        {
+            if (oldTags[slot] == EmptyTag)
+                continue;
+
+            size_t target = KeyHash{}(oldSlots[slot].first) & m_Mask;
+            while (m_Tags[target] != EmptyTag)
+                target = (target + 1) & m_Mask;
+            m_Tags[target] = oldTags[slot];
+            m_Slots[target] = std::move(oldSlots[slot]);
+        }
+    }
+
+private:
+    std::vector<uint8_t> m_Tags;
+    std::vector<std::pair<Key, Value>> m_Slots;
+    size_t m_Size = 0;
+    size_t m_Mask = 0;
+};
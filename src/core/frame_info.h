@@ -11,5 +11,16 @@ struct GlobalUbo
     glm::mat4 InvView{1.0f};
     glm::mat4 InvProjection{1.0f};
     glm::vec4 CameraPosition{0.0f};
-    glm::ivec4 ScreenResolution_NumRaysPerPixel_FrameNumber{-1};
-};
\ No newline at end of file
+    glm::ivec4 ScreenResolution{-1};
+};
+
+// Small values that change every frame. Pushed once per command buffer instead of rewriting the GlobalUbo.
+struct FramePushConstants
+{
+    uint32_t FrameNumber = 0;
+    uint32_t AccumulationIndex = 0;     // Frames accumulated since the camera last moved
+    uint32_t SampleCount = 1;
+    uint32_t TransformIndex = 0;
+    uint32_t MaxBounceCount = 4;
+    uint32_t NextEventEstimation = 1;   // Sample the emitter table at diffuse hits, combined with the bounce by MIS
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+// Bytewise hashing in the style of wyhash: input is read 8 bytes at a time and folded with 64x64->128-bit
+// multiplies, so a short fixed-size key such as a vertex hashes in a handful of instructions and every
+// input bit reaches every output bit.
+namespace Hash
+{
+    inline void Multiply128(uint64_t& a, uint64_t& b)
+    {
+#if defined(__SIZEOF_INT128__)
+        const __uint128_t product = static_cast<__uint128_t>(a) * b;
+        a = static_cast<uint64_t>(product);
+        b = static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        a = _umul128(a, b, &b);
+#else
+        const uint64_t aHigh = a >> 32, aLow = static_cast<uint32_t>(a);
+        const uint64_t bHigh = b >> 32, bLow = static_cast<uint32_t>(b);
+        const uint64_t highHigh = aHigh * bHigh, highLow = aHigh * bLow, lowHigh = aLow * bHigh, lowLow = aLow * bLow;
+        const uint64_t middle = (lowLow >> 32) + static_cast<uint32_t>(highLow) + static_cast<uint32_t>(lowHigh);
+        a = (middle << 32) | static_cast<uint32_t>(lowLow);
+        b = highHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+#endif
+    }
+
+    inline uint64_t Mix(uint64_t a, uint64_t b)
+    {
+        Multiply128(a, b);
+        return a ^ b;
+    }
+
+    inline uint64_t Read64(const uint8_t* bytes)
+    {
+        uint64_t value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+
+    inline uint64_t Read32(const uint8_t* bytes)
+    {
+        uint32_t value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+
+    inline constexpr uint64_t Secret[4] = { 0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull };
+
+    inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        seed ^= Mix(seed ^ Secret[0], Secret[1]);
+
+        uint64_t a, b;
+        if (size <= 16)
+        {
+            if (size >= 4)
+            {
+                const size_t quarter = (size >> 3) << 2;
+                a = (Read32(bytes) << 32) | Read32(bytes + quarter);
+                b = (Read32(bytes + size - 4) << 32) | Read32(bytes + size - 4 - quarter);
+            }
+            else if (size > 0)
+            {
+                a = (static_cast<uint64_t>(bytes[0]) << 16) | (static_cast<uint64_t>(bytes[size >> 1]) << 8) | bytes[size - 1];
+                b = 0;
+            }
+            else
+            {
+                a = b = 0;
+            }
+        }
+        else
+        {
+            size_t remaining = size;
+            if (remaining > 48)
+            {
+                // Three independent lanes keep the multipliers busy on long inputs.
+                uint64_t seed1 = seed, seed2 = seed;
+                do
+                {
+                    seed = Mix(Read64(bytes) ^ Secret[1], Read64(bytes + 8) ^ seed);
+                    seed1 = Mix(Read64(bytes + 16) ^ Secret[2], Read64(bytes + 24) ^ seed1);
+                    seed2 = Mix(Read64(bytes + 32) ^ Secret[3], Read64(bytes + 40) ^ seed2);
+                    bytes += 48;
+                    remaining -= 48;
+                } while (remaining > 48);
+                seed ^= seed1 ^ seed2;
+            }
+            while (remaining > 16)
+            {
+                seed = Mix(Read64(bytes) ^ Secret[1], Read64(bytes + 8) ^ seed);
+                bytes += 16;
+                remaining -= 16;
+            }
+            // The last 16 bytes, overlapping what was already consumed when fewer remain.
+            a = Read64(bytes + remaining - 16);
+            b = Read64(bytes + remaining - 8);
+        }
+
+        a ^= Secret[1];
+        b ^= seed;
+        Multiply128(a, b);
+        return Mix(a ^ Secret[0] ^ size, b ^ Secret[1]);
+    }
+}
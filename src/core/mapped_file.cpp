@@ -0,0 +1,149 @@
+#include "mapped_file.h"
+
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+MappedFile::MappedFile(const std::string& filepath, AccessPattern accessPattern)
+{
+#if defined(_WIN32)
+    const DWORD flags = accessPattern == AccessPattern::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+    HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("failed to open file: " + filepath);
+
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        CloseHandle(file);
+        throw std::runtime_error("failed to query file size: " + filepath);
+    }
+    m_Size = static_cast<size_t>(fileSize.QuadPart);
+    if (m_Size == 0)
+    {
+        CloseHandle(file);
+        m_IsEmptyFile = true;
+        return;
+    }
+
+    // The view keeps the mapping alive, so neither handle is needed past this point.
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr)
+        throw std::runtime_error("failed to map file: " + filepath);
+
+    m_Data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    CloseHandle(mapping);
+    if (m_Data == nullptr)
+        throw std::runtime_error("failed to map file: " + filepath);
+#elif defined(__unix__) || defined(__APPLE__)
+    const int file = open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0)
+        throw std::runtime_error("failed to open file: " + filepath);
+
+    struct stat status{};
+    if (fstat(file, &status) != 0)
+    {
+        close(file);
+        throw std::runtime_error("failed to query file size: " + filepath);
+    }
+    m_Size = static_cast<size_t>(status.st_size);
+    if (m_Size == 0)
+    {
+        close(file);
+        m_IsEmptyFile = true;
+        return;
+    }
+
+    // The mapping holds its own reference to the file.
+    void* mapping = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (mapping == MAP_FAILED)
+        throw std::runtime_error("failed to map file: " + filepath);
+    m_Data = static_cast<const uint8_t*>(mapping);
+
+    // Hints only; a kernel that ignores them still serves the pages on fault.
+    if (accessPattern == AccessPattern::Sequential)
+    {
+        madvise(mapping, m_Size, MADV_SEQUENTIAL);
+        madvise(mapping, m_Size, MADV_WILLNEED);
+    }
+    else
+    {
+        madvise(mapping, m_Size, MADV_RANDOM);
+    }
+#else
+    (void)accessPattern;
+    std::ifstream file{filepath, std::ios::ate | std::ios::binary};
+    if (!file.is_open())
+        throw std::runtime_error("failed to open file: " + filepath);
+
+    m_Fallback.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(m_Fallback.data()), static_cast<std::streamsize>(m_Fallback.size()));
+    if (!file)
+        throw std::runtime_error("failed to read file: " + filepath);
+
+    m_Data = m_Fallback.data();
+    m_Size = m_Fallback.size();
+    m_IsEmptyFile = m_Size == 0;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    Unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+    Unmap();
+    m_Data = std::exchange(other.m_Data, nullptr);
+    m_Size = std::exchange(other.m_Size, 0);
+    m_IsEmptyFile = std::exchange(other.m_IsEmptyFile, false);
+#if !defined(_WIN32) && !defined(__unix__) && !defined(__APPLE__)
+    // Moving a vector keeps its storage, so m_Data stays valid.
+    m_Fallback = std::move(other.m_Fallback);
+#endif
+    return *this;
+}
+
+void MappedFile::Unmap()
+{
+#if defined(_WIN32)
+    if (m_Data != nullptr)
+        UnmapViewOfFile(m_Data);
+#elif defined(__unix__) || defined(__APPLE__)
+    if (m_Data != nullptr)
+        munmap(const_cast<uint8_t*>(m_Data), m_Size);
+#else
+    m_Fallback.clear();
+#endif
+    m_Data = nullptr;
+    m_Size = 0;
+    m_IsEmptyFile = false;
+}
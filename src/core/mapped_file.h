@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Read-only view of a whole file mapped into memory, so shader modules and asset payloads can be consumed
+// straight from the page cache instead of being copied into a heap buffer first. The mapping is released
+// when the object is destroyed; spans taken from it must not outlive it.
+class MappedFile
+{
+public:
+    enum class AccessPattern
+    {
+        // Read front to back once: aggressive readahead, pages dropped behind the reader.
+        Sequential,
+        // Read in scattered pieces, e.g. tiles of a virtual texture: no readahead.
+        Random,
+    };
+
+    MappedFile() = default;
+    // Throws std::runtime_error if the file cannot be opened or mapped.
+    explicit MappedFile(const std::string& filepath, AccessPattern accessPattern = AccessPattern::Sequential);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Page aligned, so SPIR-V and other word-aligned formats can be read in place.
+    [[nodiscard]] const uint8_t* GetData() const { return m_Data; }
+    [[nodiscard]] size_t GetSize() const { return m_Size; }
+    [[nodiscard]] std::span<const uint8_t> GetSpan() const { return { m_Data, m_Size }; }
+    [[nodiscard]] bool IsOpen() const { return m_Data != nullptr || m_IsEmptyFile; }
+
+private:
+    void Unmap();
+
+private:
+    const uint8_t* m_Data = nullptr;
+    size_t m_Size = 0;
+    // An empty file maps to nothing but is still a successfully opened file.
+    bool m_IsEmptyFile = false;
+#if !defined(_WIN32) && !defined(__unix__) && !defined(__APPLE__)
+    // Platforms without a mapping API read the file into memory instead.
+    std::vector<uint8_t> m_Fallback;
+#endif
+};
@@ -0,0 +1,210 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+
+thread_local uint32_t Profiler::s_Depth = 0;
+
+namespace
+{
+    struct Zone
+    {
+        std::atomic<const char*> Name{nullptr};
+        std::atomic<uint64_t> StartTicks{0};
+        std::atomic<uint64_t> EndTicks{0};
+        std::atomic<uint32_t> Depth{0};
+    };
+
+    // Written only by its thread. Outlives the thread so its zones can still be exported.
+    struct ThreadZones
+    {
+        uint32_t Index = 0;
+        std::atomic<const char*> Name{nullptr};
+        // Started is bumped before a slot is rewritten and Written after, so readers can tell which slots
+        // changed under them.
+        std::atomic<uint64_t> Started{0};
+        std::atomic<uint64_t> Written{0};
+        std::array<Zone, Profiler::ZonesPerThread> Zones;
+    };
+
+    struct Registry
+    {
+        std::mutex Mutex;
+        std::vector<std::unique_ptr<ThreadZones>> Threads;
+    };
+
+    Registry& GetRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    ThreadZones& GetThreadZones()
+    {
+        thread_local ThreadZones* zones = nullptr;
+        if (zones)
+            return *zones;
+
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.Mutex);
+        registry.Threads.push_back(std::make_unique<ThreadZones>());
+        zones = registry.Threads.back().get();
+        zones->Index = static_cast<uint32_t>(registry.Threads.size() - 1);
+        return *zones;
+    }
+
+    int64_t SteadyNanoseconds()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Tick and steady_clock readings taken together at startup; a second pair at export gives the tick rate.
+    struct ClockReference
+    {
+        uint64_t Ticks = Profiler::Now();
+        int64_t Nanoseconds = SteadyNanoseconds();
+    };
+    const ClockReference s_StartReference;
+
+    class TickConverter
+    {
+    public:
+        TickConverter()
+        {
+#if defined(__x86_64__) || defined(_M_X64)
+            ClockReference now;
+            const uint64_t elapsedTicks = now.Ticks - s_StartReference.Ticks;
+            if (elapsedTicks > 0)
+                m_NanosecondsPerTick = static_cast<double>(now.Nanoseconds - s_StartReference.Nanoseconds) / static_cast<double>(elapsedTicks);
+#endif
+        }
+
+        [[nodiscard]] int64_t ToNanoseconds(uint64_t ticks) const
+        {
+#if defined(__x86_64__) || defined(_M_X64)
+            const double elapsedTicks = static_cast<double>(static_cast<int64_t>(ticks - s_StartReference.Ticks));
+            return s_StartReference.Nanoseconds + static_cast<int64_t>(elapsedTicks * m_NanosecondsPerTick);
+#else
+            return static_cast<int64_t>(ticks);
+#endif
+        }
+
+    private:
+        double m_NanosecondsPerTick = 1.0;
+    };
+}
+
+void Profiler::RecordZone(const char* name, uint64_t startTicks, uint64_t endTicks, uint32_t depth)
+{
+    ThreadZones& zones = GetThreadZones();
+    const uint64_t index = zones.Written.load(std::memory_order_relaxed);
+    zones.Started.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Zone& zone = zones.Zones[index % ZonesPerThread];
+    zone.Name.store(name, std::memory_order_relaxed);
+    zone.StartTicks.store(startTicks, std::memory_order_relaxed);
+    zone.EndTicks.store(endTicks, std::memory_order_relaxed);
+    zone.Depth.store(depth, std::memory_order_relaxed);
+    zones.Written.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+    GetThreadZones().Name.store(name, std::memory_order_relaxed);
+}
+
+std::vector<ProfilerZoneEvent> Profiler::CollectZones()
+{
+    const TickConverter converter;
+    std::vector<ProfilerZoneEvent> events;
+
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.Mutex);
+    for (const std::unique_ptr<ThreadZones>& thread : registry.Threads)
+    {
+        const uint64_t written = thread->Written.load(std::memory_order_acquire);
+        const uint64_t first = written > ZonesPerThread ? written - ZonesPerThread : 0;
+        const size_t threadBegin = events.size();
+
+        for (uint64_t i = first; i < written; i++)
+        {
+            const Zone& zone = thread->Zones[i % ZonesPerThread];
+            const uint64_t startTicks = zone.StartTicks.load(std::memory_order_relaxed);
+            const uint64_t endTicks = zone.EndTicks.load(std::memory_order_relaxed);
+
+            ProfilerZoneEvent event{};
+            event.Name = zone.Name.load(std::memory_order_relaxed);
+            event.ThreadIndex = thread->Index;
+            event.Depth = zone.Depth.load(std::memory_order_relaxed);
+            event.StartNanoseconds = converter.ToNanoseconds(startTicks);
+            event.DurationNanoseconds = converter.ToNanoseconds(endTicks) - event.StartNanoseconds;
+            events.push_back(event);
+        }
+
+        // The thread kept recording during the copy; drop the slots it may have started overwriting meanwhile.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t started = thread->Started.load(std::memory_order_relaxed);
+        const uint64_t overwritten = started > first + ZonesPerThread ? started - first - ZonesPerThread : 0;
+        const size_t dropCount = static_cast<size_t>(std::min<uint64_t>(overwritten, written - first));
+        events.erase(events.begin() + static_cast<std::ptrdiff_t>(threadBegin),
+                     events.begin() + static_cast<std::ptrdiff_t>(threadBegin + dropCount));
+    }
+    return events;
+}
+
+std::vector<std::string> Profiler::GetThreadNames()
+{
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.Mutex);
+
+    std::vector<std::string> names;
+    names.reserve(registry.Threads.size());
+    for (const std::unique_ptr<ThreadZones>& thread : registry.Threads)
+    {
+        const char* name = thread->Name.load(std::memory_order_relaxed);
+        names.push_back(name ? name : "Thread " + std::to_string(thread->Index));
+    }
+    return names;
+}
+
+void Profiler::WriteChromeTrace(std::ostream& out)
+{
+    const std::vector<ProfilerZoneEvent> zones = CollectZones();
+    int64_t origin = 0;
+    if (!zones.empty())
+    {
+        origin = std::min_element(zones.begin(), zones.end(), [](const ProfilerZoneEvent& a, const ProfilerZoneEvent& b)
+        {
+            return a.StartNanoseconds < b.StartNanoseconds;
+        })->StartNanoseconds;
+    }
+
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    WriteChromeTraceEvents(out, zones, origin);
+    out << "\n]}\n";
+}
+
+void Profiler::WriteChromeTraceEvents(std::ostream& out, const std::vector<ProfilerZoneEvent>& zones, int64_t originNanoseconds)
+{
+    const std::vector<std::string> threadNames = GetThreadNames();
+
+    out << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 0, \"args\": {\"name\": \"CPU\"}}";
+    for (size_t i = 0; i < threadNames.size(); i++)
+    {
+        out << ",\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": " << i
+            << ", \"args\": {\"name\": \"" << threadNames[i] << "\"}}";
+    }
+
+    out << std::fixed << std::setprecision(3);
+    for (const ProfilerZoneEvent& zone : zones)
+    {
+        out << ",\n  {\"name\": \"" << zone.Name << "\", \"cat\": \"cpu\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << zone.ThreadIndex
+            << ", \"ts\": " << static_cast<double>(zone.StartNanoseconds - originNanoseconds) * 1e-3
+            << ", \"dur\": " << static_cast<double>(zone.DurationNanoseconds) * 1e-3 << "}";
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#include <chrono>
+#endif
+
+// Zones compile to nothing when RE_COO_CPU_PROFILER is 0 (CMake option of the same name).
+#ifndef RE_COO_CPU_PROFILER
+#define RE_COO_CPU_PROFILER 1
+#endif
+
+#define RE_COO_PROFILER_CONCAT_INNER(a, b) a##b
+#define RE_COO_PROFILER_CONCAT(a, b) RE_COO_PROFILER_CONCAT_INNER(a, b)
+
+#if RE_COO_CPU_PROFILER
+// Times the rest of the enclosing block. The name must outlive the program, e.g. a string literal.
+#define PROFILE_ZONE(name) ProfilerZone RE_COO_PROFILER_CONCAT(profilerZone, __LINE__)(name)
+#define PROFILE_THREAD_NAME(name) Profiler::SetThreadName(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_THREAD_NAME(name) ((void)0)
+#endif
+
+// A finished zone, in steady_clock nanoseconds.
+struct ProfilerZoneEvent
+{
+    const char* Name;
+    uint32_t ThreadIndex;
+    uint32_t Depth;
+    int64_t StartNanoseconds;
+    int64_t DurationNanoseconds;
+};
+
+// CPU zone profiler. Every thread records into its own ring of the last ZonesPerThread zones: recording is a
+// few relaxed stores and one release store, with no locks or allocation after the thread's first zone.
+// Readers copy the rings while threads keep recording and drop whatever was overwritten during the copy.
+// Ticks come from rdtsc on x86-64, which assumes an invariant TSC, and from steady_clock elsewhere; both are
+// reported in steady_clock nanoseconds so zones line up with other clocks calibrated against it.
+class Profiler
+{
+public:
+    static constexpr uint32_t ZonesPerThread = 1 << 14;
+
+    static uint64_t Now()
+    {
+#if defined(__x86_64__) || defined(_M_X64)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    static void RecordZone(const char* name, uint64_t startTicks, uint64_t endTicks, uint32_t depth);
+    static void SetThreadName(const char* name);
+
+    // Every thread's zones still in its ring, oldest first per thread.
+    static std::vector<ProfilerZoneEvent> CollectZones();
+    // Indexed by ProfilerZoneEvent::ThreadIndex.
+    static std::vector<std::string> GetThreadNames();
+
+    // Chrome trace event format; load it in chrome://tracing or Perfetto.
+    static void WriteChromeTrace(std::ostream& out);
+    // Writes the CPU process metadata and the zones as comma-separated trace events, without a trailing
+    // comma, with timestamps relative to originNanoseconds. For merging other timelines into one trace.
+    static void WriteChromeTraceEvents(std::ostream& out, const std::vector<ProfilerZoneEvent>& zones, int64_t originNanoseconds);
+
+    static thread_local uint32_t s_Depth;
+};
+
+// RAII zone; prefer the PROFILE_ZONE macro, which compiles out with the profiler.
+class ProfilerZone
+{
+public:
+    explicit ProfilerZone(const char* name)
+        : m_Name(name), m_Depth(Profiler::s_Depth++), m_StartTicks(Profiler::Now()) {}
+
+    ~ProfilerZone()
+    {
+        Profiler::RecordZone(m_Name, m_StartTicks, Profiler::Now(), m_Depth);
+        Profiler::s_Depth--;
+    }
+
+    ProfilerZone(const ProfilerZone&) = delete;
+    ProfilerZone& operator=(const ProfilerZone&) = delete;
+
+private:
+    const char* m_Name;
+    uint32_t m_Depth;
+    uint64_t m_StartTicks;
+};
@@ -0,0 +1,109 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cassert>
+
+uint32_t ThreadPool::GetDefaultWorkerCount()
+{
+    uint32_t hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+}
+
+ThreadPool::ThreadPool(uint32_t workerCount)
+{
+    assert(workerCount > 0 && "ThreadPool needs at least one worker.");
+
+    m_Workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; i++)
+        m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_JobAvailable.notify_all();
+
+    for (std::thread& worker : m_Workers)
+        worker.join();
+}
+
+void ThreadPool::Submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        assert(!m_Stopping && "Job submitted to a ThreadPool that is shutting down.");
+        m_Jobs.push_back(std::move(job));
+    }
+    m_JobAvailable.notify_one();
+}
+
+void ThreadPool::ParallelFor(uint32_t count, const std::function<void(uint32_t, uint32_t)>& fn)
+{
+    if (count == 0)
+        return;
+
+    // The calling thread takes the first range itself, so it must not be one of this pool's workers.
+    uint32_t rangeCount = std::min(count, GetWorkerCount() + 1);
+    uint32_t rangeSize = (count + rangeCount - 1) / rangeCount;
+    rangeCount = (count + rangeSize - 1) / rangeSize;
+
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+    uint32_t remaining = rangeCount - 1;
+
+    for (uint32_t range = 1; range < rangeCount; range++)
+    {
+        uint32_t begin = range * rangeSize;
+        uint32_t end = std::min(begin + rangeSize, count);
+        Submit([&, begin, end]()
+        {
+            fn(begin, end);
+
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (--remaining == 0)
+                doneCondition.notify_one();
+        });
+    }
+
+    fn(0, std::min(rangeSize, count));
+
+    std::unique_lock<std::mutex> lock(doneMutex);
+    doneCondition.wait(lock, [&]() { return remaining == 0; });
+}
+
+void ThreadPool::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Idle.wait(lock, [this]() { return m_Jobs.empty() && m_ActiveJobs == 0; });
+}
+
+void ThreadPool::WorkerLoop()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_JobAvailable.wait(lock, [this]() { return m_Stopping || !m_Jobs.empty(); });
+
+            if (m_Jobs.empty())
+                return;
+
+            job = std::move(m_Jobs.front());
+            m_Jobs.pop_front();
+            m_ActiveJobs++;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_ActiveJobs--;
+            if (m_Jobs.empty() && m_ActiveJobs == 0)
+                m_Idle.notify_all();
+        }
+    }
+}
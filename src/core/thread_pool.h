@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads pulling jobs from a shared FIFO queue.
+class ThreadPool
+{
+public:
+    // Leaves one core to the thread that feeds the pool.
+    static uint32_t GetDefaultWorkerCount();
+
+    explicit ThreadPool(uint32_t workerCount = GetDefaultWorkerCount());
+    // Finishes every queued job before joining the workers.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Submit(std::function<void()> job);
+
+    // Splits [0, count) into contiguous ranges, runs fn(begin, end) for each on the workers and blocks until all are done.
+    void ParallelFor(uint32_t count, const std::function<void(uint32_t, uint32_t)>& fn);
+
+    // Blocks until the queue is empty and no job is running.
+    void WaitIdle();
+
+    [[nodiscard]] uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_Workers.size()); }
+
+private:
+    void WorkerLoop();
+
+private:
+    std::vector<std::thread> m_Workers;
+    std::deque<std::function<void()>> m_Jobs;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_JobAvailable;
+    std::condition_variable m_Idle;
+    uint32_t m_ActiveJobs = 0;
+    bool m_Stopping = false;
+};
@@ -4,8 +4,8 @@
 #include <utility>
 #include <stdexcept>
 
-Window::Window(int width, int height, std::string name)
-    :m_Width(width), m_Height(height), m_WindowName(std::move(name))
+Window::Window(int width, int height, std::string name, bool visible)
+    :m_Visible(visible), m_Width(width), m_Height(height), m_WindowName(std::move(name))
 {
     InitializeWindow();
 }
@@ -21,6 +21,7 @@ void Window::InitializeWindow()
     glfwInit();
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
     glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, m_Visible ? GLFW_TRUE : GLFW_FALSE);
 
     m_WindowHandle = glfwCreateWindow(m_Width, m_Height, m_WindowName.c_str(), nullptr, nullptr);
     glfwSetWindowUserPointer(m_WindowHandle, this);
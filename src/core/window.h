@@ -8,7 +8,8 @@
 class Window
 {
 public:
-    Window(int width, int height, std::string name);
+    // A hidden window still backs a swapchain, for runs that need no interaction.
+    Window(int width, int height, std::string name, bool visible = true);
     ~Window();
 
     Window(const Window&) = delete;
@@ -33,6 +34,7 @@ private:
     void InitializeWindow();
 
     bool m_FramebufferResized = false;
+    bool m_Visible;
     int m_Width;
     int m_Height;
 
@@ -1,15 +1,23 @@
 #include <iostream>
 #include <cstdlib>
+#include <cstring>
 
 #include "core/application.h"
 
-int main()
+int main(int argc, char** argv)
 {
     Application app;
+    const bool compareTracers = argc > 1 && std::strcmp(argv[1], "--compare-tracers") == 0;
+    const bool profile = argc > 2 && std::strcmp(argv[1], "--profile") == 0;
 
     try
     {
-        app.Run();
+        if (compareTracers)
+            app.RunTracerComparison();
+        else if (profile)
+            app.Run(argv[2]);
+        else
+            app.Run();
     }
     catch(const std::exception& e)
     {
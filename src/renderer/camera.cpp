@@ -73,6 +73,14 @@ void Camera::UpdateView()
     m_InvViewMatrix[3][2] = eye.z;
 }
 
+void Camera::SetOrbit(const glm::vec2& angles, float zoom)
+{
+    m_CurrentInputState.Angles = angles;
+    m_CurrentInputState.Zoom = zoom;
+    m_DragState.Velocity = glm::vec2(0.0f);
+    UpdateView();
+}
+
 void Camera::OnScroll(double/* xoffset*/, double yoffset)
 {
     m_CurrentInputState.Zoom += DragState::ScrollSensitivity * static_cast<float>(yoffset);
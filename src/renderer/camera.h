@@ -39,6 +39,8 @@ public:
     void SetOrthographicProjection(float left, float right, float top, float bottom, float near, float far);
     void SetPerspectiveProjection(float fovy, float aspect, float near, float far);
     void UpdateView();
+    // Places the camera on its orbit directly, e.g. for scripted camera paths. See InputState.
+    void SetOrbit(const glm::vec2& angles, float zoom);
 
     [[nodiscard]] const glm::mat4& GetProjection() const { return m_ProjectionMatrix; }
     [[nodiscard]] const glm::mat4& GetView() const { return m_ViewMatrix; }
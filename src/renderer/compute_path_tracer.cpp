@@ -0,0 +1,260 @@
+#include "compute_path_tracer.h"
+#include "renderer/vulkan/vulkan_swapchain.h"
+#include "renderer/vulkan/vulkan_utils.h"
+
+#include <array>
+#include <cassert>
+#include <string>
+
+ComputePathTracer::ComputePathTracer(
+        VulkanDevice& deviceRef,
+        VulkanDescriptorSetLayout& globalSetLayout,
+        VulkanBindlessTable& bindlessTableRef,
+        SamplerType sampler)
+    : m_DeviceRef(deviceRef),
+      m_BindlessTableRef(bindlessTableRef),
+      m_Sampler(sampler),
+      m_PushConstants(deviceRef, VK_SHADER_STAGE_COMPUTE_BIT)
+{
+    m_SphereBufferInfos.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
+    CreateStatisticsBuffers();
+    CreateDescriptors();
+    CreatePipeline(globalSetLayout);
+    AllocateCommandBuffers();
+}
+
+ComputePathTracer::~ComputePathTracer()
+{
+    vkFreeCommandBuffers(
+            m_DeviceRef.GetDevice(),
+            m_DeviceRef.GetComputeCommandPool(),
+            static_cast<uint32_t>(m_CommandBuffers.size()),
+            m_CommandBuffers.data());
+    vkDestroyPipelineLayout(m_DeviceRef.GetDevice(), m_PipelineLayout, nullptr);
+}
+
+void ComputePathTracer::CreateStatisticsBuffers()
+{
+    m_StatisticsBuffers.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
+    for (auto& buffer : m_StatisticsBuffers)
+    {
+        buffer = std::make_unique<VulkanBuffer>(
+                m_DeviceRef,
+                sizeof(uint32_t),
+                1,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        buffer->Map();
+    }
+}
+
+void ComputePathTracer::CreateDescriptors()
+{
+    m_DescriptorSetLayout = VulkanDescriptorSetLayout::Builder(m_DeviceRef)
+            // Binding 0: SS BO for Spheres
+            .AddBinding(
+                    0,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_SHADER_STAGE_COMPUTE_BIT)
+            // Binding 1: Accumulation storage image
+            .AddBinding(
+                    1,
+                    VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                    VK_SHADER_STAGE_COMPUTE_BIT)
+            // Binding 2: Ray counter read back by the host
+            .AddBinding(
+                    2,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_SHADER_STAGE_COMPUTE_BIT)
+            // Binding 3: This frame's display image
+            .AddBinding(
+                    3,
+                    VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                    VK_SHADER_STAGE_COMPUTE_BIT)
+            .Build();
+
+    m_DescriptorPool = VulkanDescriptorPool::Builder(m_DeviceRef)
+            .SetMaxSets(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT)
+            .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VulkanSwapchain::MAX_FRAMES_IN_FLIGHT * 2)
+            .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VulkanSwapchain::MAX_FRAMES_IN_FLIGHT * 2)
+            .Build();
+
+    m_DescriptorSets.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+}
+
+void ComputePathTracer::CreatePipeline(VulkanDescriptorSetLayout& globalSetLayout)
+{
+    const std::vector<VkDescriptorSetLayout> descriptorSetLayouts
+    {
+        globalSetLayout.GetDescriptorSetLayout(),
+        m_DescriptorSetLayout->GetDescriptorSetLayout(),
+        m_BindlessTableRef.GetDescriptorSetLayout().GetDescriptorSetLayout()
+    };
+
+    VkPushConstantRange pushConstantRange = m_PushConstants.GetRange();
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    VK_CHECK_RESULT(vkCreatePipelineLayout(m_DeviceRef.GetDevice(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout));
+
+    // Specialization constant 0 selects the sampler.
+    const std::array<uint32_t, 1> specializationConstants{ static_cast<uint32_t>(m_Sampler) };
+    m_Pipeline = std::make_unique<VulkanComputePipeline>(
+            m_DeviceRef,
+            "../assets/shaders/path_trace.comp.spv",
+            m_PipelineLayout,
+            specializationConstants);
+}
+
+void ComputePathTracer::AllocateCommandBuffers()
+{
+    m_CommandBuffers.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = static_cast<uint32_t>(m_CommandBuffers.size());
+    allocInfo.commandPool = m_DeviceRef.GetComputeCommandPool();
+    VK_CHECK_RESULT(vkAllocateCommandBuffers(m_DeviceRef.GetDevice(), &allocInfo, m_CommandBuffers.data()));
+}
+
+void ComputePathTracer::Resize(uint32_t width, uint32_t height)
+{
+    if (width == m_Width && height == m_Height && m_AccumulationImage)
+        return;
+
+    m_Width = width;
+    m_Height = height;
+
+    ImageSpecification spec{};
+    spec.DebugName = "Path Trace Accumulation";
+    spec.Format = ImageFormat::RGBA32F;
+    spec.Usage = ImageUsage::Storage;
+    spec.Width = width;
+    spec.Height = height;
+    spec.ExclusiveQueueOwnership = true;
+    // Read back by PathTracerBenchmark to measure convergence.
+    spec.UsedInTransferOps = true;
+    m_AccumulationImage = std::make_shared<VulkanImage2D>(m_DeviceRef, spec);
+    m_AccumulationImage->Invalidate();
+
+    spec.Format = ImageFormat::RGBA16F;
+    spec.UsedInTransferOps = false;
+    m_DisplayImages.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
+    for (uint32_t i = 0; i < VulkanSwapchain::MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        spec.DebugName = "Path Trace Display " + std::to_string(i);
+        m_DisplayImages[i] = std::make_shared<VulkanImage2D>(m_DeviceRef, spec);
+        m_DisplayImages[i]->Invalidate();
+    }
+
+    WriteDescriptorSets();
+}
+
+void ComputePathTracer::SetSphereBuffer(uint32_t frameIndex, const VkDescriptorBufferInfo& sphereBufferInfo)
+{
+    m_SphereBufferInfos[frameIndex] = sphereBufferInfo;
+    WriteDescriptorSets();
+}
+
+void ComputePathTracer::WriteDescriptorSets()
+{
+    if (!m_AccumulationImage)
+        return;
+
+    for (uint32_t i = 0; i < VulkanSwapchain::MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        if (m_SphereBufferInfos[i].buffer == VK_NULL_HANDLE)
+            continue;
+
+        VkDescriptorBufferInfo sphereInfo = m_SphereBufferInfos[i];
+        VkDescriptorImageInfo imageInfo = m_AccumulationImage->GetDescriptorInfo();
+        VkDescriptorBufferInfo statisticsInfo = m_StatisticsBuffers[i]->DescriptorInfo();
+        VkDescriptorImageInfo displayInfo = m_DisplayImages[i]->GetDescriptorInfo();
+        VulkanDescriptorWriter writer(*m_DescriptorSetLayout, *m_DescriptorPool);
+        writer.WriteBuffer(0, &sphereInfo)
+              .WriteImage(1, &imageInfo)
+              .WriteBuffer(2, &statisticsInfo)
+              .WriteImage(3, &displayInfo);
+
+        if (m_DescriptorSets[i] == VK_NULL_HANDLE)
+            writer.Build(m_DescriptorSets[i]);
+        else
+            writer.Overwrite(m_DescriptorSets[i]);
+    }
+}
+
+void ComputePathTracer::Record(
+        VkCommandBuffer cmdBuffer,
+        uint32_t frameIndex,
+        VkDescriptorSet globalSet,
+        const FramePushConstants& pushConstants)
+{
+    assert(m_DescriptorSets[frameIndex] != VK_NULL_HANDLE && "Compute path tracer recorded before its sphere buffer and size were set");
+
+    vkCmdFillBuffer(cmdBuffer, m_StatisticsBuffers[frameIndex]->GetBuffer(), 0, VK_WHOLE_SIZE, 0);
+
+    // The previous frame's dispatch wrote the accumulation image this one reads back,
+    // and the ray counter must be cleared before the dispatch adds to it.
+    VkMemoryBarrier accumulationBarrier{};
+    accumulationBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    accumulationBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    accumulationBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(
+            cmdBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0,
+            1, &accumulationBarrier,
+            0, nullptr,
+            0, nullptr);
+
+    m_Pipeline->Bind(cmdBuffer);
+
+    const std::array<VkDescriptorSet, 3> sets
+    {
+        globalSet,
+        m_DescriptorSets[frameIndex],
+        m_BindlessTableRef.GetDescriptorSet()
+    };
+
+    vkCmdBindDescriptorSets(
+            cmdBuffer,
+            VK_PIPELINE_BIND_POINT_COMPUTE,
+            m_PipelineLayout,
+            0,
+            static_cast<uint32_t>(sets.size()),
+            sets.data(),
+            0,
+            nullptr);
+
+    m_PushConstants.Push(cmdBuffer, m_PipelineLayout, pushConstants);
+
+    m_Pipeline->Dispatch(
+            cmdBuffer,
+            VulkanComputePipeline::GetGroupCount(m_Width, TileSize),
+            VulkanComputePipeline::GetGroupCount(m_Height, TileSize));
+
+    VkMemoryBarrier statisticsBarrier{};
+    statisticsBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    statisticsBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    statisticsBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(
+            cmdBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_HOST_BIT,
+            0,
+            1, &statisticsBarrier,
+            0, nullptr,
+            0, nullptr);
+}
+
+uint64_t ComputePathTracer::GetRaysTraced(uint32_t frameIndex) const
+{
+    return *static_cast<const uint32_t*>(m_StatisticsBuffers[frameIndex]->GetMappedMemory());
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "renderer/vulkan/vulkan_device.h"
+#include "renderer/vulkan/vulkan_descriptors.h"
+#include "renderer/vulkan/vulkan_compute_pipeline.h"
+#include "renderer/vulkan/vulkan_push_constants.h"
+#include "renderer/vulkan/vulkan_bindless.h"
+#include "renderer/vulkan/vulkan_image.h"
+#include "renderer/vulkan/vulkan_buffer.h"
+#include "renderer/path_tracer.h"
+#include "renderer/sampler_tables.h"
+#include "core/frame_info.h"
+
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Megakernel path tracer: one compute invocation per pixel, dispatched in 8x8 tiles,
+// accumulating in place into an RGBA32F storage image and copying the average to the frame's display image.
+class ComputePathTracer : public PathTracer
+{
+public:
+    static constexpr uint32_t TileSize = 8;
+
+    ComputePathTracer(
+            VulkanDevice& deviceRef,
+            VulkanDescriptorSetLayout& globalSetLayout,
+            VulkanBindlessTable& bindlessTableRef,
+            SamplerType sampler = SamplerType::Random);
+    ~ComputePathTracer() override;
+
+    ComputePathTracer(const ComputePathTracer&) = delete;
+    ComputePathTracer& operator=(const ComputePathTracer&) = delete;
+
+    void Resize(uint32_t width, uint32_t height) override;
+    void SetSphereBuffer(uint32_t frameIndex, const VkDescriptorBufferInfo& sphereBufferInfo) override;
+
+    void Record(
+            VkCommandBuffer cmdBuffer,
+            uint32_t frameIndex,
+            VkDescriptorSet globalSet,
+            const FramePushConstants& pushConstants) override;
+
+    [[nodiscard]] uint64_t GetRaysTraced(uint32_t frameIndex) const override;
+
+    [[nodiscard]] const char* GetName() const override { return "Megakernel"; }
+    [[nodiscard]] VkCommandBuffer GetCommandBuffer(uint32_t frameIndex) const override { return m_CommandBuffers[frameIndex]; }
+    [[nodiscard]] std::shared_ptr<VulkanImage2D> GetOutputImage(uint32_t frameIndex) const override { return m_DisplayImages[frameIndex]; }
+    [[nodiscard]] std::shared_ptr<VulkanImage2D> GetAccumulationImage() const override { return m_AccumulationImage; }
+    [[nodiscard]] uint32_t GetWidth() const override { return m_Width; }
+    [[nodiscard]] uint32_t GetHeight() const override { return m_Height; }
+    [[nodiscard]] SamplerType GetSampler() const { return m_Sampler; }
+
+private:
+    void CreateStatisticsBuffers();
+    void CreateDescriptors();
+    void CreatePipeline(VulkanDescriptorSetLayout& globalSetLayout);
+    void AllocateCommandBuffers();
+    void WriteDescriptorSets();
+
+private:
+    VulkanDevice& m_DeviceRef;
+    VulkanBindlessTable& m_BindlessTableRef;
+    SamplerType m_Sampler;
+
+    uint32_t m_Width = 0;
+    uint32_t m_Height = 0;
+    std::shared_ptr<VulkanImage2D> m_AccumulationImage;
+    std::vector<std::shared_ptr<VulkanImage2D>> m_DisplayImages;
+
+    std::unique_ptr<VulkanDescriptorPool> m_DescriptorPool;
+    std::unique_ptr<VulkanDescriptorSetLayout> m_DescriptorSetLayout;
+    std::vector<VkDescriptorSet> m_DescriptorSets;
+    std::vector<VkDescriptorBufferInfo> m_SphereBufferInfos;
+    std::vector<std::unique_ptr<VulkanBuffer>> m_StatisticsBuffers;
+
+    VulkanPushConstants<FramePushConstants> m_PushConstants;
+    VkPipelineLayout m_PipelineLayout{};
+    std::unique_ptr<VulkanComputePipeline> m_Pipeline;
+
+    std::vector<VkCommandBuffer> m_CommandBuffers;
+};
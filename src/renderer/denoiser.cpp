@@ -0,0 +1,254 @@
+#include "denoiser.h"
+#include "renderer/vulkan/vulkan_swapchain.h"
+#include "renderer/vulkan/vulkan_utils.h"
+
+#include <algorithm>
+#include <cassert>
+
+Denoiser::Denoiser(
+        VulkanDevice& deviceRef,
+        VulkanDescriptorSetLayout& globalSetLayout,
+        VulkanBindlessTable& bindlessTableRef)
+    : m_DeviceRef(deviceRef),
+      m_BindlessTableRef(bindlessTableRef),
+      m_PushConstants(deviceRef, VK_SHADER_STAGE_COMPUTE_BIT)
+{
+    m_SphereBufferInfos.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
+    CreateDescriptors();
+    CreatePipelines(globalSetLayout);
+}
+
+Denoiser::~Denoiser()
+{
+    vkDestroyPipelineLayout(m_DeviceRef.GetDevice(), m_PipelineLayout, nullptr);
+}
+
+void Denoiser::CreateDescriptors()
+{
+    VulkanDescriptorSetLayout::Builder builder(m_DeviceRef);
+    // Binding 0: SS BO for Spheres, for the feature pass
+    builder.AddBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+    // Bindings 1-10: accumulation, current and previous normal/depth, albedo, current and previous history,
+    // prior, the two filter images and this frame's output (see denoise.glsl)
+    constexpr uint32_t ImageBindingCount = 10;
+    for (uint32_t binding = 1; binding <= ImageBindingCount; binding++)
+        builder.AddBinding(binding, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT);
+    m_DescriptorSetLayout = builder.Build();
+
+    constexpr uint32_t SetCount = VulkanSwapchain::MAX_FRAMES_IN_FLIGHT * 2;
+    m_DescriptorPool = VulkanDescriptorPool::Builder(m_DeviceRef)
+            .SetMaxSets(SetCount)
+            .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, SetCount)
+            .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, SetCount * ImageBindingCount)
+            .Build();
+
+    m_DescriptorSets.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT, { VK_NULL_HANDLE, VK_NULL_HANDLE });
+}
+
+void Denoiser::CreatePipelines(VulkanDescriptorSetLayout& globalSetLayout)
+{
+    const std::vector<VkDescriptorSetLayout> descriptorSetLayouts
+    {
+        globalSetLayout.GetDescriptorSetLayout(),
+        m_DescriptorSetLayout->GetDescriptorSetLayout(),
+        m_BindlessTableRef.GetDescriptorSetLayout().GetDescriptorSetLayout()
+    };
+
+    VkPushConstantRange pushConstantRange = m_PushConstants.GetRange();
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    VK_CHECK_RESULT(vkCreatePipelineLayout(m_DeviceRef.GetDevice(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout));
+
+    m_FeaturePipeline = std::make_unique<VulkanComputePipeline>(m_DeviceRef, "../assets/shaders/denoise_features.comp.spv", m_PipelineLayout);
+    m_TemporalPipeline = std::make_unique<VulkanComputePipeline>(m_DeviceRef, "../assets/shaders/denoise_temporal.comp.spv", m_PipelineLayout);
+    m_AtrousPipeline = std::make_unique<VulkanComputePipeline>(m_DeviceRef, "../assets/shaders/denoise_atrous.comp.spv", m_PipelineLayout);
+}
+
+std::shared_ptr<VulkanImage2D> Denoiser::CreateImage(const std::string& debugName, ImageFormat format, bool readBack) const
+{
+    ImageSpecification spec{};
+    spec.DebugName = debugName;
+    spec.Format = format;
+    spec.Usage = ImageUsage::Storage;
+    spec.Width = m_Width;
+    spec.Height = m_Height;
+    spec.ExclusiveQueueOwnership = true;
+    spec.UsedInTransferOps = readBack;
+
+    auto image = std::make_shared<VulkanImage2D>(m_DeviceRef, spec);
+    image->Invalidate();
+    return image;
+}
+
+void Denoiser::Resize(uint32_t width, uint32_t height)
+{
+    if (width == m_Width && height == m_Height && m_AlbedoImage)
+        return;
+
+    m_Width = width;
+    m_Height = height;
+
+    // View depth needs more precision than half floats give to tell surfaces apart when reprojecting,
+    // and history lengths grow past what they count exactly while the camera rests.
+    for (uint32_t parity = 0; parity < 2; parity++)
+    {
+        m_NormalDepthImages[parity] = CreateImage("Denoise Normal Depth " + std::to_string(parity), ImageFormat::RGBA32F);
+        m_HistoryImages[parity] = CreateImage("Denoise History " + std::to_string(parity), ImageFormat::RGBA32F);
+        m_FilterImages[parity] = CreateImage("Denoise Filter " + std::to_string(parity), ImageFormat::RGBA16F);
+    }
+    m_AlbedoImage = CreateImage("Denoise Albedo", ImageFormat::RGBA16F);
+    m_PriorImage = CreateImage("Denoise Prior", ImageFormat::RGBA16F);
+
+    // Read back by PathTracerBenchmark to measure the denoised error.
+    m_OutputImages.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
+    for (uint32_t i = 0; i < VulkanSwapchain::MAX_FRAMES_IN_FLIGHT; i++)
+        m_OutputImages[i] = CreateImage("Denoise Output " + std::to_string(i), ImageFormat::RGBA16F, true);
+
+    m_HistoryValid = false;
+    WriteDescriptorSets();
+}
+
+void Denoiser::SetSphereBuffer(uint32_t frameIndex, const VkDescriptorBufferInfo& sphereBufferInfo)
+{
+    m_SphereBufferInfos[frameIndex] = sphereBufferInfo;
+    WriteDescriptorSets();
+}
+
+void Denoiser::SetInput(std::shared_ptr<VulkanImage2D> accumulationImage)
+{
+    m_AccumulationImage = std::move(accumulationImage);
+    WriteDescriptorSets();
+}
+
+void Denoiser::SetIterationCount(uint32_t iterationCount)
+{
+    m_IterationCount = std::max(1u, iterationCount);
+}
+
+void Denoiser::WriteDescriptorSets()
+{
+    if (!m_AccumulationImage || !m_AlbedoImage)
+        return;
+
+    for (uint32_t i = 0; i < VulkanSwapchain::MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        if (m_SphereBufferInfos[i].buffer == VK_NULL_HANDLE)
+            continue;
+
+        for (uint32_t parity = 0; parity < 2; parity++)
+        {
+            VkDescriptorBufferInfo sphereInfo = m_SphereBufferInfos[i];
+            VkDescriptorImageInfo accumulationInfo = m_AccumulationImage->GetDescriptorInfo();
+            VkDescriptorImageInfo normalDepthInfo = m_NormalDepthImages[parity]->GetDescriptorInfo();
+            VkDescriptorImageInfo previousNormalDepthInfo = m_NormalDepthImages[1 - parity]->GetDescriptorInfo();
+            VkDescriptorImageInfo albedoInfo = m_AlbedoImage->GetDescriptorInfo();
+            VkDescriptorImageInfo historyInfo = m_HistoryImages[parity]->GetDescriptorInfo();
+            VkDescriptorImageInfo previousHistoryInfo = m_HistoryImages[1 - parity]->GetDescriptorInfo();
+            VkDescriptorImageInfo priorInfo = m_PriorImage->GetDescriptorInfo();
+            VkDescriptorImageInfo filterAInfo = m_FilterImages[0]->GetDescriptorInfo();
+            VkDescriptorImageInfo filterBInfo = m_FilterImages[1]->GetDescriptorInfo();
+            VkDescriptorImageInfo outputInfo = m_OutputImages[i]->GetDescriptorInfo();
+
+            VulkanDescriptorWriter writer(*m_DescriptorSetLayout, *m_DescriptorPool);
+            writer.WriteBuffer(0, &sphereInfo)
+                  .WriteImage(1, &accumulationInfo)
+                  .WriteImage(2, &normalDepthInfo)
+                  .WriteImage(3, &previousNormalDepthInfo)
+                  .WriteImage(4, &albedoInfo)
+                  .WriteImage(5, &historyInfo)
+                  .WriteImage(6, &previousHistoryInfo)
+                  .WriteImage(7, &priorInfo)
+                  .WriteImage(8, &filterAInfo)
+                  .WriteImage(9, &filterBInfo)
+                  .WriteImage(10, &outputInfo);
+
+            if (m_DescriptorSets[i][parity] == VK_NULL_HANDLE)
+                writer.Build(m_DescriptorSets[i][parity]);
+            else
+                writer.Overwrite(m_DescriptorSets[i][parity]);
+        }
+    }
+}
+
+void Denoiser::ComputeBarrier(VkCommandBuffer cmdBuffer)
+{
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(
+            cmdBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0,
+            1, &barrier,
+            0, nullptr,
+            0, nullptr);
+}
+
+void Denoiser::Dispatch(VkCommandBuffer cmdBuffer, VulkanComputePipeline& pipeline, const DenoisePushConstants& pushConstants)
+{
+    pipeline.Bind(cmdBuffer);
+    m_PushConstants.Push(cmdBuffer, m_PipelineLayout, pushConstants);
+    pipeline.Dispatch(
+            cmdBuffer,
+            VulkanComputePipeline::GetGroupCount(m_Width, TileSize),
+            VulkanComputePipeline::GetGroupCount(m_Height, TileSize));
+}
+
+void Denoiser::Record(
+        VkCommandBuffer cmdBuffer,
+        uint32_t frameIndex,
+        VkDescriptorSet globalSet,
+        const FramePushConstants& pushConstants,
+        const glm::mat4& previousViewProjection)
+{
+    assert(m_DescriptorSets[frameIndex][m_HistoryParity] != VK_NULL_HANDLE && "Denoiser recorded before its input, sphere buffer and size were set");
+
+    // The tracer's accumulation, and last frame's history and features, were written by earlier dispatches.
+    ComputeBarrier(cmdBuffer);
+
+    const std::array<VkDescriptorSet, 3> sets
+    {
+        globalSet,
+        m_DescriptorSets[frameIndex][m_HistoryParity],
+        m_BindlessTableRef.GetDescriptorSet()
+    };
+
+    vkCmdBindDescriptorSets(
+            cmdBuffer,
+            VK_PIPELINE_BIND_POINT_COMPUTE,
+            m_PipelineLayout,
+            0,
+            static_cast<uint32_t>(sets.size()),
+            sets.data(),
+            0,
+            nullptr);
+
+    DenoisePushConstants denoiseConstants{};
+    denoiseConstants.Frame = pushConstants;
+    denoiseConstants.IterationCount = m_IterationCount;
+    denoiseConstants.PreviousViewProjection = previousViewProjection;
+    denoiseConstants.HistoryValid = m_HistoryValid ? 1 : 0;
+
+    Dispatch(cmdBuffer, *m_FeaturePipeline, denoiseConstants);
+    ComputeBarrier(cmdBuffer);
+    Dispatch(cmdBuffer, *m_TemporalPipeline, denoiseConstants);
+
+    for (uint32_t iteration = 0; iteration < m_IterationCount; iteration++)
+    {
+        ComputeBarrier(cmdBuffer);
+        denoiseConstants.Iteration = iteration;
+        Dispatch(cmdBuffer, *m_AtrousPipeline, denoiseConstants);
+    }
+
+    // This frame's history and features are the next one's previous.
+    m_HistoryParity = 1 - m_HistoryParity;
+    m_HistoryValid = true;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "renderer/vulkan/vulkan_device.h"
+#include "renderer/vulkan/vulkan_descriptors.h"
+#include "renderer/vulkan/vulkan_compute_pipeline.h"
+#include "renderer/vulkan/vulkan_push_constants.h"
+#include "renderer/vulkan/vulkan_bindless.h"
+#include "renderer/vulkan/vulkan_image.h"
+#include "core/frame_info.h"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Matches the DENOISE push constant block in path_tracing.glsl.
+struct DenoisePushConstants
+{
+    FramePushConstants Frame;
+    uint32_t Iteration = 0;
+    uint32_t IterationCount = 0;
+    glm::mat4 PreviousViewProjection{1.0f};
+    uint32_t HistoryValid = 0;
+};
+static_assert(offsetof(DenoisePushConstants, PreviousViewProjection) == 32, "std430 places the mat4 on a 16 byte boundary");
+
+// Spatiotemporal denoiser run on the compute queue between a tracer's accumulation and the composite.
+// A feature pass traces one unjittered primary ray per pixel for normal, view depth and albedo. A temporal
+// pass reprojects last frame's history through the previous view-projection, drops disocclusions and merges
+// it with the accumulation, so a moving camera keeps more than its one new frame. Edge-avoiding a-trous
+// iterations then filter the albedo-demodulated result, and the last writes the frame's output image.
+class Denoiser
+{
+public:
+    static constexpr uint32_t TileSize = 8;
+    static constexpr uint32_t DefaultIterationCount = 5;
+
+    Denoiser(
+            VulkanDevice& deviceRef,
+            VulkanDescriptorSetLayout& globalSetLayout,
+            VulkanBindlessTable& bindlessTableRef);
+    ~Denoiser();
+
+    Denoiser(const Denoiser&) = delete;
+    Denoiser& operator=(const Denoiser&) = delete;
+
+    void Resize(uint32_t width, uint32_t height);
+    void SetSphereBuffer(uint32_t frameIndex, const VkDescriptorBufferInfo& sphereBufferInfo);
+    // The tracer's accumulation image. Set again whenever the tracer is recreated or resized.
+    void SetInput(std::shared_ptr<VulkanImage2D> accumulationImage);
+    // At least one iteration, since the last one writes the output.
+    void SetIterationCount(uint32_t iterationCount);
+    // The next frame starts from its accumulation alone.
+    void ResetHistory() { m_HistoryValid = false; }
+
+    // Records after the tracer, into the same compute command buffer. previousViewProjection is the previous
+    // frame's Projection * View, which the history was rendered from.
+    void Record(
+            VkCommandBuffer cmdBuffer,
+            uint32_t frameIndex,
+            VkDescriptorSet globalSet,
+            const FramePushConstants& pushConstants,
+            const glm::mat4& previousViewProjection);
+
+    // Written by the compute queue each frame and handed to the graphics queue for compositing.
+    [[nodiscard]] std::shared_ptr<VulkanImage2D> GetOutputImage(uint32_t frameIndex) const { return m_OutputImages[frameIndex]; }
+    [[nodiscard]] uint32_t GetIterationCount() const { return m_IterationCount; }
+    [[nodiscard]] uint32_t GetWidth() const { return m_Width; }
+    [[nodiscard]] uint32_t GetHeight() const { return m_Height; }
+
+private:
+    void CreateDescriptors();
+    void CreatePipelines(VulkanDescriptorSetLayout& globalSetLayout);
+    std::shared_ptr<VulkanImage2D> CreateImage(const std::string& debugName, ImageFormat format, bool readBack = false) const;
+    void WriteDescriptorSets();
+    void Dispatch(VkCommandBuffer cmdBuffer, VulkanComputePipeline& pipeline, const DenoisePushConstants& pushConstants);
+
+    static void ComputeBarrier(VkCommandBuffer cmdBuffer);
+
+private:
+    VulkanDevice& m_DeviceRef;
+    VulkanBindlessTable& m_BindlessTableRef;
+
+    uint32_t m_Width = 0;
+    uint32_t m_Height = 0;
+    uint32_t m_IterationCount = DefaultIterationCount;
+
+    std::shared_ptr<VulkanImage2D> m_AccumulationImage;
+    // Indexed by history parity, which flips every recorded frame.
+    std::array<std::shared_ptr<VulkanImage2D>, 2> m_NormalDepthImages;
+    std::array<std::shared_ptr<VulkanImage2D>, 2> m_HistoryImages;
+    std::shared_ptr<VulkanImage2D> m_AlbedoImage;
+    std::shared_ptr<VulkanImage2D> m_PriorImage;
+    std::array<std::shared_ptr<VulkanImage2D>, 2> m_FilterImages;
+    std::vector<std::shared_ptr<VulkanImage2D>> m_OutputImages;
+    uint32_t m_HistoryParity = 0;
+    bool m_HistoryValid = false;
+
+    std::unique_ptr<VulkanDescriptorPool> m_DescriptorPool;
+    std::unique_ptr<VulkanDescriptorSetLayout> m_DescriptorSetLayout;
+    // Indexed by [frame in flight][history parity]
+    std::vector<std::array<VkDescriptorSet, 2>> m_DescriptorSets;
+    std::vector<VkDescriptorBufferInfo> m_SphereBufferInfos;
+
+    VulkanPushConstants<DenoisePushConstants> m_PushConstants;
+    VkPipelineLayout m_PipelineLayout{};
+    std::unique_ptr<VulkanComputePipeline> m_FeaturePipeline;
+    std::unique_ptr<VulkanComputePipeline> m_TemporalPipeline;
+    std::unique_ptr<VulkanComputePipeline> m_AtrousPipeline;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "renderer/vulkan/vulkan_image.h"
+#include "core/frame_info.h"
+
+#include <cstdint>
+#include <memory>
+#include <vulkan/vulkan.h>
+
+// Common interface of the compute path tracing backends. Each tracer keeps its accumulation
+// image on the compute queue and owns one display image and one compute command buffer per
+// frame in flight, so frame N can be composited while frame N + 1 is traced.
+class PathTracer
+{
+public:
+    virtual ~PathTracer() = default;
+
+    virtual void Resize(uint32_t width, uint32_t height) = 0;
+    virtual void SetSphereBuffer(uint32_t frameIndex, const VkDescriptorBufferInfo& sphereBufferInfo) = 0;
+
+    virtual void Record(
+            VkCommandBuffer cmdBuffer,
+            uint32_t frameIndex,
+            VkDescriptorSet globalSet,
+            const FramePushConstants& pushConstants) = 0;
+
+    // Rays traced by the last submission recorded for frameIndex. Only valid once that submission has completed.
+    [[nodiscard]] virtual uint64_t GetRaysTraced(uint32_t frameIndex) const = 0;
+
+    [[nodiscard]] virtual const char* GetName() const = 0;
+    [[nodiscard]] virtual VkCommandBuffer GetCommandBuffer(uint32_t frameIndex) const = 0;
+    // Written by the compute queue each frame and handed to the graphics queue for compositing.
+    [[nodiscard]] virtual std::shared_ptr<VulkanImage2D> GetOutputImage(uint32_t frameIndex) const = 0;
+    // RGBA32F running average of every frame since AccumulationIndex was last 0, in GENERAL layout on the compute queue.
+    [[nodiscard]] virtual std::shared_ptr<VulkanImage2D> GetAccumulationImage() const = 0;
+    [[nodiscard]] virtual uint32_t GetWidth() const = 0;
+    [[nodiscard]] virtual uint32_t GetHeight() const = 0;
+};
@@ -0,0 +1,348 @@
+#include "path_tracer_benchmark.h"
+#include "renderer/denoiser.h"
+#include "renderer/vulkan/vulkan_buffer.h"
+#include "renderer/vulkan/vulkan_utils.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <stdexcept>
+
+namespace
+{
+    // Reference frames draw seeds from far past anything a timed run reaches, so its noise is independent.
+    constexpr uint32_t ReferenceSeedOffset = 1u << 24;
+    // Stops an equal-time run whose budget is far beyond the frame time.
+    constexpr uint32_t MaxEqualTimeFrameCount = 1u << 16;
+
+    double ComputeRmse(const std::vector<float>& image, const std::vector<float>& reference)
+    {
+        if (image.size() != reference.size())
+            throw std::runtime_error("Convergence reference was rendered at a different size!");
+
+        double squaredError = 0.0;
+        uint64_t channelCount = 0;
+        for (size_t i = 0; i < image.size(); i += 4)
+        {
+            for (size_t channel = 0; channel < 3; channel++)
+            {
+                const double difference = static_cast<double>(image[i + channel]) - reference[i + channel];
+                squaredError += difference * difference;
+                channelCount++;
+            }
+        }
+        return channelCount > 0 ? std::sqrt(squaredError / static_cast<double>(channelCount)) : 0.0;
+    }
+}
+
+PathTracerBenchmark::PathTracerBenchmark(VulkanDevice& deviceRef)
+    : m_DeviceRef(deviceRef)
+{
+    if (!m_DeviceRef.PhysicalDeviceProperties.limits.timestampComputeAndGraphics)
+        throw std::runtime_error("Path tracer benchmark requires timestamp queries on the compute queue!");
+
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = 2;
+    VK_CHECK_RESULT(vkCreateQueryPool(m_DeviceRef.GetDevice(), &queryPoolInfo, nullptr, &m_QueryPool));
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VK_CHECK_RESULT(vkCreateFence(m_DeviceRef.GetDevice(), &fenceInfo, nullptr, &m_Fence));
+}
+
+PathTracerBenchmark::~PathTracerBenchmark()
+{
+    vkDestroyFence(m_DeviceRef.GetDevice(), m_Fence, nullptr);
+    vkDestroyQueryPool(m_DeviceRef.GetDevice(), m_QueryPool, nullptr);
+}
+
+PathTracerBenchmarkResult PathTracerBenchmark::Run(
+        PathTracer& tracer,
+        VkDescriptorSet globalSet,
+        uint32_t maxBounceCount,
+        uint32_t frameCount)
+{
+    PathTracerBenchmarkResult result{};
+    result.TracerName = tracer.GetName();
+    result.MaxBounceCount = maxBounceCount;
+    result.FrameCount = frameCount;
+    result.Width = tracer.GetWidth();
+    result.Height = tracer.GetHeight();
+
+    FramePushConstants pushConstants{};
+    pushConstants.SampleCount = 1;
+    pushConstants.MaxBounceCount = maxBounceCount;
+
+    for (uint32_t frame = 0; frame < WarmupFrameCount + frameCount; frame++)
+    {
+        // Fixed seeds per frame so every tracer sees the same random sequence.
+        pushConstants.FrameNumber = frame;
+        pushConstants.AccumulationIndex = frame;
+
+        double milliseconds = SubmitFrame(tracer, globalSet, pushConstants);
+        if (frame < WarmupFrameCount)
+            continue;
+
+        result.GpuMilliseconds += milliseconds;
+        result.RaysTraced += tracer.GetRaysTraced(0);
+    }
+
+    return result;
+}
+
+std::vector<float> PathTracerBenchmark::RenderReference(
+        PathTracer& tracer,
+        VkDescriptorSet globalSet,
+        const FramePushConstants& settings,
+        uint32_t frameCount)
+{
+    FramePushConstants pushConstants = settings;
+    for (uint32_t frame = 0; frame < frameCount; frame++)
+    {
+        pushConstants.FrameNumber = ReferenceSeedOffset + frame;
+        pushConstants.AccumulationIndex = frame;
+        SubmitFrame(tracer, globalSet, pushConstants);
+    }
+
+    return ReadImage(tracer, *tracer.GetAccumulationImage());
+}
+
+PathTracerConvergenceResult PathTracerBenchmark::RunEqualTime(
+        PathTracer& tracer,
+        VkDescriptorSet globalSet,
+        const FramePushConstants& settings,
+        double budgetMilliseconds,
+        const std::vector<float>& reference)
+{
+    FramePushConstants pushConstants = settings;
+    for (uint32_t frame = 0; frame < WarmupFrameCount; frame++)
+    {
+        pushConstants.FrameNumber = frame;
+        pushConstants.AccumulationIndex = frame;
+        SubmitFrame(tracer, globalSet, pushConstants);
+    }
+
+    // Accumulation restarts after the warmup, so only timed frames reach the image.
+    PathTracerConvergenceResult result{};
+    while (result.FrameCount == 0 || (result.GpuMilliseconds < budgetMilliseconds && result.FrameCount < MaxEqualTimeFrameCount))
+    {
+        pushConstants.FrameNumber = result.FrameCount;
+        pushConstants.AccumulationIndex = result.FrameCount;
+        result.GpuMilliseconds += SubmitFrame(tracer, globalSet, pushConstants);
+        result.FrameCount++;
+    }
+
+    result.Rmse = ComputeRmse(ReadImage(tracer, *tracer.GetAccumulationImage()), reference);
+    return result;
+}
+
+PathTracerConvergenceResult PathTracerBenchmark::RunFrameCount(
+        PathTracer& tracer,
+        Denoiser* denoiser,
+        VkDescriptorSet globalSet,
+        const FramePushConstants& settings,
+        uint32_t frameCount,
+        const std::vector<float>& reference)
+{
+    FramePushConstants pushConstants = settings;
+    for (uint32_t frame = 0; frame < WarmupFrameCount; frame++)
+    {
+        pushConstants.FrameNumber = frame;
+        pushConstants.AccumulationIndex = frame;
+        SubmitFrame(tracer, globalSet, pushConstants, denoiser);
+    }
+
+    // The warmup's history must not carry over into the restarted accumulation.
+    if (denoiser)
+        denoiser->ResetHistory();
+
+    PathTracerConvergenceResult result{};
+    result.FrameCount = frameCount;
+    for (uint32_t frame = 0; frame < frameCount; frame++)
+    {
+        pushConstants.FrameNumber = frame;
+        pushConstants.AccumulationIndex = frame;
+        result.GpuMilliseconds += SubmitFrame(tracer, globalSet, pushConstants, denoiser);
+    }
+
+    const std::vector<float> image = denoiser ? ReadImage(tracer, *denoiser->GetOutputImage(0)) : ReadImage(tracer, *tracer.GetAccumulationImage());
+    result.Rmse = ComputeRmse(image, reference);
+    return result;
+}
+
+std::vector<float> PathTracerBenchmark::ReadImage(PathTracer& tracer, VulkanImage2D& image)
+{
+    const uint32_t width = image.GetWidth();
+    const uint32_t height = image.GetHeight();
+    const bool halfFloat = image.GetSpecification().Format == ImageFormat::RGBA16F;
+    assert((halfFloat || image.GetSpecification().Format == ImageFormat::RGBA32F) && "Only RGBA float images can be read back");
+    const uint32_t TexelSize = halfFloat ? 4 * sizeof(uint16_t) : 4 * sizeof(float);
+
+    VulkanBuffer readback(
+            m_DeviceRef,
+            TexelSize,
+            width * height,
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    VkCommandBuffer cmdBuffer = tracer.GetCommandBuffer(0);
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK_RESULT(vkBeginCommandBuffer(cmdBuffer, &beginInfo));
+
+    // The image stays in GENERAL, which transfers may read.
+    VkMemoryBarrier writeBarrier{};
+    writeBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    writeBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    writeBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(
+            cmdBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0,
+            1, &writeBarrier,
+            0, nullptr,
+            0, nullptr);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = { width, height, 1 };
+    vkCmdCopyImageToBuffer(cmdBuffer, image.GetImageInfo().Image, VK_IMAGE_LAYOUT_GENERAL, readback.GetBuffer(), 1, &region);
+
+    VkMemoryBarrier readBarrier{};
+    readBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    readBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    readBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(
+            cmdBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_HOST_BIT,
+            0,
+            1, &readBarrier,
+            0, nullptr,
+            0, nullptr);
+    VK_CHECK_RESULT(vkEndCommandBuffer(cmdBuffer));
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &cmdBuffer;
+    VK_CHECK_RESULT(vkQueueSubmit(m_DeviceRef.GetComputeQueue(), 1, &submitInfo, m_Fence));
+    VK_CHECK_RESULT(vkWaitForFences(m_DeviceRef.GetDevice(), 1, &m_Fence, VK_TRUE, UINT64_MAX));
+    VK_CHECK_RESULT(vkResetFences(m_DeviceRef.GetDevice(), 1, &m_Fence));
+
+    std::vector<float> texels(static_cast<size_t>(width) * height * 4);
+    VK_CHECK_RESULT(readback.Map());
+    if (halfFloat)
+    {
+        const auto* halves = static_cast<const uint16_t*>(readback.GetMappedMemory());
+        for (size_t i = 0; i < texels.size(); i++)
+            texels[i] = glm::unpackHalf1x16(halves[i]);
+    }
+    else
+    {
+        std::memcpy(texels.data(), readback.GetMappedMemory(), texels.size() * sizeof(float));
+    }
+    readback.Unmap();
+    return texels;
+}
+
+double PathTracerBenchmark::SubmitFrame(PathTracer& tracer, VkDescriptorSet globalSet, const FramePushConstants& pushConstants, Denoiser* denoiser)
+{
+    VkCommandBuffer cmdBuffer = tracer.GetCommandBuffer(0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    VK_CHECK_RESULT(vkBeginCommandBuffer(cmdBuffer, &beginInfo));
+    vkCmdResetQueryPool(cmdBuffer, m_QueryPool, 0, 2);
+    vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_QueryPool, 0);
+    tracer.Record(cmdBuffer, 0, globalSet, pushConstants);
+    // The view never moves, so reprojection is the identity whatever the matrix; only its validity matters.
+    if (denoiser)
+        denoiser->Record(cmdBuffer, 0, globalSet, pushConstants, glm::mat4(1.0f));
+    vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_QueryPool, 1);
+    VK_CHECK_RESULT(vkEndCommandBuffer(cmdBuffer));
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &cmdBuffer;
+    VK_CHECK_RESULT(vkQueueSubmit(m_DeviceRef.GetComputeQueue(), 1, &submitInfo, m_Fence));
+    VK_CHECK_RESULT(vkWaitForFences(m_DeviceRef.GetDevice(), 1, &m_Fence, VK_TRUE, UINT64_MAX));
+    VK_CHECK_RESULT(vkResetFences(m_DeviceRef.GetDevice(), 1, &m_Fence));
+
+    std::array<uint64_t, 2> timestamps{};
+    VK_CHECK_RESULT(vkGetQueryPoolResults(
+            m_DeviceRef.GetDevice(),
+            m_QueryPool,
+            0,
+            2,
+            sizeof(timestamps),
+            timestamps.data(),
+            sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+
+    const double nanoseconds = static_cast<double>(timestamps[1] - timestamps[0]) * m_DeviceRef.PhysicalDeviceProperties.limits.timestampPeriod;
+    return nanoseconds * 1e-6;
+}
+
+void PathTracerBenchmark::PrintReport(const std::vector<PathTracerBenchmarkResult>& results, std::ostream& stream)
+{
+    stream << std::left
+           << std::setw(22) << "Tracer"
+           << std::setw(10) << "Bounces"
+           << std::setw(14) << "ms/frame"
+           << std::setw(16) << "Mrays/s"
+           << "vs megakernel\n";
+
+    double baselineRaysPerSecond = 0.0;
+    for (const auto& result : results)
+    {
+        // Results are grouped per bounce count with the megakernel first.
+        if (result.TracerName == "Megakernel")
+            baselineRaysPerSecond = result.GetRaysPerSecond();
+
+        stream << std::left << std::fixed << std::setprecision(3)
+               << std::setw(22) << result.TracerName
+               << std::setw(10) << result.MaxBounceCount
+               << std::setw(14) << result.GetMillisecondsPerFrame()
+               << std::setw(16) << result.GetRaysPerSecond() * 1e-6;
+
+        if (baselineRaysPerSecond > 0.0)
+            stream << std::setprecision(2) << result.GetRaysPerSecond() / baselineRaysPerSecond << "x";
+        stream << "\n";
+    }
+}
+
+void PathTracerBenchmark::PrintConvergenceReport(const std::vector<PathTracerConvergenceResult>& results, std::ostream& stream)
+{
+    stream << std::left
+           << std::setw(22) << "Configuration"
+           << std::setw(10) << "Frames"
+           << std::setw(14) << "GPU ms"
+           << std::setw(16) << "RMSE"
+           << "vs first\n";
+
+    const double baselineRmse = results.empty() ? 0.0 : results.front().Rmse;
+    for (const auto& result : results)
+    {
+        stream << std::left << std::fixed << std::setprecision(3)
+               << std::setw(22) << result.Label
+               << std::setw(10) << result.FrameCount
+               << std::setw(14) << result.GpuMilliseconds
+               << std::setprecision(5) << std::setw(16) << result.Rmse;
+
+        if (result.Rmse > 0.0)
+            stream << std::setprecision(2) << baselineRmse / result.Rmse << "x";
+        stream << "\n";
+    }
+}
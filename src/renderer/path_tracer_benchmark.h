@@ -0,0 +1,94 @@
+#pragma once
+
+#include "renderer/vulkan/vulkan_device.h"
+#include "renderer/path_tracer.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+class Denoiser;
+
+struct PathTracerBenchmarkResult
+{
+    std::string TracerName;
+    uint32_t MaxBounceCount = 0;
+    uint32_t FrameCount = 0;
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    double GpuMilliseconds = 0.0;   // Summed over all timed frames
+    uint64_t RaysTraced = 0;
+
+    [[nodiscard]] double GetRaysPerSecond() const { return GpuMilliseconds > 0.0 ? static_cast<double>(RaysTraced) / (GpuMilliseconds * 1e-3) : 0.0; }
+    [[nodiscard]] double GetMillisecondsPerFrame() const { return FrameCount > 0 ? GpuMilliseconds / FrameCount : 0.0; }
+};
+
+// Error of an accumulated image against a converged reference after a GPU time budget or frame count.
+struct PathTracerConvergenceResult
+{
+    std::string Label;
+    uint32_t FrameCount = 0;        // Frames accumulated
+    double GpuMilliseconds = 0.0;
+    double Rmse = 0.0;              // Over every RGB channel of every pixel
+};
+
+// Runs a path tracer synchronously on the compute queue, bracketing each frame with GPU
+// timestamps and reading back the tracer's ray counter, to report rays per second.
+class PathTracerBenchmark
+{
+public:
+    static constexpr uint32_t WarmupFrameCount = 4;
+
+    explicit PathTracerBenchmark(VulkanDevice& deviceRef);
+    ~PathTracerBenchmark();
+
+    PathTracerBenchmark(const PathTracerBenchmark&) = delete;
+    PathTracerBenchmark& operator=(const PathTracerBenchmark&) = delete;
+
+    // The global set must already hold the view to trace. Accumulation restarts on the first frame.
+    PathTracerBenchmarkResult Run(
+            PathTracer& tracer,
+            VkDescriptorSet globalSet,
+            uint32_t maxBounceCount,
+            uint32_t frameCount);
+
+    // Accumulates frameCount frames from seeds no timed run uses and reads the result back as RGBA floats.
+    std::vector<float> RenderReference(
+            PathTracer& tracer,
+            VkDescriptorSet globalSet,
+            const FramePushConstants& settings,
+            uint32_t frameCount);
+
+    // Accumulates frames until their GPU time reaches budgetMilliseconds, then compares against reference.
+    PathTracerConvergenceResult RunEqualTime(
+            PathTracer& tracer,
+            VkDescriptorSet globalSet,
+            const FramePushConstants& settings,
+            double budgetMilliseconds,
+            const std::vector<float>& reference);
+
+    // Accumulates frameCount frames, then compares against reference. With a denoiser, it runs after every
+    // frame with a fresh history, its GPU time counts, and its output is compared instead of the accumulation.
+    PathTracerConvergenceResult RunFrameCount(
+            PathTracer& tracer,
+            Denoiser* denoiser,
+            VkDescriptorSet globalSet,
+            const FramePushConstants& settings,
+            uint32_t frameCount,
+            const std::vector<float>& reference);
+
+    static void PrintReport(const std::vector<PathTracerBenchmarkResult>& results, std::ostream& stream);
+    static void PrintConvergenceReport(const std::vector<PathTracerConvergenceResult>& results, std::ostream& stream);
+
+private:
+    double SubmitFrame(PathTracer& tracer, VkDescriptorSet globalSet, const FramePushConstants& pushConstants, Denoiser* denoiser = nullptr);
+    // RGBA32F or RGBA16F storage image in GENERAL layout on the compute queue, as RGBA floats.
+    std::vector<float> ReadImage(PathTracer& tracer, VulkanImage2D& image);
+
+private:
+    VulkanDevice& m_DeviceRef;
+    VkQueryPool m_QueryPool = VK_NULL_HANDLE;
+    VkFence m_Fence = VK_NULL_HANDLE;
+};
@@ -0,0 +1,616 @@
+#include "render_graph.h"
+#include "renderer/vulkan/vulkan_barrier.h"
+#include "renderer/vulkan/vulkan_gpu_profiler.h"
+
+#include <cassert>
+#include <iomanip>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    const char* GetLayoutName(VkImageLayout layout)
+    {
+        switch (layout)
+        {
+            case VK_IMAGE_LAYOUT_UNDEFINED: return "UNDEFINED";
+            case VK_IMAGE_LAYOUT_GENERAL: return "GENERAL";
+            case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL: return "COLOR_ATTACHMENT_OPTIMAL";
+            case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL: return "SHADER_READ_ONLY_OPTIMAL";
+            case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL: return "TRANSFER_SRC_OPTIMAL";
+            case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL: return "TRANSFER_DST_OPTIMAL";
+            case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR: return "PRESENT_SRC";
+            default: return "OTHER";
+        }
+    }
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Read(RenderGraphResource resource, RenderGraphUsage usage, VkImageLayout layout)
+{
+    m_Graph.AddAccess(m_PassIndex, resource, usage, layout, false);
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Write(RenderGraphResource resource, RenderGraphUsage usage, VkImageLayout layout)
+{
+    m_Graph.AddAccess(m_PassIndex, resource, usage, layout, true);
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::SideEffects()
+{
+    m_Graph.m_Passes[m_PassIndex].HasSideEffects = true;
+    return *this;
+}
+
+RenderGraph::RenderGraph(VulkanDevice& deviceRef)
+    : m_DeviceRef(deviceRef)
+{
+}
+
+RenderGraph::UsageInfo RenderGraph::GetUsageInfo(RenderGraphUsage usage)
+{
+    switch (usage)
+    {
+        case RenderGraphUsage::None:
+            return { VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, 0, VK_IMAGE_LAYOUT_UNDEFINED };
+        case RenderGraphUsage::ComputeRead:
+            return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, 0, VK_IMAGE_LAYOUT_GENERAL };
+        case RenderGraphUsage::ComputeWrite:
+            return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL };
+        case RenderGraphUsage::ComputeReadWrite:
+            return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL };
+        case RenderGraphUsage::FragmentRead:
+            return { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+        case RenderGraphUsage::ColorAttachment:
+            return { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                     VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                     VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                     VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+        case RenderGraphUsage::TransferRead:
+            return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, 0, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL };
+        case RenderGraphUsage::TransferWrite:
+            return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL };
+        case RenderGraphUsage::HostRead:
+            return { VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT, 0, VK_IMAGE_LAYOUT_GENERAL };
+        case RenderGraphUsage::Present:
+            return { VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR };
+    }
+
+    assert(false && "Unknown render graph usage");
+    return {};
+}
+
+const char* RenderGraph::GetUsageName(RenderGraphUsage usage)
+{
+    switch (usage)
+    {
+        case RenderGraphUsage::None: return "None";
+        case RenderGraphUsage::ComputeRead: return "ComputeRead";
+        case RenderGraphUsage::ComputeWrite: return "ComputeWrite";
+        case RenderGraphUsage::ComputeReadWrite: return "ComputeReadWrite";
+        case RenderGraphUsage::FragmentRead: return "FragmentRead";
+        case RenderGraphUsage::ColorAttachment: return "ColorAttachment";
+        case RenderGraphUsage::TransferRead: return "TransferRead";
+        case RenderGraphUsage::TransferWrite: return "TransferWrite";
+        case RenderGraphUsage::HostRead: return "HostRead";
+        case RenderGraphUsage::Present: return "Present";
+    }
+    return "Unknown";
+}
+
+const char* RenderGraph::GetQueueName(QueueType queue)
+{
+    switch (queue)
+    {
+        case QueueType::Graphics: return "Graphics";
+        case QueueType::Compute: return "Compute";
+        case QueueType::Transfer: return "Transfer";
+    }
+    return "Unknown";
+}
+
+RenderGraphResource RenderGraph::ImportImage(
+        const std::string& name,
+        VkImage image,
+        const VkImageSubresourceRange& subresourceRange,
+        const RenderGraphResourceState& state)
+{
+    Resource resource;
+    resource.Name = name;
+    resource.Image = image;
+    resource.SubresourceRange = subresourceRange;
+    resource.Initial = state;
+    m_Resources.push_back(std::move(resource));
+    return static_cast<RenderGraphResource>(m_Resources.size() - 1);
+}
+
+RenderGraphResource RenderGraph::ImportBuffer(const std::string& name, VkBuffer buffer, const RenderGraphResourceState& state)
+{
+    Resource resource;
+    resource.Name = name;
+    resource.Buffer = buffer;
+    resource.Initial = state;
+    m_Resources.push_back(std::move(resource));
+    return static_cast<RenderGraphResource>(m_Resources.size() - 1);
+}
+
+void RenderGraph::Export(RenderGraphResource resource, QueueType queue, RenderGraphUsage usage, VkImageLayout layout)
+{
+    assert(resource < m_Resources.size() && "Invalid render graph resource");
+    Resource& exported = m_Resources[resource];
+    exported.Exported = true;
+    exported.ExportQueue = queue;
+    exported.ExportUsage = usage;
+    exported.ExportLayout = layout == VK_IMAGE_LAYOUT_MAX_ENUM ? GetUsageInfo(usage).Layout : layout;
+}
+
+RenderGraph::PassBuilder RenderGraph::AddPass(const std::string& name, QueueType queue, std::function<void(VkCommandBuffer)> execute)
+{
+    assert(!m_Compiled && "Passes must be added before the graph is compiled");
+
+    Pass pass;
+    pass.Name = name;
+    pass.Queue = queue;
+    pass.Execute = std::move(execute);
+    m_Passes.push_back(std::move(pass));
+    return { *this, static_cast<uint32_t>(m_Passes.size() - 1) };
+}
+
+void RenderGraph::AddAccess(uint32_t passIndex, RenderGraphResource resource, RenderGraphUsage usage, VkImageLayout layout, bool write)
+{
+    assert(resource < m_Resources.size() && "Invalid render graph resource");
+    assert(write == (GetUsageInfo(usage).WriteAccess != 0) && "Usage does not match Read/Write");
+
+    Pass& pass = m_Passes[passIndex];
+    for (const Access& access : pass.Accesses)
+        assert(access.Resource != resource && "A pass may declare each resource once");
+
+    if (layout == VK_IMAGE_LAYOUT_MAX_ENUM)
+        layout = GetUsageInfo(usage).Layout;
+    pass.Accesses.push_back({ resource, usage, layout, write });
+}
+
+void RenderGraph::CullPasses()
+{
+    // Walk back from the exports and the passes with side effects, keeping every pass that writes something
+    // a kept pass reads. Writers are never assumed to overwrite a whole resource, so earlier writers stay.
+    std::vector<bool> needed(m_Resources.size(), false);
+    for (size_t i = 0; i < m_Resources.size(); i++)
+        needed[i] = m_Resources[i].Exported;
+
+    for (auto pass = m_Passes.rbegin(); pass != m_Passes.rend(); ++pass)
+    {
+        bool live = pass->HasSideEffects;
+        for (const Access& access : pass->Accesses)
+            live = live || (access.Write && needed[access.Resource]);
+
+        pass->Culled = !live;
+        if (!live)
+            continue;
+
+        for (const Access& access : pass->Accesses)
+        {
+            if (!access.Write || GetUsageInfo(access.Usage).Access != GetUsageInfo(access.Usage).WriteAccess)
+                needed[access.Resource] = true;
+        }
+    }
+}
+
+void RenderGraph::InitializeTracker(Tracker& tracker, const Resource& resource) const
+{
+    const RenderGraphResourceState& state = resource.Initial;
+    tracker.Queue = state.Queue;
+    tracker.Layout = state.Layout;
+    tracker.AcquirePending = state.AcquirePending;
+    tracker.ReleasedFrom = state.ReleasedFrom;
+    tracker.LastUsage = state.Usage;
+
+    UsageInfo info = GetUsageInfo(state.Usage);
+    if (info.WriteAccess)
+    {
+        tracker.WriteStages = info.Stage;
+        tracker.WriteAccess = info.WriteAccess;
+    }
+    else if (state.Usage != RenderGraphUsage::None)
+    {
+        tracker.ReadStages = info.Stage;
+    }
+}
+
+void RenderGraph::AddBarrier(
+        BarrierBatch& batch,
+        RenderGraphResource resource,
+        VkPipelineStageFlags srcStageMask, VkAccessFlags srcAccessMask,
+        VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask,
+        VkImageLayout oldLayout, VkImageLayout newLayout,
+        uint32_t srcFamilyIndex, uint32_t dstFamilyIndex) const
+{
+    const Resource& target = m_Resources[resource];
+    batch.SrcStageMask |= srcStageMask ? srcStageMask : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+    batch.DstStageMask |= dstStageMask ? dstStageMask : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+    if (target.Image)
+    {
+        VkImageMemoryBarrier2 barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+        barrier.srcStageMask = srcStageMask;
+        barrier.dstStageMask = dstStageMask;
+        barrier.srcAccessMask = srcAccessMask;
+        barrier.dstAccessMask = dstAccessMask;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcQueueFamilyIndex = srcFamilyIndex;
+        barrier.dstQueueFamilyIndex = dstFamilyIndex;
+        barrier.image = target.Image;
+        barrier.subresourceRange = target.SubresourceRange;
+
+        batch.Resources.insert(batch.Resources.begin() + static_cast<std::ptrdiff_t>(batch.ImageBarriers.size()), resource);
+        batch.ImageBarriers.push_back(barrier);
+    }
+    else
+    {
+        VkBufferMemoryBarrier2 barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+        barrier.srcStageMask = srcStageMask;
+        barrier.dstStageMask = dstStageMask;
+        barrier.srcAccessMask = srcAccessMask;
+        barrier.dstAccessMask = dstAccessMask;
+        barrier.srcQueueFamilyIndex = srcFamilyIndex;
+        barrier.dstQueueFamilyIndex = dstFamilyIndex;
+        barrier.buffer = target.Buffer;
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+
+        batch.Resources.push_back(resource);
+        batch.BufferBarriers.push_back(barrier);
+    }
+}
+
+void RenderGraph::ApplyAccess(
+        int passIndex,
+        Tracker& tracker,
+        RenderGraphResource resource,
+        QueueType queue,
+        const UsageInfo& info,
+        VkImageLayout layout,
+        bool write)
+{
+    const bool isImage = m_Resources[resource].Image != VK_NULL_HANDLE;
+    if (!isImage)
+        layout = tracker.Layout;
+
+    BarrierBatch& before = m_Passes[passIndex].Before;
+
+    // Hand the resource over from another queue. Ownership moves without a layout change; the consumer
+    // transitions it afterwards like any other access.
+    bool handedOver = false;
+    if (tracker.AcquirePending)
+    {
+        assert(tracker.Queue == queue && "Resource was released to a different queue");
+        uint32_t srcFamily = m_DeviceRef.GetQueueFamilyIndex(tracker.ReleasedFrom);
+        uint32_t dstFamily = m_DeviceRef.GetQueueFamilyIndex(queue);
+        if (srcFamily != dstFamily)
+        {
+            AddBarrier(before, resource,
+                       VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, info.Stage, info.Access,
+                       tracker.Layout, tracker.Layout, srcFamily, dstFamily);
+        }
+        tracker.AcquirePending = false;
+        handedOver = true;
+    }
+    else if (tracker.Queue != queue)
+    {
+        int lastPass = tracker.LastPass[static_cast<int>(tracker.Queue)];
+        uint32_t srcFamily = m_DeviceRef.GetQueueFamilyIndex(tracker.Queue);
+        uint32_t dstFamily = m_DeviceRef.GetQueueFamilyIndex(queue);
+        VkPipelineStageFlags srcStages = tracker.WriteStages | tracker.ReadStages;
+
+        if (srcFamily != dstFamily)
+        {
+            if (lastPass < 0)
+                throw std::runtime_error("Render graph resource '" + m_Resources[resource].Name + "' changes queue family before any pass released it");
+
+            AddBarrier(m_Passes[lastPass].After, resource,
+                       srcStages, tracker.WriteAccess, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                       tracker.Layout, tracker.Layout, srcFamily, dstFamily);
+            AddBarrier(before, resource,
+                       VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, info.Stage, info.Access,
+                       tracker.Layout, tracker.Layout, srcFamily, dstFamily);
+        }
+        else if (lastPass >= 0)
+        {
+            // Same family: an ordinary barrier on the source queue, with the semaphore between the submits
+            // ordering the rest, as VulkanQueueOwnershipTransfer does.
+            AddBarrier(m_Passes[lastPass].After, resource,
+                       srcStages, tracker.WriteAccess, info.Stage, info.Access,
+                       tracker.Layout, tracker.Layout);
+        }
+        tracker.Queue = queue;
+        handedOver = true;
+    }
+
+    if (handedOver)
+    {
+        // The handover made earlier work visible to exactly this access.
+        tracker.WriteStages = 0;
+        tracker.WriteAccess = 0;
+        tracker.ReadStages = 0;
+        if (layout != tracker.Layout)
+        {
+            tracker.WriteStages = info.Stage;
+            tracker.VisibleStages = info.Stage;
+            tracker.VisibleAccess = info.Access;
+        }
+    }
+
+    const bool layoutChange = layout != tracker.Layout;
+    VkPipelineStageFlags srcStages;
+    bool hazard;
+    if (write || layoutChange)
+    {
+        // Write after write or read, or a layout transition, which is a write as far as hazards go.
+        srcStages = tracker.WriteStages | tracker.ReadStages;
+        hazard = srcStages != 0 || layoutChange;
+    }
+    else
+    {
+        // Read after write, unless an earlier barrier already made the write visible to this read.
+        srcStages = tracker.WriteStages;
+        hazard = tracker.WriteStages != 0
+                 && ((info.Stage & ~tracker.VisibleStages) != 0 || (info.Access & ~tracker.VisibleAccess) != 0);
+    }
+
+    if (hazard && !(handedOver && !layoutChange))
+    {
+        AddBarrier(before, resource,
+                   srcStages, tracker.WriteAccess, info.Stage, info.Access,
+                   tracker.Layout, layout);
+    }
+
+    if (write || layoutChange)
+    {
+        tracker.WriteStages = info.Stage;
+        tracker.WriteAccess = info.WriteAccess;
+        tracker.ReadStages = write ? 0 : info.Stage;
+        tracker.VisibleStages = write ? 0 : info.Stage;
+        tracker.VisibleAccess = write ? 0 : info.Access;
+    }
+    else
+    {
+        tracker.ReadStages |= info.Stage;
+        if (hazard || handedOver)
+        {
+            tracker.VisibleStages |= info.Stage;
+            tracker.VisibleAccess |= info.Access;
+        }
+    }
+
+    tracker.Layout = layout;
+    tracker.LastPass[static_cast<int>(queue)] = passIndex;
+}
+
+void RenderGraph::ApplyExport(Tracker& tracker, RenderGraphResource resource)
+{
+    Resource& target = m_Resources[resource];
+    if (!target.Exported)
+    {
+        target.Final = { tracker.Queue, tracker.LastUsage, tracker.Layout, tracker.AcquirePending, tracker.ReleasedFrom };
+        return;
+    }
+
+    const UsageInfo info = GetUsageInfo(target.ExportUsage);
+    const bool isImage = target.Image != VK_NULL_HANDLE;
+    const VkImageLayout layout = isImage ? target.ExportLayout : tracker.Layout;
+    const int lastPass = tracker.LastPass[static_cast<int>(tracker.Queue)];
+
+    if (tracker.AcquirePending)
+    {
+        // Untouched since the previous release; the next execution acquires it instead.
+        target.Final = { tracker.Queue, RenderGraphUsage::None, tracker.Layout, true, tracker.ReleasedFrom };
+        return;
+    }
+
+    if (target.ExportQueue != tracker.Queue)
+    {
+        uint32_t srcFamily = m_DeviceRef.GetQueueFamilyIndex(tracker.Queue);
+        uint32_t dstFamily = m_DeviceRef.GetQueueFamilyIndex(target.ExportQueue);
+        VkPipelineStageFlags srcStages = tracker.WriteStages | tracker.ReadStages;
+
+        if (srcFamily != dstFamily)
+        {
+            if (lastPass < 0)
+                throw std::runtime_error("Render graph resource '" + target.Name + "' is exported to another queue family but no pass released it");
+
+            AddBarrier(m_Passes[lastPass].After, resource,
+                       srcStages, tracker.WriteAccess, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                       tracker.Layout, tracker.Layout, srcFamily, dstFamily);
+            target.Final = { target.ExportQueue, RenderGraphUsage::None, tracker.Layout, true, tracker.Queue };
+        }
+        else
+        {
+            if (lastPass >= 0)
+            {
+                AddBarrier(m_Passes[lastPass].After, resource,
+                           srcStages, tracker.WriteAccess, info.Stage, info.Access,
+                           tracker.Layout, tracker.Layout);
+            }
+            target.Final = { target.ExportQueue, RenderGraphUsage::None, tracker.Layout, false, tracker.Queue };
+        }
+        return;
+    }
+
+    // Same queue: only a layout change is owed, recorded after the last pass that used the resource.
+    if (layout != tracker.Layout)
+    {
+        if (lastPass < 0)
+            throw std::runtime_error("Render graph resource '" + target.Name + "' needs a layout change but no pass uses it");
+
+        AddBarrier(m_Passes[lastPass].After, resource,
+                   tracker.WriteStages | tracker.ReadStages, tracker.WriteAccess, info.Stage, info.Access,
+                   tracker.Layout, layout);
+        target.Final = { tracker.Queue, RenderGraphUsage::None, layout, false, tracker.ReleasedFrom };
+        return;
+    }
+
+    target.Final = { tracker.Queue, tracker.LastUsage, tracker.Layout, false, tracker.ReleasedFrom };
+}
+
+void RenderGraph::Compile()
+{
+    assert(!m_Compiled && "Render graph compiled twice");
+
+    CullPasses();
+
+    std::vector<Tracker> trackers(m_Resources.size());
+    for (size_t i = 0; i < m_Resources.size(); i++)
+        InitializeTracker(trackers[i], m_Resources[i]);
+
+    for (size_t passIndex = 0; passIndex < m_Passes.size(); passIndex++)
+    {
+        const Pass& pass = m_Passes[passIndex];
+        if (pass.Culled)
+            continue;
+
+        for (const Access& access : pass.Accesses)
+        {
+            Tracker& tracker = trackers[access.Resource];
+            ApplyAccess(static_cast<int>(passIndex), tracker, access.Resource, pass.Queue,
+                        GetUsageInfo(access.Usage), access.Layout, access.Write);
+            tracker.LastUsage = access.Usage;
+        }
+    }
+
+    for (size_t i = 0; i < m_Resources.size(); i++)
+        ApplyExport(trackers[i], static_cast<RenderGraphResource>(i));
+
+    m_Compiled = true;
+}
+
+void RenderGraph::BarrierBatch::Record(VulkanDevice& deviceRef, VkCommandBuffer cmdBuffer) const
+{
+    if (IsEmpty())
+        return;
+
+    VulkanBarrierBuilder barriers(deviceRef);
+    for (const VkImageMemoryBarrier2& barrier : ImageBarriers)
+        barriers.Image(barrier);
+    for (const VkBufferMemoryBarrier2& barrier : BufferBarriers)
+        barriers.Buffer(barrier);
+    barriers.Record(cmdBuffer);
+}
+
+void RenderGraph::Execute(QueueType queue, VkCommandBuffer cmdBuffer) const
+{
+    assert(m_Compiled && "Render graph executed before Compile");
+
+    for (const Pass& pass : m_Passes)
+    {
+        if (pass.Culled || pass.Queue != queue)
+            continue;
+
+        pass.Before.Record(m_DeviceRef, cmdBuffer);
+        {
+            ScopedGpuMarker marker(m_DeviceRef.GetGpuProfiler(), cmdBuffer, queue, pass.Name);
+            pass.Execute(cmdBuffer);
+        }
+        pass.After.Record(m_DeviceRef, cmdBuffer);
+    }
+}
+
+const RenderGraphResourceState& RenderGraph::GetFinalState(RenderGraphResource resource) const
+{
+    assert(m_Compiled && resource < m_Resources.size());
+    return m_Resources[resource].Final;
+}
+
+uint32_t RenderGraph::GetBarrierCount() const
+{
+    uint32_t count = 0;
+    for (const Pass& pass : m_Passes)
+    {
+        count += static_cast<uint32_t>(pass.Before.ImageBarriers.size() + pass.Before.BufferBarriers.size());
+        count += static_cast<uint32_t>(pass.After.ImageBarriers.size() + pass.After.BufferBarriers.size());
+    }
+    return count;
+}
+
+void RenderGraph::Dump(std::ostream& out) const
+{
+    uint32_t culled = 0;
+    uint32_t batches = 0;
+    for (const Pass& pass : m_Passes)
+    {
+        culled += pass.Culled ? 1 : 0;
+        batches += (pass.Before.IsEmpty() ? 0 : 1) + (pass.After.IsEmpty() ? 0 : 1);
+    }
+
+    out << "Render graph: " << m_Passes.size() << " passes (" << culled << " culled), "
+        << GetBarrierCount() << " barriers in " << batches << " barrier calls\n";
+
+    out << "  Resources:\n";
+    for (const Resource& resource : m_Resources)
+    {
+        out << "    " << resource.Name << (resource.Image ? " (image)" : " (buffer)")
+            << " " << GetQueueName(resource.Initial.Queue) << "/" << GetUsageName(resource.Initial.Usage)
+            << (resource.Image ? std::string("/") + GetLayoutName(resource.Initial.Layout) : "")
+            << (resource.Initial.AcquirePending ? " acquire pending" : "");
+        if (m_Compiled)
+        {
+            out << " -> " << GetQueueName(resource.Final.Queue) << "/" << GetUsageName(resource.Final.Usage)
+                << (resource.Image ? std::string("/") + GetLayoutName(resource.Final.Layout) : "")
+                << (resource.Final.AcquirePending ? " release recorded" : "");
+        }
+        out << "\n";
+    }
+
+    auto dumpBatch = [&](const char* label, const BarrierBatch& batch)
+    {
+        if (batch.IsEmpty())
+            return;
+
+        out << "      " << label << ": stages 0x" << std::hex << batch.SrcStageMask << " -> 0x" << batch.DstStageMask << std::dec << "\n";
+        for (size_t i = 0; i < batch.ImageBarriers.size(); i++)
+        {
+            const VkImageMemoryBarrier2& barrier = batch.ImageBarriers[i];
+            out << "        " << m_Resources[batch.Resources[i]].Name
+                << " access 0x" << std::hex << barrier.srcAccessMask << " -> 0x" << barrier.dstAccessMask << std::dec
+                << " " << GetLayoutName(barrier.oldLayout) << " -> " << GetLayoutName(barrier.newLayout);
+            if (barrier.srcQueueFamilyIndex != barrier.dstQueueFamilyIndex)
+                out << " family " << barrier.srcQueueFamilyIndex << " -> " << barrier.dstQueueFamilyIndex;
+            out << "\n";
+        }
+        for (size_t i = 0; i < batch.BufferBarriers.size(); i++)
+        {
+            const VkBufferMemoryBarrier2& barrier = batch.BufferBarriers[i];
+            out << "        " << m_Resources[batch.Resources[batch.ImageBarriers.size() + i]].Name
+                << " access 0x" << std::hex << barrier.srcAccessMask << " -> 0x" << barrier.dstAccessMask << std::dec;
+            if (barrier.srcQueueFamilyIndex != barrier.dstQueueFamilyIndex)
+                out << " family " << barrier.srcQueueFamilyIndex << " -> " << barrier.dstQueueFamilyIndex;
+            out << "\n";
+        }
+    };
+
+    out << "  Passes:\n";
+    for (size_t i = 0; i < m_Passes.size(); i++)
+    {
+        const Pass& pass = m_Passes[i];
+        out << "    [" << i << "] " << pass.Name << " (" << GetQueueName(pass.Queue) << ")"
+            << (pass.Culled ? " culled" : "") << (pass.HasSideEffects ? " side effects" : "") << "\n";
+
+        for (const Access& access : pass.Accesses)
+        {
+            const Resource& resource = m_Resources[access.Resource];
+            out << "      " << (access.Write ? "write " : "read ") << resource.Name << " " << GetUsageName(access.Usage);
+            if (resource.Image)
+                out << " " << GetLayoutName(access.Layout);
+            out << "\n";
+        }
+
+        if (!pass.Culled)
+        {
+            dumpBatch("before", pass.Before);
+            dumpBatch("after", pass.After);
+        }
+    }
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "renderer/vulkan/vulkan_device.h"
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// How a pass touches a resource. Each usage implies the pipeline stage, access mask and (for images)
+// default layout the graph synchronizes against.
+enum class RenderGraphUsage
+{
+    None,               // Not accessed, or synchronized outside the graph
+    ComputeRead,
+    ComputeWrite,
+    ComputeReadWrite,
+    FragmentRead,       // Sampled or storage reads from fragment shaders
+    ColorAttachment,
+    TransferRead,
+    TransferWrite,
+    HostRead,
+    Present
+};
+
+using RenderGraphResource = uint32_t;
+
+// Where a resource stands between graph executions: the queue that owns it, its last access and layout.
+struct RenderGraphResourceState
+{
+    QueueType Queue = QueueType::Graphics;
+    RenderGraphUsage Usage = RenderGraphUsage::None;
+    VkImageLayout Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    // The previous execution released the resource from ReleasedFrom's family to Queue's; the graph
+    // records the matching acquire before the first pass that uses it.
+    bool AcquirePending = false;
+    QueueType ReleasedFrom = QueueType::Graphics;
+};
+
+// A frame described as passes that declare which named resources they read and write. Compile culls the
+// passes nothing depends on and derives the barriers between the rest: only where a hazard or layout
+// change exists, with the exact stages and accesses of both sides, batched into one VulkanBarrierBuilder
+// call before (and, for queue releases, after) each pass. Passes may run on different queues; when a resource
+// moves between queue families the graph records the release and acquire halves, while the caller still
+// orders the submits with semaphores.
+//
+// Passes run in declaration order, and a resource may only be declared once per pass (use ComputeReadWrite
+// rather than a read and a write).
+class RenderGraph
+{
+public:
+    class PassBuilder
+    {
+    public:
+        // layout overrides the usage's default, e.g. for storage images sampled in GENERAL.
+        PassBuilder& Read(RenderGraphResource resource, RenderGraphUsage usage, VkImageLayout layout = VK_IMAGE_LAYOUT_MAX_ENUM);
+        PassBuilder& Write(RenderGraphResource resource, RenderGraphUsage usage, VkImageLayout layout = VK_IMAGE_LAYOUT_MAX_ENUM);
+        // The pass has effects outside the graph (presenting, host readback), so it is never culled.
+        PassBuilder& SideEffects();
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph& graph, uint32_t passIndex) : m_Graph(graph), m_PassIndex(passIndex) {}
+
+        RenderGraph& m_Graph;
+        uint32_t m_PassIndex;
+    };
+
+    explicit RenderGraph(VulkanDevice& deviceRef);
+
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    RenderGraphResource ImportImage(
+            const std::string& name,
+            VkImage image,
+            const VkImageSubresourceRange& subresourceRange,
+            const RenderGraphResourceState& state);
+    RenderGraphResource ImportBuffer(const std::string& name, VkBuffer buffer, const RenderGraphResourceState& state);
+
+    // The state the resource must be left in once every pass has run. Exported resources keep the passes
+    // that write them alive.
+    void Export(RenderGraphResource resource, QueueType queue, RenderGraphUsage usage, VkImageLayout layout = VK_IMAGE_LAYOUT_MAX_ENUM);
+
+    PassBuilder AddPass(const std::string& name, QueueType queue, std::function<void(VkCommandBuffer)> execute);
+
+    void Compile();
+    // Records the live passes of one queue, in order, with their barriers. Each pass is a GPU profiler scope.
+    void Execute(QueueType queue, VkCommandBuffer cmdBuffer) const;
+
+    // The state to import the resource with next time. Only valid after Compile.
+    [[nodiscard]] const RenderGraphResourceState& GetFinalState(RenderGraphResource resource) const;
+    [[nodiscard]] uint32_t GetBarrierCount() const;
+
+    void Dump(std::ostream& out) const;
+
+private:
+    struct UsageInfo
+    {
+        VkPipelineStageFlags Stage;
+        VkAccessFlags Access;
+        VkAccessFlags WriteAccess;
+        VkImageLayout Layout;
+    };
+
+    struct Resource
+    {
+        std::string Name;
+        VkImage Image = VK_NULL_HANDLE;
+        VkBuffer Buffer = VK_NULL_HANDLE;
+        VkImageSubresourceRange SubresourceRange{};
+        RenderGraphResourceState Initial;
+        RenderGraphResourceState Final;
+
+        bool Exported = false;
+        QueueType ExportQueue = QueueType::Graphics;
+        RenderGraphUsage ExportUsage = RenderGraphUsage::None;
+        VkImageLayout ExportLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    };
+
+    struct Access
+    {
+        RenderGraphResource Resource;
+        RenderGraphUsage Usage;
+        VkImageLayout Layout;
+        bool Write;
+    };
+
+    struct BarrierBatch
+    {
+        // Union of the barriers' stages, for the dump; each barrier keeps its own masks.
+        VkPipelineStageFlags SrcStageMask = 0;
+        VkPipelineStageFlags DstStageMask = 0;
+        std::vector<VkImageMemoryBarrier2> ImageBarriers;
+        std::vector<VkBufferMemoryBarrier2> BufferBarriers;
+        // Resource of each barrier, images first, for the dump.
+        std::vector<RenderGraphResource> Resources;
+
+        [[nodiscard]] bool IsEmpty() const { return ImageBarriers.empty() && BufferBarriers.empty(); }
+        void Record(VulkanDevice& deviceRef, VkCommandBuffer cmdBuffer) const;
+    };
+
+    struct Pass
+    {
+        std::string Name;
+        QueueType Queue;
+        std::function<void(VkCommandBuffer)> Execute;
+        std::vector<Access> Accesses;
+        bool HasSideEffects = false;
+        bool Culled = false;
+
+        BarrierBatch Before;
+        BarrierBatch After;
+    };
+
+    // Synchronization scope of everything that touched a resource since its last barrier.
+    struct Tracker
+    {
+        QueueType Queue;
+        VkImageLayout Layout;
+        VkPipelineStageFlags WriteStages = 0;
+        VkAccessFlags WriteAccess = 0;
+        VkPipelineStageFlags ReadStages = 0;
+        // Stages and accesses the last write has already been made visible to.
+        VkPipelineStageFlags VisibleStages = 0;
+        VkAccessFlags VisibleAccess = 0;
+        bool AcquirePending = false;
+        QueueType ReleasedFrom;
+        RenderGraphUsage LastUsage = RenderGraphUsage::None;
+        // Last live pass on each queue that touched the resource, where releases are recorded.
+        int LastPass[3] = {-1, -1, -1};
+    };
+
+    static UsageInfo GetUsageInfo(RenderGraphUsage usage);
+    static const char* GetUsageName(RenderGraphUsage usage);
+    static const char* GetQueueName(QueueType queue);
+
+    void AddAccess(uint32_t passIndex, RenderGraphResource resource, RenderGraphUsage usage, VkImageLayout layout, bool write);
+    void CullPasses();
+    void InitializeTracker(Tracker& tracker, const Resource& resource) const;
+    void ApplyAccess(int passIndex, Tracker& tracker, RenderGraphResource resource, QueueType queue, const UsageInfo& info, VkImageLayout layout, bool write);
+    void ApplyExport(Tracker& tracker, RenderGraphResource resource);
+    void AddBarrier(
+            BarrierBatch& batch,
+            RenderGraphResource resource,
+            VkPipelineStageFlags srcStageMask, VkAccessFlags srcAccessMask,
+            VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask,
+            VkImageLayout oldLayout, VkImageLayout newLayout,
+            uint32_t srcFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            uint32_t dstFamilyIndex = VK_QUEUE_FAMILY_IGNORED) const;
+
+private:
+    VulkanDevice& m_DeviceRef;
+    std::vector<Resource> m_Resources;
+    std::vector<Pass> m_Passes;
+    bool m_Compiled = false;
+};
@@ -0,0 +1,229 @@
+#include "sampler_tables.h"
+#include "core/profiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace
+{
+    // Primitive polynomials and initial direction numbers from Joe and Kuo's new-joe-kuo-6.21201,
+    // for the dimensions after the first, which is the van der Corput sequence.
+    struct SobolPolynomial
+    {
+        uint32_t Degree;
+        uint32_t Coefficients;
+        uint32_t InitialNumbers[3];
+    };
+
+    constexpr SobolPolynomial SobolPolynomials[SamplerTables::SobolDimensionCount - 1] =
+    {
+        { 1, 0, { 1 } },
+        { 2, 1, { 1, 3 } },
+        { 3, 1, { 1, 3, 1 } },
+    };
+}
+
+const char* GetSamplerName(SamplerType sampler)
+{
+    switch (sampler)
+    {
+        case SamplerType::Random: return "Random";
+        case SamplerType::Sobol: return "Sobol";
+        case SamplerType::BlueNoise: return "Blue noise";
+    }
+    return "Unknown";
+}
+
+SamplerTables SamplerTables::Generate(uint32_t seed)
+{
+    PROFILE_ZONE("SamplerTables::Generate");
+    SamplerTables tables;
+
+    tables.m_SobolMatrices.reserve(SobolDimensionCount * SobolBitCount);
+    for (uint32_t dimension = 0; dimension < SobolDimensionCount; dimension++)
+    {
+        std::vector<uint32_t> matrix = GenerateSobolMatrix(dimension);
+        tables.m_SobolMatrices.insert(tables.m_SobolMatrices.end(), matrix.begin(), matrix.end());
+    }
+
+    tables.m_BlueNoise.reserve(BlueNoiseSize * BlueNoiseSize * BlueNoiseChannelCount);
+    for (uint32_t channel = 0; channel < BlueNoiseChannelCount; channel++)
+    {
+        std::vector<float> tile = GenerateBlueNoise(BlueNoiseSize, seed + channel);
+        tables.m_BlueNoise.insert(tables.m_BlueNoise.end(), tile.begin(), tile.end());
+    }
+
+    return tables;
+}
+
+std::vector<uint32_t> SamplerTables::GenerateSobolMatrix(uint32_t dimension)
+{
+    assert(dimension < SobolDimensionCount && "No direction numbers for this Sobol dimension");
+
+    std::vector<uint32_t> directions(SobolBitCount);
+    if (dimension == 0)
+    {
+        for (uint32_t bit = 0; bit < SobolBitCount; bit++)
+            directions[bit] = 1u << (31 - bit);
+        return directions;
+    }
+
+    const SobolPolynomial& polynomial = SobolPolynomials[dimension - 1];
+    const uint32_t degree = polynomial.Degree;
+    for (uint32_t bit = 0; bit < SobolBitCount; bit++)
+    {
+        if (bit < degree)
+        {
+            directions[bit] = polynomial.InitialNumbers[bit] << (31 - bit);
+            continue;
+        }
+
+        // v_i = a_1 v_(i-1) ^ ... ^ a_(s-1) v_(i-s+1) ^ v_(i-s) ^ (v_(i-s) >> s)
+        uint32_t direction = directions[bit - degree] ^ (directions[bit - degree] >> degree);
+        for (uint32_t k = 1; k < degree; k++)
+        {
+            if ((polynomial.Coefficients >> (degree - 1 - k)) & 1)
+                direction ^= directions[bit - k];
+        }
+        directions[bit] = direction;
+    }
+    return directions;
+}
+
+std::vector<float> SamplerTables::GenerateBlueNoise(uint32_t size, uint32_t seed)
+{
+    // Ulichney's void-and-cluster on a torus. Energy is a Gaussian splat of every set pixel; the tightest
+    // cluster is the set pixel with the most energy and the largest void the empty pixel with the least.
+    const uint32_t pixelCount = size * size;
+    constexpr float Sigma = 1.5f;
+
+    // The Gaussian is below 1e-7 beyond this radius, so splats only touch a small window around each pixel.
+    const int32_t radius = std::min(static_cast<int32_t>(std::ceil(6.0f * Sigma)), static_cast<int32_t>(size / 2) - 1);
+    const int32_t windowSize = 2 * radius + 1;
+    std::vector<float> kernel(windowSize * windowSize);
+    for (int32_t dy = -radius; dy <= radius; dy++)
+    {
+        for (int32_t dx = -radius; dx <= radius; dx++)
+            kernel[(dy + radius) * windowSize + dx + radius] = std::exp(-static_cast<float>(dx * dx + dy * dy) / (2.0f * Sigma * Sigma));
+    }
+
+    std::vector<uint8_t> pattern(pixelCount, 0);
+    std::vector<float> energy(pixelCount, 0.0f);
+    auto splat = [&](uint32_t pixel, float sign)
+    {
+        const int32_t px = static_cast<int32_t>(pixel % size);
+        const int32_t py = static_cast<int32_t>(pixel / size);
+        const int32_t wrap = static_cast<int32_t>(size);
+        for (int32_t dy = -radius; dy <= radius; dy++)
+        {
+            float* energyRow = energy.data() + ((py + dy + wrap) % wrap) * wrap;
+            const float* kernelRow = kernel.data() + (dy + radius) * windowSize + radius;
+            for (int32_t dx = -radius; dx <= radius; dx++)
+                energyRow[(px + dx + wrap) % wrap] += sign * kernelRow[dx];
+        }
+    };
+    auto tightestCluster = [&]()
+    {
+        uint32_t best = 0;
+        float bestEnergy = -1.0f;
+        for (uint32_t i = 0; i < pixelCount; i++)
+        {
+            if (pattern[i] && energy[i] > bestEnergy)
+            {
+                best = i;
+                bestEnergy = energy[i];
+            }
+        }
+        return best;
+    };
+    auto largestVoid = [&]()
+    {
+        uint32_t best = 0;
+        float bestEnergy = INFINITY;
+        for (uint32_t i = 0; i < pixelCount; i++)
+        {
+            if (!pattern[i] && energy[i] < bestEnergy)
+            {
+                best = i;
+                bestEnergy = energy[i];
+            }
+        }
+        return best;
+    };
+
+    // Initial pattern: a tenth of the pixels at random, then relaxed by moving the tightest cluster into
+    // the largest void until that stops changing anything.
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<uint32_t> pick(0, pixelCount - 1);
+    const uint32_t initialCount = std::max(1u, pixelCount / 10);
+    for (uint32_t placed = 0; placed < initialCount;)
+    {
+        const uint32_t pixel = pick(rng);
+        if (pattern[pixel])
+            continue;
+        pattern[pixel] = 1;
+        splat(pixel, 1.0f);
+        placed++;
+    }
+
+    for (uint32_t iteration = 0; iteration < pixelCount; iteration++)
+    {
+        const uint32_t cluster = tightestCluster();
+        pattern[cluster] = 0;
+        splat(cluster, -1.0f);
+
+        const uint32_t voidPixel = largestVoid();
+        pattern[voidPixel] = 1;
+        splat(voidPixel, 1.0f);
+        if (voidPixel == cluster)
+            break;
+    }
+
+    std::vector<uint32_t> ranks(pixelCount, 0);
+
+    // Phase 1: rank the initial pattern by taking its tightest clusters away, highest rank first.
+    std::vector<uint8_t> initialPattern = pattern;
+    std::vector<float> initialEnergy = energy;
+    for (uint32_t rank = initialCount; rank-- > 0;)
+    {
+        const uint32_t cluster = tightestCluster();
+        pattern[cluster] = 0;
+        splat(cluster, -1.0f);
+        ranks[cluster] = rank;
+    }
+
+    // Phase 2: fill the largest voids in turn until every pixel has a rank.
+    pattern = std::move(initialPattern);
+    energy = std::move(initialEnergy);
+    for (uint32_t rank = initialCount; rank < pixelCount; rank++)
+    {
+        const uint32_t voidPixel = largestVoid();
+        pattern[voidPixel] = 1;
+        splat(voidPixel, 1.0f);
+        ranks[voidPixel] = rank;
+    }
+
+    std::vector<float> values(pixelCount);
+    for (uint32_t i = 0; i < pixelCount; i++)
+        values[i] = (static_cast<float>(ranks[i]) + 0.5f) / static_cast<float>(pixelCount);
+    return values;
+}
+
+std::vector<uint8_t> SamplerTables::Serialize() const
+{
+    Header header;
+    header.BlueNoiseSize = BlueNoiseSize;
+    header.BlueNoiseChannelCount = BlueNoiseChannelCount;
+    header.SobolDimensionCount = SobolDimensionCount;
+
+    const size_t sobolBytes = m_SobolMatrices.size() * sizeof(uint32_t);
+    const size_t blueNoiseBytes = m_BlueNoise.size() * sizeof(float);
+    std::vector<uint8_t> bytes(sizeof(Header) + sobolBytes + blueNoiseBytes);
+    std::memcpy(bytes.data(), &header, sizeof(Header));
+    std::memcpy(bytes.data() + sizeof(Header), m_SobolMatrices.data(), sobolBytes);
+    std::memcpy(bytes.data() + sizeof(Header) + sobolBytes, m_BlueNoise.data(), blueNoiseBytes);
+    return bytes;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// How the path tracers draw their random numbers. Chosen when a tracer's pipelines are created, through
+// specialization constant 0 (SAMPLER_TYPE in path_tracing.glsl), so the unused paths compile away.
+enum class SamplerType : uint32_t
+{
+    Random = 0,     // Independent PCG numbers per pixel
+    Sobol = 1,      // Owen-scrambled Sobol, scrambled per pixel
+    BlueNoise = 2   // One Owen-scrambled Sobol sequence for every pixel, rotated per pixel by blue noise
+};
+
+const char* GetSamplerName(SamplerType sampler);
+
+// Tables the low-discrepancy samplers index by pixel, sample and dimension. Generated once on the CPU and
+// uploaded as one storage buffer (see the SamplerTables block in path_tracing.glsl).
+//
+// Only four Sobol dimensions are stored. Higher dimensions reuse them in groups of four with the sample
+// index shuffled per group by its own scramble, which keeps each group well stratified and the groups
+// uncorrelated without direction numbers for hundreds of dimensions.
+class SamplerTables
+{
+public:
+    static constexpr uint32_t SobolDimensionCount = 4;
+    static constexpr uint32_t SobolBitCount = 32;
+    static constexpr uint32_t BlueNoiseSize = 64;
+    static constexpr uint32_t BlueNoiseChannelCount = 4;
+
+    // Matches the SamplerTables block header in path_tracing.glsl.
+    struct Header
+    {
+        uint32_t BlueNoiseSize = 0;
+        uint32_t BlueNoiseChannelCount = 0;
+        uint32_t SobolDimensionCount = 0;
+        uint32_t Pad = 0;
+    };
+
+    static SamplerTables Generate(uint32_t seed = 0x5eed5eedu);
+
+    // Direction numbers of one Sobol dimension, most significant bit first.
+    static std::vector<uint32_t> GenerateSobolMatrix(uint32_t dimension);
+    // A size x size tile of the ranks 0..size^2-1 spread by void-and-cluster, mapped to [0, 1).
+    static std::vector<float> GenerateBlueNoise(uint32_t size, uint32_t seed);
+
+    // Header, then the Sobol matrices, then the blue noise channels one after another.
+    [[nodiscard]] std::vector<uint8_t> Serialize() const;
+
+    [[nodiscard]] const std::vector<uint32_t>& GetSobolMatrices() const { return m_SobolMatrices; }
+    [[nodiscard]] const std::vector<float>& GetBlueNoise() const { return m_BlueNoise; }
+
+private:
+    std::vector<uint32_t> m_SobolMatrices;
+    std::vector<float> m_BlueNoise;
+};
@@ -1,8 +1,14 @@
 #include "scratch_renderer.h"
 #include "renderer/vulkan/vulkan_utils.h"
+#include "renderer/vulkan/vulkan_gpu_profiler.h"
 #include "core/frame_info.h"
+#include "core/profiler.h"
 #include "scene/scene.h"
 
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <iostream>
 #include <memory>
 #include <sstream>
 
@@ -14,10 +20,117 @@ RTRenderer::RTRenderer(Window &windowRef, VulkanDevice &deviceRef)
 
 RTRenderer::~RTRenderer()
 {
+    for (auto semaphore : m_PresentCompleteSemaphores)
+        vkDestroySemaphore(m_DeviceRef.GetDevice(), semaphore, nullptr);
+    for (auto semaphore : m_RenderCompleteSemaphores)
+        vkDestroySemaphore(m_DeviceRef.GetDevice(), semaphore, nullptr);
+    for (auto semaphore : m_TraceCompleteSemaphores)
+        vkDestroySemaphore(m_DeviceRef.GetDevice(), semaphore, nullptr);
+    for (auto semaphore : m_CompositeCompleteSemaphores)
+        vkDestroySemaphore(m_DeviceRef.GetDevice(), semaphore, nullptr);
+    for (auto fence : m_WaitFences)
+        vkDestroyFence(m_DeviceRef.GetDevice(), fence, nullptr);
+}
+
+void RTRenderer::CreateBindlessTable()
+{
+    m_BindlessTable = std::make_unique<VulkanBindlessTable>(m_DeviceRef);
 
+    // Slot 0 always holds the fallback texture so a material never samples an empty descriptor.
+    TextureSpecification missingSpec{};
+    missingSpec.DebugName = "Missing Texture";
+    m_MissingTexture = std::make_shared<VulkanTexture2D>(m_DeviceRef, missingSpec, "../assets/textures/missing.png");
+    m_MissingTextureHandle = m_BindlessTable->RegisterTexture(m_MissingTexture->GetDescriptorInfo());
+
+    m_TextureCache = std::make_unique<VulkanTextureCache>(m_DeviceRef);
 }
 
-void RTRenderer::CreateSphereBuffers()
+BindlessHandle RTRenderer::LoadTexture(const std::string& filepath, TextureSpecification specification)
+{
+    BindlessHandle handle = m_BindlessTable->RegisterTexture(m_MissingTexture->GetDescriptorInfo());
+    // A recycled slot no longer stands for whatever texture it was a placeholder of.
+    m_LoadedTextureHandles.erase(handle);
+    m_PendingTextures.push_back({handle, m_TextureCache->Load(filepath, specification)});
+    return handle;
+}
+
+BindlessHandle RTRenderer::AddTexture(std::shared_ptr<VulkanTexture2D> texture)
+{
+    BindlessHandle handle = m_BindlessTable->RegisterTexture(texture->GetDescriptorInfo());
+    m_LoadedTextureHandles.erase(handle);
+    m_StreamedTextures[handle] = std::move(texture);
+    return handle;
+}
+
+void RTRenderer::SetSphereAlbedo(uint32_t sphereIndex, BindlessHandle handle)
+{
+    assert(sphereIndex < m_Spheres.size() && "Sphere index out of range");
+
+    auto loaded = m_LoadedTextureHandles.find(handle);
+    if (loaded != m_LoadedTextureHandles.end())
+        handle = loaded->second;
+
+    // The sphere buffers may still be read by frames in flight.
+    vkDeviceWaitIdle(m_DeviceRef.GetDevice());
+    m_Spheres[sphereIndex].Material.TextureHandles.x = handle;
+    UploadSphereBuffers();
+    m_AccumulationIndex = 0;
+}
+
+void RTRenderer::UpdateStreamedTextures()
+{
+    PROFILE_ZONE("RTRenderer::UpdateStreamedTextures");
+    m_TextureCache->Update();
+
+    bool spheresChanged = false;
+    for (auto it = m_PendingTextures.begin(); it != m_PendingTextures.end();)
+    {
+        if (it->Texture.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++it;
+            continue;
+        }
+
+        // Failures were reported by the cache; the slot keeps the placeholder.
+        if (std::shared_ptr<VulkanTexture2D> texture = it->Texture.get())
+        {
+            // Submitted frames may be sampling the placeholder slot, and update-after-bind only allows writing
+            // slots no pending command buffer uses. The texture goes to a fresh slot instead, and the
+            // placeholder's is released, which holds it back from reuse until those frames have finished.
+            BindlessHandle handle = m_BindlessTable->RegisterTexture(texture->GetDescriptorInfo());
+            m_LoadedTextureHandles.erase(handle);
+            m_StreamedTextures[handle] = std::move(texture);
+            m_LoadedTextureHandles[it->Handle] = handle;
+
+            for (Sphere& sphere : m_Spheres)
+            {
+                if (sphere.Material.TextureHandles.x != it->Handle)
+                    continue;
+                sphere.Material.TextureHandles.x = handle;
+                spheresChanged = true;
+            }
+            m_BindlessTable->ReleaseTexture(it->Handle);
+        }
+        it = m_PendingTextures.erase(it);
+    }
+
+    if (spheresChanged)
+    {
+        // The sphere buffers may still be read by frames in flight.
+        vkDeviceWaitIdle(m_DeviceRef.GetDevice());
+        UploadSphereBuffers();
+        m_AccumulationIndex = 0;
+    }
+}
+
+void RTRenderer::SetSpheres(std::vector<Sphere> spheres)
+{
+    assert(m_SphereSSBOs.empty() && "Spheres must be set before Initialize");
+    assert(!spheres.empty() && "The scene needs at least one sphere");
+    m_Spheres = std::move(spheres);
+}
+
+void RTRenderer::CreateDefaultSpheres()
 {
     Sphere sphereA
     {
@@ -50,48 +163,199 @@ void RTRenderer::CreateSphereBuffers()
                 }
     };
 
-    std::vector<Sphere> spheres { sphereA, sphereB, emissiveSphereA };
-    uint32_t sphereCount = spheres.size();
-
-    VulkanBuffer stagingBuffer {
-            m_DeviceRef,
-            sizeof(Sphere),
-            sphereCount,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-    };
+    m_Spheres = { sphereA, sphereB, emissiveSphereA };
+}
 
-    stagingBuffer.Map();
-    stagingBuffer.WriteToBuffer(spheres.data());
+void RTRenderer::CreateSphereBuffers()
+{
+    if (m_Spheres.empty())
+        CreateDefaultSpheres();
 
     m_SphereSSBOs.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
 
-    // Copy sphere data to all storage buffers
+    // Read by the fragment backend on the graphics queue and by the compute backends on the compute queue.
+    std::vector<uint32_t> sharedQueueFamilies = m_DeviceRef.GetUniqueQueueFamilyIndices(
+            { QueueType::Graphics, QueueType::Compute, QueueType::Transfer });
+
     for (size_t i = 0; i < VulkanSwapchain::MAX_FRAMES_IN_FLIGHT; i++)
     {
         m_SphereSSBOs[i] = std::make_unique<VulkanBuffer>(
                 m_DeviceRef,
                 sizeof(Sphere),
-                spheres.size(),
+                m_Spheres.size(),
                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                1,
+                sharedQueueFamilies
         );
-        m_DeviceRef.CopyBuffer(stagingBuffer.GetBuffer(), m_SphereSSBOs[i]->GetBuffer(), stagingBuffer.GetBufferSize());
     }
+
+    UploadSphereBuffers();
+    CreateEmitterBuffer();
+}
+
+void RTRenderer::CreateEmitterBuffer()
+{
+    PROFILE_ZONE("RTRenderer::CreateEmitterBuffer");
+    // Emission and radii are fixed once the scene is set; only texture handles change afterwards.
+    m_Emitters = EmitterTable::Build(m_Spheres);
+    m_EmitterSSBO = CreateComputeConstantBuffer(m_Emitters.Serialize());
+}
+
+void RTRenderer::CreateSamplerTables()
+{
+    PROFILE_ZONE("RTRenderer::CreateSamplerTables");
+    m_SamplerTablesSSBO = CreateComputeConstantBuffer(SamplerTables::Generate().Serialize());
+}
+
+std::unique_ptr<VulkanBuffer> RTRenderer::CreateComputeConstantBuffer(const std::vector<uint8_t>& data)
+{
+    auto buffer = std::make_unique<VulkanBuffer>(
+            m_DeviceRef,
+            data.size(),
+            1,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            1,
+            m_DeviceRef.GetUniqueQueueFamilyIndices({ QueueType::Compute, QueueType::Transfer }));
+
+    VulkanBuffer stagingBuffer {
+            m_DeviceRef,
+            data.size(),
+            1,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    };
+    stagingBuffer.Map();
+    stagingBuffer.WriteToBuffer(data.data());
+    m_DeviceRef.CopyBuffer(
+            stagingBuffer.GetBuffer(), buffer->GetBuffer(), stagingBuffer.GetBufferSize(),
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, QueueType::Transfer);
+    return buffer;
 }
 
-void RTRenderer::RecordFrame(int swapImageIndex, VkDescriptorSet globalSet)
+void RTRenderer::UploadSphereBuffers()
 {
-    // If the frame is even, the previous fbo is at index 1.
-    int prevIndex = m_FrameCounter % 2 == 0 ? 1 : 0;
-    int currIndex = m_FrameCounter % 2 == 0 ? 0 : 1;
-    VulkanFramebuffer& prevFbo = *m_PerFrameFramebufferMap[swapImageIndex][prevIndex];
-    VulkanFramebuffer& currFbo = *m_PerFrameFramebufferMap[swapImageIndex][currIndex];
+    PROFILE_ZONE("RTRenderer::UploadSphereBuffers");
+    VulkanBuffer stagingBuffer {
+            m_DeviceRef,
+            sizeof(Sphere),
+            static_cast<uint32_t>(m_Spheres.size()),
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    };
+    stagingBuffer.Map();
+
+    // Copy sphere data to all storage buffers. A virtual texture writes feedback to a buffer per frame in flight,
+    // so each frame's copy of its sphere names that frame's buffer.
+    for (uint32_t i = 0; i < VulkanSwapchain::MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        if (m_VirtualTexture)
+        {
+            glm::uvec3 handles = m_VirtualTexture->GetHandles(i);
+            m_Spheres[m_VirtualTextureSphere].Material.TextureHandles = { InvalidBindlessHandle, handles.x, handles.y, handles.z };
+        }
+
+        stagingBuffer.WriteToBuffer(m_Spheres.data());
+        m_DeviceRef.CopyBuffer(
+                stagingBuffer.GetBuffer(), m_SphereSSBOs[i]->GetBuffer(), stagingBuffer.GetBufferSize(),
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                QueueType::Transfer);
+    }
+}
+
+void RTRenderer::SetVirtualAlbedo(uint32_t sphereIndex, const std::string& filepath)
+{
+    assert(sphereIndex < m_Spheres.size() && "Sphere index out of range");
+
+    // The sphere buffers and the current virtual texture may still be read by frames in flight.
+    vkDeviceWaitIdle(m_DeviceRef.GetDevice());
+
+    if (m_VirtualTexture)
+        m_Spheres[m_VirtualTextureSphere].Material.TextureHandles = glm::uvec4(InvalidBindlessHandle);
+
+    m_VirtualTexture = std::make_unique<VulkanVirtualTexture>(m_DeviceRef, *m_BindlessTable, filepath);
+    m_VirtualTextureSphere = sphereIndex;
+    UploadSphereBuffers();
+    m_AccumulationIndex = 0;
+}
+
+void RTRenderer::TransitionAttachmentLayouts()
+{
+    // The render pass loads the accumulation attachments in COLOR_ATTACHMENT_OPTIMAL and leaves them there,
+    // so they only need to leave UNDEFINED once after creation (or after a resize).
+    for (auto& fbos : m_PerFrameFramebufferMap)
+    {
+        for (auto& fbo : fbos)
+        {
+            for (const auto& attachment : fbo->GetAttachments())
+            {
+                // Transient attachments start every pass UNDEFINED; their memory may be aliased anyway.
+                if (VulkanFramebuffer::IsTransient(attachment.Spec))
+                    continue;
+
+                m_DeviceRef.TransitionImageLayout(
+                        attachment.Image,
+                        attachment.Spec.Format,
+                        VK_IMAGE_LAYOUT_UNDEFINED,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1, 1);
+            }
+        }
+    }
+}
+
+void RTRenderer::WriteFrameDescriptorSets()
+{
+    const bool allocate = m_AccumulationDescriptorSets.empty();
+    m_AccumulationDescriptorSets.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
+    m_CompositionDescriptorSets.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
+
+    for (int i = 0; i < VulkanSwapchain::MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        for (int parity = 0; parity < 2; parity++)
+        {
+            // If the frame is even, the previous fbo is at index 1.
+            VulkanFramebuffer& prevFbo = *m_PerFrameFramebufferMap[i][parity == 0 ? 1 : 0];
+            VulkanFramebuffer& currFbo = *m_PerFrameFramebufferMap[i][parity];
+
+            auto bufferInfo = m_GlobalUBOs[i]->DescriptorInfo();
+            VkDescriptorImageInfo curr = currFbo.GetDescriptorImageInfoForAttachment(0, m_FramebufferColorSampler);
+            VkDescriptorImageInfo prev = prevFbo.GetDescriptorImageInfoForAttachment(1, m_FramebufferColorSampler);
+            VulkanDescriptorWriter accumulationWriter(*m_AccumulationDescriptorSetLayout, *m_DescriptorPool);
+            accumulationWriter
+                    .WriteBuffer(0, &bufferInfo)
+                    .WriteImage(1, &curr)
+                    .WriteImage(2, &prev);
+
+            VkDescriptorImageInfo accumulatedAttachment = currFbo.GetDescriptorImageInfoForAttachment(1, m_FramebufferColorSampler);
+            VulkanDescriptorWriter compositionWriter(*m_CompositeDescriptorSetLayout, *m_DescriptorPool);
+            compositionWriter.WriteImage(0, &accumulatedAttachment);
+
+            if (allocate)
+            {
+                accumulationWriter.Build(m_AccumulationDescriptorSets[i][parity]);
+                compositionWriter.Build(m_CompositionDescriptorSets[i][parity]);
+            }
+            else
+            {
+                accumulationWriter.Overwrite(m_AccumulationDescriptorSets[i][parity]);
+                compositionWriter.Overwrite(m_CompositionDescriptorSets[i][parity]);
+            }
+        }
+    }
+}
+
+void RTRenderer::RecordFrame(uint32_t swapImageIndex, const FramePushConstants& pushConstants)
+{
+    // Ping-pong between the two framebuffers of this swap image every frame.
+    const uint32_t parity = pushConstants.FrameNumber % 2;
+    VulkanFramebuffer& currFbo = *m_PerFrameFramebufferMap[swapImageIndex][parity];
     VkCommandBuffer cmdBuffer = m_DrawCommandBuffers[swapImageIndex];
 
     // Begin recording the offscreen command buffer
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
     std::array<VkClearValue, 5> clearValues{};
     clearValues[0].color = {{0.0f, 0.0f, 0.0f, 0.0f}};
@@ -109,44 +373,11 @@ void RTRenderer::RecordFrame(int swapImageIndex, VkDescriptorSet globalSet)
     renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
     renderPassBeginInfo.pClearValues = clearValues.data();
 
-
-    // Transition image layouts for current and previous framebuffers
-    for (const auto& attachment : currFbo.GetAttachments())
-    {
-        m_DeviceRef.TransitionImageLayout(
-                attachment.Image,
-                attachment.Spec.Format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1, 1);
-    }
-
-    for (const auto& attachment : prevFbo.GetAttachments())
-    {
-        m_DeviceRef.TransitionImageLayout(
-                attachment.Image,
-                attachment.Spec.Format,
-                VK_IMAGE_LAYOUT_UNDEFINED,
-                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1, 1);
-    }
-
-    // If using external attachments, ensure their layout transition as well
-    for (const auto& externalAttachment : currFbo.GetExternalAttachments())
-    {
-        VkImageLayout targetLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-        if (externalAttachment.Spec.Usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)
-        {
-            targetLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-        }
-
-        m_DeviceRef.TransitionImageLayout(
-                externalAttachment.Image,
-                externalAttachment.Spec.Format,
-                externalAttachment.Spec.InitialLayout,
-                targetLayout,
-                1,
-                1
-        );    }
-
     VK_CHECK_RESULT(vkBeginCommandBuffer(cmdBuffer, &beginInfo));
 
+    VulkanGpuProfiler& profiler = m_DeviceRef.GetGpuProfiler();
+    profiler.RecordReset(cmdBuffer);
+
     vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
     VkViewport viewport{};
     viewport.x = 0.0f;
@@ -159,45 +390,41 @@ void RTRenderer::RecordFrame(int swapImageIndex, VkDescriptorSet globalSet)
     vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
     vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
 
+    // Every pass layout shares set 0 and the push constant range, so both stay bound across pipeline switches.
+    vkCmdBindDescriptorSets(
+            cmdBuffer,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            m_MainRTPassGraphicsPipelineLayout,
+            0,
+            1,
+            &m_GlobalDescriptorSets[swapImageIndex],
+            0,
+            nullptr);
+    m_FramePushConstants->Push(cmdBuffer, m_MainRTPassGraphicsPipelineLayout, pushConstants);
+
+    // Profiler scopes stay within their subpass, as statistics queries must.
     {
-        VkDescriptorSet mainSet = m_MainRTPassDescriptorSets[swapImageIndex];
+        ScopedGpuMarker marker(profiler, cmdBuffer, QueueType::Graphics, "MainRTPass");
         RecordMainRTPass(
                 cmdBuffer,
-                globalSet,
-                mainSet);
+                m_MainRTPassDescriptorSets[swapImageIndex],
+                m_BindlessTable->GetDescriptorSet());
     }
 
+    vkCmdNextSubpass(cmdBuffer, VK_SUBPASS_CONTENTS_INLINE);
     {
-        vkCmdNextSubpass(cmdBuffer, VK_SUBPASS_CONTENTS_INLINE);
-
-        VkDescriptorSet accumulationSet;
-        auto bufferInfo = m_GlobalUBOs[swapImageIndex]->DescriptorInfo();
-        VkDescriptorImageInfo curr = currFbo.GetDescriptorImageInfoForAttachment(0, m_FramebufferColorSampler);
-        VkDescriptorImageInfo prev = prevFbo.GetDescriptorImageInfoForAttachment(1, m_FramebufferColorSampler);
-        VulkanDescriptorWriter(*m_AccumulationDescriptorSetLayout, *m_DescriptorPool)
-                .WriteBuffer(0, &bufferInfo)
-                .WriteImage(1, &curr)
-                .WriteImage(2, &prev)
-                .Build(accumulationSet);
-
+        ScopedGpuMarker marker(profiler, cmdBuffer, QueueType::Graphics, "AccumulationPass");
         RecordAccumulationPass(
                 cmdBuffer,
-                globalSet,
-                accumulationSet);
+                m_AccumulationDescriptorSets[swapImageIndex][parity]);
     }
 
+    vkCmdNextSubpass(cmdBuffer, VK_SUBPASS_CONTENTS_INLINE);
     {
-        vkCmdNextSubpass(cmdBuffer, VK_SUBPASS_CONTENTS_INLINE);
-
-        VkDescriptorSet compositionSet;
-        VkDescriptorImageInfo accumulatedAttachment = currFbo.GetDescriptorImageInfoForAttachment(1, m_FramebufferColorSampler);
-        VulkanDescriptorWriter(*m_CompositeDescriptorSetLayout, *m_DescriptorPool)
-                .WriteImage(0, &accumulatedAttachment)
-                .Build(compositionSet);
-
+        ScopedGpuMarker marker(profiler, cmdBuffer, QueueType::Graphics, "CompositionPass");
         RecordCompositionPass(
                 cmdBuffer,
-                compositionSet,
+                m_CompositionDescriptorSets[swapImageIndex][parity],
                 currFbo);
     }
 
@@ -207,7 +434,9 @@ void RTRenderer::RecordFrame(int swapImageIndex, VkDescriptorSet globalSet)
 
 void RTRenderer::Initialize()
 {
+    CreateBindlessTable();
     CreateSphereBuffers();
+    CreateSamplerTables();
     RecreateSwapchain();
     CreateFramebuffers();
     AllocateCommandBuffers();
@@ -217,37 +446,27 @@ void RTRenderer::Initialize()
     SetupMainRayTracePass();
     SetupAccumulationPass();
     SetupCompositionPass();
+    SetupComputeBackend();
 
-    for(int i = 0; i < VulkanSwapchain::MAX_FRAMES_IN_FLIGHT; i++)
-    {
-        RecordFrame(i, m_GlobalDescriptorSets[i]);
-    }
+    TransitionAttachmentLayouts();
+    WriteFrameDescriptorSets();
 }
 
 void RTRenderer::RecordMainRTPass(
         VkCommandBuffer cmdBuffer,
-        VkDescriptorSet globalSet,
-        VkDescriptorSet mainSet)
+        VkDescriptorSet mainSet,
+        VkDescriptorSet bindlessSet)
 {
     m_MainRTPassGraphicsPipeline->Bind(cmdBuffer);
 
-    vkCmdBindDescriptorSets(
-            cmdBuffer,
-            VK_PIPELINE_BIND_POINT_GRAPHICS,
-            m_MainRTPassGraphicsPipelineLayout,
-            0,
-            1,
-            &globalSet,
-            0,
-            nullptr);
-
+    const std::array<VkDescriptorSet, 2> sets { mainSet, bindlessSet };
     vkCmdBindDescriptorSets(
             cmdBuffer,
             VK_PIPELINE_BIND_POINT_GRAPHICS,
             m_MainRTPassGraphicsPipelineLayout,
             1,
-            1,
-            &mainSet,
+            static_cast<uint32_t>(sets.size()),
+            sets.data(),
             0,
             nullptr);
 
@@ -256,21 +475,10 @@ void RTRenderer::RecordMainRTPass(
 
 void RTRenderer::RecordAccumulationPass(
         VkCommandBuffer cmdBuffer,
-        VkDescriptorSet globalSet,
         VkDescriptorSet accumulationSet)
 {
     m_AccumulationPipeline->Bind(cmdBuffer);
 
-    vkCmdBindDescriptorSets(
-            cmdBuffer,
-            VK_PIPELINE_BIND_POINT_GRAPHICS,
-            m_AccumulationGraphicsPipelineLayout,
-            0,
-            1,
-            &globalSet,
-            0,
-            nullptr);
-
     vkCmdBindDescriptorSets(
             cmdBuffer,
             VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -295,7 +503,7 @@ void RTRenderer::RecordCompositionPass(
             cmdBuffer,
             VK_PIPELINE_BIND_POINT_GRAPHICS,
             m_CompositionGraphicsPipelineLayout,
-            0,
+            1,
             1,
             &compositionSet,
             0,
@@ -304,7 +512,7 @@ void RTRenderer::RecordCompositionPass(
     vkCmdDraw(cmdBuffer, 3, 1, 0, 0);
 }
 
-void RTRenderer::Draw(Camera& cameraRef)
+bool RTRenderer::UpdateGlobalUbo(Camera& cameraRef, uint32_t frameIndex)
 {
     GlobalUbo ubo{};
     ubo.Projection = cameraRef.GetProjection();
@@ -312,42 +520,291 @@ void RTRenderer::Draw(Camera& cameraRef)
     ubo.InvView = cameraRef.GetInvView();
     ubo.InvProjection = cameraRef.GetInvProjection();
     ubo.CameraPosition = glm::vec4(cameraRef.GetPosition(), 0.0f);
-    constexpr int RaysPerPixel = 1;
-    ubo.ScreenResolution_NumRaysPerPixel_FrameNumber = glm::ivec4(
-            m_Swapchain->GetWidth(),
-            m_Swapchain->GetHeight(),
-            RaysPerPixel,
-            m_FrameCounter);
+    ubo.ScreenResolution = glm::ivec4(m_Swapchain->GetWidth(), m_Swapchain->GetHeight(), 0, 0);
+
+    const bool viewChanged = std::memcmp(&m_LastUbo, &ubo, sizeof(GlobalUbo)) != 0;
+    m_LastUbo = ubo;
+
+    // Only the camera and resolution live in the UBO; skip the write and flush while they are unchanged.
+    if (std::memcmp(&m_GlobalUboCache[frameIndex], &ubo, sizeof(GlobalUbo)) != 0)
+    {
+        m_GlobalUboCache[frameIndex] = ubo;
+        m_GlobalUBOs[frameIndex]->WriteToBuffer(&ubo);
+        m_GlobalUBOs[frameIndex]->Flush();
+    }
+
+    return viewChanged;
+}
+
+void RTRenderer::BuildComputeFrameGraph(
+        uint32_t frameIndex,
+        uint32_t swapImageIndex,
+        const FramePushConstants& pushConstants,
+        const glm::mat4& previousViewProjection)
+{
+    m_FrameGraph = std::make_unique<RenderGraph>(m_DeviceRef);
 
-    m_GlobalUBOs[m_CurrentFrameIndex]->WriteToBuffer(&ubo);
-    m_GlobalUBOs[m_CurrentFrameIndex]->Flush();
+    VkImageSubresourceRange subresourceRange{};
+    subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    subresourceRange.levelCount = 1;
+    subresourceRange.layerCount = 1;
+
+    RenderGraphResource display = m_FrameGraph->ImportImage(
+            "Display",
+            GetComputeOutputImage(frameIndex)->GetImageInfo().Image,
+            subresourceRange,
+            m_DisplayStates[frameIndex]);
+
+    if (m_VirtualTexture)
+    {
+        m_FrameGraph->AddPass("VirtualTextureUploads", QueueType::Compute, [this, frameIndex](VkCommandBuffer cmdBuffer)
+        {
+            m_VirtualTexture->RecordUploads(cmdBuffer, frameIndex);
+        }).SideEffects();
+    }
+
+    RenderGraph::PassBuilder trace = m_FrameGraph->AddPass("Trace", QueueType::Compute, [this, frameIndex, pushConstants](VkCommandBuffer cmdBuffer)
+    {
+        m_PathTracer->Record(cmdBuffer, frameIndex, m_GlobalDescriptorSets[frameIndex], pushConstants);
+    });
+
+    // With denoising the tracer's own display image goes unused; the denoiser reads its accumulation instead.
+    if (m_Denoising)
+    {
+        trace.SideEffects();
+        m_FrameGraph->AddPass("Denoise", QueueType::Compute, [this, frameIndex, pushConstants, previousViewProjection](VkCommandBuffer cmdBuffer)
+        {
+            m_Denoiser->Record(cmdBuffer, frameIndex, m_GlobalDescriptorSets[frameIndex], pushConstants, previousViewProjection);
+        }).Write(display, RenderGraphUsage::ComputeWrite);
+    }
+    else
+    {
+        trace.Write(display, RenderGraphUsage::ComputeWrite);
+    }
+
+    // The display is a storage image, so the composite samples it in GENERAL rather than transitioning it.
+    m_FrameGraph->AddPass("Composite", QueueType::Graphics, [this, frameIndex, swapImageIndex](VkCommandBuffer cmdBuffer)
+    {
+        RecordComputeCompositePass(cmdBuffer, frameIndex, swapImageIndex);
+    }).Read(display, RenderGraphUsage::FragmentRead, VK_IMAGE_LAYOUT_GENERAL).SideEffects();
+
+    // Hand the image back for the next trace into this slot; only the composite's reads have to finish first.
+    m_FrameGraph->Export(display, QueueType::Compute, RenderGraphUsage::ComputeWrite);
+    m_FrameGraph->Compile();
+    m_DisplayStates[frameIndex] = m_FrameGraph->GetFinalState(display);
+
+    if (m_DumpFrameGraph)
+    {
+        m_FrameGraph->Dump(std::cout);
+        m_DumpFrameGraph = false;
+    }
+}
+
+void RTRenderer::RecordComputeFrame(uint32_t frameIndex)
+{
+    VkCommandBuffer computeCmdBuffer = m_PathTracer->GetCommandBuffer(frameIndex);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    VK_CHECK_RESULT(vkBeginCommandBuffer(computeCmdBuffer, &beginInfo));
+    // The trace is submitted before the composite, which waits on it.
+    m_DeviceRef.GetGpuProfiler().RecordReset(computeCmdBuffer);
+    m_FrameGraph->Execute(QueueType::Compute, computeCmdBuffer);
+    VK_CHECK_RESULT(vkEndCommandBuffer(computeCmdBuffer));
+}
+
+void RTRenderer::RecordComputeComposite(uint32_t frameIndex)
+{
+    VkCommandBuffer cmdBuffer = m_DrawCommandBuffers[frameIndex];
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    VK_CHECK_RESULT(vkBeginCommandBuffer(cmdBuffer, &beginInfo));
+    m_FrameGraph->Execute(QueueType::Graphics, cmdBuffer);
+    VK_CHECK_RESULT(vkEndCommandBuffer(cmdBuffer));
+}
+
+void RTRenderer::RecordComputeCompositePass(VkCommandBuffer cmdBuffer, uint32_t frameIndex, uint32_t swapImageIndex)
+{
+    std::array<VkClearValue, 2> clearValues{};
+    clearValues[0].color = {{0.0f, 0.0f, 0.0f, 0.0f}};
+    clearValues[1].depthStencil = {1.0f, 0};
+
+    VkRenderPassBeginInfo renderPassBeginInfo{};
+    renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassBeginInfo.renderPass = m_Swapchain->GetRenderPass();
+    renderPassBeginInfo.framebuffer = m_Swapchain->GetFrameBuffer(swapImageIndex);
+    renderPassBeginInfo.renderArea.extent = m_Swapchain->GetSwapchainExtent();
+    renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+    renderPassBeginInfo.pClearValues = clearValues.data();
+
+    vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+    VkViewport viewport{};
+    viewport.width = static_cast<float>(m_Swapchain->GetWidth());
+    viewport.height = static_cast<float>(m_Swapchain->GetHeight());
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    VkRect2D scissor{{0, 0}, renderPassBeginInfo.renderArea.extent};
+    vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
+
+    m_ComputeCompositePipeline->Bind(cmdBuffer);
+
+    const std::array<VkDescriptorSet, 2> sets { m_GlobalDescriptorSets[frameIndex], m_ComputeCompositeDescriptorSets[frameIndex] };
+    vkCmdBindDescriptorSets(
+            cmdBuffer,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            m_CompositionGraphicsPipelineLayout,
+            0,
+            static_cast<uint32_t>(sets.size()),
+            sets.data(),
+            0,
+            nullptr);
+
+    vkCmdDraw(cmdBuffer, 3, 1, 0, 0);
+
+    vkCmdEndRenderPass(cmdBuffer);
+}
+
+void RTRenderer::Draw(Camera& cameraRef)
+{
+    PROFILE_ZONE("RTRenderer::Draw");
+    const uint32_t frameIndex = static_cast<uint32_t>(m_FrameCounter % VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
+
+    // Only block on the frame that last used this slot, so the CPU records one frame ahead of the GPU.
+    {
+        PROFILE_ZONE("WaitForFrameFence");
+        VK_CHECK_RESULT(vkWaitForFences(m_DeviceRef.GetDevice(), 1, &m_WaitFences[frameIndex], VK_TRUE, UINT64_MAX));
+    }
+    m_FrameArena.Reset();
+
+    m_DeviceRef.GetGpuProfiler().BeginFrame(frameIndex, m_FrameCounter);
+    m_BindlessTable->BeginFrame(m_FrameCounter);
+    UpdateStreamedTextures();
+
+    VkSemaphore imageAvailableSemaphore = m_PresentCompleteSemaphores[frameIndex];
+    uint32_t swapImageIndex = 0;
 
     //Acquisition
     {
-        auto result = m_Swapchain->AcquireNextImage(&m_CurrentFrameIndex, m_PresentCompleteSemaphores[m_CurrentFrameIndex]);
+        auto result = m_Swapchain->AcquireNextImage(&swapImageIndex, imageAvailableSemaphore);
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR)
         {
             RecreateSwapchain();
+            OnSwapchainResized(m_Swapchain->GetWidth(), m_Swapchain->GetHeight());
+            return;
         }
         if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
             throw std::runtime_error("Failed to acquire swap chain image!");
     }
 
-    VkCommandBuffer cmdBuffer = m_DrawCommandBuffers[m_CurrentFrameIndex];
+    // The swap image may still be in use by the frame in the other slot.
+    if (m_ImagesInFlightFences[swapImageIndex] != VK_NULL_HANDLE)
+        VK_CHECK_RESULT(vkWaitForFences(m_DeviceRef.GetDevice(), 1, &m_ImagesInFlightFences[swapImageIndex], VK_TRUE, UINT64_MAX));
+    m_ImagesInFlightFences[swapImageIndex] = m_WaitFences[frameIndex];
+    VK_CHECK_RESULT(vkResetFences(m_DeviceRef.GetDevice(), 1, &m_WaitFences[frameIndex]));
+
+    // The fragment backend's framebuffers wrap the swap images, so its per-frame resources follow the swap image.
+    const uint32_t resourceIndex = m_Backend == PathTracerBackend::Fragment ? swapImageIndex : frameIndex;
+
+    // The denoiser reprojects its history from the view the previous frame was rendered with.
+    const glm::mat4 previousViewProjection = m_LastUbo.Projection * m_LastUbo.View;
+
+    // Restart accumulation whenever the view changes, or when newly resident pages sharpen a virtual texture.
+    if (UpdateGlobalUbo(cameraRef, resourceIndex))
+        m_AccumulationIndex = 0;
+    if (m_VirtualTexture && m_Backend != PathTracerBackend::Fragment && m_VirtualTexture->Update(frameIndex, m_FrameCounter))
+        m_AccumulationIndex = 0;
+
+    constexpr uint32_t RaysPerPixel = 1;
+    FramePushConstants pushConstants{};
+    pushConstants.FrameNumber = static_cast<uint32_t>(m_FrameCounter);
+    pushConstants.AccumulationIndex = m_AccumulationIndex;
+    pushConstants.SampleCount = RaysPerPixel;
+    pushConstants.TransformIndex = 0;
+
+    constexpr uint32_t MaxGraphicsSemaphores = 2;
+    auto* waitSemaphores = m_FrameArena.AllocateArray<VkSemaphore>(MaxGraphicsSemaphores);
+    auto* waitStages = m_FrameArena.AllocateArray<VkPipelineStageFlags>(MaxGraphicsSemaphores);
+    auto* signalSemaphores = m_FrameArena.AllocateArray<VkSemaphore>(MaxGraphicsSemaphores);
+    uint32_t waitSemaphoreCount = 0;
+    uint32_t signalSemaphoreCount = 0;
+    waitSemaphores[waitSemaphoreCount] = imageAvailableSemaphore;
+    waitStages[waitSemaphoreCount++] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    signalSemaphores[signalSemaphoreCount++] = m_RenderCompleteSemaphores[swapImageIndex];
+
+    if (m_Backend != PathTracerBackend::Fragment)
+    {
+        {
+            PROFILE_ZONE("RecordComputeFrame");
+            BuildComputeFrameGraph(frameIndex, swapImageIndex, pushConstants, previousViewProjection);
+            RecordComputeFrame(frameIndex);
+            RecordComputeComposite(frameIndex);
+        }
+
+        // The trace goes to the compute queue without waiting on the previous composite, which samples the other
+        // slot's display image; only the composite that last sampled this slot's image has to have finished.
+        VkSemaphore traceCompleteSemaphore = m_TraceCompleteSemaphores[frameIndex];
+        VkSemaphore compositeCompleteSemaphore = m_CompositeCompleteSemaphores[frameIndex];
+        VkPipelineStageFlags traceWaitStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+        VkCommandBuffer computeCmdBuffer = m_PathTracer->GetCommandBuffer(frameIndex);
+        VkSubmitInfo computeSubmitInfo{};
+        computeSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        if (m_DisplayReleasedToCompute[frameIndex])
+        {
+            computeSubmitInfo.waitSemaphoreCount = 1;
+            computeSubmitInfo.pWaitSemaphores = &compositeCompleteSemaphore;
+            computeSubmitInfo.pWaitDstStageMask = &traceWaitStage;
+        }
+        computeSubmitInfo.commandBufferCount = 1;
+        computeSubmitInfo.pCommandBuffers = &computeCmdBuffer;
+        computeSubmitInfo.signalSemaphoreCount = 1;
+        computeSubmitInfo.pSignalSemaphores = &traceCompleteSemaphore;
+        PROFILE_ZONE("ComputeQueueSubmit");
+        VK_CHECK_RESULT(vkQueueSubmit(m_DeviceRef.GetComputeQueue(), 1, &computeSubmitInfo, VK_NULL_HANDLE));
+
+        // The composite samples the display image once the trace has released it.
+        waitSemaphores[waitSemaphoreCount] = traceCompleteSemaphore;
+        waitStages[waitSemaphoreCount++] = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        signalSemaphores[signalSemaphoreCount++] = compositeCompleteSemaphore;
+        m_DisplayReleasedToCompute[frameIndex] = true;
+    }
+    else
+    {
+        PROFILE_ZONE("RecordFrame");
+        RecordFrame(swapImageIndex, pushConstants);
+    }
+
+    VkCommandBuffer cmdBuffer = m_DrawCommandBuffers[resourceIndex];
 
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.waitSemaphoreCount = waitSemaphoreCount;
+    submitInfo.pWaitSemaphores = waitSemaphores;
+    submitInfo.pWaitDstStageMask = waitStages;
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &cmdBuffer;
-    VK_CHECK_RESULT(vkQueueSubmit(m_DeviceRef.GetGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE));
+    submitInfo.signalSemaphoreCount = signalSemaphoreCount;
+    submitInfo.pSignalSemaphores = signalSemaphores;
+    // The composite waits on the trace, so this fence also covers the compute submission.
+    {
+        PROFILE_ZONE("GraphicsQueueSubmit");
+        VK_CHECK_RESULT(vkQueueSubmit(m_DeviceRef.GetGraphicsQueue(), 1, &submitInfo, m_WaitFences[frameIndex]));
+    }
 
     // Presentation
     {
         auto result = m_Swapchain->Present(
                 m_DeviceRef.GetPresentQueue(),
-                m_CurrentFrameIndex,
-                m_RenderCompleteSemaphores[m_CurrentFrameIndex]);
+                swapImageIndex,
+                m_RenderCompleteSemaphores[swapImageIndex]);
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_WindowRef.WasWindowResized())
         {
@@ -359,11 +816,10 @@ void RTRenderer::Draw(Camera& cameraRef)
         {
             throw std::runtime_error("Failed to present swapchain image!");
         }
-        VK_CHECK_RESULT(vkQueueWaitIdle(m_DeviceRef.GetGraphicsQueue()));
     }
 
     m_FrameCounter++;
-    m_AccumulationIndex = (m_AccumulationIndex + 1) % 2;
+    m_AccumulationIndex++;
 }
 
 void RTRenderer::AllocateCommandBuffers()
@@ -386,17 +842,32 @@ void RTRenderer::SetupGlobalDescriptors()
             .AddBinding(
                     0,
                     VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                    VK_SHADER_STAGE_ALL_GRAPHICS)
+                    VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT)
+            // Binding 1: Emitter alias table, for next-event estimation on the compute backends
+            .AddBinding(
+                    1,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_SHADER_STAGE_COMPUTE_BIT)
+            // Binding 2: Sobol and blue noise tables for the low-discrepancy samplers
+            .AddBinding(
+                    2,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_SHADER_STAGE_COMPUTE_BIT)
             .Build();
 
     m_DescriptorPool = VulkanDescriptorPool::Builder(m_DeviceRef)
-            .SetMaxSets(8)
+            .SetMaxSets(17)
             .AddPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VulkanSwapchain::MAX_FRAMES_IN_FLIGHT * 10)
             .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VulkanSwapchain::MAX_FRAMES_IN_FLIGHT * 10)
             .AddPoolSize(VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, VulkanSwapchain::MAX_FRAMES_IN_FLIGHT * 10)
             .AddPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VulkanSwapchain::MAX_FRAMES_IN_FLIGHT * 10)
             .Build();
 
+    m_FramePushConstants = std::make_unique<VulkanPushConstants<FramePushConstants>>(
+            m_DeviceRef,
+            VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
+
+    m_GlobalUboCache.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
     m_GlobalUBOs.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
     for (auto &uboBuffer: m_GlobalUBOs)
     {
@@ -413,13 +884,21 @@ void RTRenderer::SetupGlobalDescriptors()
     for (int i = 0; i < VulkanSwapchain::MAX_FRAMES_IN_FLIGHT; i++)
     {
         auto bufferInfo = m_GlobalUBOs[i]->DescriptorInfo();
+        auto emitterInfo = m_EmitterSSBO->DescriptorInfo();
+        auto samplerTablesInfo = m_SamplerTablesSSBO->DescriptorInfo();
         VulkanDescriptorWriter(*m_GlobalSetLayout, *m_DescriptorPool)
                 .WriteBuffer(0, &bufferInfo)
+                .WriteBuffer(1, &emitterInfo)
+                .WriteBuffer(2, &samplerTablesInfo)
                 .Build(m_GlobalDescriptorSets[i]);
     }
 }
 
-std::unique_ptr<VulkanFramebuffer> CreateFramebuffer(int frameIndex, VulkanDevice& device, VulkanSwapchain& swapchain)
+std::unique_ptr<VulkanFramebuffer> CreateFramebuffer(
+        int frameIndex,
+        VulkanDevice& device,
+        VulkanSwapchain& swapchain,
+        VulkanTransientMemoryPool& transientPool)
 {
     /*
      * Execution order:
@@ -430,6 +909,9 @@ std::unique_ptr<VulkanFramebuffer> CreateFramebuffer(int frameIndex, VulkanDevic
      *      - Draw to attachment1 in subpass 1 if frame # is even, otherwise write to attachment2
      *      - Draw to attachment3, the swapchain image
      *      - Present the swapchain image
+     *
+     * Attachment0, the swapchain image attachment and the depth attachment are produced and consumed
+     * inside the render pass, so they are never stored and become transient attachments.
      */
 
     VulkanFramebuffer::Attachment::Specification attachment0 =
@@ -437,7 +919,7 @@ std::unique_ptr<VulkanFramebuffer> CreateFramebuffer(int frameIndex, VulkanDevic
                     VK_FORMAT_R8G8B8A8_UNORM,
                     VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT,
                     VK_ATTACHMENT_LOAD_OP_CLEAR,
-                    VK_ATTACHMENT_STORE_OP_STORE,
+                    VK_ATTACHMENT_STORE_OP_DONT_CARE,
                     VK_IMAGE_LAYOUT_UNDEFINED,
                     VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
             };
@@ -465,7 +947,7 @@ std::unique_ptr<VulkanFramebuffer> CreateFramebuffer(int frameIndex, VulkanDevic
                     swapchain.GetSwapchainImageFormat(),
                     VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT,
                     VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-                    VK_ATTACHMENT_STORE_OP_STORE,
+                    VK_ATTACHMENT_STORE_OP_DONT_CARE,
                     VK_IMAGE_LAYOUT_UNDEFINED,
                     VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
             };
@@ -474,7 +956,7 @@ std::unique_ptr<VulkanFramebuffer> CreateFramebuffer(int frameIndex, VulkanDevic
                     swapchain.GetSwapchainDepthFormat(),
                     VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
                     VK_ATTACHMENT_LOAD_OP_CLEAR,
-                    VK_ATTACHMENT_STORE_OP_STORE,
+                    VK_ATTACHMENT_STORE_OP_DONT_CARE,
                     VK_IMAGE_LAYOUT_UNDEFINED,
                     VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
             };
@@ -623,19 +1105,27 @@ std::unique_ptr<VulkanFramebuffer> CreateFramebuffer(int frameIndex, VulkanDevic
             attachmentSpecs,
             subpasses,
             dependencies,
-            externalAttachments);
+            externalAttachments,
+            &transientPool,
+            frameIndex);
 }
 
 void RTRenderer::CreateFramebuffers()
 {
+    m_TransientAttachmentPools.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
     m_PerFrameFramebufferMap.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
     for(int i = 0; i < VulkanSwapchain::MAX_FRAMES_IN_FLIGHT; ++i)
     {
+        // The parity doubles as the pass index: frames of opposite parity on one frame index are serialized
+        // by that frame's fence, so the pool may alias their transients.
+        m_TransientAttachmentPools[i] = std::make_unique<VulkanTransientMemoryPool>(m_DeviceRef);
+
         std::array<std::unique_ptr<VulkanFramebuffer>, 2> fbos;
-        fbos[0] = std::move(CreateFramebuffer(0, m_DeviceRef, *m_Swapchain));
-        fbos[1] = std::move(CreateFramebuffer(1, m_DeviceRef, *m_Swapchain));
+        fbos[0] = std::move(CreateFramebuffer(0, m_DeviceRef, *m_Swapchain, *m_TransientAttachmentPools[i]));
+        fbos[1] = std::move(CreateFramebuffer(1, m_DeviceRef, *m_Swapchain, *m_TransientAttachmentPools[i]));
         m_PerFrameFramebufferMap[i] = std::move(fbos);
     }
+    ReportTransientAttachmentMemory();
 
     VkSamplerCreateInfo samplerCreateInfo = {};
     samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
@@ -650,7 +1140,36 @@ void RTRenderer::CreateFramebuffers()
     samplerCreateInfo.minLod = 0.0f;
     samplerCreateInfo.maxLod = 1.0f;
     samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
-    VK_CHECK_RESULT(vkCreateSampler(m_DeviceRef.GetDevice(), &samplerCreateInfo, nullptr, &m_FramebufferColorSampler));
+    m_FramebufferColorSampler = m_DeviceRef.GetSampler(samplerCreateInfo);
+}
+
+void RTRenderer::ReportTransientAttachmentMemory() const
+{
+    constexpr double MiB = 1024.0 * 1024.0;
+    auto report = [this](uint32_t width, uint32_t height, bool estimate)
+    {
+        VulkanTransientMemoryPool::Statistics total;
+        for (const auto& pool : m_TransientAttachmentPools)
+        {
+            VulkanTransientMemoryPool::Statistics statistics = estimate ? pool->EstimateStatistics(width, height) : pool->GetStatistics();
+            total.RequestedBytes += statistics.RequestedBytes;
+            total.AllocatedBytes += statistics.AllocatedBytes;
+            total.LazyBytes += statistics.LazyBytes;
+            total.ImageCount += statistics.ImageCount;
+            total.BlockCount += statistics.BlockCount;
+        }
+
+        std::cout << "Transient attachments at " << width << "x" << height << (estimate ? " (estimated)" : "") << ": "
+                  << total.ImageCount << " images in " << total.BlockCount << " blocks, "
+                  << total.AllocatedBytes / MiB << " MiB allocated for " << total.RequestedBytes / MiB << " MiB requested ("
+                  << (static_cast<double>(total.RequestedBytes) - static_cast<double>(total.AllocatedBytes)) / MiB << " MiB saved by aliasing, "
+                  << total.LazyBytes / MiB << " MiB lazily allocated)" << std::endl;
+    };
+
+    report(m_Swapchain->GetWidth(), m_Swapchain->GetHeight(), false);
+    // The saving scales with resolution, so it is also given for a 4K swapchain whatever the window size.
+    if (m_Swapchain->GetWidth() != 3840 || m_Swapchain->GetHeight() != 2160)
+        report(3840, 2160, true);
 }
 
 void RTRenderer::SetupMainRayTracePass()
@@ -667,13 +1186,17 @@ void RTRenderer::SetupMainRayTracePass()
     const std::vector<VkDescriptorSetLayout> descriptorSetLayouts
     {
         m_GlobalSetLayout->GetDescriptorSetLayout(),
-        m_MainRTPassDescriptorSetLayout->GetDescriptorSetLayout()
+        m_MainRTPassDescriptorSetLayout->GetDescriptorSetLayout(),
+        m_BindlessTable->GetDescriptorSetLayout().GetDescriptorSetLayout()
     };
 
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
     pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+    VkPushConstantRange pushConstantRange = m_FramePushConstants->GetRange();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
     VK_CHECK_RESULT(vkCreatePipelineLayout(m_DeviceRef.GetDevice(), &pipelineLayoutInfo, nullptr,
                                            &m_MainRTPassGraphicsPipelineLayout));
@@ -744,6 +1267,9 @@ void RTRenderer::SetupAccumulationPass()
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
     pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+    VkPushConstantRange pushConstantRange = m_FramePushConstants->GetRange();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
     VK_CHECK_RESULT(vkCreatePipelineLayout(
             m_DeviceRef.GetDevice(),
@@ -790,6 +1316,7 @@ void RTRenderer::SetupCompositionPass()
 
     const std::vector<VkDescriptorSetLayout> descriptorSetLayouts
     {
+        m_GlobalSetLayout->GetDescriptorSetLayout(),
         m_CompositeDescriptorSetLayout->GetDescriptorSetLayout()
     };
 
@@ -797,6 +1324,9 @@ void RTRenderer::SetupCompositionPass()
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
     pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+    VkPushConstantRange pushConstantRange = m_FramePushConstants->GetRange();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
     VK_CHECK_RESULT(vkCreatePipelineLayout(
             m_DeviceRef.GetDevice(),
@@ -818,14 +1348,309 @@ void RTRenderer::SetupCompositionPass()
             pipelineConfig);
 }
 
+std::unique_ptr<PathTracer> RTRenderer::CreatePathTracer(PathTracerBackend backend)
+{
+    return CreatePathTracer(backend, m_Sampler);
+}
+
+std::unique_ptr<PathTracer> RTRenderer::CreatePathTracer(PathTracerBackend backend, SamplerType sampler)
+{
+    std::unique_ptr<PathTracer> tracer;
+    if (backend == PathTracerBackend::Wavefront)
+        tracer = std::make_unique<WavefrontPathTracer>(m_DeviceRef, *m_GlobalSetLayout, *m_BindlessTable, sampler);
+    else
+        tracer = std::make_unique<ComputePathTracer>(m_DeviceRef, *m_GlobalSetLayout, *m_BindlessTable, sampler);
+
+    tracer->Resize(m_Swapchain->GetWidth(), m_Swapchain->GetHeight());
+    for (uint32_t i = 0; i < VulkanSwapchain::MAX_FRAMES_IN_FLIGHT; i++)
+        tracer->SetSphereBuffer(i, m_SphereSSBOs[i]->DescriptorInfo());
+    return tracer;
+}
+
+void RTRenderer::SetBackend(PathTracerBackend backend)
+{
+    m_AccumulationIndex = 0;
+    if (backend == m_Backend)
+        return;
+
+    m_Backend = backend;
+    // Before Initialize the tracer is simply created for the chosen backend.
+    if (!m_PathTracer)
+        return;
+
+    // The fragment and compute backends index the per-frame command buffers differently.
+    VK_CHECK_RESULT(vkDeviceWaitIdle(m_DeviceRef.GetDevice()));
+    if (backend == PathTracerBackend::Fragment)
+        return;
+
+    m_PathTracer = CreatePathTracer(backend);
+    WriteComputeCompositeDescriptorSets();
+    CreateDisplaySynchronization();
+}
+
+void RTRenderer::SetSampler(SamplerType sampler)
+{
+    m_AccumulationIndex = 0;
+    if (sampler == m_Sampler)
+        return;
+
+    m_Sampler = sampler;
+    // The next compute tracer is created with it, whether by Initialize or by SetBackend.
+    if (!m_PathTracer || m_Backend == PathTracerBackend::Fragment)
+        return;
+
+    // The tracer's pipelines may still be in use by frames in flight.
+    VK_CHECK_RESULT(vkDeviceWaitIdle(m_DeviceRef.GetDevice()));
+    m_PathTracer = CreatePathTracer(m_Backend);
+    WriteComputeCompositeDescriptorSets();
+    CreateDisplaySynchronization();
+}
+
+void RTRenderer::SetDenoising(bool enabled)
+{
+    if (enabled == m_Denoising)
+        return;
+
+    m_Denoising = enabled;
+    // Before Initialize the frame graph is simply built with the choice.
+    if (!m_Denoiser)
+        return;
+
+    // The composite switches to sampling the other output image, which frames in flight may still be using.
+    VK_CHECK_RESULT(vkDeviceWaitIdle(m_DeviceRef.GetDevice()));
+    m_Denoiser->ResetHistory();
+    WriteComputeCompositeDescriptorSets();
+    CreateDisplaySynchronization();
+}
+
+std::vector<PathTracerBenchmarkResult> RTRenderer::CompareTracers(
+        Camera& cameraRef,
+        const std::vector<uint32_t>& bounceCounts,
+        uint32_t frameCount)
+{
+    VK_CHECK_RESULT(vkDeviceWaitIdle(m_DeviceRef.GetDevice()));
+    UpdateGlobalUbo(cameraRef, 0);
+
+    std::unique_ptr<PathTracer> megakernel = CreatePathTracer(PathTracerBackend::Compute);
+    std::unique_ptr<PathTracer> wavefront = CreatePathTracer(PathTracerBackend::Wavefront);
+    auto& wavefrontTracer = static_cast<WavefrontPathTracer&>(*wavefront);
+
+    PathTracerBenchmark benchmark(m_DeviceRef);
+    std::vector<PathTracerBenchmarkResult> results;
+    for (uint32_t bounceCount : bounceCounts)
+    {
+        results.push_back(benchmark.Run(*megakernel, m_GlobalDescriptorSets[0], bounceCount, frameCount));
+
+        wavefrontTracer.SetSortRays(false);
+        results.push_back(benchmark.Run(wavefrontTracer, m_GlobalDescriptorSets[0], bounceCount, frameCount));
+
+        wavefrontTracer.SetSortRays(true);
+        results.push_back(benchmark.Run(wavefrontTracer, m_GlobalDescriptorSets[0], bounceCount, frameCount));
+    }
+
+    PathTracerBenchmark::PrintReport(results, std::cout);
+    m_AccumulationIndex = 0;
+    return results;
+}
+
+std::vector<PathTracerConvergenceResult> RTRenderer::CompareLightSampling(
+        Camera& cameraRef,
+        uint32_t bounceCount,
+        double budgetMilliseconds,
+        uint32_t referenceFrameCount)
+{
+    VK_CHECK_RESULT(vkDeviceWaitIdle(m_DeviceRef.GetDevice()));
+    UpdateGlobalUbo(cameraRef, 0);
+
+    std::unique_ptr<PathTracer> tracer = CreatePathTracer(PathTracerBackend::Compute);
+    PathTracerBenchmark benchmark(m_DeviceRef);
+
+    FramePushConstants settings{};
+    settings.MaxBounceCount = bounceCount;
+    settings.NextEventEstimation = 1;
+    const std::vector<float> reference = benchmark.RenderReference(*tracer, m_GlobalDescriptorSets[0], settings, referenceFrameCount);
+
+    std::vector<PathTracerConvergenceResult> results;
+    settings.NextEventEstimation = 0;
+    results.push_back(benchmark.RunEqualTime(*tracer, m_GlobalDescriptorSets[0], settings, budgetMilliseconds, reference));
+    results.back().Label = "BSDF";
+
+    settings.NextEventEstimation = 1;
+    results.push_back(benchmark.RunEqualTime(*tracer, m_GlobalDescriptorSets[0], settings, budgetMilliseconds, reference));
+    results.back().Label = "NEE + MIS";
+
+    PathTracerBenchmark::PrintConvergenceReport(results, std::cout);
+    m_AccumulationIndex = 0;
+    return results;
+}
+
+std::vector<PathTracerConvergenceResult> RTRenderer::CompareSamplers(
+        Camera& cameraRef,
+        uint32_t bounceCount,
+        double budgetMilliseconds,
+        uint32_t referenceFrameCount)
+{
+    VK_CHECK_RESULT(vkDeviceWaitIdle(m_DeviceRef.GetDevice()));
+    UpdateGlobalUbo(cameraRef, 0);
+
+    PathTracerBenchmark benchmark(m_DeviceRef);
+    FramePushConstants settings{};
+    settings.MaxBounceCount = bounceCount;
+
+    std::vector<float> reference;
+    {
+        std::unique_ptr<PathTracer> tracer = CreatePathTracer(PathTracerBackend::Compute, SamplerType::Random);
+        reference = benchmark.RenderReference(*tracer, m_GlobalDescriptorSets[0], settings, referenceFrameCount);
+    }
+
+    std::vector<PathTracerConvergenceResult> results;
+    for (SamplerType sampler : { SamplerType::Random, SamplerType::Sobol, SamplerType::BlueNoise })
+    {
+        std::unique_ptr<PathTracer> tracer = CreatePathTracer(PathTracerBackend::Compute, sampler);
+        results.push_back(benchmark.RunEqualTime(*tracer, m_GlobalDescriptorSets[0], settings, budgetMilliseconds, reference));
+        results.back().Label = GetSamplerName(sampler);
+    }
+
+    PathTracerBenchmark::PrintConvergenceReport(results, std::cout);
+    m_AccumulationIndex = 0;
+    return results;
+}
+
+std::vector<PathTracerConvergenceResult> RTRenderer::CompareDenoising(
+        Camera& cameraRef,
+        uint32_t bounceCount,
+        const std::vector<uint32_t>& frameCounts,
+        uint32_t referenceFrameCount)
+{
+    VK_CHECK_RESULT(vkDeviceWaitIdle(m_DeviceRef.GetDevice()));
+    UpdateGlobalUbo(cameraRef, 0);
+
+    std::unique_ptr<PathTracer> tracer = CreatePathTracer(PathTracerBackend::Compute);
+    // Its own denoiser, so the live one keeps its input and history.
+    Denoiser denoiser(m_DeviceRef, *m_GlobalSetLayout, *m_BindlessTable);
+    denoiser.Resize(tracer->GetWidth(), tracer->GetHeight());
+    denoiser.SetSphereBuffer(0, m_SphereSSBOs[0]->DescriptorInfo());
+    denoiser.SetInput(tracer->GetAccumulationImage());
+
+    PathTracerBenchmark benchmark(m_DeviceRef);
+    FramePushConstants settings{};
+    settings.MaxBounceCount = bounceCount;
+    settings.NextEventEstimation = 1;
+    const std::vector<float> reference = benchmark.RenderReference(*tracer, m_GlobalDescriptorSets[0], settings, referenceFrameCount);
+
+    std::vector<PathTracerConvergenceResult> results;
+    for (uint32_t frameCount : frameCounts)
+    {
+        results.push_back(benchmark.RunFrameCount(*tracer, nullptr, m_GlobalDescriptorSets[0], settings, frameCount, reference));
+        results.back().Label = "Raw " + std::to_string(frameCount);
+
+        results.push_back(benchmark.RunFrameCount(*tracer, &denoiser, m_GlobalDescriptorSets[0], settings, frameCount, reference));
+        results.back().Label = "Denoised " + std::to_string(frameCount);
+    }
+
+    PathTracerBenchmark::PrintConvergenceReport(results, std::cout);
+    m_AccumulationIndex = 0;
+    return results;
+}
+
+void RTRenderer::SetupComputeBackend()
+{
+    m_PathTracer = CreatePathTracer(m_Backend);
+
+    m_Denoiser = std::make_unique<Denoiser>(m_DeviceRef, *m_GlobalSetLayout, *m_BindlessTable);
+    m_Denoiser->Resize(m_Swapchain->GetWidth(), m_Swapchain->GetHeight());
+    for (uint32_t i = 0; i < VulkanSwapchain::MAX_FRAMES_IN_FLIGHT; i++)
+        m_Denoiser->SetSphereBuffer(i, m_SphereSSBOs[i]->DescriptorInfo());
+
+    // The composite reuses the composition layout (global set + one sampled texture) against the swapchain pass.
+    VulkanGraphicsPipeline::PipelineConfigInfo pipelineConfig{};
+    VulkanGraphicsPipeline::GetDefaultPipelineConfigInfo(pipelineConfig);
+
+    pipelineConfig.RenderPass = m_Swapchain->GetRenderPass();
+    pipelineConfig.PipelineLayout = m_CompositionGraphicsPipelineLayout;
+    pipelineConfig.EmptyVertexInputState = true;
+    pipelineConfig.DepthStencilInfo.depthTestEnable = VK_FALSE;
+    pipelineConfig.DepthStencilInfo.depthWriteEnable = VK_FALSE;
+    pipelineConfig.Subpass = 0;
+    m_ComputeCompositePipeline = std::make_unique<VulkanGraphicsPipeline>(
+            m_DeviceRef,
+            "../assets/shaders/fsq.vert.spv",
+            "../assets/shaders/texture_display.frag.spv",
+            pipelineConfig);
+
+    WriteComputeCompositeDescriptorSets();
+    CreateDisplaySynchronization();
+}
+
+std::shared_ptr<VulkanImage2D> RTRenderer::GetComputeOutputImage(uint32_t frameIndex) const
+{
+    return m_Denoising ? m_Denoiser->GetOutputImage(frameIndex) : m_PathTracer->GetOutputImage(frameIndex);
+}
+
+void RTRenderer::WriteComputeCompositeDescriptorSets()
+{
+    // Called whenever the tracer or its images are replaced, so this is also where the denoiser follows them.
+    m_Denoiser->SetInput(m_PathTracer->GetAccumulationImage());
+
+    const bool allocate = m_ComputeCompositeDescriptorSets.empty();
+    m_ComputeCompositeDescriptorSets.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
+
+    for (uint32_t i = 0; i < VulkanSwapchain::MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        VkDescriptorImageInfo displayImage = GetComputeOutputImage(i)->GetDescriptorInfo();
+        VulkanDescriptorWriter writer(*m_CompositeDescriptorSetLayout, *m_DescriptorPool);
+        writer.WriteImage(0, &displayImage);
+
+        if (allocate)
+            writer.Build(m_ComputeCompositeDescriptorSets[i]);
+        else
+            writer.Overwrite(m_ComputeCompositeDescriptorSets[i]);
+    }
+}
+
+void RTRenderer::CreateDisplaySynchronization()
+{
+    for (VkSemaphore semaphore : m_TraceCompleteSemaphores)
+        vkDestroySemaphore(m_DeviceRef.GetDevice(), semaphore, nullptr);
+    for (VkSemaphore semaphore : m_CompositeCompleteSemaphores)
+        vkDestroySemaphore(m_DeviceRef.GetDevice(), semaphore, nullptr);
+
+    // Freshly created display images start out owned by the compute queue.
+    RenderGraphResourceState displayState{};
+    displayState.Queue = QueueType::Compute;
+    displayState.Layout = VK_IMAGE_LAYOUT_GENERAL;
+    m_DisplayStates.assign(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT, displayState);
+    m_DisplayReleasedToCompute.assign(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT, false);
+    m_TraceCompleteSemaphores.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
+    m_CompositeCompleteSemaphores.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
+    m_DumpFrameGraph = true;
+
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    for (uint32_t i = 0; i < VulkanSwapchain::MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        VK_CHECK_RESULT(vkCreateSemaphore(m_DeviceRef.GetDevice(), &semaphoreInfo, nullptr, &m_TraceCompleteSemaphores[i]));
+        VK_CHECK_RESULT(vkCreateSemaphore(m_DeviceRef.GetDevice(), &semaphoreInfo, nullptr, &m_CompositeCompleteSemaphores[i]));
+
+        std::stringstream traceNameStream;
+        traceNameStream << "TraceComplete" << i;
+        SetDebugUtilsObjectName(m_DeviceRef.GetDevice(), VK_OBJECT_TYPE_SEMAPHORE,
+                                (uint64_t) m_TraceCompleteSemaphores[i], traceNameStream.str().c_str());
+
+        std::stringstream compositeNameStream;
+        compositeNameStream << "CompositeComplete" << i;
+        SetDebugUtilsObjectName(m_DeviceRef.GetDevice(), VK_OBJECT_TYPE_SEMAPHORE,
+                                (uint64_t) m_CompositeCompleteSemaphores[i], compositeNameStream.str().c_str());
+    }
+}
+
 void RTRenderer::CreateSynchronizationPrimitives()
 {
     // Presentation/Draw Sync Primitives
     {
         m_PresentCompleteSemaphores.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
-        m_RenderCompleteSemaphores.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
         m_WaitFences.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
-        m_ImagesInFlightFences.resize(m_Swapchain->GetImageCount(), VK_NULL_HANDLE);
 
         VkSemaphoreCreateInfo semaphoreInfo = {};
         semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -837,7 +1662,6 @@ void RTRenderer::CreateSynchronizationPrimitives()
         for (size_t i = 0; i < VulkanSwapchain::MAX_FRAMES_IN_FLIGHT; i++)
         {
             VK_CHECK_RESULT(vkCreateSemaphore(m_DeviceRef.GetDevice(), &semaphoreInfo, nullptr, &m_PresentCompleteSemaphores[i]));
-            VK_CHECK_RESULT(vkCreateSemaphore(m_DeviceRef.GetDevice(), &semaphoreInfo, nullptr,&m_RenderCompleteSemaphores[i]));
             VK_CHECK_RESULT(vkCreateFence(m_DeviceRef.GetDevice(), &fenceInfo, nullptr, &m_WaitFences[i]));
 
             std::stringstream semaphoreNameStream;
@@ -845,11 +1669,6 @@ void RTRenderer::CreateSynchronizationPrimitives()
             SetDebugUtilsObjectName(m_DeviceRef.GetDevice(), VK_OBJECT_TYPE_SEMAPHORE,
                                     (uint64_t) m_PresentCompleteSemaphores[i], semaphoreNameStream.str().c_str());
 
-            std::stringstream semaphoreRenderNameStream;
-            semaphoreRenderNameStream << "RenderComplete" << i;
-            SetDebugUtilsObjectName(m_DeviceRef.GetDevice(), VK_OBJECT_TYPE_SEMAPHORE,
-                                    (uint64_t) m_RenderCompleteSemaphores[i], semaphoreRenderNameStream.str().c_str());
-
             std::stringstream fenceNameStream;
             fenceNameStream << "WaitFence" << i;
             SetDebugUtilsObjectName(m_DeviceRef.GetDevice(), VK_OBJECT_TYPE_FENCE, (uint64_t) m_WaitFences[i],
@@ -881,6 +1700,23 @@ void RTRenderer::RecreateSwapchain()
             throw std::runtime_error("Swap chain image(or depth) format has changed!");
         }
     }
+
+    // Presentation waits are only retired once the image is reacquired, so render-complete semaphores are per swap image.
+    m_ImagesInFlightFences.assign(m_Swapchain->GetImageCount(), VK_NULL_HANDLE);
+
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    for (size_t i = m_RenderCompleteSemaphores.size(); i < m_Swapchain->GetImageCount(); i++)
+    {
+        VkSemaphore renderCompleteSemaphore;
+        VK_CHECK_RESULT(vkCreateSemaphore(m_DeviceRef.GetDevice(), &semaphoreInfo, nullptr, &renderCompleteSemaphore));
+        m_RenderCompleteSemaphores.push_back(renderCompleteSemaphore);
+
+        std::stringstream semaphoreRenderNameStream;
+        semaphoreRenderNameStream << "RenderComplete" << i;
+        SetDebugUtilsObjectName(m_DeviceRef.GetDevice(), VK_OBJECT_TYPE_SEMAPHORE,
+                                (uint64_t) renderCompleteSemaphore, semaphoreRenderNameStream.str().c_str());
+    }
 }
 
 void RTRenderer::OnSwapchainResized(uint32_t width, uint32_t height)
@@ -890,4 +1726,14 @@ void RTRenderer::OnSwapchainResized(uint32_t width, uint32_t height)
         for (auto &framebuffer: m_PerFrameFramebufferMap[i])
             framebuffer->Resize(width, height);
     }
+    ReportTransientAttachmentMemory();
+
+    TransitionAttachmentLayouts();
+    WriteFrameDescriptorSets();
+
+    m_PathTracer->Resize(width, height);
+    m_Denoiser->Resize(width, height);
+    WriteComputeCompositeDescriptorSets();
+    CreateDisplaySynchronization();
+    m_AccumulationIndex = 0;
 }
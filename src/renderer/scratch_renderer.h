@@ -5,10 +5,27 @@
 #include "renderer/vulkan/vulkan_descriptors.h"
 #include "renderer/vulkan/vulkan_graphics_pipeline.h"
 #include "renderer/vulkan/vulkan_buffer.h"
+#include "renderer/vulkan/vulkan_bindless.h"
+#include "renderer/vulkan/vulkan_texture.h"
+#include "renderer/vulkan/vulkan_texture_cache.h"
+#include "renderer/vulkan/vulkan_transient_memory.h"
+#include "renderer/vulkan/vulkan_virtual_texture.h"
+#include "renderer/vulkan/vulkan_push_constants.h"
+#include "renderer/compute_path_tracer.h"
+#include "renderer/wavefront_path_tracer.h"
+#include "renderer/path_tracer_benchmark.h"
+#include "renderer/denoiser.h"
+#include "renderer/sampler_tables.h"
+#include "renderer/render_graph.h"
 #include "renderer/camera.h"
+#include "scene/scene.h"
+#include "scene/emitter_table.h"
+#include "core/buffer_allocator.h"
+#include "core/frame_info.h"
 #include <memory>
 #include <vector>
 #include <array>
+#include <unordered_map>
 #include <vulkan/vulkan.h>
 
 
@@ -28,6 +45,12 @@ struct Attachments
     int32_t Height{};
 };
 
+enum class PathTracerBackend
+{
+    Fragment,   // Full-screen fragment passes with subpass accumulation
+    Compute,    // Compute megakernel into a storage image, accumulated in place
+    Wavefront   // Compute generate/extend/shade/connect stages over compacted ray queues
+};
 
 class RTRenderer
 {
@@ -35,23 +58,87 @@ public:
     explicit RTRenderer(Window& windowRef, VulkanDevice &deviceRef);
     ~RTRenderer();
 
+    // Replaces the default scene. Call before Initialize.
+    void SetSpheres(std::vector<Sphere> spheres);
+
     void Initialize();
     void Draw(Camera &cameraRef);
 
     float GetAspectRatio() const { return m_Swapchain->GetExtentAspectRatio(); }
+    [[nodiscard]] uint32_t GetWidth() const { return m_Swapchain->GetWidth(); }
+    [[nodiscard]] uint32_t GetHeight() const { return m_Swapchain->GetHeight(); }
+
+    void SetBackend(PathTracerBackend backend);
+    [[nodiscard]] PathTracerBackend GetBackend() const { return m_Backend; }
+
+    // Recreates the compute tracer's pipelines with the sampler compiled in.
+    void SetSampler(SamplerType sampler);
+    [[nodiscard]] SamplerType GetSampler() const { return m_Sampler; }
+
+    // Runs the Denoiser between the compute tracer's accumulation and the composite. The fragment backend
+    // is never denoised.
+    void SetDenoising(bool enabled);
+    [[nodiscard]] bool IsDenoising() const { return m_Denoising; }
+
+    // Scratch memory for the frame being recorded, reset at the start of every Draw. Only for CPU-side data
+    // that is consumed before Draw returns, such as submit info arrays.
+    [[nodiscard]] LinearArena& GetFrameArena() { return m_FrameArena; }
+
+    // Queues the file on the texture loader and returns a handle right away, which shows the missing texture
+    // until the upload finishes and keeps doing so if the file fails to load. Submitted frames may still be
+    // sampling the placeholder's slot, so the finished texture gets a slot of its own: spheres using the
+    // handle are moved to it, and the handle keeps resolving to it in SetSphereAlbedo.
+    BindlessHandle LoadTexture(const std::string& filepath, TextureSpecification specification = {});
+    // Registers an already uploaded texture and keeps it alive with the renderer.
+    BindlessHandle AddTexture(std::shared_ptr<VulkanTexture2D> texture);
+    // Samples the texture as the sphere's albedo on the compute backends. Call after Initialize.
+    void SetSphereAlbedo(uint32_t sphereIndex, BindlessHandle handle);
+
+    // Pages the sphere's albedo in from a virtual texture file (see re_coo_texconv --virtual), replacing any
+    // previous one. Call after Initialize. Only the compute backends sample it; the fragment backend draws
+    // the sphere untextured.
+    void SetVirtualAlbedo(uint32_t sphereIndex, const std::string& filepath);
+
+    // Times the megakernel against the wavefront tracer at each bounce count from the camera's current view.
+    std::vector<PathTracerBenchmarkResult> CompareTracers(
+            Camera& cameraRef,
+            const std::vector<uint32_t>& bounceCounts,
+            uint32_t frameCount);
+
+    // Renders a converged reference with next-event estimation, then gives BSDF sampling alone and
+    // NEE + MIS the same GPU time on the megakernel and reports each one's RMSE against it.
+    std::vector<PathTracerConvergenceResult> CompareLightSampling(
+            Camera& cameraRef,
+            uint32_t bounceCount,
+            double budgetMilliseconds,
+            uint32_t referenceFrameCount);
+
+    // Same, for the random, Sobol and blue noise samplers with next-event estimation on.
+    std::vector<PathTracerConvergenceResult> CompareSamplers(
+            Camera& cameraRef,
+            uint32_t bounceCount,
+            double budgetMilliseconds,
+            uint32_t referenceFrameCount);
+
+    // Accumulates each frame count on the megakernel and reports the RMSE against a converged reference of the
+    // raw accumulation and of the denoised output, with the GPU time each took.
+    std::vector<PathTracerConvergenceResult> CompareDenoising(
+            Camera& cameraRef,
+            uint32_t bounceCount,
+            const std::vector<uint32_t>& frameCounts,
+            uint32_t referenceFrameCount);
 
 private:
 
-    void RecordFrame(int swapImageIndex, VkDescriptorSet globalSet);
+    void RecordFrame(uint32_t swapImageIndex, const FramePushConstants& pushConstants);
 
     void RecordMainRTPass(
             VkCommandBuffer cmdBuffer,
-            VkDescriptorSet globalSet,
-            VkDescriptorSet mainSet);
+            VkDescriptorSet mainSet,
+            VkDescriptorSet bindlessSet);
 
     void RecordAccumulationPass(
             VkCommandBuffer cmdBuffer,
-            VkDescriptorSet globalSet,
             VkDescriptorSet accumulationSet);
 
     void RecordCompositionPass(
@@ -59,8 +146,30 @@ private:
             VkDescriptorSet compositionSet,
             VulkanFramebuffer& fbo);
 
+    void BuildComputeFrameGraph(
+            uint32_t frameIndex,
+            uint32_t swapImageIndex,
+            const FramePushConstants& pushConstants,
+            const glm::mat4& previousViewProjection);
+    void RecordComputeFrame(uint32_t frameIndex);
+    void RecordComputeComposite(uint32_t frameIndex);
+    void RecordComputeCompositePass(VkCommandBuffer cmdBuffer, uint32_t frameIndex, uint32_t swapImageIndex);
+
+    bool UpdateGlobalUbo(Camera& cameraRef, uint32_t frameIndex);
+    void TransitionAttachmentLayouts();
+    void WriteFrameDescriptorSets();
+
+    void CreateBindlessTable();
+    void UpdateStreamedTextures();
+    void CreateDefaultSpheres();
     void CreateSphereBuffers();
+    void UploadSphereBuffers();
+    void CreateEmitterBuffer();
+    void CreateSamplerTables();
+    // Device-local storage buffer the compute queue only reads, filled once through a staging copy.
+    std::unique_ptr<VulkanBuffer> CreateComputeConstantBuffer(const std::vector<uint8_t>& data);
     void CreateFramebuffers();
+    void ReportTransientAttachmentMemory() const;
     void AllocateCommandBuffers();
     void SetupGlobalDescriptors();
     void CreateSynchronizationPrimitives();
@@ -68,6 +177,13 @@ private:
     void SetupMainRayTracePass();
     void SetupAccumulationPass();
     void SetupCompositionPass();
+    void SetupComputeBackend();
+    std::unique_ptr<PathTracer> CreatePathTracer(PathTracerBackend backend);
+    std::unique_ptr<PathTracer> CreatePathTracer(PathTracerBackend backend, SamplerType sampler);
+    // The image the composite samples: the denoiser's output, or the tracer's display image without denoising.
+    [[nodiscard]] std::shared_ptr<VulkanImage2D> GetComputeOutputImage(uint32_t frameIndex) const;
+    void WriteComputeCompositeDescriptorSets();
+    void CreateDisplaySynchronization();
 
     void RecreateSwapchain();
     void OnSwapchainResized(uint32_t width, uint32_t height);
@@ -86,14 +202,46 @@ private:
     std::vector<VkCommandBuffer> m_DrawCommandBuffers;
     std::unique_ptr<VulkanDescriptorPool> m_DescriptorPool;
 
+    // One per frame in flight: the two ping-pong framebuffers of a frame never render at the same time,
+    // so their transient attachments share memory. Declared first so it outlives the framebuffers.
+    std::vector<std::unique_ptr<VulkanTransientMemoryPool>> m_TransientAttachmentPools;
     std::vector<std::array<std::unique_ptr<VulkanFramebuffer>, 2>> m_PerFrameFramebufferMap;
     VkSampler m_FramebufferColorSampler;
 
     // UBOs
     std::vector<std::unique_ptr<VulkanBuffer>> m_GlobalUBOs;
+    std::vector<GlobalUbo> m_GlobalUboCache;
+    GlobalUbo m_LastUbo{};
+
+    // Push Constants
+    std::unique_ptr<VulkanPushConstants<FramePushConstants>> m_FramePushConstants;
 
     // Buffers
+    std::vector<Sphere> m_Spheres;
     std::vector<std::unique_ptr<VulkanBuffer>> m_SphereSSBOs;
+    EmitterTable m_Emitters;
+    std::unique_ptr<VulkanBuffer> m_EmitterSSBO;
+    std::unique_ptr<VulkanBuffer> m_SamplerTablesSSBO;
+
+    // Bindless resources
+    std::unique_ptr<VulkanBindlessTable> m_BindlessTable;
+    std::shared_ptr<VulkanTexture2D> m_MissingTexture;
+    BindlessHandle m_MissingTextureHandle = InvalidBindlessHandle;
+
+    // Streamed textures
+    struct PendingTexture
+    {
+        BindlessHandle Handle;
+        TextureFuture Texture;
+    };
+    std::unique_ptr<VulkanTextureCache> m_TextureCache;
+    std::vector<PendingTexture> m_PendingTextures;
+    // Placeholder slots handed out by LoadTexture, to the slot their texture was registered at once loaded.
+    std::unordered_map<BindlessHandle, BindlessHandle> m_LoadedTextureHandles;
+    std::unordered_map<BindlessHandle, std::shared_ptr<VulkanTexture2D>> m_StreamedTextures;
+
+    std::unique_ptr<VulkanVirtualTexture> m_VirtualTexture;
+    uint32_t m_VirtualTextureSphere = 0;
 
     // Descriptor Set Layouts
     std::unique_ptr<VulkanDescriptorSetLayout> m_MainRTPassDescriptorSetLayout;
@@ -104,6 +252,9 @@ private:
     // Descriptor Sets
     std::vector<VkDescriptorSet> m_MainRTPassDescriptorSets;
     std::vector<VkDescriptorSet> m_GlobalDescriptorSets;
+    // Indexed by [swap image][frame parity]
+    std::vector<std::array<VkDescriptorSet, 2>> m_AccumulationDescriptorSets;
+    std::vector<std::array<VkDescriptorSet, 2>> m_CompositionDescriptorSets;
 
     // Pipeline Layouts
     VkPipelineLayout m_MainRTPassGraphicsPipelineLayout{};
@@ -115,17 +266,35 @@ private:
     std::unique_ptr<VulkanGraphicsPipeline> m_MainRTPassGraphicsPipeline;
     std::unique_ptr<VulkanGraphicsPipeline> m_AccumulationPipeline;
 
+    // Compute backend
+    PathTracerBackend m_Backend = PathTracerBackend::Compute;
+    SamplerType m_Sampler = SamplerType::Random;
+    std::unique_ptr<PathTracer> m_PathTracer;
+    std::unique_ptr<Denoiser> m_Denoiser;
+    bool m_Denoising = true;
+    std::unique_ptr<VulkanGraphicsPipeline> m_ComputeCompositePipeline;
+    std::vector<VkDescriptorSet> m_ComputeCompositeDescriptorSets;
+    // Per frame in flight: the composited image moves to the graphics queue for the composite and back
+    // to the compute queue for the next trace into it. The frame graph records the barriers; the semaphores
+    // order the two submits.
+    std::unique_ptr<RenderGraph> m_FrameGraph;
+    std::vector<RenderGraphResourceState> m_DisplayStates;
+    std::vector<VkSemaphore> m_TraceCompleteSemaphores;
+    std::vector<VkSemaphore> m_CompositeCompleteSemaphores;
+    std::vector<bool> m_DisplayReleasedToCompute;
+    bool m_DumpFrameGraph = true;
+
     std::vector<VkSemaphore> m_PresentCompleteSemaphores;   // Swap chain image presentation
     std::vector<VkSemaphore> m_RenderCompleteSemaphores;    // Command buffer submission and execution
 
-    std::vector<VkFence> m_WaitFences;
-    std::vector<VkFence> m_ImagesInFlightFences;
+    std::vector<VkFence> m_WaitFences;              // Per frame in flight
+    std::vector<VkFence> m_ImagesInFlightFences;    // Per swap image, the fence of the frame last drawn into it
 
     VkSemaphore m_RenderComplete;
 
+    LinearArena m_FrameArena{"Frame", 64 << 10};
     uint64_t m_FrameCounter = 0;
-    uint32_t m_CurrentFrameIndex = 0;
-    uint8_t m_AccumulationIndex = 0;
+    uint32_t m_AccumulationIndex = 0;
 
     Attachments m_Attachments;
 };
\ No newline at end of file
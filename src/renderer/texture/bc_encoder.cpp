@@ -0,0 +1,639 @@
+#include "bc_encoder.h"
+#include "core/thread_pool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BC_ENCODER_SSE2 1
+#endif
+
+namespace
+{
+    // Block texels split into one array per channel, so four texels fit in one SSE register.
+    struct BlockChannels
+    {
+        alignas(16) float Values[4][16];
+    };
+
+    BlockChannels SplitChannels(const uint8_t block[64])
+    {
+        BlockChannels channels{};
+        for (uint32_t i = 0; i < 16; i++)
+            for (uint32_t c = 0; c < 4; c++)
+                channels.Values[c][i] = static_cast<float>(block[i * 4 + c]);
+        return channels;
+    }
+
+    // Projects channels [firstChannel, firstChannel + channelCount) of each texel onto the segment e0 -> e1
+    // and rounds to the nearest of `levels` evenly spaced steps along it.
+    void ProjectToLevels(
+            const BlockChannels& channels,
+            uint32_t firstChannel,
+            uint32_t channelCount,
+            const float* e0,
+            const float* e1,
+            int levels,
+            uint8_t out[16])
+    {
+        float direction[4] = {};
+        float lengthSq = 0.0f;
+        for (uint32_t c = 0; c < channelCount; c++)
+        {
+            direction[c] = e1[c] - e0[c];
+            lengthSq += direction[c] * direction[c];
+        }
+
+        if (lengthSq < 1e-6f)
+        {
+            std::memset(out, 0, 16);
+            return;
+        }
+
+        float scale = static_cast<float>(levels - 1) / lengthSq;
+
+#ifdef BC_ENCODER_SSE2
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 maxLevel = _mm_set1_ps(static_cast<float>(levels - 1));
+        for (uint32_t i = 0; i < 16; i += 4)
+        {
+            __m128 t = zero;
+            for (uint32_t c = 0; c < channelCount; c++)
+            {
+                __m128 offset = _mm_sub_ps(_mm_load_ps(&channels.Values[firstChannel + c][i]), _mm_set1_ps(e0[c]));
+                t = _mm_add_ps(t, _mm_mul_ps(offset, _mm_set1_ps(direction[c] * scale)));
+            }
+            t = _mm_min_ps(_mm_max_ps(t, zero), maxLevel);
+
+            alignas(16) int32_t lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_cvtps_epi32(t));
+            for (uint32_t k = 0; k < 4; k++)
+                out[i + k] = static_cast<uint8_t>(lanes[k]);
+        }
+#else
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            float t = 0.0f;
+            for (uint32_t c = 0; c < channelCount; c++)
+                t += (channels.Values[firstChannel + c][i] - e0[c]) * direction[c] * scale;
+            t = std::clamp(t, 0.0f, static_cast<float>(levels - 1));
+            out[i] = static_cast<uint8_t>(std::lround(t));
+        }
+#endif
+    }
+
+    // Mean of the texels and the dominant direction of their spread, by power iteration on the covariance.
+    void PrincipalAxis(const BlockChannels& channels, uint32_t channelCount, float mean[4], float axis[4])
+    {
+        for (uint32_t c = 0; c < channelCount; c++)
+        {
+            mean[c] = 0.0f;
+            for (uint32_t i = 0; i < 16; i++)
+                mean[c] += channels.Values[c][i];
+            mean[c] /= 16.0f;
+        }
+
+        float covariance[4][4] = {};
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            float delta[4];
+            for (uint32_t c = 0; c < channelCount; c++)
+                delta[c] = channels.Values[c][i] - mean[c];
+            for (uint32_t a = 0; a < channelCount; a++)
+                for (uint32_t b = 0; b < channelCount; b++)
+                    covariance[a][b] += delta[a] * delta[b];
+        }
+
+        // Start from the per-channel extent, which is rarely orthogonal to the principal axis.
+        for (uint32_t c = 0; c < channelCount; c++)
+        {
+            auto [lo, hi] = std::minmax_element(channels.Values[c], channels.Values[c] + 16);
+            axis[c] = *hi - *lo;
+        }
+
+        for (uint32_t iteration = 0; iteration < 8; iteration++)
+        {
+            float next[4] = {};
+            float largest = 0.0f;
+            for (uint32_t a = 0; a < channelCount; a++)
+            {
+                for (uint32_t b = 0; b < channelCount; b++)
+                    next[a] += covariance[a][b] * axis[b];
+                largest = std::max(largest, std::abs(next[a]));
+            }
+
+            if (largest < 1e-8f)
+                break;
+
+            for (uint32_t c = 0; c < channelCount; c++)
+                axis[c] = next[c] / largest;
+        }
+
+        float length = 0.0f;
+        for (uint32_t c = 0; c < channelCount; c++)
+            length += axis[c] * axis[c];
+        length = std::sqrt(length);
+
+        for (uint32_t c = 0; c < channelCount; c++)
+            axis[c] = length > 0.0f ? axis[c] / length : 0.0f;
+    }
+
+    // The two points on the principal axis that bound the texels' projections.
+    void AxisEndpoints(const BlockChannels& channels, uint32_t channelCount, float lo[4], float hi[4])
+    {
+        float mean[4], axis[4];
+        PrincipalAxis(channels, channelCount, mean, axis);
+
+        float tMin = 0.0f, tMax = 0.0f;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            float t = 0.0f;
+            for (uint32_t c = 0; c < channelCount; c++)
+                t += (channels.Values[c][i] - mean[c]) * axis[c];
+            tMin = std::min(tMin, t);
+            tMax = std::max(tMax, t);
+        }
+
+        for (uint32_t c = 0; c < channelCount; c++)
+        {
+            lo[c] = std::clamp(mean[c] + axis[c] * tMin, 0.0f, 255.0f);
+            hi[c] = std::clamp(mean[c] + axis[c] * tMax, 0.0f, 255.0f);
+        }
+    }
+
+    uint16_t PackRGB565(const float color[3])
+    {
+        auto r = static_cast<uint16_t>(std::clamp(std::lround(color[0] * 31.0f / 255.0f), 0l, 31l));
+        auto g = static_cast<uint16_t>(std::clamp(std::lround(color[1] * 63.0f / 255.0f), 0l, 63l));
+        auto b = static_cast<uint16_t>(std::clamp(std::lround(color[2] * 31.0f / 255.0f), 0l, 31l));
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    void UnpackRGB565(uint16_t packed, float color[3])
+    {
+        uint32_t r = (packed >> 11) & 31;
+        uint32_t g = (packed >> 5) & 63;
+        uint32_t b = packed & 31;
+        color[0] = static_cast<float>((r << 3) | (r >> 2));
+        color[1] = static_cast<float>((g << 2) | (g >> 4));
+        color[2] = static_cast<float>((b << 3) | (b >> 2));
+    }
+
+    // Orders the endpoints for four-colour mode, assigns each texel the nearest palette entry and
+    // returns the squared error. levels[i] is the texel's step from c0 (0) to c1 (3).
+    float FitColorIndices(const BlockChannels& channels, uint16_t& c0, uint16_t& c1, uint8_t levels[16], uint8_t indices[16])
+    {
+        if (c0 < c1)
+            std::swap(c0, c1);
+
+        float e0[3], e1[3];
+        UnpackRGB565(c0, e0);
+        UnpackRGB565(c1, e1);
+
+        if (c0 == c1)
+            std::memset(levels, 0, 16);
+        else
+            ProjectToLevels(channels, 0, 3, e0, e1, 4, levels);
+
+        static constexpr uint8_t LevelToIndex[4] = { 0, 2, 3, 1 };
+
+        float error = 0.0f;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            float w = static_cast<float>(levels[i]) / 3.0f;
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                float delta = channels.Values[c][i] - (e0[c] * (1.0f - w) + e1[c] * w);
+                error += delta * delta;
+            }
+            indices[i] = LevelToIndex[levels[i]];
+        }
+        return error;
+    }
+
+    // Least-squares endpoints for fixed palette weights.
+    bool RefitColorEndpoints(const BlockChannels& channels, const uint8_t levels[16], float e0[3], float e1[3])
+    {
+        float a = 0.0f, b = 0.0f, c = 0.0f;
+        float x[3] = {}, y[3] = {};
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            float w = static_cast<float>(levels[i]) / 3.0f;
+            a += (1.0f - w) * (1.0f - w);
+            b += (1.0f - w) * w;
+            c += w * w;
+            for (uint32_t ch = 0; ch < 3; ch++)
+            {
+                x[ch] += (1.0f - w) * channels.Values[ch][i];
+                y[ch] += w * channels.Values[ch][i];
+            }
+        }
+
+        float determinant = a * c - b * b;
+        if (std::abs(determinant) < 1e-6f)
+            return false;
+
+        for (uint32_t ch = 0; ch < 3; ch++)
+        {
+            e0[ch] = std::clamp((c * x[ch] - b * y[ch]) / determinant, 0.0f, 255.0f);
+            e1[ch] = std::clamp((a * y[ch] - b * x[ch]) / determinant, 0.0f, 255.0f);
+        }
+        return true;
+    }
+
+    void EncodeColorBlock(const BlockChannels& channels, uint8_t* output)
+    {
+        float lo[4], hi[4];
+        AxisEndpoints(channels, 3, lo, hi);
+
+        uint16_t c0 = PackRGB565(hi);
+        uint16_t c1 = PackRGB565(lo);
+        uint8_t levels[16], indices[16];
+        float error = FitColorIndices(channels, c0, c1, levels, indices);
+
+        float e0[3], e1[3];
+        if (c0 != c1 && RefitColorEndpoints(channels, levels, e0, e1))
+        {
+            uint16_t refitC0 = PackRGB565(e0);
+            uint16_t refitC1 = PackRGB565(e1);
+            uint8_t refitLevels[16], refitIndices[16];
+            float refitError = FitColorIndices(channels, refitC0, refitC1, refitLevels, refitIndices);
+            if (refitError < error)
+            {
+                c0 = refitC0;
+                c1 = refitC1;
+                std::memcpy(indices, refitIndices, 16);
+            }
+        }
+
+        uint32_t packedIndices = 0;
+        for (uint32_t i = 0; i < 16; i++)
+            packedIndices |= static_cast<uint32_t>(indices[i]) << (2 * i);
+
+        output[0] = static_cast<uint8_t>(c0 & 0xFF);
+        output[1] = static_cast<uint8_t>(c0 >> 8);
+        output[2] = static_cast<uint8_t>(c1 & 0xFF);
+        output[3] = static_cast<uint8_t>(c1 >> 8);
+        std::memcpy(output + 4, &packedIndices, 4);
+    }
+
+    // BC4: one channel, two 8-bit endpoints and eight interpolated steps.
+    void EncodeSingleChannelBlock(const BlockChannels& channels, uint32_t channel, uint8_t* output)
+    {
+        auto [lo, hi] = std::minmax_element(channels.Values[channel], channels.Values[channel] + 16);
+        auto a0 = static_cast<uint8_t>(std::lround(*hi));
+        auto a1 = static_cast<uint8_t>(std::lround(*lo));
+        output[0] = a0;
+        output[1] = a1;
+
+        uint64_t packedIndices = 0;
+        if (a0 > a1)
+        {
+            float e0 = a0, e1 = a1;
+            uint8_t levels[16];
+            ProjectToLevels(channels, channel, 1, &e0, &e1, 8, levels);
+
+            static constexpr uint8_t LevelToIndex[8] = { 0, 2, 3, 4, 5, 6, 7, 1 };
+            for (uint32_t i = 0; i < 16; i++)
+                packedIndices |= static_cast<uint64_t>(LevelToIndex[levels[i]]) << (3 * i);
+        }
+
+        for (uint32_t i = 0; i < 6; i++)
+            output[2 + i] = static_cast<uint8_t>(packedIndices >> (8 * i));
+    }
+
+    struct BitWriter
+    {
+        uint64_t Bits[2] = {};
+        uint32_t Position = 0;
+
+        void Write(uint32_t value, uint32_t count)
+        {
+            for (uint32_t bit = 0; bit < count; bit++, Position++)
+                if ((value >> bit) & 1)
+                    Bits[Position / 64] |= 1ull << (Position % 64);
+        }
+    };
+
+    struct BitReader
+    {
+        uint64_t Bits[2] = {};
+        uint32_t Position = 0;
+
+        uint32_t Read(uint32_t count)
+        {
+            uint32_t value = 0;
+            for (uint32_t bit = 0; bit < count; bit++, Position++)
+                value |= static_cast<uint32_t>((Bits[Position / 64] >> (Position % 64)) & 1) << bit;
+            return value;
+        }
+    };
+
+    // Mode 6 stores RGBA endpoints as 7 bits plus a parity bit shared by the endpoint's four channels.
+    void QuantizeEndpointWithParity(const float endpoint[4], uint8_t quantized[4], uint8_t& parity)
+    {
+        float bestError = -1.0f;
+        for (uint8_t p = 0; p < 2; p++)
+        {
+            uint8_t candidate[4];
+            float error = 0.0f;
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                candidate[c] = static_cast<uint8_t>(std::clamp(std::lround((endpoint[c] - p) * 0.5f), 0l, 127l));
+                float delta = static_cast<float>(candidate[c] * 2 + p) - endpoint[c];
+                error += delta * delta;
+            }
+
+            if (bestError < 0.0f || error < bestError)
+            {
+                bestError = error;
+                parity = p;
+                std::memcpy(quantized, candidate, 4);
+            }
+        }
+    }
+
+    constexpr uint32_t BC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    void EncodeBC7Block(const BlockChannels& channels, uint8_t* output)
+    {
+        float lo[4], hi[4];
+        AxisEndpoints(channels, 4, lo, hi);
+
+        uint8_t q0[4], q1[4], p0, p1;
+        QuantizeEndpointWithParity(lo, q0, p0);
+        QuantizeEndpointWithParity(hi, q1, p1);
+
+        float e0[4], e1[4];
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            e0[c] = static_cast<float>(q0[c] * 2 + p0);
+            e1[c] = static_cast<float>(q1[c] * 2 + p1);
+        }
+
+        uint8_t indices[16];
+        ProjectToLevels(channels, 0, 4, e0, e1, 16, indices);
+
+        // The anchor texel's index drops its top bit, so it must be below 8.
+        if (indices[0] >= 8)
+        {
+            std::swap(q0, q1);
+            std::swap(p0, p1);
+            for (uint8_t& index : indices)
+                index = static_cast<uint8_t>(15 - index);
+        }
+
+        BitWriter writer;
+        writer.Write(1u << 6, 7);
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            writer.Write(q0[c], 7);
+            writer.Write(q1[c], 7);
+        }
+        writer.Write(p0, 1);
+        writer.Write(p1, 1);
+        writer.Write(indices[0], 3);
+        for (uint32_t i = 1; i < 16; i++)
+            writer.Write(indices[i], 4);
+
+        std::memcpy(output, writer.Bits, 16);
+    }
+
+    void DecodeColorBlock(const uint8_t* input, uint8_t block[64], bool forceFourColor)
+    {
+        uint16_t c0 = static_cast<uint16_t>(input[0] | (input[1] << 8));
+        uint16_t c1 = static_cast<uint16_t>(input[2] | (input[3] << 8));
+        uint32_t packedIndices;
+        std::memcpy(&packedIndices, input + 4, 4);
+
+        float e0[3], e1[3];
+        UnpackRGB565(c0, e0);
+        UnpackRGB565(c1, e1);
+
+        uint8_t palette[4][4];
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            auto a = static_cast<uint32_t>(e0[c]);
+            auto b = static_cast<uint32_t>(e1[c]);
+            palette[0][c] = static_cast<uint8_t>(a);
+            palette[1][c] = static_cast<uint8_t>(b);
+            if (forceFourColor || c0 > c1)
+            {
+                palette[2][c] = static_cast<uint8_t>((2 * a + b) / 3);
+                palette[3][c] = static_cast<uint8_t>((a + 2 * b) / 3);
+            }
+            else
+            {
+                palette[2][c] = static_cast<uint8_t>((a + b) / 2);
+                palette[3][c] = 0;
+            }
+        }
+        palette[0][3] = palette[1][3] = palette[2][3] = 255;
+        palette[3][3] = forceFourColor || c0 > c1 ? 255 : 0;
+
+        for (uint32_t i = 0; i < 16; i++)
+            std::memcpy(block + i * 4, palette[(packedIndices >> (2 * i)) & 3], 4);
+    }
+
+    void DecodeSingleChannelBlock(const uint8_t* input, uint8_t block[64], uint32_t channel)
+    {
+        uint32_t a0 = input[0];
+        uint32_t a1 = input[1];
+
+        uint8_t palette[8];
+        palette[0] = static_cast<uint8_t>(a0);
+        palette[1] = static_cast<uint8_t>(a1);
+        if (a0 > a1)
+        {
+            for (uint32_t i = 2; i < 8; i++)
+                palette[i] = static_cast<uint8_t>(((8 - i) * a0 + (i - 1) * a1) / 7);
+        }
+        else
+        {
+            for (uint32_t i = 2; i < 6; i++)
+                palette[i] = static_cast<uint8_t>(((6 - i) * a0 + (i - 1) * a1) / 5);
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        uint64_t packedIndices = 0;
+        for (uint32_t i = 0; i < 6; i++)
+            packedIndices |= static_cast<uint64_t>(input[2 + i]) << (8 * i);
+
+        for (uint32_t i = 0; i < 16; i++)
+            block[i * 4 + channel] = palette[(packedIndices >> (3 * i)) & 7];
+    }
+
+    void DecodeBC7Block(const uint8_t* input, uint8_t block[64])
+    {
+        BitReader reader;
+        std::memcpy(reader.Bits, input, 16);
+
+        if (reader.Read(7) != (1u << 6))
+        {
+            // Not mode 6: flag the block in magenta rather than decoding modes the encoder never writes.
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                block[i * 4 + 0] = 255;
+                block[i * 4 + 1] = 0;
+                block[i * 4 + 2] = 255;
+                block[i * 4 + 3] = 255;
+            }
+            return;
+        }
+
+        uint32_t q0[4], q1[4];
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            q0[c] = reader.Read(7);
+            q1[c] = reader.Read(7);
+        }
+        uint32_t p0 = reader.Read(1);
+        uint32_t p1 = reader.Read(1);
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            uint32_t index = reader.Read(i == 0 ? 3 : 4);
+            uint32_t weight = BC7Weights4[index];
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                uint32_t e0 = q0[c] * 2 + p0;
+                uint32_t e1 = q1[c] * 2 + p1;
+                block[i * 4 + c] = static_cast<uint8_t>(((64 - weight) * e0 + weight * e1 + 32) >> 6);
+            }
+        }
+    }
+}
+
+namespace BlockCompression
+{
+    uint32_t GetBlockByteSize(BlockFormat format)
+    {
+        return format == BlockFormat::BC1 ? 8 : 16;
+    }
+
+    size_t GetCompressedSize(BlockFormat format, uint32_t width, uint32_t height)
+    {
+        return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * GetBlockByteSize(format);
+    }
+
+    void EncodeBlock(BlockFormat format, const uint8_t block[64], uint8_t* output)
+    {
+        BlockChannels channels = SplitChannels(block);
+
+        switch (format)
+        {
+            case BlockFormat::BC1:
+                EncodeColorBlock(channels, output);
+                return;
+            case BlockFormat::BC3:
+                EncodeSingleChannelBlock(channels, 3, output);
+                EncodeColorBlock(channels, output + 8);
+                return;
+            case BlockFormat::BC5:
+                EncodeSingleChannelBlock(channels, 0, output);
+                EncodeSingleChannelBlock(channels, 1, output + 8);
+                return;
+            case BlockFormat::BC7:
+                EncodeBC7Block(channels, output);
+                return;
+        }
+        assert(false && "Unknown block format");
+    }
+
+    void DecodeBlock(BlockFormat format, const uint8_t* input, uint8_t block[64])
+    {
+        switch (format)
+        {
+            case BlockFormat::BC1:
+                DecodeColorBlock(input, block, false);
+                return;
+            case BlockFormat::BC3:
+                DecodeColorBlock(input + 8, block, true);
+                DecodeSingleChannelBlock(input, block, 3);
+                return;
+            case BlockFormat::BC5:
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    block[i * 4 + 2] = 0;
+                    block[i * 4 + 3] = 255;
+                }
+                DecodeSingleChannelBlock(input, block, 0);
+                DecodeSingleChannelBlock(input + 8, block, 1);
+                return;
+            case BlockFormat::BC7:
+                DecodeBC7Block(input, block);
+                return;
+        }
+        assert(false && "Unknown block format");
+    }
+
+    void CompressImage(
+            BlockFormat format,
+            const uint8_t* rgba,
+            uint32_t width,
+            uint32_t height,
+            uint8_t* output,
+            ThreadPool* pool)
+    {
+        uint32_t blocksX = (width + 3) / 4;
+        uint32_t blocksY = (height + 3) / 4;
+        uint32_t blockBytes = GetBlockByteSize(format);
+
+        auto encodeRows = [&](uint32_t begin, uint32_t end)
+        {
+            uint8_t block[64];
+            for (uint32_t blockY = begin; blockY < end; blockY++)
+            {
+                for (uint32_t blockX = 0; blockX < blocksX; blockX++)
+                {
+                    for (uint32_t y = 0; y < 4; y++)
+                    {
+                        uint32_t sourceY = std::min(blockY * 4 + y, height - 1);
+                        for (uint32_t x = 0; x < 4; x++)
+                        {
+                            uint32_t sourceX = std::min(blockX * 4 + x, width - 1);
+                            std::memcpy(block + (y * 4 + x) * 4, rgba + (static_cast<size_t>(sourceY) * width + sourceX) * 4, 4);
+                        }
+                    }
+
+                    EncodeBlock(format, block, output + (static_cast<size_t>(blockY) * blocksX + blockX) * blockBytes);
+                }
+            }
+        };
+
+        if (pool)
+            pool->ParallelFor(blocksY, encodeRows);
+        else
+            encodeRows(0, blocksY);
+    }
+
+    void DecompressImage(
+            BlockFormat format,
+            const uint8_t* input,
+            uint32_t width,
+            uint32_t height,
+            uint8_t* rgba)
+    {
+        uint32_t blocksX = (width + 3) / 4;
+        uint32_t blocksY = (height + 3) / 4;
+        uint32_t blockBytes = GetBlockByteSize(format);
+
+        uint8_t block[64];
+        for (uint32_t blockY = 0; blockY < blocksY; blockY++)
+        {
+            for (uint32_t blockX = 0; blockX < blocksX; blockX++)
+            {
+                DecodeBlock(format, input + (static_cast<size_t>(blockY) * blocksX + blockX) * blockBytes, block);
+
+                for (uint32_t y = 0; y < 4 && blockY * 4 + y < height; y++)
+                    for (uint32_t x = 0; x < 4 && blockX * 4 + x < width; x++)
+                        std::memcpy(rgba + (static_cast<size_t>(blockY * 4 + y) * width + blockX * 4 + x) * 4, block + (y * 4 + x) * 4, 4);
+            }
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class ThreadPool;
+
+enum class BlockFormat
+{
+    BC1,    // RGB, always encoded in four-colour (opaque) mode
+    BC3,    // BC1 colour + BC4 alpha
+    BC5,    // Two BC4 channels from R and G
+    BC7     // RGBA, mode 6 only
+};
+
+// CPU encoders for 4x4 block-compressed formats. Endpoints come from the principal axis of each block
+// and texels are quantized by projecting onto it, four texels at a time with SSE2 where available.
+namespace BlockCompression
+{
+    uint32_t GetBlockByteSize(BlockFormat format);
+    size_t GetCompressedSize(BlockFormat format, uint32_t width, uint32_t height);
+
+    // block is 16 RGBA8 texels, row-major.
+    void EncodeBlock(BlockFormat format, const uint8_t block[64], uint8_t* output);
+    // Inverse of EncodeBlock; BC7 only decodes mode 6, the one mode the encoder emits.
+    void DecodeBlock(BlockFormat format, const uint8_t* input, uint8_t block[64]);
+
+    // Compresses a tightly packed RGBA8 image. Partial edge blocks repeat the last row and column.
+    // With a pool, rows of blocks are spread across its workers.
+    void CompressImage(
+            BlockFormat format,
+            const uint8_t* rgba,
+            uint32_t width,
+            uint32_t height,
+            uint8_t* output,
+            ThreadPool* pool = nullptr);
+
+    void DecompressImage(
+            BlockFormat format,
+            const uint8_t* input,
+            uint32_t width,
+            uint32_t height,
+            uint8_t* rgba);
+}
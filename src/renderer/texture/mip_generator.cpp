@@ -0,0 +1,364 @@
+#include "mip_generator.h"
+#include "core/thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MIP_GENERATOR_SSE2 1
+#endif
+
+namespace
+{
+    // Kaiser support in destination texels either side of the centre, and window shape.
+    constexpr float KaiserRadius = 2.0f;
+    constexpr float KaiserAlpha = 4.0f;
+
+    // Taps for every output texel along one axis, TapCount per texel with unused taps weighted zero.
+    struct ResampleKernel
+    {
+        uint32_t TapCount = 0;
+        std::vector<uint32_t> Indices;
+        std::vector<float> Weights;
+    };
+
+    float BesselI0(float x)
+    {
+        float sum = 1.0f;
+        float term = 1.0f;
+        float halfSquared = x * x * 0.25f;
+        for (int k = 1; k < 32 && term > sum * 1e-8f; k++)
+        {
+            term *= halfSquared / static_cast<float>(k * k);
+            sum += term;
+        }
+        return sum;
+    }
+
+    float Sinc(float x)
+    {
+        if (std::fabs(x) < 1e-6f)
+            return 1.0f;
+        float angle = 3.14159265358979f * x;
+        return std::sin(angle) / angle;
+    }
+
+    float KaiserWeight(float x)
+    {
+        float t = x / KaiserRadius;
+        if (t * t >= 1.0f)
+            return 0.0f;
+        return Sinc(x) * BesselI0(KaiserAlpha * std::sqrt(1.0f - t * t)) / BesselI0(KaiserAlpha);
+    }
+
+    uint32_t AddressTexel(int64_t index, uint32_t extent, bool wrap)
+    {
+        auto size = static_cast<int64_t>(extent);
+        if (wrap)
+            return static_cast<uint32_t>(((index % size) + size) % size);
+        return static_cast<uint32_t>(std::clamp<int64_t>(index, 0, size - 1));
+    }
+
+    ResampleKernel BuildKernel(uint32_t sourceExtent, uint32_t targetExtent, const MipOptions& options)
+    {
+        ResampleKernel kernel;
+        if (sourceExtent == targetExtent)
+        {
+            kernel.TapCount = 1;
+            kernel.Weights.assign(targetExtent, 1.0f);
+            kernel.Indices.resize(targetExtent);
+            for (uint32_t i = 0; i < targetExtent; i++)
+                kernel.Indices[i] = i;
+            return kernel;
+        }
+
+        // Positions are in source texels; output texel i covers [i * scale, (i + 1) * scale).
+        float scale = static_cast<float>(sourceExtent) / static_cast<float>(targetExtent);
+        float support = options.Filter == MipFilter::Box ? 0.5f * scale : KaiserRadius * scale;
+        for (uint32_t i = 0; i < targetExtent; i++)
+        {
+            float centre = (static_cast<float>(i) + 0.5f) * scale;
+            auto span = static_cast<int64_t>(std::ceil(centre + support)) - static_cast<int64_t>(std::floor(centre - support));
+            kernel.TapCount = std::max(kernel.TapCount, static_cast<uint32_t>(span));
+        }
+        kernel.Indices.resize(static_cast<size_t>(targetExtent) * kernel.TapCount);
+        kernel.Weights.resize(static_cast<size_t>(targetExtent) * kernel.TapCount);
+
+        for (uint32_t i = 0; i < targetExtent; i++)
+        {
+            float centre = (static_cast<float>(i) + 0.5f) * scale;
+            auto first = static_cast<int64_t>(std::floor(centre - support));
+            size_t base = static_cast<size_t>(i) * kernel.TapCount;
+
+            float total = 0.0f;
+            for (uint32_t tap = 0; tap < kernel.TapCount; tap++)
+            {
+                int64_t texel = first + tap;
+                float weight;
+                if (options.Filter == MipFilter::Box)
+                {
+                    float begin = std::max(static_cast<float>(texel), centre - support);
+                    float end = std::min(static_cast<float>(texel + 1), centre + support);
+                    weight = std::max(end - begin, 0.0f);
+                }
+                else
+                {
+                    weight = KaiserWeight((static_cast<float>(texel) + 0.5f - centre) / scale);
+                }
+
+                kernel.Indices[base + tap] = AddressTexel(texel, sourceExtent, options.Wrap);
+                kernel.Weights[base + tap] = weight;
+                total += weight;
+            }
+
+            for (uint32_t tap = 0; tap < kernel.TapCount; tap++)
+                kernel.Weights[base + tap] /= total;
+        }
+        return kernel;
+    }
+
+    void ForEachRow(uint32_t rowCount, const MipOptions& options, const std::function<void(uint32_t, uint32_t)>& fn)
+    {
+        if (options.Pool)
+            options.Pool->ParallelFor(rowCount, fn);
+        else
+            fn(0, rowCount);
+    }
+
+    void ResampleRow(const float* source, float* target, uint32_t targetWidth, const ResampleKernel& kernel)
+    {
+        for (uint32_t x = 0; x < targetWidth; x++)
+        {
+            const uint32_t* indices = &kernel.Indices[static_cast<size_t>(x) * kernel.TapCount];
+            const float* weights = &kernel.Weights[static_cast<size_t>(x) * kernel.TapCount];
+
+#ifdef MIP_GENERATOR_SSE2
+            __m128 sum = _mm_setzero_ps();
+            for (uint32_t tap = 0; tap < kernel.TapCount; tap++)
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[tap]), _mm_loadu_ps(source + indices[tap] * 4)));
+            _mm_storeu_ps(target + x * 4, sum);
+#else
+            float sum[4] = {};
+            for (uint32_t tap = 0; tap < kernel.TapCount; tap++)
+                for (uint32_t c = 0; c < 4; c++)
+                    sum[c] += weights[tap] * source[indices[tap] * 4 + c];
+            for (uint32_t c = 0; c < 4; c++)
+                target[x * 4 + c] = sum[c];
+#endif
+        }
+    }
+
+    // Blends whole rows, so the inner loop runs over contiguous floats.
+    void BlendRows(const float* const* rows, const float* weights, uint32_t rowCount, float* target, size_t floatCount)
+    {
+#ifdef MIP_GENERATOR_SSE2
+        for (size_t i = 0; i < floatCount; i += 4)
+        {
+            __m128 sum = _mm_setzero_ps();
+            for (uint32_t row = 0; row < rowCount; row++)
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[row]), _mm_loadu_ps(rows[row] + i)));
+            _mm_storeu_ps(target + i, sum);
+        }
+#else
+        for (size_t i = 0; i < floatCount; i++)
+        {
+            float sum = 0.0f;
+            for (uint32_t row = 0; row < rowCount; row++)
+                sum += weights[row] * rows[row][i];
+            target[i] = sum;
+        }
+#endif
+    }
+
+    // Resamples each level from the one above it. Levels 1 onwards are written packed into chain.
+    void GenerateLinearChain(const float* source, uint32_t width, uint32_t height, uint32_t mipCount, float* chain, const MipOptions& options)
+    {
+        std::vector<float> horizontal;
+        const float* level = source;
+        float* target = chain;
+
+        for (uint32_t mip = 1; mip < mipCount; mip++)
+        {
+            uint32_t targetWidth = std::max(width / 2, 1u);
+            uint32_t targetHeight = std::max(height / 2, 1u);
+            ResampleKernel columns = BuildKernel(width, targetWidth, options);
+            ResampleKernel rows = BuildKernel(height, targetHeight, options);
+
+            horizontal.resize(static_cast<size_t>(height) * targetWidth * 4);
+            ForEachRow(height, options, [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t y = begin; y < end; y++)
+                    ResampleRow(level + static_cast<size_t>(y) * width * 4, horizontal.data() + static_cast<size_t>(y) * targetWidth * 4, targetWidth, columns);
+            });
+
+            ForEachRow(targetHeight, options, [&](uint32_t begin, uint32_t end)
+            {
+                std::vector<const float*> sourceRows(rows.TapCount);
+                for (uint32_t y = begin; y < end; y++)
+                {
+                    for (uint32_t tap = 0; tap < rows.TapCount; tap++)
+                        sourceRows[tap] = horizontal.data() + static_cast<size_t>(rows.Indices[static_cast<size_t>(y) * rows.TapCount + tap]) * targetWidth * 4;
+
+                    BlendRows(sourceRows.data(), &rows.Weights[static_cast<size_t>(y) * rows.TapCount], rows.TapCount,
+                              target + static_cast<size_t>(y) * targetWidth * 4, static_cast<size_t>(targetWidth) * 4);
+                }
+            });
+
+            level = target;
+            target += static_cast<size_t>(targetWidth) * targetHeight * 4;
+            width = targetWidth;
+            height = targetHeight;
+        }
+    }
+
+    float SRGBToLinear(float value)
+    {
+        return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    float LinearToSRGB(float value)
+    {
+        return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    }
+
+    constexpr uint32_t EncodeTableSize = 65536;
+
+    const std::vector<float>& GetDecodeTable(bool srgb)
+    {
+        static const std::vector<float> tables[2] = {
+            [] { std::vector<float> t(256); for (uint32_t i = 0; i < 256; i++) t[i] = static_cast<float>(i) / 255.0f; return t; }(),
+            [] { std::vector<float> t(256); for (uint32_t i = 0; i < 256; i++) t[i] = SRGBToLinear(static_cast<float>(i) / 255.0f); return t; }()
+        };
+        return tables[srgb ? 1 : 0];
+    }
+
+    // Linear [0, 1] quantized to 16 bits, mapped to the nearest sRGB code.
+    const std::vector<uint8_t>& GetSRGBEncodeTable()
+    {
+        static const std::vector<uint8_t> table = []
+        {
+            std::vector<uint8_t> t(EncodeTableSize);
+            for (uint32_t i = 0; i < EncodeTableSize; i++)
+                t[i] = static_cast<uint8_t>(LinearToSRGB(static_cast<float>(i) / (EncodeTableSize - 1)) * 255.0f + 0.5f);
+            return t;
+        }();
+        return table;
+    }
+
+    // srgbTable decodes the colour channels when set; alpha is always linear.
+    void DecodeTexel(const uint8_t* texel, float* linear, const float* srgbTable)
+    {
+#ifdef MIP_GENERATOR_SSE2
+        uint32_t packed;
+        std::memcpy(&packed, texel, sizeof(packed));
+        __m128i zero = _mm_setzero_si128();
+        __m128i widened = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(packed)), zero), zero);
+        _mm_storeu_ps(linear, _mm_mul_ps(_mm_cvtepi32_ps(widened), _mm_set1_ps(1.0f / 255.0f)));
+#else
+        for (uint32_t c = 0; c < 4; c++)
+            linear[c] = static_cast<float>(texel[c]) / 255.0f;
+#endif
+        if (srgbTable)
+        {
+            linear[0] = srgbTable[texel[0]];
+            linear[1] = srgbTable[texel[1]];
+            linear[2] = srgbTable[texel[2]];
+        }
+    }
+
+    // Kaiser lobes can overshoot, so values are clamped before quantizing.
+    void EncodeTexel(const float* linear, uint8_t* texel, const uint8_t* srgbTable)
+    {
+#ifdef MIP_GENERATOR_SSE2
+        __m128 clamped = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(linear), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+        __m128i quantized = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(clamped, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+        quantized = _mm_packs_epi32(quantized, quantized);
+        auto packed = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(quantized, quantized)));
+        std::memcpy(texel, &packed, sizeof(packed));
+
+        if (srgbTable)
+        {
+            alignas(16) float values[4];
+            _mm_store_ps(values, _mm_mul_ps(clamped, _mm_set1_ps(EncodeTableSize - 1)));
+            for (uint32_t c = 0; c < 3; c++)
+                texel[c] = srgbTable[static_cast<uint32_t>(values[c] + 0.5f)];
+        }
+#else
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            float value = std::clamp(linear[c], 0.0f, 1.0f);
+            texel[c] = srgbTable && c < 3
+                    ? srgbTable[static_cast<uint32_t>(value * (EncodeTableSize - 1) + 0.5f)]
+                    : static_cast<uint8_t>(value * 255.0f + 0.5f);
+        }
+#endif
+    }
+}
+
+namespace MipGeneration
+{
+    uint32_t GetMipCount(uint32_t width, uint32_t height)
+    {
+        uint32_t count = 1;
+        for (uint32_t extent = std::max(width, height); extent > 1; extent /= 2)
+            count++;
+        return count;
+    }
+
+    uint32_t GetMipExtent(uint32_t extent, uint32_t mip)
+    {
+        return std::max(extent >> mip, 1u);
+    }
+
+    size_t GetChainTexelCount(uint32_t width, uint32_t height, uint32_t mipCount)
+    {
+        size_t count = 0;
+        for (uint32_t mip = 0; mip < mipCount; mip++)
+            count += static_cast<size_t>(GetMipExtent(width, mip)) * GetMipExtent(height, mip);
+        return count;
+    }
+
+    void Generate(const uint8_t* source, uint32_t width, uint32_t height, uint32_t mipCount, uint8_t* destination, const MipOptions& options)
+    {
+        if (mipCount <= 1)
+            return;
+
+        const std::vector<float>& colourTable = GetDecodeTable(options.SRGB);
+        const std::vector<uint8_t>& encodeTable = GetSRGBEncodeTable();
+
+        // Left uninitialized; every float is written before it is read.
+        size_t levelTexels = static_cast<size_t>(width) * height;
+        std::unique_ptr<float[]> linear(new float[levelTexels * 4]);
+        ForEachRow(height, options, [&](uint32_t begin, uint32_t end)
+        {
+            for (size_t i = static_cast<size_t>(begin) * width; i < static_cast<size_t>(end) * width; i++)
+                DecodeTexel(source + i * 4, linear.get() + i * 4, options.SRGB ? colourTable.data() : nullptr);
+        });
+
+        size_t chainTexels = GetChainTexelCount(width, height, mipCount) - levelTexels;
+        std::unique_ptr<float[]> chain(new float[chainTexels * 4]);
+        GenerateLinearChain(linear.get(), width, height, mipCount, chain.get(), options);
+
+        constexpr uint32_t TexelsPerJob = 4096;
+        auto jobCount = static_cast<uint32_t>((chainTexels + TexelsPerJob - 1) / TexelsPerJob);
+        ForEachRow(jobCount, options, [&](uint32_t begin, uint32_t end)
+        {
+            size_t last = std::min(static_cast<size_t>(end) * TexelsPerJob, chainTexels);
+            for (size_t i = static_cast<size_t>(begin) * TexelsPerJob; i < last; i++)
+                EncodeTexel(chain.get() + i * 4, destination + i * 4, options.SRGB ? encodeTable.data() : nullptr);
+        });
+    }
+
+    void Generate(const float* source, uint32_t width, uint32_t height, uint32_t mipCount, float* destination, const MipOptions& options)
+    {
+        if (mipCount <= 1)
+            return;
+
+        GenerateLinearChain(source, width, height, mipCount, destination, options);
+    }
+}
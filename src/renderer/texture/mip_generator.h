@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class ThreadPool;
+
+enum class MipFilter
+{
+    Box,        // Exact area average, including the fractional texels of odd extents
+    Kaiser      // Kaiser-windowed sinc, sharper with little ringing
+};
+
+struct MipOptions
+{
+    MipFilter Filter = MipFilter::Kaiser;
+    // RGBA8 only: colour is filtered in linear space and re-encoded; alpha is always linear.
+    bool SRGB = false;
+    // Sample across the opposite edge instead of clamping, for textures sampled with repeat.
+    bool Wrap = false;
+    // Rows are spread across the pool's workers. Must not be set when called from one of them.
+    ThreadPool* Pool = nullptr;
+};
+
+// CPU mip chain generation for tightly packed RGBA images. Level extents follow Vulkan (max(extent >> mip, 1)),
+// and each level is resampled from the one above with a separable polyphase kernel, so odd extents are
+// weighted by true coverage rather than truncated.
+namespace MipGeneration
+{
+    uint32_t GetMipCount(uint32_t width, uint32_t height);
+    uint32_t GetMipExtent(uint32_t extent, uint32_t mip);
+    // Texels in levels [0, mipCount).
+    size_t GetChainTexelCount(uint32_t width, uint32_t height, uint32_t mipCount);
+
+    // Writes levels 1 to mipCount - 1 of source, packed back to back, to destination. Level 0 is not copied,
+    // so destination may point just past it in a buffer holding the whole chain.
+    void Generate(
+            const uint8_t* source,
+            uint32_t width,
+            uint32_t height,
+            uint32_t mipCount,
+            uint8_t* destination,
+            const MipOptions& options = {});
+
+    void Generate(
+            const float* source,
+            uint32_t width,
+            uint32_t height,
+            uint32_t mipCount,
+            float* destination,
+            const MipOptions& options = {});
+}
@@ -0,0 +1,453 @@
+#include "texture_container.h"
+#include "core/mapped_file.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+    constexpr uint8_t Ktx2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    // Khronos Data Format enumerants used by the descriptors below.
+    constexpr uint32_t ModelRGBSDA = 1;
+    constexpr uint32_t ModelBC1A = 128;
+    constexpr uint32_t ModelBC3 = 130;
+    constexpr uint32_t ModelBC5 = 132;
+    constexpr uint32_t ModelBC7 = 134;
+    constexpr uint32_t PrimariesBT709 = 1;
+    constexpr uint32_t TransferLinear = 1;
+    constexpr uint32_t TransferSRGB = 2;
+    constexpr uint8_t QualifierLinear = 0x10;
+    constexpr uint8_t QualifierSigned = 0x40;
+    constexpr uint8_t QualifierFloat = 0x80;
+
+    struct DfdSample
+    {
+        uint32_t BitOffset;
+        uint32_t BitLength;
+        uint8_t ChannelType;    // Channel id in the low nibble, qualifiers in the high one
+        uint32_t Lower;
+        uint32_t Upper;
+    };
+
+    struct DfdDescription
+    {
+        uint32_t Model = 0;
+        uint32_t Transfer = TransferLinear;
+        bool BlockCompressed = false;
+        uint32_t BytesPerBlock = 0;     // Texel bytes for uncompressed formats
+        uint32_t TypeSize = 1;
+        std::vector<DfdSample> Samples;
+    };
+
+    bool DescribeFormat(VkFormat format, DfdDescription& out)
+    {
+        constexpr uint32_t Full = 0xFFFFFFFF;
+
+        switch (format)
+        {
+            case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+                out = { ModelBC1A, format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK ? TransferSRGB : TransferLinear, true, 8, 1,
+                        { { 0, 64, 1, 0, Full } } };
+                return true;
+            case VK_FORMAT_BC3_UNORM_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:
+                out = { ModelBC3, format == VK_FORMAT_BC3_SRGB_BLOCK ? TransferSRGB : TransferLinear, true, 16, 1,
+                        { { 0, 64, 15, 0, Full }, { 64, 64, 0, 0, Full } } };
+                return true;
+            case VK_FORMAT_BC5_UNORM_BLOCK:
+                out = { ModelBC5, TransferLinear, true, 16, 1,
+                        { { 0, 64, 0, 0, Full }, { 64, 64, 1, 0, Full } } };
+                return true;
+            case VK_FORMAT_BC7_UNORM_BLOCK:
+            case VK_FORMAT_BC7_SRGB_BLOCK:
+                out = { ModelBC7, format == VK_FORMAT_BC7_SRGB_BLOCK ? TransferSRGB : TransferLinear, true, 16, 1,
+                        { { 0, 128, 0, 0, Full } } };
+                return true;
+            case VK_FORMAT_R8G8B8A8_UNORM:
+            case VK_FORMAT_R8G8B8A8_SRGB:
+            {
+                bool srgb = format == VK_FORMAT_R8G8B8A8_SRGB;
+                // Alpha stays linear in an sRGB format.
+                out = { ModelRGBSDA, srgb ? TransferSRGB : TransferLinear, false, 4, 1,
+                        { { 0, 8, 0, 0, 255 }, { 8, 8, 1, 0, 255 }, { 16, 8, 2, 0, 255 },
+                          { 24, 8, static_cast<uint8_t>(15 | (srgb ? QualifierLinear : 0)), 0, 255 } } };
+                return true;
+            }
+            case VK_FORMAT_R32G32B32A32_SFLOAT:
+            {
+                constexpr uint8_t FloatChannel = QualifierSigned | QualifierFloat;
+                constexpr uint32_t MinusOne = 0xBF800000;
+                constexpr uint32_t One = 0x3F800000;
+                out = { ModelRGBSDA, TransferLinear, false, 16, 4,
+                        { { 0, 32, FloatChannel | 0, MinusOne, One }, { 32, 32, FloatChannel | 1, MinusOne, One },
+                          { 64, 32, FloatChannel | 2, MinusOne, One }, { 96, 32, FloatChannel | 15, MinusOne, One } } };
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    std::vector<uint32_t> BuildDfd(const DfdDescription& description)
+    {
+        auto blockSize = static_cast<uint32_t>(24 + 16 * description.Samples.size());
+
+        std::vector<uint32_t> words;
+        words.push_back(4 + blockSize);                                     // dfdTotalSize
+        words.push_back(0);                                                 // Khronos vendor, basic descriptor type
+        words.push_back(2 | (blockSize << 16));                             // Version 1.3, block size
+        words.push_back(description.Model | (PrimariesBT709 << 8) | (description.Transfer << 16));
+        words.push_back(description.BlockCompressed ? (3 | (3 << 8)) : 0);  // Texel block dimensions minus one
+        words.push_back(description.BytesPerBlock);                         // bytesPlane0
+        words.push_back(0);
+
+        for (const DfdSample& sample : description.Samples)
+        {
+            words.push_back(sample.BitOffset | ((sample.BitLength - 1) << 16) | (static_cast<uint32_t>(sample.ChannelType) << 24));
+            words.push_back(0);     // Sample position at the origin
+            words.push_back(sample.Lower);
+            words.push_back(sample.Upper);
+        }
+        return words;
+    }
+
+    uint64_t AlignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    template<typename T>
+    T ReadValue(const uint8_t* data, size_t offset)
+    {
+        T value;
+        std::memcpy(&value, data + offset, sizeof(T));
+        return value;
+    }
+
+    constexpr uint32_t MakeFourCC(char a, char b, char c, char d)
+    {
+        return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) | (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+    }
+
+    constexpr uint32_t DdsMagic = MakeFourCC('D', 'D', 'S', ' ');
+    constexpr size_t DdsHeaderSize = 4 + 124;
+    constexpr size_t DdsDx10HeaderSize = 20;
+    constexpr uint32_t DdsPixelFormatFourCC = 0x4;
+    constexpr uint32_t DdsPixelFormatRGB = 0x40;
+    constexpr uint32_t DdsCaps2Cubemap = 0x200;
+    constexpr uint32_t DdsCaps2Volume = 0x200000;
+
+    VkFormat FromDxgiFormat(uint32_t dxgiFormat)
+    {
+        switch (dxgiFormat)
+        {
+            case 2:  return VK_FORMAT_R32G32B32A32_SFLOAT;
+            case 10: return VK_FORMAT_R16G16B16A16_SFLOAT;
+            case 28: return VK_FORMAT_R8G8B8A8_UNORM;
+            case 29: return VK_FORMAT_R8G8B8A8_SRGB;
+            case 71: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+            case 72: return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+            case 77: return VK_FORMAT_BC3_UNORM_BLOCK;
+            case 78: return VK_FORMAT_BC3_SRGB_BLOCK;
+            case 83: return VK_FORMAT_BC5_UNORM_BLOCK;
+            case 98: return VK_FORMAT_BC7_UNORM_BLOCK;
+            case 99: return VK_FORMAT_BC7_SRGB_BLOCK;
+            default: return VK_FORMAT_UNDEFINED;
+        }
+    }
+
+    // Lays out levels packed from mip 0 down, given each level's payload position in the file.
+    bool AddParsedLevel(TextureContainer& out, uint64_t fileOffset, uint64_t size, size_t fileSize)
+    {
+        auto mip = static_cast<uint32_t>(out.Levels.size());
+        TextureLevel level;
+        level.Width = std::max(out.Width >> mip, 1u);
+        level.Height = std::max(out.Height >> mip, 1u);
+        level.Size = size;
+        level.Offset = out.Levels.empty() ? 0 : out.Levels.back().Offset + out.Levels.back().Size;
+        level.FileOffset = fileOffset;
+
+        if (size != TextureContainer::GetLevelSize(out.Format, level.Width, level.Height) || fileOffset + size > fileSize)
+            return false;
+
+        out.Levels.push_back(level);
+        return true;
+    }
+}
+
+void TextureContainer::AddLevel(uint32_t width, uint32_t height, const void* data, size_t size)
+{
+    TextureLevel level;
+    level.Offset = Data.size();
+    level.Size = size;
+    level.Width = width;
+    level.Height = height;
+    Levels.push_back(level);
+
+    Data.resize(Data.size() + size);
+    std::memcpy(Data.data() + level.Offset, data, size);
+}
+
+uint64_t TextureContainer::GetPackedSize() const
+{
+    return Levels.empty() ? 0 : Levels.back().Offset + Levels.back().Size;
+}
+
+void TextureContainer::CopyLevels(const uint8_t* fileData, void* destination) const
+{
+    auto* target = static_cast<uint8_t*>(destination);
+    for (const TextureLevel& level : Levels)
+        std::memcpy(target + level.Offset, fileData + level.FileOffset, level.Size);
+}
+
+uint64_t TextureContainer::GetLevelSize(VkFormat format, uint32_t width, uint32_t height)
+{
+    uint64_t blocksWide = (width + 3) / 4;
+    uint64_t blocksHigh = (height + 3) / 4;
+
+    switch (format)
+    {
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            return blocksWide * blocksHigh * 8;
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            return blocksWide * blocksHigh * 16;
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+            return static_cast<uint64_t>(width) * height * 4;
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+            return static_cast<uint64_t>(width) * height * 8;
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+            return static_cast<uint64_t>(width) * height * 16;
+        default:
+            return 0;
+    }
+}
+
+bool IsTextureContainer(const uint8_t* fileData, size_t fileSize)
+{
+    return Ktx2::IsKtx2(fileData, fileSize) || Dds::IsDds(fileData, fileSize);
+}
+
+bool ParseTextureContainer(const uint8_t* fileData, size_t fileSize, TextureContainer& out)
+{
+    if (Ktx2::IsKtx2(fileData, fileSize))
+        return Ktx2::Parse(fileData, fileSize, out);
+    if (Dds::IsDds(fileData, fileSize))
+        return Dds::Parse(fileData, fileSize, out);
+    return false;
+}
+
+bool LoadTextureContainer(const std::string& filepath, TextureContainer& out)
+{
+    MappedFile file;
+    try
+    {
+        file = MappedFile(filepath);
+    }
+    catch (const std::runtime_error&)
+    {
+        return false;
+    }
+    if (!ParseTextureContainer(file.GetData(), file.GetSize(), out))
+        return false;
+
+    out.Data.resize(out.GetPackedSize());
+    out.CopyLevels(file.GetData(), out.Data.data());
+    return true;
+}
+
+namespace Ktx2
+{
+    bool IsFormatSupported(VkFormat format)
+    {
+        DfdDescription description;
+        return DescribeFormat(format, description);
+    }
+
+    bool Write(const std::string& filepath, const TextureContainer& container)
+    {
+        DfdDescription description;
+        if (!DescribeFormat(container.Format, description) || container.Levels.empty())
+            return false;
+
+        std::vector<uint32_t> dfd = BuildDfd(description);
+        auto levelCount = static_cast<uint32_t>(container.Levels.size());
+
+        constexpr uint64_t HeaderSize = sizeof(Ktx2Identifier) + 9 * sizeof(uint32_t) + 4 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+        uint64_t dfdOffset = HeaderSize + levelCount * 3 * sizeof(uint64_t);
+        uint64_t dfdSize = dfd.size() * sizeof(uint32_t);
+
+        // Level data is aligned to lcm(texel block size, 4), and the smallest level comes first.
+        uint64_t alignment = description.BytesPerBlock % 4 == 0 ? description.BytesPerBlock : description.BytesPerBlock * 4;
+        std::vector<uint64_t> levelFileOffsets(levelCount);
+        uint64_t cursor = dfdOffset + dfdSize;
+        for (uint32_t level = levelCount; level-- > 0;)
+        {
+            cursor = AlignUp(cursor, alignment);
+            levelFileOffsets[level] = cursor;
+            cursor += container.Levels[level].Size;
+        }
+
+        std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        auto write = [&file](const void* data, size_t size) { file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size)); };
+        auto writeU32 = [&write](uint32_t value) { write(&value, sizeof(value)); };
+        auto writeU64 = [&write](uint64_t value) { write(&value, sizeof(value)); };
+
+        write(Ktx2Identifier, sizeof(Ktx2Identifier));
+        writeU32(static_cast<uint32_t>(container.Format));
+        writeU32(description.TypeSize);
+        writeU32(container.Width);
+        writeU32(container.Height);
+        writeU32(0);            // pixelDepth
+        writeU32(0);            // layerCount
+        writeU32(1);            // faceCount
+        writeU32(levelCount);
+        writeU32(0);            // supercompressionScheme
+
+        writeU32(static_cast<uint32_t>(dfdOffset));
+        writeU32(static_cast<uint32_t>(dfdSize));
+        writeU32(0);            // kvdByteOffset
+        writeU32(0);            // kvdByteLength
+        writeU64(0);            // sgdByteOffset
+        writeU64(0);            // sgdByteLength
+
+        for (uint32_t level = 0; level < levelCount; level++)
+        {
+            writeU64(levelFileOffsets[level]);
+            writeU64(container.Levels[level].Size);
+            writeU64(container.Levels[level].Size);
+        }
+
+        write(dfd.data(), dfdSize);
+
+        uint64_t position = dfdOffset + dfdSize;
+        const uint8_t padding[16] = {};
+        for (uint32_t level = levelCount; level-- > 0;)
+        {
+            const TextureLevel& textureLevel = container.Levels[level];
+            write(padding, levelFileOffsets[level] - position);
+            write(container.Data.data() + textureLevel.Offset, textureLevel.Size);
+            position = levelFileOffsets[level] + textureLevel.Size;
+        }
+
+        return file.good();
+    }
+
+    bool IsKtx2(const uint8_t* fileData, size_t fileSize)
+    {
+        return fileSize >= sizeof(Ktx2Identifier) && std::memcmp(fileData, Ktx2Identifier, sizeof(Ktx2Identifier)) == 0;
+    }
+
+    bool Parse(const uint8_t* fileData, size_t fileSize, TextureContainer& out)
+    {
+        constexpr size_t HeaderSize = sizeof(Ktx2Identifier) + 13 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+        if (!IsKtx2(fileData, fileSize) || fileSize < HeaderSize)
+            return false;
+
+        out = {};
+        out.Format = static_cast<VkFormat>(ReadValue<uint32_t>(fileData, 12));
+        out.Width = ReadValue<uint32_t>(fileData, 20);
+        out.Height = ReadValue<uint32_t>(fileData, 24);
+        auto depth = ReadValue<uint32_t>(fileData, 28);
+        auto layerCount = ReadValue<uint32_t>(fileData, 32);
+        auto faceCount = ReadValue<uint32_t>(fileData, 36);
+        // Zero asks the loader to generate the chain; only the base level is stored.
+        uint32_t levelCount = std::max(ReadValue<uint32_t>(fileData, 40), 1u);
+        auto supercompression = ReadValue<uint32_t>(fileData, 44);
+
+        if (out.Width == 0 || out.Height == 0 || depth > 0 || layerCount > 1 || faceCount != 1 || supercompression != 0)
+            return false;
+        if (HeaderSize + static_cast<uint64_t>(levelCount) * 3 * sizeof(uint64_t) > fileSize)
+            return false;
+
+        for (uint32_t level = 0; level < levelCount; level++)
+        {
+            size_t entry = HeaderSize + level * 3 * sizeof(uint64_t);
+            if (!AddParsedLevel(out, ReadValue<uint64_t>(fileData, entry), ReadValue<uint64_t>(fileData, entry + 8), fileSize))
+                return false;
+        }
+        return true;
+    }
+}
+
+namespace Dds
+{
+    bool IsDds(const uint8_t* fileData, size_t fileSize)
+    {
+        return fileSize >= DdsHeaderSize && ReadValue<uint32_t>(fileData, 0) == DdsMagic;
+    }
+
+    bool Parse(const uint8_t* fileData, size_t fileSize, TextureContainer& out)
+    {
+        if (!IsDds(fileData, fileSize) || ReadValue<uint32_t>(fileData, 4) != 124)
+            return false;
+
+        out = {};
+        out.Height = ReadValue<uint32_t>(fileData, 12);
+        out.Width = ReadValue<uint32_t>(fileData, 16);
+        uint32_t levelCount = std::max(ReadValue<uint32_t>(fileData, 28), 1u);
+        auto pixelFormatFlags = ReadValue<uint32_t>(fileData, 80);
+        auto fourCC = ReadValue<uint32_t>(fileData, 84);
+        auto caps2 = ReadValue<uint32_t>(fileData, 112);
+
+        if (out.Width == 0 || out.Height == 0 || (caps2 & (DdsCaps2Cubemap | DdsCaps2Volume)) != 0)
+            return false;
+
+        size_t dataOffset = DdsHeaderSize;
+        if ((pixelFormatFlags & DdsPixelFormatFourCC) != 0)
+        {
+            if (fourCC == MakeFourCC('D', 'X', '1', '0'))
+            {
+                if (fileSize < DdsHeaderSize + DdsDx10HeaderSize)
+                    return false;
+
+                constexpr uint32_t ResourceDimensionTexture2D = 3;
+                if (ReadValue<uint32_t>(fileData, DdsHeaderSize + 4) != ResourceDimensionTexture2D ||
+                    ReadValue<uint32_t>(fileData, DdsHeaderSize + 12) > 1)
+                    return false;
+
+                out.Format = FromDxgiFormat(ReadValue<uint32_t>(fileData, DdsHeaderSize));
+                dataOffset += DdsDx10HeaderSize;
+            }
+            else if (fourCC == MakeFourCC('D', 'X', 'T', '1'))
+                out.Format = VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+            else if (fourCC == MakeFourCC('D', 'X', 'T', '5'))
+                out.Format = VK_FORMAT_BC3_UNORM_BLOCK;
+            else if (fourCC == MakeFourCC('A', 'T', 'I', '2') || fourCC == MakeFourCC('B', 'C', '5', 'U'))
+                out.Format = VK_FORMAT_BC5_UNORM_BLOCK;
+        }
+        else if ((pixelFormatFlags & DdsPixelFormatRGB) != 0 && ReadValue<uint32_t>(fileData, 88) == 32 &&
+                 ReadValue<uint32_t>(fileData, 92) == 0x000000FF && ReadValue<uint32_t>(fileData, 96) == 0x0000FF00 &&
+                 ReadValue<uint32_t>(fileData, 100) == 0x00FF0000)
+        {
+            out.Format = VK_FORMAT_R8G8B8A8_UNORM;
+        }
+
+        if (out.Format == VK_FORMAT_UNDEFINED)
+            return false;
+
+        // DDS already stores levels from mip 0 down, back to back.
+        uint64_t cursor = dataOffset;
+        for (uint32_t level = 0; level < levelCount; level++)
+        {
+            uint64_t size = TextureContainer::GetLevelSize(out.Format, std::max(out.Width >> level, 1u), std::max(out.Height >> level, 1u));
+            if (!AddParsedLevel(out, cursor, size, fileSize))
+                return false;
+            cursor += size;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+struct TextureLevel
+{
+    uint64_t Offset = 0;        // In the packed, mip 0 first layout
+    uint64_t Size = 0;
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    uint64_t FileOffset = 0;    // Where a parsed level's payload sits in the source file
+};
+
+// Every mip level of one 2D image, packed from mip 0 down in Data, ready for a single buffer-to-image copy.
+struct TextureContainer
+{
+    VkFormat Format = VK_FORMAT_UNDEFINED;
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    std::vector<TextureLevel> Levels;
+    std::vector<uint8_t> Data;
+
+    // Appends the next smaller level.
+    void AddLevel(uint32_t width, uint32_t height, const void* data, size_t size);
+
+    [[nodiscard]] uint64_t GetPackedSize() const;
+    // Gathers the parsed levels out of fileData into destination, packed as Levels describes.
+    void CopyLevels(const uint8_t* fileData, void* destination) const;
+
+    // Bytes of one level of the given extent, or 0 for formats this module does not know.
+    static uint64_t GetLevelSize(VkFormat format, uint32_t width, uint32_t height);
+};
+
+// The parsers fill everything but Data, so callers can copy the levels straight into upload memory.
+// Only single-layer 2D images without supercompression are accepted.
+bool IsTextureContainer(const uint8_t* fileData, size_t fileSize);
+bool ParseTextureContainer(const uint8_t* fileData, size_t fileSize, TextureContainer& out);
+// Reads, parses and copies the levels into out.Data.
+bool LoadTextureContainer(const std::string& filepath, TextureContainer& out);
+
+namespace Ktx2
+{
+    // Formats with a data format descriptor here: BC1 (RGBA), BC3, BC5, BC7, RGBA8 (UNORM/SRGB) and RGBA32F.
+    bool IsFormatSupported(VkFormat format);
+
+    // Writes an uncompressed-supercompression KTX2 file. Levels are stored smallest first, as the format requires.
+    bool Write(const std::string& filepath, const TextureContainer& container);
+
+    bool IsKtx2(const uint8_t* fileData, size_t fileSize);
+    bool Parse(const uint8_t* fileData, size_t fileSize, TextureContainer& out);
+}
+
+namespace Dds
+{
+    bool IsDds(const uint8_t* fileData, size_t fileSize);
+    // Legacy DXT1/DXT5/ATI2 and 32-bit RGBA headers, or a DX10 header naming a format GetLevelSize knows.
+    bool Parse(const uint8_t* fileData, size_t fileSize, TextureContainer& out);
+}
@@ -0,0 +1,244 @@
+#include "virtual_page_cache.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+VirtualPageCache::VirtualPageCache(const VirtualTextureLayout& layout, uint32_t slotsPerRow, uint32_t slotRows)
+    : m_Layout(layout), m_SlotsPerRow(slotsPerRow)
+{
+    assert(slotsPerRow > 0 && slotRows > 0 && slotsPerRow <= 256 && slotRows <= 256 && "Slot coordinates must fit in 8 bits");
+    assert(slotsPerRow * slotRows >= layout.GetMipCount() && "Page cache must hold at least one page per level");
+
+    m_Slots.resize(slotsPerRow * slotRows);
+    m_FreeSlots.reserve(m_Slots.size());
+    for (uint32_t slot = static_cast<uint32_t>(m_Slots.size()); slot-- > 0;)
+        m_FreeSlots.push_back(slot);
+
+    m_PageSlots.assign(layout.GetGridPageCount(), InvalidSlot);
+    m_PageLastUsed.assign(layout.GetGridPageCount(), 0);
+    m_PageLoading.assign(layout.GetGridPageCount(), 0);
+}
+
+void VirtualPageCache::ProcessFeedback(const uint32_t* requestedBits, uint64_t frame, std::vector<VirtualPage>& loads, uint32_t maxLoads)
+{
+    std::vector<VirtualPage> candidates;
+    uint32_t wordCount = (m_Layout.GetGridPageCount() + 31) / 32;
+    for (uint32_t word = 0; word < wordCount; word++)
+    {
+        uint32_t bits = requestedBits[word];
+        while (bits != 0)
+        {
+            uint32_t gridIndex = word * 32 + static_cast<uint32_t>(std::countr_zero(bits));
+            bits &= bits - 1;
+            if (gridIndex >= m_Layout.GetGridPageCount())
+                break;
+
+            VirtualPage page = m_Layout.GetGridPage(gridIndex);
+            if (m_Layout.IsStored(page))
+                Request(page, frame, candidates);
+        }
+    }
+    QueueLoads(candidates, loads, maxLoads);
+}
+
+void VirtualPageCache::ProcessRequests(const std::vector<VirtualPage>& requested, uint64_t frame, std::vector<VirtualPage>& loads, uint32_t maxLoads)
+{
+    std::vector<VirtualPage> candidates;
+    for (const VirtualPage& page : requested)
+    {
+        if (m_Layout.IsStored(page))
+            Request(page, frame, candidates);
+    }
+    QueueLoads(candidates, loads, maxLoads);
+}
+
+void VirtualPageCache::Request(const VirtualPage& page, uint64_t frame, std::vector<VirtualPage>& candidates)
+{
+    m_Statistics.Requested++;
+    if (IsResident(page))
+        m_Statistics.Hits++;
+
+    // Walk to the root so the fallback chain the shader will use stays warm and gets filled in coarsest first.
+    VirtualPage current = page;
+    while (true)
+    {
+        uint32_t gridIndex = m_Layout.GetGridIndex(current);
+        if (m_PageSlots[gridIndex] != InvalidSlot)
+            m_PageLastUsed[gridIndex] = frame;
+        else if (!m_PageLoading[gridIndex])
+            candidates.push_back(current);
+
+        if (current.Mip + 1 >= m_Layout.GetMipCount())
+            break;
+        current = m_Layout.GetParent(current);
+    }
+}
+
+void VirtualPageCache::QueueLoads(std::vector<VirtualPage>& candidates, std::vector<VirtualPage>& loads, uint32_t maxLoads)
+{
+    std::stable_sort(candidates.begin(), candidates.end(), [](const VirtualPage& a, const VirtualPage& b) { return a.Mip > b.Mip; });
+
+    uint32_t queued = 0;
+    for (const VirtualPage& page : candidates)
+    {
+        if (queued == maxLoads)
+            break;
+
+        uint32_t gridIndex = m_Layout.GetGridIndex(page);
+        if (m_PageLoading[gridIndex])
+            continue;
+
+        m_PageLoading[gridIndex] = 1;
+        loads.push_back(page);
+        queued++;
+    }
+}
+
+uint32_t VirtualPageCache::MakeResident(const VirtualPage& page, uint64_t frame)
+{
+    uint32_t gridIndex = m_Layout.GetGridIndex(page);
+    m_PageLoading[gridIndex] = 0;
+    if (m_PageSlots[gridIndex] != InvalidSlot)
+        return m_PageSlots[gridIndex];
+
+    uint32_t slot = InvalidSlot;
+    if (!m_FreeSlots.empty())
+    {
+        slot = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+    }
+    else
+    {
+        uint64_t oldest = frame;
+        for (uint32_t candidate = 0; candidate < m_Slots.size(); candidate++)
+        {
+            const Slot& entry = m_Slots[candidate];
+            uint64_t lastUsed = m_PageLastUsed[entry.GridIndex];
+            if (!entry.Pinned && lastUsed < oldest)
+            {
+                oldest = lastUsed;
+                slot = candidate;
+            }
+        }
+
+        if (slot == InvalidSlot)
+            return InvalidSlot;
+
+        m_PageSlots[m_Slots[slot].GridIndex] = InvalidSlot;
+        m_Statistics.Evictions++;
+    }
+
+    m_Slots[slot] = { gridIndex, false };
+    m_PageSlots[gridIndex] = slot;
+    m_PageLastUsed[gridIndex] = frame;
+    m_IndirectionDirty = true;
+    m_Statistics.Loads++;
+    return slot;
+}
+
+void VirtualPageCache::CancelLoad(const VirtualPage& page)
+{
+    m_PageLoading[m_Layout.GetGridIndex(page)] = 0;
+}
+
+void VirtualPageCache::Pin(const VirtualPage& page)
+{
+    uint32_t slot = GetSlot(page);
+    assert(slot != InvalidSlot && "Only resident pages can be pinned");
+    m_Slots[slot].Pinned = true;
+}
+
+bool VirtualPageCache::UpdateIndirection(std::vector<uint8_t>& entries)
+{
+    if (!m_IndirectionDirty)
+        return false;
+
+    entries.resize(static_cast<size_t>(m_Layout.GetGridPageCount()) * 4);
+    for (uint32_t mip = m_Layout.GetMipCount(); mip-- > 0;)
+    {
+        for (uint32_t y = 0; y < m_Layout.GetGridHeight(mip); y++)
+        {
+            for (uint32_t x = 0; x < m_Layout.GetGridWidth(mip); x++)
+            {
+                VirtualPage page = { mip, x, y };
+                uint8_t* entry = &entries[static_cast<size_t>(m_Layout.GetGridIndex(page)) * 4];
+
+                bool stored = m_Layout.IsStored(page);
+                uint32_t slot = stored ? GetSlot(page) : InvalidSlot;
+                if (slot != InvalidSlot)
+                {
+                    entry[0] = static_cast<uint8_t>(slot % m_SlotsPerRow);
+                    entry[1] = static_cast<uint8_t>(slot / m_SlotsPerRow);
+                    entry[2] = static_cast<uint8_t>(mip);
+                    entry[3] = 255;
+                }
+                else if (mip + 1 < m_Layout.GetMipCount())
+                {
+                    // Grid cells past the stored pages are never sampled; any parent will do for them.
+                    VirtualPage parent = stored ? m_Layout.GetParent(page) : VirtualPage { mip + 1, x >> 1, y >> 1 };
+                    const uint8_t* parentEntry = &entries[static_cast<size_t>(m_Layout.GetGridIndex(parent)) * 4];
+                    std::copy(parentEntry, parentEntry + 4, entry);
+                }
+                else
+                {
+                    entry[0] = entry[1] = 0;
+                    entry[2] = static_cast<uint8_t>(mip);
+                    entry[3] = 0;
+                }
+            }
+        }
+    }
+
+    m_IndirectionDirty = false;
+    return true;
+}
+
+bool VirtualPageCache::Validate(std::string* error) const
+{
+    auto fail = [error](const std::string& message)
+    {
+        if (error)
+            *error = message;
+        return false;
+    };
+
+    std::vector<uint8_t> isFree(m_Slots.size(), 0);
+    for (uint32_t slot : m_FreeSlots)
+    {
+        if (slot >= m_Slots.size() || isFree[slot])
+            return fail("free list holds an invalid or repeated slot " + std::to_string(slot));
+        isFree[slot] = 1;
+    }
+
+    uint32_t resident = 0;
+    for (uint32_t slot = 0; slot < m_Slots.size(); slot++)
+    {
+        if (isFree[slot])
+            continue;
+
+        uint32_t gridIndex = m_Slots[slot].GridIndex;
+        if (gridIndex >= m_PageSlots.size() || m_PageSlots[gridIndex] != slot)
+            return fail("slot " + std::to_string(slot) + " is not referenced by its page");
+        if (!m_Layout.IsStored(m_Layout.GetGridPage(gridIndex)))
+            return fail("slot " + std::to_string(slot) + " holds a page outside the texture");
+        resident++;
+    }
+
+    for (uint32_t gridIndex = 0; gridIndex < m_PageSlots.size(); gridIndex++)
+    {
+        uint32_t slot = m_PageSlots[gridIndex];
+        if (slot == InvalidSlot)
+            continue;
+
+        if (slot >= m_Slots.size() || isFree[slot] || m_Slots[slot].GridIndex != gridIndex)
+            return fail("page " + std::to_string(gridIndex) + " points at a slot it does not own");
+        if (m_PageLoading[gridIndex])
+            return fail("page " + std::to_string(gridIndex) + " is resident and loading");
+        resident--;
+    }
+
+    if (resident != 0)
+        return fail("slot and page tables disagree on the resident count");
+    return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "virtual_texture_file.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Residency bookkeeping for a virtual texture's physical page cache, with no GPU dependency so the
+// replacement policy can be driven and checked on the CPU. Every grid page maps to at most one slot
+// of a slotsPerRow x slotRows physical atlas. Slots are reused least recently used first, never for
+// a page touched in the current frame and never for a pinned page.
+class VirtualPageCache
+{
+public:
+    static constexpr uint32_t InvalidSlot = ~0u;
+
+    struct Statistics
+    {
+        uint64_t Requested = 0;
+        uint64_t Hits = 0;
+        uint64_t Loads = 0;
+        uint64_t Evictions = 0;
+    };
+
+    VirtualPageCache(const VirtualTextureLayout& layout, uint32_t slotsPerRow, uint32_t slotRows);
+
+    // Consumes one frame of feedback, given as a bitset over grid indices or as a page list. Resident pages
+    // and their resident ancestors are marked used; missing pages and missing ancestors are appended to
+    // loads, coarsest first, at most maxLoads of them, and flagged as loading until MakeResident or CancelLoad.
+    void ProcessFeedback(const uint32_t* requestedBits, uint64_t frame, std::vector<VirtualPage>& loads, uint32_t maxLoads);
+    void ProcessRequests(const std::vector<VirtualPage>& requested, uint64_t frame, std::vector<VirtualPage>& loads, uint32_t maxLoads);
+
+    // Assigns a slot to a loaded page, evicting if needed. Returns InvalidSlot when every slot is in use this frame.
+    uint32_t MakeResident(const VirtualPage& page, uint64_t frame);
+    void CancelLoad(const VirtualPage& page);
+    // Keeps a resident page from ever being evicted.
+    void Pin(const VirtualPage& page);
+
+    [[nodiscard]] bool IsResident(const VirtualPage& page) const { return GetSlot(page) != InvalidSlot; }
+    [[nodiscard]] uint32_t GetSlot(const VirtualPage& page) const { return m_PageSlots[m_Layout.GetGridIndex(page)]; }
+    [[nodiscard]] uint32_t GetSlotsPerRow() const { return m_SlotsPerRow; }
+    [[nodiscard]] uint32_t GetSlotCount() const { return static_cast<uint32_t>(m_Slots.size()); }
+    [[nodiscard]] uint32_t GetResidentCount() const { return GetSlotCount() - static_cast<uint32_t>(m_FreeSlots.size()); }
+    [[nodiscard]] const VirtualTextureLayout& GetLayout() const { return m_Layout; }
+    [[nodiscard]] const Statistics& GetStatistics() const { return m_Statistics; }
+
+    // Fills one RGBA8 entry per grid page, levels packed from mip 0: (slot x, slot y, resident mip, 255), where a
+    // page that is not resident takes its nearest resident ancestor's entry. Alpha is 0 where nothing is resident.
+    // Returns false, leaving entries untouched, when residency has not changed since the last call.
+    bool UpdateIndirection(std::vector<uint8_t>& entries);
+
+    // Checks that the slot and page tables agree. On failure the first inconsistency is written to error.
+    bool Validate(std::string* error = nullptr) const;
+
+private:
+    void Request(const VirtualPage& page, uint64_t frame, std::vector<VirtualPage>& candidates);
+    void QueueLoads(std::vector<VirtualPage>& candidates, std::vector<VirtualPage>& loads, uint32_t maxLoads);
+
+private:
+    struct Slot
+    {
+        uint32_t GridIndex = InvalidSlot;
+        bool Pinned = false;
+    };
+
+    VirtualTextureLayout m_Layout;
+    uint32_t m_SlotsPerRow = 0;
+
+    std::vector<Slot> m_Slots;
+    std::vector<uint32_t> m_FreeSlots;
+
+    // Indexed by grid index.
+    std::vector<uint32_t> m_PageSlots;
+    std::vector<uint64_t> m_PageLastUsed;
+    std::vector<uint8_t> m_PageLoading;
+
+    bool m_IndirectionDirty = true;
+    Statistics m_Statistics;
+};
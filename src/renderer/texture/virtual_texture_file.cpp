@@ -0,0 +1,183 @@
+#include "virtual_texture_file.h"
+#include "texture_container.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+    constexpr char VirtualTextureMagic[4] = { 'V', 'T', 'E', 'X' };
+    constexpr uint32_t VirtualTextureVersion = 1;
+    // Magic, version, format, width, height, page size, border, page byte size.
+    constexpr uint64_t HeaderSize = 8 * sizeof(uint32_t);
+
+    uint32_t NextPowerOfTwo(uint32_t value)
+    {
+        uint32_t result = 1;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+}
+
+VirtualTextureLayout::VirtualTextureLayout(uint32_t width, uint32_t height, uint32_t pageSize, uint32_t border)
+    : m_Width(width), m_Height(height), m_PageSize(pageSize), m_Border(border)
+{
+    assert(width > 0 && height > 0 && pageSize > 0 && "Virtual texture extents must be positive");
+
+    m_MipCount = 1;
+    while (GetLevelWidth(m_MipCount - 1) > pageSize || GetLevelHeight(m_MipCount - 1) > pageSize)
+        m_MipCount++;
+
+    for (uint32_t mip = 0; mip < m_MipCount; mip++)
+    {
+        m_StoredOffsets.push_back(m_StoredOffsets.back() + static_cast<uint64_t>(GetPageCountX(mip)) * GetPageCountY(mip));
+        m_GridOffsets.push_back(m_GridOffsets.back() + GetGridWidth(mip) * GetGridHeight(mip));
+    }
+}
+
+uint32_t VirtualTextureLayout::GetLevelWidth(uint32_t mip) const
+{
+    return std::max(m_Width >> mip, 1u);
+}
+
+uint32_t VirtualTextureLayout::GetLevelHeight(uint32_t mip) const
+{
+    return std::max(m_Height >> mip, 1u);
+}
+
+uint32_t VirtualTextureLayout::GetPageCountX(uint32_t mip) const
+{
+    return (GetLevelWidth(mip) + m_PageSize - 1) / m_PageSize;
+}
+
+uint32_t VirtualTextureLayout::GetPageCountY(uint32_t mip) const
+{
+    return (GetLevelHeight(mip) + m_PageSize - 1) / m_PageSize;
+}
+
+bool VirtualTextureLayout::IsStored(const VirtualPage& page) const
+{
+    return page.Mip < m_MipCount && page.X < GetPageCountX(page.Mip) && page.Y < GetPageCountY(page.Mip);
+}
+
+uint64_t VirtualTextureLayout::GetStoredPageIndex(const VirtualPage& page) const
+{
+    assert(IsStored(page));
+    return m_StoredOffsets[page.Mip] + static_cast<uint64_t>(page.Y) * GetPageCountX(page.Mip) + page.X;
+}
+
+uint32_t VirtualTextureLayout::GetGridWidth(uint32_t mip) const
+{
+    return std::max(NextPowerOfTwo(GetPageCountX(0)) >> mip, 1u);
+}
+
+uint32_t VirtualTextureLayout::GetGridHeight(uint32_t mip) const
+{
+    return std::max(NextPowerOfTwo(GetPageCountY(0)) >> mip, 1u);
+}
+
+uint32_t VirtualTextureLayout::GetGridIndex(const VirtualPage& page) const
+{
+    return m_GridOffsets[page.Mip] + page.Y * GetGridWidth(page.Mip) + page.X;
+}
+
+VirtualPage VirtualTextureLayout::GetGridPage(uint32_t gridIndex) const
+{
+    auto mip = static_cast<uint32_t>(std::upper_bound(m_GridOffsets.begin(), m_GridOffsets.end(), gridIndex) - m_GridOffsets.begin()) - 1;
+    uint32_t local = gridIndex - m_GridOffsets[mip];
+    return { mip, local % GetGridWidth(mip), local / GetGridWidth(mip) };
+}
+
+VirtualPage VirtualTextureLayout::GetParent(const VirtualPage& page) const
+{
+    assert(page.Mip + 1 < m_MipCount);
+    // Halving rounds extents down, so the last page of an odd level can sit past the end of the next one.
+    return {
+        page.Mip + 1,
+        std::min(page.X >> 1, GetPageCountX(page.Mip + 1) - 1),
+        std::min(page.Y >> 1, GetPageCountY(page.Mip + 1) - 1)
+    };
+}
+
+VirtualTextureFile::VirtualTextureFile(const std::string& filepath)
+{
+    try
+    {
+        m_File = MappedFile(filepath, MappedFile::AccessPattern::Random);
+    }
+    catch (const std::runtime_error&)
+    {
+        throw std::runtime_error("Failed to open virtual texture: " + filepath);
+    }
+
+    uint32_t fields[7];
+    if (m_File.GetSize() < HeaderSize || std::memcmp(m_File.GetData(), VirtualTextureMagic, sizeof(VirtualTextureMagic)) != 0)
+        throw std::runtime_error("Not a virtual texture: " + filepath);
+    std::memcpy(fields, m_File.GetData() + sizeof(VirtualTextureMagic), sizeof(fields));
+    if (fields[0] != VirtualTextureVersion)
+        throw std::runtime_error("Not a virtual texture: " + filepath);
+
+    m_Format = static_cast<VkFormat>(fields[1]);
+    m_Layout = VirtualTextureLayout(fields[2], fields[3], fields[4], fields[5]);
+    m_PageByteSize = fields[6];
+    m_DataOffset = HeaderSize;
+
+    if (m_PageByteSize == 0 || m_PageByteSize != GetPageByteSize(m_Format, m_Layout.GetPaddedPageSize()))
+        throw std::runtime_error("Unsupported virtual texture format: " + filepath);
+}
+
+bool VirtualTextureFile::ReadPage(const VirtualPage& page, void* destination)
+{
+    uint64_t offset = m_DataOffset + m_Layout.GetStoredPageIndex(page) * m_PageByteSize;
+
+    if (offset + m_PageByteSize > m_File.GetSize())
+        return false;
+
+    std::memcpy(destination, m_File.GetData() + offset, m_PageByteSize);
+    return true;
+}
+
+bool VirtualTextureFile::Write(
+        const std::string& filepath,
+        const VirtualTextureLayout& layout,
+        VkFormat format,
+        const std::function<void(const VirtualPage&, std::vector<uint8_t>&)>& fillPage)
+{
+    uint32_t pageByteSize = GetPageByteSize(format, layout.GetPaddedPageSize());
+    if (pageByteSize == 0)
+        return false;
+
+    std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    const uint32_t fields[7] = {
+        VirtualTextureVersion, static_cast<uint32_t>(format), layout.GetWidth(), layout.GetHeight(),
+        layout.GetPageSize(), layout.GetBorder(), pageByteSize
+    };
+    file.write(VirtualTextureMagic, sizeof(VirtualTextureMagic));
+    file.write(reinterpret_cast<const char*>(fields), sizeof(fields));
+
+    std::vector<uint8_t> page(pageByteSize);
+    for (uint32_t mip = 0; mip < layout.GetMipCount(); mip++)
+    {
+        for (uint32_t y = 0; y < layout.GetPageCountY(mip); y++)
+        {
+            for (uint32_t x = 0; x < layout.GetPageCountX(mip); x++)
+            {
+                fillPage({ mip, x, y }, page);
+                file.write(reinterpret_cast<const char*>(page.data()), pageByteSize);
+            }
+        }
+    }
+    return file.good();
+}
+
+uint32_t VirtualTextureFile::GetPageByteSize(VkFormat format, uint32_t paddedPageSize)
+{
+    return static_cast<uint32_t>(TextureContainer::GetLevelSize(format, paddedPageSize, paddedPageSize));
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "core/mapped_file.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+struct VirtualPage
+{
+    uint32_t Mip = 0;
+    uint32_t X = 0;
+    uint32_t Y = 0;
+};
+
+// Page addressing for a virtual texture. Level m is max(extent >> m, 1) texels, cut into PageSize squares
+// (the last row and column may be partial), and the chain stops at the first level that fits in one page.
+// Pages are addressed two ways: the stored pages actually written to disk, and a power-of-two grid per
+// level that the indirection texture and the GPU feedback use, so its levels line up with image mips.
+class VirtualTextureLayout
+{
+public:
+    VirtualTextureLayout() = default;
+    VirtualTextureLayout(uint32_t width, uint32_t height, uint32_t pageSize = 128, uint32_t border = 4);
+
+    [[nodiscard]] uint32_t GetWidth() const { return m_Width; }
+    [[nodiscard]] uint32_t GetHeight() const { return m_Height; }
+    [[nodiscard]] uint32_t GetPageSize() const { return m_PageSize; }
+    // Texels repeated from the neighbouring pages on each side, so filtering never reads another slot.
+    [[nodiscard]] uint32_t GetBorder() const { return m_Border; }
+    [[nodiscard]] uint32_t GetPaddedPageSize() const { return m_PageSize + 2 * m_Border; }
+    [[nodiscard]] uint32_t GetMipCount() const { return m_MipCount; }
+
+    [[nodiscard]] uint32_t GetLevelWidth(uint32_t mip) const;
+    [[nodiscard]] uint32_t GetLevelHeight(uint32_t mip) const;
+    [[nodiscard]] uint32_t GetPageCountX(uint32_t mip) const;
+    [[nodiscard]] uint32_t GetPageCountY(uint32_t mip) const;
+    [[nodiscard]] bool IsStored(const VirtualPage& page) const;
+    [[nodiscard]] uint64_t GetStoredPageCount() const { return m_StoredOffsets.back(); }
+    [[nodiscard]] uint64_t GetStoredPageIndex(const VirtualPage& page) const;
+
+    [[nodiscard]] uint32_t GetGridWidth(uint32_t mip) const;
+    [[nodiscard]] uint32_t GetGridHeight(uint32_t mip) const;
+    [[nodiscard]] uint32_t GetGridPageCount() const { return m_GridOffsets.back(); }
+    [[nodiscard]] uint32_t GetGridIndex(const VirtualPage& page) const;
+    [[nodiscard]] VirtualPage GetGridPage(uint32_t gridIndex) const;
+    // The stored page one level up that covers this stored page; the coarsest level has none.
+    [[nodiscard]] VirtualPage GetParent(const VirtualPage& page) const;
+
+private:
+    uint32_t m_Width = 0;
+    uint32_t m_Height = 0;
+    uint32_t m_PageSize = 128;
+    uint32_t m_Border = 4;
+    uint32_t m_MipCount = 0;
+    std::vector<uint64_t> m_StoredOffsets { 0 };
+    std::vector<uint32_t> m_GridOffsets { 0 };
+};
+
+// A tiled on-disk virtual texture: a fixed header followed by every stored page, padded with its
+// border, at a fixed size in stored page order. Pages are RGBA8 or BCn; either can be copied into
+// a physical page slot as is.
+class VirtualTextureFile
+{
+public:
+    // Throws std::runtime_error when the file cannot be opened or is not a virtual texture.
+    explicit VirtualTextureFile(const std::string& filepath);
+
+    [[nodiscard]] const VirtualTextureLayout& GetLayout() const { return m_Layout; }
+    [[nodiscard]] VkFormat GetFormat() const { return m_Format; }
+    [[nodiscard]] uint32_t GetPageByteSize() const { return m_PageByteSize; }
+
+    // Safe to call from several threads. Returns false for a page past the end of a truncated file.
+    bool ReadPage(const VirtualPage& page, void* destination);
+
+    // fillPage writes the padded page (GetPaddedPageSize() squared texels in the given format) for each stored page.
+    static bool Write(
+            const std::string& filepath,
+            const VirtualTextureLayout& layout,
+            VkFormat format,
+            const std::function<void(const VirtualPage&, std::vector<uint8_t>&)>& fillPage);
+
+    static uint32_t GetPageByteSize(VkFormat format, uint32_t paddedPageSize);
+
+private:
+    VirtualTextureLayout m_Layout;
+    VkFormat m_Format = VK_FORMAT_UNDEFINED;
+    uint32_t m_PageByteSize = 0;
+    uint64_t m_DataOffset = 0;
+
+    // Mapped for random access, so streaming threads copy pages out concurrently instead of taking turns on one stream.
+    MappedFile m_File;
+};
@@ -1,28 +1,17 @@
 #include "model.h"
 #include "core/engine_utils.h"
+#include "core/flat_hash_map.h"
+#include "core/profiler.h"
 #include "vulkan_buffer.h"
 
+#include <algorithm>
+
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tiny_obj_loader.h>
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
-
-namespace std
-{
-    template<>
-    struct hash<Model::Vertex>
-    {
-        size_t operator()(const Model::Vertex& vertex) const noexcept
-        {
-            size_t seed = 0;
-            EngineUtils::HashCombine(seed, vertex.Position, vertex.Color, vertex.Normal, vertex.UV);
-            return seed;
-        }
-    };
-}
 
 void Model::Builder::LoadModel(const std::string &filePath)
 {
+    PROFILE_ZONE("Model::LoadModel");
     tinyobj::attrib_t attrib;
     std::vector<tinyobj::shape_t> shapes;
     std::vector<tinyobj::material_t> materials;
@@ -33,9 +22,20 @@ void Model::Builder::LoadModel(const std::string &filePath)
         throw std::runtime_error(warn + err);
     }
 
+    size_t indexCount = 0;
+    for (const auto &shape: shapes)
+        indexCount += shape.mesh.indices.size();
+
+    // A mesh usually has about as many distinct vertices as its largest attribute stream. Flat-shaded or
+    // UV-seamed meshes exceed that and the table grows, but sizing for every index would overallocate ~6x.
+    const size_t expectedVertexCount = std::min(indexCount,
+        std::max({ attrib.vertices.size() / 3, attrib.normals.size() / 3, attrib.texcoords.size() / 2 }));
+
     Vertices.clear();
     Indices.clear();
-    std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+    Vertices.reserve(expectedVertexCount);
+    Indices.reserve(indexCount);
+    FlatHashMap<Vertex, uint32_t> uniqueVertices(expectedVertexCount);
 
     for (const auto &shape: shapes)
     {
@@ -78,12 +78,10 @@ void Model::Builder::LoadModel(const std::string &filePath)
                 };
             }
 
-            if (uniqueVertices.count(vertex) == 0)
-            {
-                uniqueVertices[vertex] = static_cast<uint32_t>(Vertices.size());
+            const auto [vertexIndex, inserted] = uniqueVertices.TryEmplace(vertex, static_cast<uint32_t>(Vertices.size()));
+            if (inserted)
                 Vertices.push_back(vertex);
-            }
-            Indices.push_back(uniqueVertices[vertex]);
+            Indices.push_back(*vertexIndex);
         }
     }
 
@@ -134,6 +132,7 @@ Model::Model(VulkanDevice& deviceRef, const Builder& builder)
 
 std::shared_ptr<Model> Model::CreateModelFromFile(VulkanDevice &deviceRef, const std::string &filePath)
 {
+    PROFILE_ZONE("Model::CreateModelFromFile");
     Builder builder{};
     builder.LoadModel(filePath);
     return std::make_shared<Model>(deviceRef, builder);
@@ -172,7 +171,9 @@ void Model::CreateVertexBuffer(const std::vector<Vertex> &vertices)
     m_DeviceRef.CopyBuffer(
                stagingBuffer.GetBuffer(),
                m_VertexBuffer->GetBuffer(),
-               bufferSize);
+               bufferSize,
+               VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+               VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
 }
 
 void Model::CreateIndexBuffer(const std::vector<uint32_t>& indices)
@@ -206,7 +207,9 @@ void Model::CreateIndexBuffer(const std::vector<uint32_t>& indices)
     m_DeviceRef.CopyBuffer(
             stagingBuffer.GetBuffer(),
             m_IndexBuffer->GetBuffer(),
-            bufferSize);
+            bufferSize,
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+            VK_ACCESS_INDEX_READ_BIT);
 }
 
 void Model::Draw(VkCommandBuffer commandBuffer) const
@@ -5,7 +5,9 @@
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include "vulkan_buffer.h"
+#include "core/hash.h"
 #include <glm/glm.hpp>
+#include <cstring>
 
 class Model
 {
@@ -39,8 +41,8 @@ public:
 
         void LoadModel(const std::string& filePath);
 
-    private:
-        void ComputeTangentBasis(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+        // Accumulates per-triangle tangents into the vertices and orthogonalizes them against the normals.
+        static void ComputeTangentBasis(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
     };
 
     Model(VulkanDevice& deviceRef, const Builder& builder);
@@ -66,4 +68,24 @@ private:
     bool m_HasIndexBuffer{false};
     std::unique_ptr<VulkanBuffer> m_IndexBuffer;
     uint32_t m_IndexCount{};
-};
\ No newline at end of file
+};
+
+// Keys LoadModel's vertex deduplication: one bytewise hash over the whole packed vertex.
+namespace std
+{
+    template<>
+    struct hash<Model::Vertex>
+    {
+        size_t operator()(const Model::Vertex& vertex) const noexcept
+        {
+            static_assert(sizeof(Model::Vertex) == 14 * sizeof(float), "Vertex is hashed as raw bytes and must stay tightly packed");
+
+            // operator== treats -0.0f and 0.0f as equal, so they must hash alike.
+            uint32_t words[sizeof(Model::Vertex) / sizeof(uint32_t)];
+            std::memcpy(words, &vertex, sizeof(words));
+            for (uint32_t& word : words)
+                word = word == 0x80000000u ? 0u : word;
+            return static_cast<size_t>(Hash::HashBytes(words, sizeof(words)));
+        }
+    };
+}
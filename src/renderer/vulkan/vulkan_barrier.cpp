@@ -0,0 +1,421 @@
+#include "vulkan_barrier.h"
+#include "core/buffer_allocator.h"
+
+#include <cassert>
+#include <iostream>
+
+namespace
+{
+    constexpr VkAccessFlags2 WriteAccessMask =
+            VK_ACCESS_2_SHADER_WRITE_BIT |
+            VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+            VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+            VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+            VK_ACCESS_2_TRANSFER_WRITE_BIT |
+            VK_ACCESS_2_HOST_WRITE_BIT |
+            VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+    constexpr VkPipelineStageFlags2 TransferStageMask =
+            VK_PIPELINE_STAGE_2_COPY_BIT |
+            VK_PIPELINE_STAGE_2_RESOLVE_BIT |
+            VK_PIPELINE_STAGE_2_BLIT_BIT |
+            VK_PIPELINE_STAGE_2_CLEAR_BIT;
+}
+
+VulkanBarrierBuilder::VulkanBarrierBuilder(VulkanDevice& deviceRef)
+    : m_DeviceRef(deviceRef)
+{
+}
+
+VulkanBarrierBuilder::AccessInfo VulkanBarrierBuilder::GetAccessInfo(ResourceAccess access)
+{
+    switch (access)
+    {
+        case ResourceAccess::None:
+            return { VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, false, VK_IMAGE_LAYOUT_UNDEFINED };
+        case ResourceAccess::HostRead:
+            return { VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT, false, VK_IMAGE_LAYOUT_GENERAL };
+        case ResourceAccess::HostWrite:
+            return { VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_WRITE_BIT, true, VK_IMAGE_LAYOUT_GENERAL };
+        case ResourceAccess::CopyRead:
+            return { VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, false, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL };
+        case ResourceAccess::CopyWrite:
+            return { VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, true, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL };
+        case ResourceAccess::BlitRead:
+            return { VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, false, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL };
+        case ResourceAccess::BlitWrite:
+            return { VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, true, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL };
+        case ResourceAccess::IndirectRead:
+            return { VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, false, VK_IMAGE_LAYOUT_UNDEFINED };
+        case ResourceAccess::IndexRead:
+            return { VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT, VK_ACCESS_2_INDEX_READ_BIT, false, VK_IMAGE_LAYOUT_UNDEFINED };
+        case ResourceAccess::VertexRead:
+            return { VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT, VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT, false, VK_IMAGE_LAYOUT_UNDEFINED };
+        case ResourceAccess::VertexShaderUniformRead:
+            return { VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, VK_ACCESS_2_UNIFORM_READ_BIT, false, VK_IMAGE_LAYOUT_UNDEFINED };
+        case ResourceAccess::FragmentShaderUniformRead:
+            return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_UNIFORM_READ_BIT, false, VK_IMAGE_LAYOUT_UNDEFINED };
+        case ResourceAccess::FragmentShaderSampledRead:
+            return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, false, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+        case ResourceAccess::FragmentShaderStorageRead:
+            return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, false, VK_IMAGE_LAYOUT_GENERAL };
+        case ResourceAccess::InputAttachmentRead:
+            return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_INPUT_ATTACHMENT_READ_BIT, false, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+        case ResourceAccess::ColorAttachmentWrite:
+            return { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, true, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+        case ResourceAccess::ColorAttachmentReadWrite:
+            return { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                     VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                     true,
+                     VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+        case ResourceAccess::DepthStencilAttachmentRead:
+            return { VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                     VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+                     false,
+                     VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
+        case ResourceAccess::DepthStencilAttachmentWrite:
+            return { VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                     VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                     true,
+                     VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+        case ResourceAccess::ComputeShaderUniformRead:
+            return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_UNIFORM_READ_BIT, false, VK_IMAGE_LAYOUT_UNDEFINED };
+        case ResourceAccess::ComputeShaderSampledRead:
+            return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, false, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+        case ResourceAccess::ComputeShaderStorageRead:
+            return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, false, VK_IMAGE_LAYOUT_GENERAL };
+        case ResourceAccess::ComputeShaderStorageWrite:
+            return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, true, VK_IMAGE_LAYOUT_GENERAL };
+        case ResourceAccess::ComputeShaderStorageReadWrite:
+            return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                     VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                     true,
+                     VK_IMAGE_LAYOUT_GENERAL };
+        case ResourceAccess::Present:
+            // The semaphore handed to vkQueuePresentKHR orders the presentation engine's read.
+            return { VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, false, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR };
+    }
+
+    assert(false && "Unknown resource access");
+    return {};
+}
+
+VkImageLayout VulkanBarrierBuilder::GetLayout(ResourceAccess access)
+{
+    return GetAccessInfo(access).Layout;
+}
+
+VulkanBarrierBuilder::Scope VulkanBarrierBuilder::GetSrcScope(std::initializer_list<ResourceAccess> accesses)
+{
+    // Earlier reads only need an execution dependency; earlier writes also need to be made available.
+    Scope scope;
+    for (ResourceAccess access : accesses)
+    {
+        AccessInfo info = GetAccessInfo(access);
+        scope.Stage |= info.Stage;
+        if (info.Write)
+            scope.Access |= info.Access & WriteAccessMask;
+
+        assert((scope.Layout == VK_IMAGE_LAYOUT_UNDEFINED || info.Layout == VK_IMAGE_LAYOUT_UNDEFINED || scope.Layout == info.Layout) &&
+               "Accesses on one side of a barrier need different layouts");
+        if (info.Layout != VK_IMAGE_LAYOUT_UNDEFINED)
+            scope.Layout = info.Layout;
+    }
+    return scope;
+}
+
+VulkanBarrierBuilder::Scope VulkanBarrierBuilder::GetDstScope(std::initializer_list<ResourceAccess> accesses)
+{
+    Scope scope;
+    for (ResourceAccess access : accesses)
+    {
+        AccessInfo info = GetAccessInfo(access);
+        scope.Stage |= info.Stage;
+        scope.Access |= info.Access;
+
+        assert((scope.Layout == VK_IMAGE_LAYOUT_UNDEFINED || info.Layout == VK_IMAGE_LAYOUT_UNDEFINED || scope.Layout == info.Layout) &&
+               "Accesses on one side of a barrier need different layouts");
+        if (info.Layout != VK_IMAGE_LAYOUT_UNDEFINED)
+            scope.Layout = info.Layout;
+    }
+    return scope;
+}
+
+VulkanBarrierBuilder& VulkanBarrierBuilder::Image(
+        VkImage image,
+        const VkImageSubresourceRange& subresourceRange,
+        std::initializer_list<ResourceAccess> before,
+        std::initializer_list<ResourceAccess> after)
+{
+    return Image(image, subresourceRange, before, after, GetSrcScope(before).Layout, GetDstScope(after).Layout);
+}
+
+VulkanBarrierBuilder& VulkanBarrierBuilder::Image(
+        VkImage image,
+        const VkImageSubresourceRange& subresourceRange,
+        std::initializer_list<ResourceAccess> before,
+        std::initializer_list<ResourceAccess> after,
+        VkImageLayout oldLayout,
+        VkImageLayout newLayout)
+{
+    Scope src = GetSrcScope(before);
+    Scope dst = GetDstScope(after);
+
+    VkImageMemoryBarrier2 barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    barrier.srcStageMask = src.Stage;
+    barrier.srcAccessMask = src.Access;
+    barrier.dstStageMask = dst.Stage;
+    barrier.dstAccessMask = dst.Access;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = subresourceRange;
+    return Image(barrier);
+}
+
+VulkanBarrierBuilder& VulkanBarrierBuilder::Buffer(
+        VkBuffer buffer,
+        std::initializer_list<ResourceAccess> before,
+        std::initializer_list<ResourceAccess> after,
+        VkDeviceSize offset,
+        VkDeviceSize size)
+{
+    Scope src = GetSrcScope(before);
+    Scope dst = GetDstScope(after);
+
+    VkBufferMemoryBarrier2 barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+    barrier.srcStageMask = src.Stage;
+    barrier.srcAccessMask = src.Access;
+    barrier.dstStageMask = dst.Stage;
+    barrier.dstAccessMask = dst.Access;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buffer;
+    barrier.offset = offset;
+    barrier.size = size;
+    return Buffer(barrier);
+}
+
+VulkanBarrierBuilder& VulkanBarrierBuilder::Memory(std::initializer_list<ResourceAccess> before, std::initializer_list<ResourceAccess> after)
+{
+    Scope src = GetSrcScope(before);
+    Scope dst = GetDstScope(after);
+    Check(src.Stage, src.Access, dst.Stage, dst.Access);
+
+    VkMemoryBarrier2 barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    barrier.srcStageMask = src.Stage;
+    barrier.srcAccessMask = src.Access;
+    barrier.dstStageMask = dst.Stage;
+    barrier.dstAccessMask = dst.Access;
+    m_MemoryBarriers.push_back(barrier);
+    return *this;
+}
+
+VulkanBarrierBuilder& VulkanBarrierBuilder::Image(const VkImageMemoryBarrier2& barrier)
+{
+    Check(barrier.srcStageMask, barrier.srcAccessMask, barrier.dstStageMask, barrier.dstAccessMask);
+    m_ImageBarriers.push_back(barrier);
+    m_ImageBarriers.back().sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    return *this;
+}
+
+VulkanBarrierBuilder& VulkanBarrierBuilder::Buffer(const VkBufferMemoryBarrier2& barrier)
+{
+    Check(barrier.srcStageMask, barrier.srcAccessMask, barrier.dstStageMask, barrier.dstAccessMask);
+    m_BufferBarriers.push_back(barrier);
+    m_BufferBarriers.back().sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+    return *this;
+}
+
+uint32_t VulkanBarrierBuilder::GetBarrierCount() const
+{
+    return static_cast<uint32_t>(m_ImageBarriers.size() + m_BufferBarriers.size() + m_MemoryBarriers.size());
+}
+
+void VulkanBarrierBuilder::Clear()
+{
+    m_ImageBarriers.clear();
+    m_BufferBarriers.clear();
+    m_MemoryBarriers.clear();
+}
+
+void VulkanBarrierBuilder::Record(VkCommandBuffer cmdBuffer)
+{
+    if (IsEmpty())
+        return;
+
+    if (m_DeviceRef.SupportsSynchronization2())
+    {
+        VkDependencyInfo dependencyInfo{};
+        dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependencyInfo.memoryBarrierCount = static_cast<uint32_t>(m_MemoryBarriers.size());
+        dependencyInfo.pMemoryBarriers = m_MemoryBarriers.data();
+        dependencyInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(m_BufferBarriers.size());
+        dependencyInfo.pBufferMemoryBarriers = m_BufferBarriers.data();
+        dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(m_ImageBarriers.size());
+        dependencyInfo.pImageMemoryBarriers = m_ImageBarriers.data();
+        m_DeviceRef.CmdPipelineBarrier2(cmdBuffer, dependencyInfo);
+    }
+    else
+    {
+        RecordLegacy(cmdBuffer);
+    }
+
+    Clear();
+}
+
+void VulkanBarrierBuilder::RecordLegacy(VkCommandBuffer cmdBuffer) const
+{
+    // Without synchronization2 every barrier in a call shares one pair of stage masks.
+    VkPipelineStageFlags2 srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+    VkPipelineStageFlags2 dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+
+    // Barriers are recorded every frame, so the converted arrays live in the thread's scratch arena.
+    ScratchScope scratch;
+    auto* memoryBarriers = scratch.GetArena().AllocateArray<VkMemoryBarrier>(m_MemoryBarriers.size());
+    for (size_t i = 0; i < m_MemoryBarriers.size(); i++)
+    {
+        const VkMemoryBarrier2& barrier = m_MemoryBarriers[i];
+        srcStageMask |= barrier.srcStageMask;
+        dstStageMask |= barrier.dstStageMask;
+
+        VkMemoryBarrier legacy{};
+        legacy.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        legacy.srcAccessMask = ToLegacyAccessMask(barrier.srcAccessMask);
+        legacy.dstAccessMask = ToLegacyAccessMask(barrier.dstAccessMask);
+        memoryBarriers[i] = legacy;
+    }
+
+    auto* bufferBarriers = scratch.GetArena().AllocateArray<VkBufferMemoryBarrier>(m_BufferBarriers.size());
+    for (size_t i = 0; i < m_BufferBarriers.size(); i++)
+    {
+        const VkBufferMemoryBarrier2& barrier = m_BufferBarriers[i];
+        srcStageMask |= barrier.srcStageMask;
+        dstStageMask |= barrier.dstStageMask;
+
+        VkBufferMemoryBarrier legacy{};
+        legacy.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        legacy.srcAccessMask = ToLegacyAccessMask(barrier.srcAccessMask);
+        legacy.dstAccessMask = ToLegacyAccessMask(barrier.dstAccessMask);
+        legacy.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+        legacy.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+        legacy.buffer = barrier.buffer;
+        legacy.offset = barrier.offset;
+        legacy.size = barrier.size;
+        bufferBarriers[i] = legacy;
+    }
+
+    auto* imageBarriers = scratch.GetArena().AllocateArray<VkImageMemoryBarrier>(m_ImageBarriers.size());
+    for (size_t i = 0; i < m_ImageBarriers.size(); i++)
+    {
+        const VkImageMemoryBarrier2& barrier = m_ImageBarriers[i];
+        srcStageMask |= barrier.srcStageMask;
+        dstStageMask |= barrier.dstStageMask;
+
+        VkImageMemoryBarrier legacy{};
+        legacy.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        legacy.srcAccessMask = ToLegacyAccessMask(barrier.srcAccessMask);
+        legacy.dstAccessMask = ToLegacyAccessMask(barrier.dstAccessMask);
+        legacy.oldLayout = barrier.oldLayout;
+        legacy.newLayout = barrier.newLayout;
+        legacy.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+        legacy.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+        legacy.image = barrier.image;
+        legacy.subresourceRange = barrier.subresourceRange;
+        imageBarriers[i] = legacy;
+    }
+
+    // Legacy barriers need at least one stage on each side.
+    VkPipelineStageFlags legacySrcStageMask = ToLegacyStageMask(srcStageMask);
+    VkPipelineStageFlags legacyDstStageMask = ToLegacyStageMask(dstStageMask);
+    if (legacySrcStageMask == 0)
+        legacySrcStageMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    if (legacyDstStageMask == 0)
+        legacyDstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+    vkCmdPipelineBarrier(
+            cmdBuffer,
+            legacySrcStageMask,
+            legacyDstStageMask,
+            0,
+            static_cast<uint32_t>(m_MemoryBarriers.size()), memoryBarriers,
+            static_cast<uint32_t>(m_BufferBarriers.size()), bufferBarriers,
+            static_cast<uint32_t>(m_ImageBarriers.size()), imageBarriers);
+}
+
+VkPipelineStageFlags VulkanBarrierBuilder::ToLegacyStageMask(VkPipelineStageFlags2 stageMask)
+{
+    // The low 32 bits share their values with the legacy flags; the split stages fold onto the stage they came from.
+    VkPipelineStageFlags legacy = static_cast<VkPipelineStageFlags>(stageMask & 0xFFFFFFFFull);
+    if (stageMask & TransferStageMask)
+        legacy |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+    if (stageMask & (VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT | VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT))
+        legacy |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    if (stageMask & VK_PIPELINE_STAGE_2_PRE_RASTERIZATION_SHADERS_BIT)
+    {
+        legacy |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                  VK_PIPELINE_STAGE_TESSELLATION_CONTROL_SHADER_BIT |
+                  VK_PIPELINE_STAGE_TESSELLATION_EVALUATION_SHADER_BIT |
+                  VK_PIPELINE_STAGE_GEOMETRY_SHADER_BIT;
+    }
+    return legacy;
+}
+
+VkAccessFlags VulkanBarrierBuilder::ToLegacyAccessMask(VkAccessFlags2 accessMask)
+{
+    VkAccessFlags legacy = static_cast<VkAccessFlags>(accessMask & 0xFFFFFFFFull);
+    if (accessMask & (VK_ACCESS_2_SHADER_SAMPLED_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT))
+        legacy |= VK_ACCESS_SHADER_READ_BIT;
+    if (accessMask & VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT)
+        legacy |= VK_ACCESS_SHADER_WRITE_BIT;
+    return legacy;
+}
+
+bool VulkanBarrierBuilder::CheckMasks(
+        VkPipelineStageFlags2 srcStageMask, VkAccessFlags2 srcAccessMask,
+        VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask,
+        const char** outProblem)
+{
+    constexpr VkPipelineStageFlags2 broadStages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT | VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT;
+    constexpr VkAccessFlags2 broadAccess = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+    const char* problem = nullptr;
+    if ((srcStageMask | dstStageMask) & broadStages)
+        problem = "ALL_COMMANDS/ALL_GRAPHICS stage mask waits on or blocks every stage";
+    else if ((srcAccessMask | dstAccessMask) & broadAccess)
+        problem = "MEMORY_READ/MEMORY_WRITE access mask flushes or invalidates every cache";
+    else if (srcAccessMask & ~WriteAccessMask)
+        problem = "source access mask includes reads, which never need to be made available";
+    else if (srcAccessMask != 0 && srcStageMask == VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT)
+        problem = "source access mask on TOP_OF_PIPE, which performs no accesses";
+    else if (dstAccessMask != 0 && dstStageMask == VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT)
+        problem = "destination access mask on BOTTOM_OF_PIPE, which performs no accesses";
+
+    if (outProblem)
+        *outProblem = problem;
+    return problem == nullptr;
+}
+
+void VulkanBarrierBuilder::Check(
+        VkPipelineStageFlags2 srcStageMask, VkAccessFlags2 srcAccessMask,
+        VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask) const
+{
+#ifndef NDEBUG
+    const char* problem = nullptr;
+    if (!CheckMasks(srcStageMask, srcAccessMask, dstStageMask, dstAccessMask, &problem))
+    {
+        std::cerr << "Over-broad barrier: " << problem << " (src stages 0x" << std::hex << srcStageMask
+                  << " access 0x" << srcAccessMask << ", dst stages 0x" << dstStageMask
+                  << " access 0x" << dstAccessMask << std::dec << ")\n";
+    }
+#else
+    (void) srcStageMask;
+    (void) srcAccessMask;
+    (void) dstStageMask;
+    (void) dstAccessMask;
+#endif
+}
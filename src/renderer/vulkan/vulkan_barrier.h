@@ -0,0 +1,125 @@
+#pragma once
+
+#include "renderer/vulkan/vulkan_device.h"
+
+#include <initializer_list>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// One kind of command touching a resource. Each implies the exact synchronization2 stage and access bits,
+// whether it writes, and for images the layout it needs.
+enum class ResourceAccess
+{
+    None,                           // Nothing to wait for; before an image barrier it discards the contents
+    HostRead,
+    HostWrite,
+    CopyRead,                       // vkCmdCopy* source
+    CopyWrite,                      // vkCmdCopy* destination
+    BlitRead,
+    BlitWrite,
+    IndirectRead,
+    IndexRead,
+    VertexRead,
+    VertexShaderUniformRead,
+    FragmentShaderUniformRead,
+    FragmentShaderSampledRead,
+    FragmentShaderStorageRead,      // Storage image or buffer, image in GENERAL
+    InputAttachmentRead,
+    ColorAttachmentWrite,
+    ColorAttachmentReadWrite,       // Blending
+    DepthStencilAttachmentRead,
+    DepthStencilAttachmentWrite,
+    ComputeShaderUniformRead,
+    ComputeShaderSampledRead,
+    ComputeShaderStorageRead,
+    ComputeShaderStorageWrite,
+    ComputeShaderStorageReadWrite,
+    Present
+};
+
+// Collects image, buffer and global barriers and records them as a single vkCmdPipelineBarrier2. Barriers
+// are described by the accesses on either side instead of masks: the source scope gets the stages of every
+// earlier access but only the access bits of its writes, since reads have nothing to make available.
+// Devices without VK_KHR_synchronization2 get the same barriers through vkCmdPipelineBarrier, with the
+// 64-bit masks folded onto their legacy equivalents.
+//
+// Debug builds check every barrier, including raw ones, for over-broad masks (ALL_COMMANDS, MEMORY_READ,
+// read bits in a source scope) and report them through std::cerr; synchronization validation in the layers
+// covers the opposite mistake.
+class VulkanBarrierBuilder
+{
+public:
+    explicit VulkanBarrierBuilder(VulkanDevice& deviceRef);
+
+    // The layouts follow from the accesses unless given; every access on one side must agree on it.
+    VulkanBarrierBuilder& Image(
+            VkImage image,
+            const VkImageSubresourceRange& subresourceRange,
+            std::initializer_list<ResourceAccess> before,
+            std::initializer_list<ResourceAccess> after);
+    VulkanBarrierBuilder& Image(
+            VkImage image,
+            const VkImageSubresourceRange& subresourceRange,
+            std::initializer_list<ResourceAccess> before,
+            std::initializer_list<ResourceAccess> after,
+            VkImageLayout oldLayout,
+            VkImageLayout newLayout);
+    VulkanBarrierBuilder& Buffer(
+            VkBuffer buffer,
+            std::initializer_list<ResourceAccess> before,
+            std::initializer_list<ResourceAccess> after,
+            VkDeviceSize offset = 0,
+            VkDeviceSize size = VK_WHOLE_SIZE);
+    VulkanBarrierBuilder& Memory(std::initializer_list<ResourceAccess> before, std::initializer_list<ResourceAccess> after);
+
+    // Raw barriers for callers that already know their masks, e.g. queue family transfers.
+    VulkanBarrierBuilder& Image(const VkImageMemoryBarrier2& barrier);
+    VulkanBarrierBuilder& Buffer(const VkBufferMemoryBarrier2& barrier);
+
+    [[nodiscard]] bool IsEmpty() const { return m_ImageBarriers.empty() && m_BufferBarriers.empty() && m_MemoryBarriers.empty(); }
+    [[nodiscard]] uint32_t GetBarrierCount() const;
+
+    // Records everything collected so far and clears the builder for reuse.
+    void Record(VkCommandBuffer cmdBuffer);
+    void Clear();
+
+    static VkImageLayout GetLayout(ResourceAccess access);
+    static VkPipelineStageFlags ToLegacyStageMask(VkPipelineStageFlags2 stageMask);
+    static VkAccessFlags ToLegacyAccessMask(VkAccessFlags2 accessMask);
+    // Returns false and describes the problem when the masks are wider than any access needs.
+    static bool CheckMasks(
+            VkPipelineStageFlags2 srcStageMask, VkAccessFlags2 srcAccessMask,
+            VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask,
+            const char** outProblem);
+
+private:
+    struct AccessInfo
+    {
+        VkPipelineStageFlags2 Stage;
+        VkAccessFlags2 Access;
+        bool Write;
+        VkImageLayout Layout;
+    };
+
+    struct Scope
+    {
+        VkPipelineStageFlags2 Stage = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2 Access = VK_ACCESS_2_NONE;
+        VkImageLayout Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    };
+
+    static AccessInfo GetAccessInfo(ResourceAccess access);
+    static Scope GetSrcScope(std::initializer_list<ResourceAccess> accesses);
+    static Scope GetDstScope(std::initializer_list<ResourceAccess> accesses);
+
+    void Check(
+            VkPipelineStageFlags2 srcStageMask, VkAccessFlags2 srcAccessMask,
+            VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask) const;
+    void RecordLegacy(VkCommandBuffer cmdBuffer) const;
+
+private:
+    VulkanDevice& m_DeviceRef;
+    std::vector<VkImageMemoryBarrier2> m_ImageBarriers;
+    std::vector<VkBufferMemoryBarrier2> m_BufferBarriers;
+    std::vector<VkMemoryBarrier2> m_MemoryBarriers;
+};
@@ -0,0 +1,143 @@
+#include "vulkan_bindless.h"
+#include "vulkan_swapchain.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+BindlessHandle BindlessIndexAllocator::Allocate()
+{
+    if (!m_FreeList.empty())
+    {
+        BindlessHandle handle = m_FreeList.back();
+        m_FreeList.pop_back();
+        return handle;
+    }
+
+    if (m_NextIndex >= m_Capacity)
+        throw std::runtime_error("Bindless table is full!");
+
+    return m_NextIndex++;
+}
+
+void BindlessIndexAllocator::Free(BindlessHandle handle)
+{
+    assert(handle < m_NextIndex && "Freeing a bindless handle that was never allocated");
+    assert(std::find(m_FreeList.begin(), m_FreeList.end(), handle) == m_FreeList.end() && "Bindless handle freed twice");
+    m_FreeList.push_back(handle);
+}
+
+VulkanBindlessTable::VulkanBindlessTable(VulkanDevice& deviceRef, uint32_t maxSampledImages, uint32_t maxStorageBuffers)
+    : m_DeviceRef(deviceRef)
+{
+    const auto& limits = m_DeviceRef.PhysicalDeviceVulkan12Properties;
+    maxSampledImages = std::min({
+            maxSampledImages,
+            limits.maxDescriptorSetUpdateAfterBindSampledImages,
+            limits.maxPerStageDescriptorUpdateAfterBindSampledImages});
+    maxStorageBuffers = std::min({
+            maxStorageBuffers,
+            limits.maxDescriptorSetUpdateAfterBindStorageBuffers,
+            limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers});
+
+    m_SampledImageIndices = BindlessIndexAllocator(maxSampledImages);
+    m_StorageBufferIndices = BindlessIndexAllocator(maxStorageBuffers);
+
+    constexpr VkDescriptorBindingFlags bindingFlags =
+            VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+            VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+            VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+    constexpr VkShaderStageFlags stages = VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+
+    m_DescriptorSetLayout = VulkanDescriptorSetLayout::Builder(m_DeviceRef)
+            // Binding 0: All sampled textures, indexed by BindlessHandle
+            .AddBinding(
+                    SampledImageBinding,
+                    VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                    stages,
+                    maxSampledImages,
+                    bindingFlags)
+            // Binding 1: All storage buffers, indexed by BindlessHandle
+            .AddBinding(
+                    StorageBufferBinding,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    stages,
+                    maxStorageBuffers,
+                    bindingFlags)
+            .SetLayoutFlags(VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT)
+            .Build();
+
+    m_DescriptorPool = VulkanDescriptorPool::Builder(m_DeviceRef)
+            .SetMaxSets(1)
+            .SetPoolFlags(VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT)
+            .AddPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxSampledImages)
+            .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, maxStorageBuffers)
+            .Build();
+
+    if (!m_DescriptorPool->AllocateDescriptor(m_DescriptorSetLayout->GetDescriptorSetLayout(), m_DescriptorSet))
+        throw std::runtime_error("Failed to allocate bindless descriptor set!");
+}
+
+BindlessHandle VulkanBindlessTable::RegisterTexture(const VkDescriptorImageInfo& imageInfo)
+{
+    BindlessHandle handle = m_SampledImageIndices.Allocate();
+    UpdateTexture(handle, imageInfo);
+    return handle;
+}
+
+void VulkanBindlessTable::UpdateTexture(BindlessHandle handle, const VkDescriptorImageInfo& imageInfo)
+{
+    VkDescriptorImageInfo info = imageInfo;
+    VulkanDescriptorWriter(*m_DescriptorSetLayout, *m_DescriptorPool)
+            .WriteImage(SampledImageBinding, &info, handle)
+            .Overwrite(m_DescriptorSet);
+}
+
+void VulkanBindlessTable::ReleaseTexture(BindlessHandle handle)
+{
+    if (handle == InvalidBindlessHandle)
+        return;
+    m_PendingReleases.push_back({handle, SampledImageBinding, m_FrameNumber});
+}
+
+BindlessHandle VulkanBindlessTable::RegisterStorageBuffer(const VkDescriptorBufferInfo& bufferInfo)
+{
+    BindlessHandle handle = m_StorageBufferIndices.Allocate();
+    UpdateStorageBuffer(handle, bufferInfo);
+    return handle;
+}
+
+void VulkanBindlessTable::UpdateStorageBuffer(BindlessHandle handle, const VkDescriptorBufferInfo& bufferInfo)
+{
+    VkDescriptorBufferInfo info = bufferInfo;
+    VulkanDescriptorWriter(*m_DescriptorSetLayout, *m_DescriptorPool)
+            .WriteBuffer(StorageBufferBinding, &info, handle)
+            .Overwrite(m_DescriptorSet);
+}
+
+void VulkanBindlessTable::ReleaseStorageBuffer(BindlessHandle handle)
+{
+    if (handle == InvalidBindlessHandle)
+        return;
+    m_PendingReleases.push_back({handle, StorageBufferBinding, m_FrameNumber});
+}
+
+void VulkanBindlessTable::BeginFrame(uint64_t frameNumber)
+{
+    m_FrameNumber = frameNumber;
+
+    auto retired = std::remove_if(m_PendingReleases.begin(), m_PendingReleases.end(),
+        [this](const PendingRelease& release)
+        {
+            if (m_FrameNumber < release.FrameNumber + VulkanSwapchain::MAX_FRAMES_IN_FLIGHT)
+                return false;
+
+            if (release.Binding == SampledImageBinding)
+                m_SampledImageIndices.Free(release.Handle);
+            else
+                m_StorageBufferIndices.Free(release.Handle);
+            return true;
+        });
+    m_PendingReleases.erase(retired, m_PendingReleases.end());
+}
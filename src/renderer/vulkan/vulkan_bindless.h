@@ -0,0 +1,79 @@
+#pragma once
+
+#include "renderer/vulkan/vulkan_descriptors.h"
+#include "renderer/vulkan/vulkan_device.h"
+
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+using BindlessHandle = uint32_t;
+constexpr BindlessHandle InvalidBindlessHandle = 0xFFFFFFFF;
+
+// Hands out slot indices into a fixed-capacity descriptor array.
+// Freed slots are recycled LIFO so the live range stays dense.
+class BindlessIndexAllocator
+{
+public:
+    explicit BindlessIndexAllocator(uint32_t capacity = 0) : m_Capacity(capacity) {}
+
+    BindlessHandle Allocate();
+    void Free(BindlessHandle handle);
+
+    [[nodiscard]] uint32_t GetCapacity() const { return m_Capacity; }
+    [[nodiscard]] uint32_t GetLiveCount() const { return m_NextIndex - static_cast<uint32_t>(m_FreeList.size()); }
+
+private:
+    uint32_t m_Capacity;
+    uint32_t m_NextIndex = 0;
+    std::vector<BindlessHandle> m_FreeList;
+};
+
+class VulkanBindlessTable
+{
+public:
+    static constexpr uint32_t SampledImageBinding = 0;
+    static constexpr uint32_t StorageBufferBinding = 1;
+
+    explicit VulkanBindlessTable(VulkanDevice& deviceRef, uint32_t maxSampledImages = 4096, uint32_t maxStorageBuffers = 1024);
+    ~VulkanBindlessTable() = default;
+
+    VulkanBindlessTable(const VulkanBindlessTable&) = delete;
+    VulkanBindlessTable& operator=(const VulkanBindlessTable&) = delete;
+
+    BindlessHandle RegisterTexture(const VkDescriptorImageInfo& imageInfo);
+    void UpdateTexture(BindlessHandle handle, const VkDescriptorImageInfo& imageInfo);
+    void ReleaseTexture(BindlessHandle handle);
+
+    BindlessHandle RegisterStorageBuffer(const VkDescriptorBufferInfo& bufferInfo);
+    void UpdateStorageBuffer(BindlessHandle handle, const VkDescriptorBufferInfo& bufferInfo);
+    void ReleaseStorageBuffer(BindlessHandle handle);
+
+    // Recycles slots released at least MAX_FRAMES_IN_FLIGHT frames ago, so a slot
+    // is never rewritten while a command buffer that may sample it is still pending.
+    void BeginFrame(uint64_t frameNumber);
+
+    [[nodiscard]] VkDescriptorSet GetDescriptorSet() const { return m_DescriptorSet; }
+    [[nodiscard]] VulkanDescriptorSetLayout& GetDescriptorSetLayout() const { return *m_DescriptorSetLayout; }
+    [[nodiscard]] uint32_t GetSampledImageCapacity() const { return m_SampledImageIndices.GetCapacity(); }
+    [[nodiscard]] uint32_t GetStorageBufferCapacity() const { return m_StorageBufferIndices.GetCapacity(); }
+
+private:
+    struct PendingRelease
+    {
+        BindlessHandle Handle;
+        uint32_t Binding;
+        uint64_t FrameNumber;
+    };
+
+    VulkanDevice& m_DeviceRef;
+
+    std::unique_ptr<VulkanDescriptorPool> m_DescriptorPool;
+    std::unique_ptr<VulkanDescriptorSetLayout> m_DescriptorSetLayout;
+    VkDescriptorSet m_DescriptorSet = VK_NULL_HANDLE;
+
+    BindlessIndexAllocator m_SampledImageIndices;
+    BindlessIndexAllocator m_StorageBufferIndices;
+    std::vector<PendingRelease> m_PendingReleases;
+    uint64_t m_FrameNumber = 0;
+};
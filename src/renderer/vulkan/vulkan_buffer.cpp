@@ -18,7 +18,8 @@ VulkanBuffer::VulkanBuffer(
     uint32_t instanceCount,
     VkBufferUsageFlags usageFlags,
     VkMemoryPropertyFlags memoryPropertyFlags,
-    VkDeviceSize minOffsetAlignment)
+    VkDeviceSize minOffsetAlignment,
+    const std::vector<uint32_t>& sharedQueueFamilies)
     : m_VulkanDevice{device},
       m_InstanceCount{instanceCount},
       m_InstanceSize{instanceSize},
@@ -27,7 +28,7 @@ VulkanBuffer::VulkanBuffer(
 {
     m_AlignmentSize = GetAlignment(instanceSize, minOffsetAlignment);
     m_BufferSize = m_AlignmentSize * instanceCount;
-    device.CreateBuffer(m_BufferSize, usageFlags, memoryPropertyFlags, m_Buffer, m_Memory);
+    device.CreateBuffer(m_BufferSize, usageFlags, memoryPropertyFlags, m_Buffer, m_Memory, sharedQueueFamilies);
 }
 
 VulkanBuffer::~VulkanBuffer()
@@ -11,7 +11,8 @@ public:
         uint32_t instanceCount,
         VkBufferUsageFlags usageFlags,
         VkMemoryPropertyFlags memoryPropertyFlags,
-        VkDeviceSize minOffsetAlignment = 1);
+        VkDeviceSize minOffsetAlignment = 1,
+        const std::vector<uint32_t>& sharedQueueFamilies = {});
 
     ~VulkanBuffer();
 
@@ -0,0 +1,103 @@
+#include "vulkan_compute_pipeline.h"
+#include "core/mapped_file.h"
+#include "core/profiler.h"
+
+#include <stdexcept>
+#include <cassert>
+
+
+VulkanComputePipeline::VulkanComputePipeline(VulkanDevice& deviceRef,
+                                             const std::string& compFilepath,
+                                             VkPipelineLayout pipelineLayout,
+                                             std::span<const uint32_t> specializationConstants)
+    :m_DeviceRef(deviceRef), m_PipelineLayout(pipelineLayout)
+{
+    CreateComputePipeline(compFilepath, specializationConstants);
+}
+
+VulkanComputePipeline::~VulkanComputePipeline()
+{
+    vkDestroyShaderModule(m_DeviceRef.GetDevice(), m_CompShaderModule, nullptr);
+    vkDestroyPipeline(m_DeviceRef.GetDevice(), m_ComputePipeline, nullptr);
+}
+
+void VulkanComputePipeline::CreateComputePipeline(const std::string& compFilepath, std::span<const uint32_t> specializationConstants)
+{
+    PROFILE_ZONE("CreateComputePipeline");
+    assert(m_PipelineLayout != VK_NULL_HANDLE && "Cannot create compute pipeline: no pipelineLayout provided");
+
+    // vkCreateShaderModule copies the code, so the mapping only has to live until it returns.
+    MappedFile compCode(compFilepath);
+    CreateShaderModule(compCode.GetSpan(), &m_CompShaderModule);
+
+    VkPipelineShaderStageCreateInfo shaderStage{};
+    shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    shaderStage.module = m_CompShaderModule;
+    shaderStage.pName = "main";
+    shaderStage.flags = 0;
+    shaderStage.pNext = nullptr;
+    shaderStage.pSpecializationInfo = nullptr;
+
+    std::vector<VkSpecializationMapEntry> specializationEntries(specializationConstants.size());
+    for (uint32_t i = 0; i < specializationEntries.size(); i++)
+    {
+        specializationEntries[i].constantID = i;
+        specializationEntries[i].offset = i * sizeof(uint32_t);
+        specializationEntries[i].size = sizeof(uint32_t);
+    }
+
+    VkSpecializationInfo specializationInfo{};
+    specializationInfo.mapEntryCount = static_cast<uint32_t>(specializationEntries.size());
+    specializationInfo.pMapEntries = specializationEntries.data();
+    specializationInfo.dataSize = specializationConstants.size_bytes();
+    specializationInfo.pData = specializationConstants.data();
+    if (!specializationConstants.empty())
+        shaderStage.pSpecializationInfo = &specializationInfo;
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = shaderStage;
+    pipelineInfo.layout = m_PipelineLayout;
+    pipelineInfo.basePipelineIndex = -1;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+    if (vkCreateComputePipelines(
+            m_DeviceRef.GetDevice(),
+            VK_NULL_HANDLE,
+            1,
+            &pipelineInfo,
+            nullptr,
+            &m_ComputePipeline) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create compute pipeline");
+    }
+}
+
+void VulkanComputePipeline::CreateShaderModule(std::span<const uint8_t> code, VkShaderModule* shaderModule)
+{
+    VkShaderModuleCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = code.size();
+    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+    if (vkCreateShaderModule(m_DeviceRef.GetDevice(), &createInfo, nullptr, shaderModule) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create shader module");
+    }
+}
+
+void VulkanComputePipeline::Bind(VkCommandBuffer commandBuffer)
+{
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ComputePipeline);
+}
+
+void VulkanComputePipeline::Dispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+    vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
+}
+
+void VulkanComputePipeline::DispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer argumentBuffer, VkDeviceSize offset)
+{
+    vkCmdDispatchIndirect(commandBuffer, argumentBuffer, offset);
+}
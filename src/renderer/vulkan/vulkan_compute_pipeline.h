@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "vulkan_device.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+class VulkanComputePipeline
+{
+public:
+    // specializationConstants are the values of constant_id 0, 1, ... in order; ids the shader does not
+    // declare are ignored.
+    explicit VulkanComputePipeline(VulkanDevice& deviceRef,
+                                   const std::string& compFilepath,
+                                   VkPipelineLayout pipelineLayout,
+                                   std::span<const uint32_t> specializationConstants = {});
+
+    ~VulkanComputePipeline();
+
+    VulkanComputePipeline(const VulkanComputePipeline&) = delete;
+    VulkanComputePipeline& operator=(const VulkanComputePipeline&) = delete;
+
+    void Bind(VkCommandBuffer commandBuffer);
+    void Dispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
+    // Group counts are read from a VkDispatchIndirectCommand written on the GPU.
+    void DispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer argumentBuffer, VkDeviceSize offset = 0);
+
+    [[nodiscard]] VkPipelineLayout GetPipelineLayout() const { return m_PipelineLayout; }
+
+    // Number of work groups of groupSize needed to cover size invocations.
+    static uint32_t GetGroupCount(uint32_t size, uint32_t groupSize) { return (size + groupSize - 1) / groupSize; }
+
+private:
+
+    void CreateComputePipeline(const std::string& compFilepath, std::span<const uint32_t> specializationConstants);
+    void CreateShaderModule(std::span<const uint8_t> code, VkShaderModule* shaderModule);
+
+private:
+    VulkanDevice& m_DeviceRef;
+    VkPipelineLayout m_PipelineLayout;
+    VkPipeline m_ComputePipeline{};
+    VkShaderModule m_CompShaderModule{};
+};
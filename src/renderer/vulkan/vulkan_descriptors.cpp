@@ -11,7 +11,8 @@ VulkanDescriptorSetLayout::Builder& VulkanDescriptorSetLayout::Builder::AddBindi
     glm::uint32_t binding,
     VkDescriptorType descriptorType,
     VkShaderStageFlags stageFlags,
-    uint32_t count)
+    uint32_t count,
+    VkDescriptorBindingFlags bindingFlags)
 {
     assert(m_Bindings.count(binding) == 0 && "Binding already in use");
     VkDescriptorSetLayoutBinding layoutBinding{};
@@ -20,31 +21,59 @@ VulkanDescriptorSetLayout::Builder& VulkanDescriptorSetLayout::Builder::AddBindi
     layoutBinding.descriptorCount = count;
     layoutBinding.stageFlags = stageFlags;
     m_Bindings[binding] = layoutBinding;
+    if (bindingFlags != 0)
+        m_BindingFlags[binding] = bindingFlags;
+    return *this;
+}
+
+VulkanDescriptorSetLayout::Builder& VulkanDescriptorSetLayout::Builder::SetLayoutFlags(VkDescriptorSetLayoutCreateFlags flags)
+{
+    m_LayoutFlags = flags;
     return *this;
 }
 
 std::unique_ptr<VulkanDescriptorSetLayout> VulkanDescriptorSetLayout::Builder::Build() const
 {
-    return std::make_unique<VulkanDescriptorSetLayout>(m_Device, m_Bindings);
+    return std::make_unique<VulkanDescriptorSetLayout>(m_Device, m_Bindings, m_BindingFlags, m_LayoutFlags);
 }
 
 // *************** Descriptor Set Layout *********************
 
-VulkanDescriptorSetLayout::VulkanDescriptorSetLayout(VulkanDevice& device, const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>&bindings)
+VulkanDescriptorSetLayout::VulkanDescriptorSetLayout(
+        VulkanDevice& device,
+        const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings,
+        const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& bindingFlags,
+        VkDescriptorSetLayoutCreateFlags layoutFlags)
     : m_Device{device}, m_Bindings{bindings}
 {
     std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings{};
+    std::vector<VkDescriptorBindingFlags> setLayoutBindingFlags{};
     setLayoutBindings.reserve(bindings.size());
+    setLayoutBindingFlags.reserve(bindings.size());
     for (auto kv: bindings)
     {
         setLayoutBindings.push_back(kv.second);
+
+        // Flags must line up index-for-index with pBindings.
+        auto flagsIt = bindingFlags.find(kv.first);
+        setLayoutBindingFlags.push_back(flagsIt != bindingFlags.end() ? flagsIt->second : 0);
     }
 
     VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo{};
     descriptorSetLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    descriptorSetLayoutInfo.flags = layoutFlags;
     descriptorSetLayoutInfo.bindingCount = static_cast<uint32_t>(setLayoutBindings.size());
     descriptorSetLayoutInfo.pBindings = setLayoutBindings.data();
 
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+    if (!bindingFlags.empty())
+    {
+        bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        bindingFlagsInfo.bindingCount = static_cast<uint32_t>(setLayoutBindingFlags.size());
+        bindingFlagsInfo.pBindingFlags = setLayoutBindingFlags.data();
+        descriptorSetLayoutInfo.pNext = &bindingFlagsInfo;
+    }
+
     if (vkCreateDescriptorSetLayout(
             m_Device.GetDevice(),
             &descriptorSetLayoutInfo,
@@ -150,18 +179,19 @@ VulkanDescriptorWriter::VulkanDescriptorWriter(VulkanDescriptorSetLayout& setLay
 {
 }
 
-VulkanDescriptorWriter& VulkanDescriptorWriter::WriteBuffer(uint32_t binding, VkDescriptorBufferInfo* bufferInfo)
+VulkanDescriptorWriter& VulkanDescriptorWriter::WriteBuffer(uint32_t binding, VkDescriptorBufferInfo* bufferInfo, uint32_t arrayElement)
 {
     assert(m_SetLayout.m_Bindings.count(binding) == 1 && "Layout does not contain specified binding");
 
     auto& bindingDescription = m_SetLayout.m_Bindings[binding];
 
-    assert(bindingDescription.descriptorCount == 1 && "Binding single descriptor info, but binding expects multiple");
+    assert(arrayElement < bindingDescription.descriptorCount && "Array element out of range for binding");
 
     VkWriteDescriptorSet write{};
     write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     write.descriptorType = bindingDescription.descriptorType;
     write.dstBinding = binding;
+    write.dstArrayElement = arrayElement;
     write.pBufferInfo = bufferInfo;
     write.descriptorCount = 1;
 
@@ -169,20 +199,21 @@ VulkanDescriptorWriter& VulkanDescriptorWriter::WriteBuffer(uint32_t binding, Vk
     return *this;
 }
 
-VulkanDescriptorWriter& VulkanDescriptorWriter::WriteImage(uint32_t binding, VkDescriptorImageInfo* imageInfo)
+VulkanDescriptorWriter& VulkanDescriptorWriter::WriteImage(uint32_t binding, VkDescriptorImageInfo* imageInfo, uint32_t arrayElement)
 {
     assert(m_SetLayout.m_Bindings.count(binding) == 1 && "Layout does not contain specified binding");
 
     auto&bindingDescription = m_SetLayout.m_Bindings[binding];
 
     assert(
-        bindingDescription.descriptorCount == 1 &&
-        "Binding single descriptor info, but binding expects multiple");
+        arrayElement < bindingDescription.descriptorCount &&
+        "Array element out of range for binding");
 
     VkWriteDescriptorSet write{};
     write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     write.descriptorType = bindingDescription.descriptorType;
     write.dstBinding = binding;
+    write.dstArrayElement = arrayElement;
     write.pImageInfo = imageInfo;
     write.descriptorCount = 1;
 
@@ -16,15 +16,27 @@ public:
         {
         }
 
-        Builder& AddBinding(uint32_t binding, VkDescriptorType descriptorType, VkShaderStageFlags stageFlags, uint32_t count = 1);
+        Builder& AddBinding(
+                uint32_t binding,
+                VkDescriptorType descriptorType,
+                VkShaderStageFlags stageFlags,
+                uint32_t count = 1,
+                VkDescriptorBindingFlags bindingFlags = 0);
+        Builder& SetLayoutFlags(VkDescriptorSetLayoutCreateFlags flags);
         [[nodiscard]] std::unique_ptr<VulkanDescriptorSetLayout> Build() const;
 
     private:
         VulkanDevice& m_Device;
         std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> m_Bindings{};
+        std::unordered_map<uint32_t, VkDescriptorBindingFlags> m_BindingFlags{};
+        VkDescriptorSetLayoutCreateFlags m_LayoutFlags = 0;
     };
 
-    VulkanDescriptorSetLayout(VulkanDevice& device, const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>&bindings);
+    VulkanDescriptorSetLayout(
+            VulkanDevice& device,
+            const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings,
+            const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& bindingFlags = {},
+            VkDescriptorSetLayoutCreateFlags layoutFlags = 0);
     ~VulkanDescriptorSetLayout();
 
     VulkanDescriptorSetLayout(const VulkanDescriptorSetLayout&) = delete;
@@ -89,8 +101,8 @@ class VulkanDescriptorWriter
 public:
     VulkanDescriptorWriter(VulkanDescriptorSetLayout& setLayout, VulkanDescriptorPool& pool);
 
-    VulkanDescriptorWriter& WriteBuffer(uint32_t binding, VkDescriptorBufferInfo* bufferInfo);
-    VulkanDescriptorWriter& WriteImage(uint32_t binding, VkDescriptorImageInfo* imageInfo);
+    VulkanDescriptorWriter& WriteBuffer(uint32_t binding, VkDescriptorBufferInfo* bufferInfo, uint32_t arrayElement = 0);
+    VulkanDescriptorWriter& WriteImage(uint32_t binding, VkDescriptorImageInfo* imageInfo, uint32_t arrayElement = 0);
 
     bool Build(VkDescriptorSet& set);
     void Overwrite(VkDescriptorSet& set);
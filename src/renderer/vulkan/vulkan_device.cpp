@@ -1,11 +1,18 @@
 #include "vulkan_device.h"
 #include "vulkan_utils.h"
+#include "vulkan_queue_ownership.h"
+#include "vulkan_barrier.h"
+#include "vulkan_gpu_profiler.h"
+#include "vulkan_swapchain.h"
+#include "core/profiler.h"
 
+#include <array>
 #include <cstring>
 #include <iostream>
 #include <set>
 #include <unordered_set>
 #include <cassert>
+#include <algorithm>
 
 
 static VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(
@@ -116,11 +123,19 @@ VulkanDevice::VulkanDevice(Window& window)
     CreateLogicalDevice();
     CreateGraphicsCommandPool();
     CreateComputeCommandPool();
+    CreateTransferCommandPool();
+
+    m_SamplerCache = std::make_unique<VulkanSamplerCache>(m_LogicalDevice, PhysicalDeviceProperties.limits.maxSamplerAnisotropy);
+    m_GpuProfiler = std::make_unique<VulkanGpuProfiler>(*this, VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
 }
 
 VulkanDevice::~VulkanDevice()
 {
+    m_GpuProfiler.reset();
+    m_SamplerCache.reset();
     vkDestroyCommandPool(m_LogicalDevice, m_GraphicsCommandPool, nullptr);
+    vkDestroyCommandPool(m_LogicalDevice, m_ComputeCommandPool, nullptr);
+    vkDestroyCommandPool(m_LogicalDevice, m_TransferCommandPool, nullptr);
     vkDestroyDevice(m_LogicalDevice, nullptr);
 
     if(m_EnableValidationLayers)
@@ -143,7 +158,12 @@ void VulkanDevice::CreateInstance()
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "No Engine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    appInfo.apiVersion = VK_API_VERSION_1_2;
+
+#ifndef NDEBUG
+    // VK_EXT_validation_features comes from the validation layer rather than the loader, and older layers lack it.
+    m_EnableValidationFeatures = m_EnableValidationLayers && IsValidationLayerExtensionAvailable(VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME);
+#endif
 
     VkInstanceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -155,6 +175,13 @@ void VulkanDevice::CreateInstance()
     createInfo.flags |= VK_INSTANCE_CREATE_ENUMERATE_PORTABILITY_BIT_KHR;
 
     VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo{};
+#ifndef NDEBUG
+    const VkValidationFeatureEnableEXT enabledValidationFeatures[] = { VK_VALIDATION_FEATURE_ENABLE_SYNCHRONIZATION_VALIDATION_EXT };
+    VkValidationFeaturesEXT validationFeatures{};
+    validationFeatures.sType = VK_STRUCTURE_TYPE_VALIDATION_FEATURES_EXT;
+    validationFeatures.enabledValidationFeatureCount = 1;
+    validationFeatures.pEnabledValidationFeatures = enabledValidationFeatures;
+#endif
     if (m_EnableValidationLayers)
     {
         createInfo.enabledLayerCount = static_cast<uint32_t>(m_ValidationLayers.size());
@@ -162,6 +189,12 @@ void VulkanDevice::CreateInstance()
 
         PopulateDebugMessengerCreateInfo(debugCreateInfo);
         createInfo.pNext = (VkDebugUtilsMessengerCreateInfoEXT *) &debugCreateInfo;
+
+#ifndef NDEBUG
+        // Synchronization validation reports missing barriers; VulkanBarrierBuilder reports over-broad ones.
+        if (m_EnableValidationFeatures)
+            debugCreateInfo.pNext = &validationFeatures;
+#endif
     }
     else
     {
@@ -204,6 +237,14 @@ void VulkanDevice::SelectPhysicalDevice()
     }
 
     vkGetPhysicalDeviceProperties(m_PhysicalDevice, &PhysicalDeviceProperties);
+
+    PhysicalDeviceVulkan12Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+    VkPhysicalDeviceProperties2 properties2{};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties2.pNext = &PhysicalDeviceVulkan12Properties;
+    vkGetPhysicalDeviceProperties2(m_PhysicalDevice, &properties2);
+    PhysicalDeviceVulkan12Properties.pNext = nullptr;
+
     std::cout << "physical device: " << PhysicalDeviceProperties.deviceName << std::endl;
 }
 
@@ -220,11 +261,31 @@ std::vector<const char *> VulkanDevice::GetRequiredExtensions() const
     if (m_EnableValidationLayers)
     {
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+        if (m_EnableValidationFeatures)
+            extensions.push_back(VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME);
     }
 
     return extensions;
 }
 
+bool VulkanDevice::IsValidationLayerExtensionAvailable(const char* extensionName) const
+{
+    for (const char* layerName : m_ValidationLayers)
+    {
+        uint32_t extensionCount = 0;
+        vkEnumerateInstanceExtensionProperties(layerName, &extensionCount, nullptr);
+        std::vector<VkExtensionProperties> extensions(extensionCount);
+        vkEnumerateInstanceExtensionProperties(layerName, &extensionCount, extensions.data());
+
+        for (const auto& extension : extensions)
+        {
+            if (std::strcmp(extension.extensionName, extensionName) == 0)
+                return true;
+        }
+    }
+    return false;
+}
+
 void VulkanDevice::HasGLFWRequiredInstanceExtensions()
 {
     uint32_t extensionCount = 0;
@@ -245,6 +306,9 @@ void VulkanDevice::HasGLFWRequiredInstanceExtensions()
     for (const auto &required: requiredExtensions)
     {
         std::cout << "\t" << required << std::endl;
+        // Provided by the validation layer, and only requested once the layer reported it.
+        if (m_EnableValidationFeatures && std::strcmp(required, VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME) == 0)
+            continue;
         if (available.find(required) == available.end())
         {
             throw std::runtime_error("Missing required glfw extension");
@@ -274,12 +338,99 @@ bool VulkanDevice::CheckDeviceExtensionSupport(VkPhysicalDevice device)
     return requiredExtensions.empty();
 }
 
+bool VulkanDevice::IsDeviceExtensionAvailable(VkPhysicalDevice device, const char* extensionName) const
+{
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+    return std::any_of(availableExtensions.begin(), availableExtensions.end(), [&](const VkExtensionProperties& extension)
+    {
+        return strcmp(extension.extensionName, extensionName) == 0;
+    });
+}
+
+bool VulkanDevice::CanCalibrateWithSteadyClock(VkPhysicalDevice device) const
+{
+#ifdef _WIN32
+    // steady_clock is QueryPerformanceCounter scaled to nanoseconds there; not worth the conversion.
+    (void)device;
+    return false;
+#else
+    if (!IsDeviceExtensionAvailable(device, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME))
+        return false;
+
+    auto getTimeDomains = reinterpret_cast<PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT>(
+            vkGetInstanceProcAddr(m_Instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT"));
+    if (getTimeDomains == nullptr)
+        return false;
+
+    uint32_t domainCount = 0;
+    getTimeDomains(device, &domainCount, nullptr);
+    std::vector<VkTimeDomainEXT> domains(domainCount);
+    getTimeDomains(device, &domainCount, domains.data());
+
+    // steady_clock is CLOCK_MONOTONIC in both libstdc++ and libc++.
+    const bool hasDevice = std::find(domains.begin(), domains.end(), VK_TIME_DOMAIN_DEVICE_EXT) != domains.end();
+    const bool hasMonotonic = std::find(domains.begin(), domains.end(), VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT) != domains.end();
+    return hasDevice && hasMonotonic;
+#endif
+}
+
+void VulkanDevice::GetCalibratedTimestamps(uint64_t& outDeviceTicks, int64_t& outHostNanoseconds)
+{
+    assert(SupportsCalibratedTimestamps());
+
+    std::array<VkCalibratedTimestampInfoEXT, 2> infos{};
+    infos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+    infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+    infos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+    infos[1].timeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+
+    std::array<uint64_t, 2> timestamps{};
+    uint64_t maxDeviation = 0;
+    VK_CHECK_RESULT(m_GetCalibratedTimestamps(m_LogicalDevice, static_cast<uint32_t>(infos.size()), infos.data(), timestamps.data(), &maxDeviation));
+
+    outDeviceTicks = timestamps[0];
+    outHostNanoseconds = static_cast<int64_t>(timestamps[1]);
+}
+
+VkDeviceSize VulkanDevice::GetDeviceLocalMemoryUsage()
+{
+    if (!m_SupportsMemoryBudget)
+        return 0;
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+    budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    VkPhysicalDeviceMemoryProperties2 memoryProperties{};
+    memoryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    memoryProperties.pNext = &budget;
+    vkGetPhysicalDeviceMemoryProperties2(m_PhysicalDevice, &memoryProperties);
+
+    VkDeviceSize usage = 0;
+    for (uint32_t i = 0; i < memoryProperties.memoryProperties.memoryHeapCount; i++)
+    {
+        if (memoryProperties.memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+            usage += budget.heapUsage[i];
+    }
+    return usage;
+}
+
 void VulkanDevice::CreateLogicalDevice()
 {
-    QueueFamilyIndices indices = FindQueueFamilies(m_PhysicalDevice);
+    m_QueueFamilyIndices = FindQueueFamilies(m_PhysicalDevice);
+    const QueueFamilyIndices& indices = m_QueueFamilyIndices;
 
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-    std::set<uint32_t> uniqueQueueFamilies = { indices.GraphicsFamily.value(), indices.PresentFamily.value(), indices.ComputeFamily.value() };
+    std::set<uint32_t> uniqueQueueFamilies =
+    {
+        indices.GraphicsFamily.value(),
+        indices.PresentFamily.value(),
+        indices.ComputeFamily.value(),
+        indices.TransferFamily.value()
+    };
 
     float queuePriority = 1.0f;
     for (uint32_t queueFamily: uniqueQueueFamilies)
@@ -292,18 +443,81 @@ void VulkanDevice::CreateLogicalDevice()
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
-    VkPhysicalDeviceFeatures deviceFeatures = {};
-    deviceFeatures.samplerAnisotropy = VK_TRUE;
+    // Descriptor indexing (core in 1.2) backs the bindless resource table.
+    VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.descriptorIndexing = VK_TRUE;
+    vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+    vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+    vulkan12Features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+    vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    vulkan12Features.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+
+    // Synchronization2 (core only from 1.3) is optional; VulkanBarrierBuilder falls back to the legacy barrier.
+    std::vector<const char*> deviceExtensions = m_DeviceExtensions;
+    VkPhysicalDeviceSynchronization2Features synchronization2Features = {};
+    synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
+    if (IsDeviceExtensionAvailable(m_PhysicalDevice, VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME))
+    {
+        VkPhysicalDeviceFeatures2 supportedFeatures2 = {};
+        supportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        supportedFeatures2.pNext = &synchronization2Features;
+        vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &supportedFeatures2);
+    }
+    const bool enableSynchronization2 = synchronization2Features.synchronization2 == VK_TRUE;
+    if (enableSynchronization2)
+    {
+        deviceExtensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+        synchronization2Features.pNext = nullptr;
+        vulkan12Features.pNext = &synchronization2Features;
+    }
+
+    // Calibrated timestamps let the GPU profiler place its scopes on the CPU profiler's timeline.
+    const bool enableCalibratedTimestamps = CanCalibrateWithSteadyClock(m_PhysicalDevice);
+    if (enableCalibratedTimestamps)
+        deviceExtensions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+
+    // Memory budget only feeds reporting (re_coo_bench).
+    m_SupportsMemoryBudget = IsDeviceExtensionAvailable(m_PhysicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (m_SupportsMemoryBudget)
+        deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+    // Host query reset lets the GPU profiler recycle its query pools without recording a reset.
+    VkPhysicalDeviceVulkan12Features supportedVulkan12Features = {};
+    supportedVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    VkPhysicalDeviceFeatures2 supportedCoreFeatures = {};
+    supportedCoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supportedCoreFeatures.pNext = &supportedVulkan12Features;
+    vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &supportedCoreFeatures);
+    m_SupportsHostQueryReset = supportedVulkan12Features.hostQueryReset == VK_TRUE;
+    vulkan12Features.hostQueryReset = supportedVulkan12Features.hostQueryReset;
+
+    VkPhysicalDeviceFeatures2 deviceFeatures = {};
+    deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    deviceFeatures.pNext = &vulkan12Features;
+    deviceFeatures.features.samplerAnisotropy = VK_TRUE;
+
+    // Block-compressed textures are optional; VulkanTexture2D rejects BCn formats when this is off.
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(m_PhysicalDevice, &supportedFeatures);
+    m_SupportsTextureCompressionBC = supportedFeatures.textureCompressionBC == VK_TRUE;
+    deviceFeatures.features.textureCompressionBC = supportedFeatures.textureCompressionBC;
+    // Optional as well; without it the GPU profiler only records timestamps.
+    m_SupportsPipelineStatistics = supportedFeatures.pipelineStatisticsQuery == VK_TRUE;
+    deviceFeatures.features.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
 
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &deviceFeatures;
 
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
-    createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(m_DeviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = m_DeviceExtensions.data();
+    createInfo.pEnabledFeatures = nullptr;
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
     // might not really be necessary anymore because device specific validation layers
     // have been deprecated
@@ -322,6 +536,11 @@ void VulkanDevice::CreateLogicalDevice()
         throw std::runtime_error("failed to create logical device!");
     }
 
+    if (enableSynchronization2)
+        m_CmdPipelineBarrier2 = reinterpret_cast<PFN_vkCmdPipelineBarrier2KHR>(vkGetDeviceProcAddr(m_LogicalDevice, "vkCmdPipelineBarrier2KHR"));
+    if (enableCalibratedTimestamps)
+        m_GetCalibratedTimestamps = reinterpret_cast<PFN_vkGetCalibratedTimestampsEXT>(vkGetDeviceProcAddr(m_LogicalDevice, "vkGetCalibratedTimestampsEXT"));
+
     vkGetDeviceQueue(m_LogicalDevice, indices.GraphicsFamily.value(), 0, &m_GraphicsQueue);
     SetDebugUtilsObjectName(m_LogicalDevice, VK_OBJECT_TYPE_QUEUE, (uint64_t)m_GraphicsQueue, "GraphicsQueue");
 
@@ -331,6 +550,11 @@ void VulkanDevice::CreateLogicalDevice()
     std::string name = indices.ComputeFamily.value() == indices.GraphicsFamily.value() ? "Graphics/Compute" : "Compute";
     vkGetDeviceQueue(m_LogicalDevice, indices.ComputeFamily.value(), 0, &m_ComputeQueue);
     SetDebugUtilsObjectName(m_LogicalDevice, VK_OBJECT_TYPE_QUEUE, (uint64_t)m_ComputeQueue, name.c_str());
+
+    // Without a dedicated transfer family this aliases the compute or graphics queue.
+    vkGetDeviceQueue(m_LogicalDevice, indices.TransferFamily.value(), 0, &m_TransferQueue);
+    if (indices.TransferFamily.value() != indices.ComputeFamily.value() && indices.TransferFamily.value() != indices.GraphicsFamily.value())
+        SetDebugUtilsObjectName(m_LogicalDevice, VK_OBJECT_TYPE_QUEUE, (uint64_t)m_TransferQueue, "TransferQueue");
 }
 
 void VulkanDevice::CreateGraphicsCommandPool()
@@ -363,6 +587,67 @@ void VulkanDevice::CreateComputeCommandPool()
     }
 }
 
+void VulkanDevice::CreateTransferCommandPool()
+{
+    VkCommandPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = m_QueueFamilyIndices.TransferFamily.value();
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+    if (vkCreateCommandPool(m_LogicalDevice, &poolInfo, nullptr, &m_TransferCommandPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create transfer command pool!");
+    }
+}
+
+VkCommandPool VulkanDevice::GetCommandPool(QueueType queueType)
+{
+    switch (queueType)
+    {
+        case QueueType::Graphics: return m_GraphicsCommandPool;
+        case QueueType::Compute: return m_ComputeCommandPool;
+        case QueueType::Transfer: return m_TransferCommandPool;
+    }
+    assert(false && "Unknown queue type");
+    return VK_NULL_HANDLE;
+}
+
+VkQueue VulkanDevice::GetQueue(QueueType queueType)
+{
+    switch (queueType)
+    {
+        case QueueType::Graphics: return m_GraphicsQueue;
+        case QueueType::Compute: return m_ComputeQueue;
+        case QueueType::Transfer: return m_TransferQueue;
+    }
+    assert(false && "Unknown queue type");
+    return VK_NULL_HANDLE;
+}
+
+uint32_t VulkanDevice::GetQueueFamilyIndex(QueueType queueType) const
+{
+    switch (queueType)
+    {
+        case QueueType::Graphics: return m_QueueFamilyIndices.GraphicsFamily.value();
+        case QueueType::Compute: return m_QueueFamilyIndices.ComputeFamily.value();
+        case QueueType::Transfer: return m_QueueFamilyIndices.TransferFamily.value();
+    }
+    assert(false && "Unknown queue type");
+    return VK_QUEUE_FAMILY_IGNORED;
+}
+
+std::vector<uint32_t> VulkanDevice::GetUniqueQueueFamilyIndices(std::initializer_list<QueueType> queueTypes) const
+{
+    std::vector<uint32_t> familyIndices;
+    for (QueueType queueType : queueTypes)
+    {
+        uint32_t familyIndex = GetQueueFamilyIndex(queueType);
+        if (std::find(familyIndices.begin(), familyIndices.end(), familyIndex) == familyIndices.end())
+            familyIndices.push_back(familyIndex);
+    }
+    return familyIndices;
+}
+
 void VulkanDevice::CreateSurface()
 {
     m_WindowRef.CreateWindowSurface(m_Instance, &m_Surface);
@@ -381,10 +666,30 @@ bool VulkanDevice::IsDeviceSuitable(VkPhysicalDevice device)
         swapChainAdequate = !swapChainSupport.Formats.empty() && !swapChainSupport.PresentModes.empty();
     }
 
-    VkPhysicalDeviceFeatures supportedFeatures;
-    vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
-
-    return indices.IsComplete() && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy;
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device, &properties);
+    if (properties.apiVersion < VK_API_VERSION_1_2)
+        return false;
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    VkPhysicalDeviceFeatures2 supportedFeatures{};
+    supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supportedFeatures.pNext = &vulkan12Features;
+    vkGetPhysicalDeviceFeatures2(device, &supportedFeatures);
+
+    bool descriptorIndexingSupported =
+            vulkan12Features.descriptorIndexing &&
+            vulkan12Features.runtimeDescriptorArray &&
+            vulkan12Features.descriptorBindingPartiallyBound &&
+            vulkan12Features.descriptorBindingUpdateUnusedWhilePending &&
+            vulkan12Features.descriptorBindingSampledImageUpdateAfterBind &&
+            vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind &&
+            vulkan12Features.shaderSampledImageArrayNonUniformIndexing &&
+            vulkan12Features.shaderStorageBufferArrayNonUniformIndexing;
+
+    return indices.IsComplete() && extensionsSupported && swapChainAdequate &&
+           supportedFeatures.features.samplerAnisotropy && descriptorIndexingSupported;
 }
 
 QueueFamilyIndices VulkanDevice::FindQueueFamilies(VkPhysicalDevice device)
@@ -397,26 +702,56 @@ QueueFamilyIndices VulkanDevice::FindQueueFamilies(VkPhysicalDevice device)
     std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
 
-    int i = 0;
-    for (const auto &queueFamily: queueFamilies)
+    // Prefer families without graphics for compute and without graphics or compute for transfer,
+    // so async compute and uploads run on their own hardware queues alongside rendering.
+    std::optional<uint32_t> dedicatedComputeFamily;
+    std::optional<uint32_t> dedicatedTransferFamily;
+    std::optional<uint32_t> anyComputeFamily;
+
+    for (uint32_t i = 0; i < queueFamilyCount; i++)
     {
-        if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+        const VkQueueFamilyProperties& queueFamily = queueFamilies[i];
+        if (queueFamily.queueCount == 0)
+            continue;
+
+        bool supportsGraphics = queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT;
+        bool supportsCompute = queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT;
+        bool supportsTransfer = queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT;
+
+        if (supportsGraphics && !indices.GraphicsFamily.has_value())
             indices.GraphicsFamily = i;
 
-        if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT)
-            indices.ComputeFamily = i;
+        if (supportsCompute && !anyComputeFamily.has_value())
+            anyComputeFamily = i;
+
+        if (supportsCompute && !supportsGraphics && !dedicatedComputeFamily.has_value())
+            dedicatedComputeFamily = i;
+
+        if (supportsTransfer && !supportsGraphics && !supportsCompute && !dedicatedTransferFamily.has_value())
+            dedicatedTransferFamily = i;
 
         VkBool32 presentSupport = false;
         vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_Surface, &presentSupport);
 
-        if (queueFamily.queueCount > 0 && presentSupport)
+        // Presenting from the graphics family avoids a swapchain ownership transfer.
+        if (presentSupport && (!indices.PresentFamily.has_value() || indices.GraphicsFamily == i))
             indices.PresentFamily = i;
+    }
 
-        if (indices.IsComplete())
-            break;
+    if (dedicatedComputeFamily.has_value())
+        indices.ComputeFamily = dedicatedComputeFamily;
+    else if (indices.GraphicsFamily.has_value() && queueFamilies[indices.GraphicsFamily.value()].queueFlags & VK_QUEUE_COMPUTE_BIT)
+        indices.ComputeFamily = indices.GraphicsFamily;
+    else
+        indices.ComputeFamily = anyComputeFamily;
 
-        i++;
-    }
+    // Graphics and compute families implicitly support transfer operations.
+    if (dedicatedTransferFamily.has_value())
+        indices.TransferFamily = dedicatedTransferFamily;
+    else if (dedicatedComputeFamily.has_value())
+        indices.TransferFamily = dedicatedComputeFamily;
+    else
+        indices.TransferFamily = indices.GraphicsFamily;
 
     return indices;
 }
@@ -451,6 +786,16 @@ SwapchainSupportDetails VulkanDevice::QuerySwapchainSupport(VkPhysicalDevice dev
 }
 
 
+bool VulkanDevice::SupportsLinearBlit(VkFormat format) const
+{
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(m_PhysicalDevice, format, &props);
+
+    constexpr VkFormatFeatureFlags required =
+            VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (props.optimalTilingFeatures & required) == required;
+}
+
 VkFormat VulkanDevice::FindSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features)
 {
     for (VkFormat format: candidates)
@@ -485,12 +830,12 @@ uint32_t VulkanDevice::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags
     throw std::runtime_error("failed to find suitable memory type!");
 }
 
-VkCommandBuffer VulkanDevice::BeginSingleTimeCommands()
+VkCommandBuffer VulkanDevice::BeginSingleTimeCommands(QueueType queueType)
 {
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = m_GraphicsCommandPool;
+    allocInfo.commandPool = GetCommandPool(queueType);
     allocInfo.commandBufferCount = 1;
 
     VkCommandBuffer commandBuffer;
@@ -504,7 +849,7 @@ VkCommandBuffer VulkanDevice::BeginSingleTimeCommands()
     return commandBuffer;
 }
 
-void VulkanDevice::EndSingleTimeCommand(VkCommandBuffer commandBuffer)
+void VulkanDevice::EndSingleTimeCommand(VkCommandBuffer commandBuffer, QueueType queueType)
 {
     vkEndCommandBuffer(commandBuffer);
 
@@ -513,22 +858,30 @@ void VulkanDevice::EndSingleTimeCommand(VkCommandBuffer commandBuffer)
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffer;
 
-    vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(m_GraphicsQueue);
+    VkQueue queue = GetQueue(queueType);
+    vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(queue);
 
-    vkFreeCommandBuffers(m_LogicalDevice, m_GraphicsCommandPool, 1, &commandBuffer);
+    vkFreeCommandBuffers(m_LogicalDevice, GetCommandPool(queueType), 1, &commandBuffer);
 }
 
 void VulkanDevice::CreateBuffer(
         VkDeviceSize size,
         VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
-        VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+        VkBuffer& buffer, VkDeviceMemory& bufferMemory,
+        const std::vector<uint32_t>& sharedQueueFamilies)
 {
     VkBufferCreateInfo bufferInfo{};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = size;
     bufferInfo.usage = usage;
     bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (sharedQueueFamilies.size() > 1)
+    {
+        bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(sharedQueueFamilies.size());
+        bufferInfo.pQueueFamilyIndices = sharedQueueFamilies.data();
+    }
 
     if (vkCreateBuffer(m_LogicalDevice, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
         throw std::runtime_error("Failed to create vertex buffer!");
@@ -547,9 +900,15 @@ void VulkanDevice::CreateBuffer(
     vkBindBufferMemory(m_LogicalDevice, buffer, bufferMemory, 0);
 }
 
-void VulkanDevice::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
+void VulkanDevice::CopyBuffer(
+        VkBuffer srcBuffer, VkBuffer dstBuffer,
+        VkDeviceSize size,
+        VkPipelineStageFlags dstStageMask,
+        VkAccessFlags dstAccessMask,
+        QueueType dstQueueType)
 {
-    VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+    PROFILE_ZONE("VulkanDevice::CopyBuffer");
+    VkCommandBuffer commandBuffer = BeginSingleTimeCommands(QueueType::Transfer);
 
     VkBufferCopy copyRegion{};
     copyRegion.srcOffset = 0; // Optional
@@ -557,7 +916,30 @@ void VulkanDevice::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSi
     copyRegion.size = size;
     vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
 
-    EndSingleTimeCommand(commandBuffer);
+    // A barrier here could only order later work on the transfer queue, whose family may not even support
+    // the consumer's stages; the wait for the copy orders the readers on other queues.
+    if (dstQueueType == QueueType::Transfer)
+    {
+        EndSingleTimeCommand(commandBuffer, QueueType::Transfer);
+        return;
+    }
+
+    VulkanQueueOwnershipTransfer ownershipTransfer(
+            *this,
+            QueueType::Transfer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            dstQueueType, dstStageMask);
+    ownershipTransfer.AddBuffer(dstBuffer, VK_ACCESS_TRANSFER_WRITE_BIT, dstAccessMask, 0, size);
+
+    ownershipTransfer.RecordRelease(commandBuffer);
+    if (!ownershipTransfer.IsRequired())
+    {
+        EndSingleTimeCommand(commandBuffer, QueueType::Transfer);
+        return;
+    }
+
+    VkCommandBuffer acquireCommandBuffer = BeginSingleTimeCommands(dstQueueType);
+    ownershipTransfer.RecordAcquire(acquireCommandBuffer);
+    ownershipTransfer.SubmitAndWait(commandBuffer, acquireCommandBuffer);
 }
 
 void VulkanDevice::CopyBufferToImage(
@@ -566,6 +948,7 @@ void VulkanDevice::CopyBufferToImage(
     uint32_t width, uint32_t height,
     uint32_t layerCount)
 {
+    PROFILE_ZONE("VulkanDevice::CopyBufferToImage");
     VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
 
     VkBufferImageCopy region{};
@@ -599,96 +982,46 @@ void VulkanDevice::TransitionImageLayout(
         uint32_t mipLevels,
         uint32_t layerCount)
 {
-    // Uses an image memory barrier transition image layouts and transfer queue
-    // family ownership when VK_SHARING_MODE_EXCLUSIVE is used. There is an
-    // equivalent buffer memory barrier to do this for buffers
-    VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
-
-    VkImageMemoryBarrier barrier{};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout = oldLayout;
-    barrier.newLayout = newLayout;
-
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    // The access each layout is used for decides the stages and access masks on either side.
+    auto getLayoutAccess = [](VkImageLayout layout)
+    {
+        switch (layout)
+        {
+            case VK_IMAGE_LAYOUT_UNDEFINED: return ResourceAccess::None;
+            case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL: return ResourceAccess::CopyWrite;
+            case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL: return ResourceAccess::CopyRead;
+            case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL: return ResourceAccess::FragmentShaderSampledRead;
+            case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL: return ResourceAccess::DepthStencilAttachmentWrite;
+            case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL: return ResourceAccess::ColorAttachmentReadWrite;
+            default: throw std::invalid_argument("unsupported layout transition!");
+        }
+    };
 
-    barrier.image = image;
-    barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = mipLevels;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = layerCount;
+    VkImageSubresourceRange subresourceRange{};
+    subresourceRange.baseMipLevel = 0;
+    subresourceRange.levelCount = mipLevels;
+    subresourceRange.baseArrayLayer = 0;
+    subresourceRange.layerCount = layerCount;
 
     if (newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
     {
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
 
         if (format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT)
         {
-            barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+            subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
         }
     }
     else
     {
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    }
-
-    VkPipelineStageFlags sourceStage;
-    VkPipelineStageFlags destinationStage;
-
-    if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
-    {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-        sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-    }
-    else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
-    {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-        sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-    }
-    else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-    {
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-        sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    }
-    else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
-    {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-        sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        destinationStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    }
-    else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
-    {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-        sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        destinationStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    }
-    else
-    {
-        throw std::invalid_argument("unsupported layout transition!");
+        subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     }
 
-    vkCmdPipelineBarrier(
-            commandBuffer,
-            sourceStage,
-            destinationStage,
-            0,
-            0, nullptr,
-            0, nullptr,
-            1, &barrier);
+    VulkanBarrierBuilder barriers(*this);
+    barriers.Image(image, subresourceRange, { getLayoutAccess(oldLayout) }, { getLayoutAccess(newLayout) });
 
+    VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+    barriers.Record(commandBuffer);
     EndSingleTimeCommand(commandBuffer);
 }
 
@@ -1,9 +1,14 @@
 #pragma once
 
 #include "core/window.h"
+#include "renderer/vulkan/vulkan_sampler_cache.h"
+#include <memory>
 #include <string>
 #include <vector>
 #include <optional>
+#include <initializer_list>
+
+class VulkanGpuProfiler;
 
 struct SwapchainSupportDetails
 {
@@ -15,10 +20,21 @@ struct SwapchainSupportDetails
 struct QueueFamilyIndices
 {
     std::optional<uint32_t> GraphicsFamily;
-    std::optional<uint32_t> ComputeFamily;
+    std::optional<uint32_t> ComputeFamily;     // Dedicated async compute family when the device has one
+    std::optional<uint32_t> TransferFamily;    // Dedicated transfer (DMA) family when the device has one
     std::optional<uint32_t> PresentFamily;
 
-    [[nodiscard]] bool IsComplete() const { return GraphicsFamily.has_value() && PresentFamily.has_value() && ComputeFamily.has_value(); }
+    [[nodiscard]] bool IsComplete() const
+    {
+        return GraphicsFamily.has_value() && PresentFamily.has_value() && ComputeFamily.has_value() && TransferFamily.has_value();
+    }
+};
+
+enum class QueueType
+{
+    Graphics,
+    Compute,
+    Transfer
 };
 
 
@@ -35,20 +51,48 @@ public:
 
     VkCommandPool GetGraphicsCommandPool() { return m_GraphicsCommandPool; }
     VkCommandPool GetComputeCommandPool() { return m_ComputeCommandPool; }
+    VkCommandPool GetTransferCommandPool() { return m_TransferCommandPool; }
+    VkCommandPool GetCommandPool(QueueType queueType);
     VkDevice GetDevice() { return m_LogicalDevice; }
     VkSurfaceKHR GetSurface() { return m_Surface; }
     VkQueue GetGraphicsQueue() { return m_GraphicsQueue; }
     VkQueue GetPresentQueue() { return m_PresentQueue; }
     VkQueue GetComputeQueue() { return m_ComputeQueue; }
+    VkQueue GetTransferQueue() { return m_TransferQueue; }
+    VkQueue GetQueue(QueueType queueType);
+    uint32_t GetQueueFamilyIndex(QueueType queueType) const;
+    // Distinct family indices of the given queues, for resources created with VK_SHARING_MODE_CONCURRENT.
+    std::vector<uint32_t> GetUniqueQueueFamilyIndices(std::initializer_list<QueueType> queueTypes) const;
+    bool HasDedicatedComputeQueue() const { return m_QueueFamilyIndices.ComputeFamily != m_QueueFamilyIndices.GraphicsFamily; }
+    bool HasDedicatedTransferQueue() const { return m_QueueFamilyIndices.TransferFamily != m_QueueFamilyIndices.GraphicsFamily; }
+    bool SupportsTextureCompressionBC() const { return m_SupportsTextureCompressionBC; }
+    bool SupportsSynchronization2() const { return m_CmdPipelineBarrier2 != nullptr; }
+    bool SupportsHostQueryReset() const { return m_SupportsHostQueryReset; }
+    bool SupportsPipelineStatistics() const { return m_SupportsPipelineStatistics; }
+    bool SupportsCalibratedTimestamps() const { return m_GetCalibratedTimestamps != nullptr; }
+    // Reads the device timestamp counter and steady_clock together. Only valid when SupportsCalibratedTimestamps().
+    void GetCalibratedTimestamps(uint64_t& outDeviceTicks, int64_t& outHostNanoseconds);
+    bool SupportsMemoryBudget() const { return m_SupportsMemoryBudget; }
+    // Bytes the process has allocated from device-local heaps, per VK_EXT_memory_budget. 0 without it.
+    VkDeviceSize GetDeviceLocalMemoryUsage();
+    // Only valid when SupportsSynchronization2(); VulkanBarrierBuilder falls back to vkCmdPipelineBarrier otherwise.
+    void CmdPipelineBarrier2(VkCommandBuffer cmdBuffer, const VkDependencyInfo& dependencyInfo) { m_CmdPipelineBarrier2(cmdBuffer, &dependencyInfo); }
+    // Optimal-tiling blit source and destination with linear filtering, as GenerateMips needs.
+    bool SupportsLinearBlit(VkFormat format) const;
     VkPhysicalDevice GetPhysicalDevice() { return m_PhysicalDevice; }
+    // Shared and owned by the device: never destroy the returned sampler.
+    VkSampler GetSampler(const VkSamplerCreateInfo& createInfo) { return m_SamplerCache->GetSampler(createInfo); }
+    // Per-frame GPU timings of the renderer's passes, see VulkanGpuProfiler.
+    VulkanGpuProfiler& GetGpuProfiler() { return *m_GpuProfiler; }
 
     SwapchainSupportDetails GetSwapchainSupport() { return QuerySwapchainSupport(m_PhysicalDevice); }
     uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
-    QueueFamilyIndices FindPhysicalQueueFamilies() { return FindQueueFamilies(m_PhysicalDevice); }
+    QueueFamilyIndices FindPhysicalQueueFamilies() { return m_QueueFamilyIndices; }
     VkFormat FindSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
     QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device);
 
     VkPhysicalDeviceProperties PhysicalDeviceProperties{};
+    VkPhysicalDeviceVulkan12Properties PhysicalDeviceVulkan12Properties{};
 
     void CreateImageWithInfo(const VkImageCreateInfo& imageInfo,
                              VkMemoryPropertyFlags properties,
@@ -58,11 +102,19 @@ public:
     void CreateBuffer(
             VkDeviceSize size,
             VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
-            VkBuffer &buffer, VkDeviceMemory &bufferMemory);
+            VkBuffer &buffer, VkDeviceMemory &bufferMemory,
+            const std::vector<uint32_t>& sharedQueueFamilies = {});
 
+    // Copies on the transfer queue, then hands the destination to dstQueueType's family, where it is made
+    // visible to the consumer's stages and accesses. Buffers created with concurrent sharing stay on
+    // QueueType::Transfer; they have no owner to hand to, and their consumers on other queues are ordered by
+    // the copy having completed, so no barrier is recorded for them.
     void CopyBuffer(
         VkBuffer srcBuffer, VkBuffer dstBuffer,
-        VkDeviceSize size);
+        VkDeviceSize size,
+        VkPipelineStageFlags dstStageMask,
+        VkAccessFlags dstAccessMask,
+        QueueType dstQueueType = QueueType::Graphics);
 
     void CopyBufferToImage(
         VkBuffer buffer,
@@ -78,8 +130,8 @@ public:
         uint32_t mipLevels = 1,
         uint32_t layerCount = 1);
 
-    VkCommandBuffer BeginSingleTimeCommands();
-    void EndSingleTimeCommand(VkCommandBuffer commandBuffer);
+    VkCommandBuffer BeginSingleTimeCommands(QueueType queueType = QueueType::Graphics);
+    void EndSingleTimeCommand(VkCommandBuffer commandBuffer, QueueType queueType = QueueType::Graphics);
 
 private:
     void CreateInstance();
@@ -89,31 +141,49 @@ private:
     void CreateLogicalDevice();
     void CreateGraphicsCommandPool();
     void CreateComputeCommandPool();
+    void CreateTransferCommandPool();
 
     bool IsDeviceSuitable(VkPhysicalDevice device);
     [[nodiscard]] std::vector<const char*> GetRequiredExtensions() const;
     bool CheckValidationLayerSupport();
+    [[nodiscard]] bool IsValidationLayerExtensionAvailable(const char* extensionName) const;
 
     void PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
     void HasGLFWRequiredInstanceExtensions();
     bool CheckDeviceExtensionSupport(VkPhysicalDevice device);
+    bool IsDeviceExtensionAvailable(VkPhysicalDevice device, const char* extensionName) const;
+    bool CanCalibrateWithSteadyClock(VkPhysicalDevice device) const;
 
     SwapchainSupportDetails QuerySwapchainSupport(VkPhysicalDevice device);
 
     Window& m_WindowRef;
 
     bool m_EnableValidationLayers = true;
+    // Synchronization validation, in debug builds whose validation layer provides VK_EXT_validation_features.
+    bool m_EnableValidationFeatures = false;
     VkInstance m_Instance{};
     VkDebugUtilsMessengerEXT m_DebugMessenger{};
     VkPhysicalDevice m_PhysicalDevice = VK_NULL_HANDLE;
     VkCommandPool m_GraphicsCommandPool{};
     VkCommandPool m_ComputeCommandPool{};
+    VkCommandPool m_TransferCommandPool{};
+    QueueFamilyIndices m_QueueFamilyIndices;
+    bool m_SupportsTextureCompressionBC = false;
+    bool m_SupportsHostQueryReset = false;
+    bool m_SupportsPipelineStatistics = false;
+    bool m_SupportsMemoryBudget = false;
+    PFN_vkCmdPipelineBarrier2KHR m_CmdPipelineBarrier2 = nullptr;
+    PFN_vkGetCalibratedTimestampsEXT m_GetCalibratedTimestamps = nullptr;
 
     VkDevice m_LogicalDevice{};
     VkSurfaceKHR m_Surface{};
     VkQueue m_GraphicsQueue{};
     VkQueue m_PresentQueue{};
     VkQueue m_ComputeQueue{};
+    VkQueue m_TransferQueue{};
+
+    std::unique_ptr<VulkanSamplerCache> m_SamplerCache;
+    std::unique_ptr<VulkanGpuProfiler> m_GpuProfiler;
 
     const std::vector<const char *> m_ValidationLayers = {
             "VK_LAYER_KHRONOS_validation",
@@ -8,32 +8,47 @@ VulkanFramebuffer::VulkanFramebuffer(
         const std::vector<Attachment::Specification>& attachmentSpecs,
         const std::vector<Subpass>& subpasses,
         const std::vector<SubpassDependency>& dependencies,
-        const std::vector<ExternalAttachment>& externalAttachments)
-        : m_DeviceRef(deviceRef), m_Width(width), m_Height(height), m_Subpasses(subpasses), m_Dependencies(dependencies), m_ExternalAttachments(externalAttachments)
+        const std::vector<ExternalAttachment>& externalAttachments,
+        VulkanTransientMemoryPool* transientPool,
+        uint32_t passIndex)
+        : m_DeviceRef(deviceRef), m_Width(width), m_Height(height), m_Subpasses(subpasses), m_Dependencies(dependencies), m_ExternalAttachments(externalAttachments),
+          m_PassIndex(passIndex), m_TransientPool(transientPool)
 {
-    m_Attachments.resize(attachmentSpecs.size());
-    for (int i = 0; i < attachmentSpecs.size(); i++)
+    if (!m_TransientPool)
     {
-        CreateAttachment(
-                m_DeviceRef,
-                attachmentSpecs[i],
-                &m_Attachments[i],
-                m_Width, m_Height);
+        m_OwnedTransientPool = std::make_unique<VulkanTransientMemoryPool>(m_DeviceRef);
+        m_TransientPool = m_OwnedTransientPool.get();
     }
+
+    m_Attachments.resize(attachmentSpecs.size());
+    for (int i = 0; i < attachmentSpecs.size(); i++)
+        CreateAttachment(attachmentSpecs[i], &m_Attachments[i]);
     CreateFramebuffer();
 }
 
 VulkanFramebuffer::~VulkanFramebuffer()
 {
-    for(auto& attachment : m_Attachments)
+    DestroyAttachments();
+
+    vkDestroyFramebuffer(m_DeviceRef.GetDevice(), m_Framebuffer, nullptr);
+    vkDestroyRenderPass(m_DeviceRef.GetDevice(), m_RenderPass, nullptr);
+}
+
+bool VulkanFramebuffer::IsTransient(const Attachment::Specification& spec)
+{
+    return spec.LoadOp != VK_ATTACHMENT_LOAD_OP_LOAD && spec.StoreOp == VK_ATTACHMENT_STORE_OP_DONT_CARE;
+}
+
+void VulkanFramebuffer::DestroyAttachments()
+{
+    for (auto& attachment : m_Attachments)
     {
         vkDestroyImageView(m_DeviceRef.GetDevice(), attachment.View, nullptr);
+        if (!attachment.Mem)
+            m_TransientPool->Release(attachment.Image);
         vkDestroyImage(m_DeviceRef.GetDevice(), attachment.Image, nullptr);
         vkFreeMemory(m_DeviceRef.GetDevice(), attachment.Mem, nullptr);
     }
-
-    vkDestroyFramebuffer(m_DeviceRef.GetDevice(), m_Framebuffer, nullptr);
-    vkDestroyRenderPass(m_DeviceRef.GetDevice(), m_RenderPass, nullptr);
 }
 
 void PrintAttachment(VulkanFramebuffer::Attachment& attachment)
@@ -46,11 +61,7 @@ void PrintAttachment(VulkanFramebuffer::Attachment& attachment)
               << "VkImageView: " << attachment.View << "\n";
 }
 
-void VulkanFramebuffer::CreateAttachment(
-    VulkanDevice& deviceRef,
-    const Attachment::Specification& spec,
-    Attachment* attachment,
-    uint32_t width, uint32_t height)
+void VulkanFramebuffer::CreateAttachment(const Attachment::Specification& spec, Attachment* attachment)
 {
     VkImageAspectFlags aspectMask = 0;
 
@@ -67,27 +78,40 @@ void VulkanFramebuffer::CreateAttachment(
 
     assert(aspectMask > 0);
 
+    const bool transient = IsTransient(spec);
+
     attachment->Spec = spec;
-    attachment->Width = width;
-    attachment->Height = height;
+    attachment->Width = m_Width;
+    attachment->Height = m_Height;
     VkImageCreateInfo imageCreateInfo{};
     imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
     imageCreateInfo.format = spec.Format;
-    imageCreateInfo.extent.width = width;
-    imageCreateInfo.extent.height = height;
+    imageCreateInfo.extent.width = m_Width;
+    imageCreateInfo.extent.height = m_Height;
     imageCreateInfo.extent.depth = 1;
     imageCreateInfo.mipLevels = 1;
     imageCreateInfo.arrayLayers = 1;
     imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
     imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-    imageCreateInfo.usage = spec.Usage | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageCreateInfo.usage = transient
+            ? spec.Usage | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT
+            : spec.Usage | VK_IMAGE_USAGE_SAMPLED_BIT;
 
-    deviceRef.CreateImageWithInfo(
-        imageCreateInfo,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        attachment->Image,
-        attachment->Mem);
+    if (transient)
+    {
+        VK_CHECK_RESULT(vkCreateImage(m_DeviceRef.GetDevice(), &imageCreateInfo, nullptr, &attachment->Image));
+        m_TransientPool->Bind(attachment->Image, imageCreateInfo, m_PassIndex, m_PassIndex, true);
+        attachment->Mem = VK_NULL_HANDLE;
+    }
+    else
+    {
+        m_DeviceRef.CreateImageWithInfo(
+            imageCreateInfo,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            attachment->Image,
+            attachment->Mem);
+    }
 
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -100,7 +124,7 @@ void VulkanFramebuffer::CreateAttachment(
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount = 1;
     viewInfo.image = attachment->Image;
-    VK_CHECK_RESULT(vkCreateImageView(deviceRef.GetDevice(), &viewInfo, nullptr, &attachment->View));
+    VK_CHECK_RESULT(vkCreateImageView(m_DeviceRef.GetDevice(), &viewInfo, nullptr, &attachment->View));
 
     PrintAttachment(*attachment);
 }
@@ -217,16 +241,11 @@ void VulkanFramebuffer::Resize(uint32_t width, uint32_t height)
     vkDestroyRenderPass(m_DeviceRef.GetDevice(), m_RenderPass, nullptr);
 
     // Destroy attachments
-    for (auto& attachment : m_Attachments)
-    {
-        vkDestroyImageView(m_DeviceRef.GetDevice(), attachment.View, nullptr);
-        vkDestroyImage(m_DeviceRef.GetDevice(), attachment.Image, nullptr);
-        vkFreeMemory(m_DeviceRef.GetDevice(), attachment.Mem, nullptr);
-    }
+    DestroyAttachments();
 
     // Recreate attachments with new size
     for (auto& attachment : m_Attachments)
-        CreateAttachment(m_DeviceRef, attachment.Spec, &attachment, width, height);
+        CreateAttachment(attachment.Spec, &attachment);
 
     CreateFramebuffer();
 }
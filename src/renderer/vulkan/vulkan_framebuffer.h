@@ -1,7 +1,9 @@
 #pragma once
 
 #include "renderer/vulkan/vulkan_device.h"
+#include "renderer/vulkan/vulkan_transient_memory.h"
 #include <glm/fwd.hpp>
+#include <memory>
 #include <unordered_map>
 #include <vulkan/vulkan.h>
 
@@ -22,6 +24,7 @@ public:
 
         uint32_t Width, Height;
         VkImage Image;
+        // Null for transient attachments, whose memory belongs to the transient pool.
         VkDeviceMemory Mem;
         VkImageView View;
         Specification Spec;
@@ -69,15 +72,16 @@ public:
             const std::vector<Attachment::Specification>& attachmentSpecs,
             const std::vector<Subpass>& subpasses,
             const std::vector<SubpassDependency>& dependencies,
-            const std::vector<ExternalAttachment>& externalAttachments = {});
+            const std::vector<ExternalAttachment>& externalAttachments = {},
+            VulkanTransientMemoryPool* transientPool = nullptr,
+            uint32_t passIndex = 0);
 
     ~VulkanFramebuffer();
 
-    static void CreateAttachment(
-            VulkanDevice& deviceRef,
-            const Attachment::Specification& spec,
-            Attachment* attachment,
-            uint32_t width, uint32_t height);
+    // An attachment neither loaded nor stored lives only inside the render pass. It is created with
+    // VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT (so it cannot be sampled) and its memory comes from the
+    // transient pool, shared with other framebuffers' transient attachments whose passes never overlap.
+    static bool IsTransient(const Attachment::Specification& spec);
 
     void Resize(uint32_t width, uint32_t height);
 
@@ -95,6 +99,8 @@ public:
     VkFormat GetExternalDepthImageFormat() const { return m_ExternalDepthImageFormat; }
 
 private:
+    void CreateAttachment(const Attachment::Specification& spec, Attachment* attachment);
+    void DestroyAttachments();
     void CreateFramebuffer();
 
 private:
@@ -109,4 +115,9 @@ private:
     std::vector<ExternalAttachment> m_ExternalAttachments;
     VkFormat m_ExternalColorImageFormat;
     VkFormat m_ExternalDepthImageFormat;
+
+    // Position of this framebuffer's render pass on the transient pool's timeline.
+    uint32_t m_PassIndex;
+    VulkanTransientMemoryPool* m_TransientPool;
+    std::unique_ptr<VulkanTransientMemoryPool> m_OwnedTransientPool;
 };
@@ -0,0 +1,576 @@
+#include "vulkan_gpu_profiler.h"
+#include "vulkan_utils.h"
+#include "core/profiler.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    // Same order as GpuPipelineStatistic, which is ascending bit order.
+    constexpr std::array<VkQueryPipelineStatisticFlagBits, static_cast<size_t>(GpuPipelineStatistic::Count)> PipelineStatisticBits =
+    {
+        VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT,
+        VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT,
+        VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT,
+        VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT,
+        VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT,
+        VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT
+    };
+
+    void WriteJsonString(std::ostream& out, std::string_view text)
+    {
+        out << '"';
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                out << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20)
+                out << ' ';
+            else
+                out << c;
+        }
+        out << '"';
+    }
+}
+
+VulkanGpuProfiler::VulkanGpuProfiler(VulkanDevice& deviceRef, uint32_t frameCount)
+    : m_DeviceRef(deviceRef), m_Frames(frameCount)
+{
+    m_NanosecondsPerTick = m_DeviceRef.PhysicalDeviceProperties.limits.timestampPeriod;
+
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(m_DeviceRef.GetPhysicalDevice(), &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(m_DeviceRef.GetPhysicalDevice(), &familyCount, families.data());
+
+    VkQueryPipelineStatisticFlags graphicsStatistics = 0;
+    for (VkQueryPipelineStatisticFlagBits bit : PipelineStatisticBits)
+        graphicsStatistics |= bit;
+
+    bool anyTimestamps = false;
+    for (QueueType queue : { QueueType::Graphics, QueueType::Compute, QueueType::Transfer })
+    {
+        const VkQueueFamilyProperties& family = families[m_DeviceRef.GetQueueFamilyIndex(queue)];
+        const uint32_t validBits = family.timestampValidBits;
+        const size_t index = static_cast<size_t>(queue);
+        m_TimestampMasks[index] = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+        anyTimestamps = anyTimestamps || validBits > 0;
+
+        // Families without graphics may only count compute invocations; transfer-only families count nothing.
+        if (!m_DeviceRef.SupportsPipelineStatistics())
+            m_StatisticsFlags[index] = 0;
+        else if (family.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+            m_StatisticsFlags[index] = graphicsStatistics;
+        else if (family.queueFlags & VK_QUEUE_COMPUTE_BIT)
+            m_StatisticsFlags[index] = VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+    }
+
+    for (uint32_t i = 0; i < frameCount; i++)
+    {
+        FrameQueries& frame = m_Frames[i];
+
+        if (anyTimestamps)
+        {
+            VkQueryPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            poolInfo.queryCount = MaxScopesPerFrame * 2;
+            VK_CHECK_RESULT(vkCreateQueryPool(m_DeviceRef.GetDevice(), &poolInfo, nullptr, &frame.TimestampPool));
+            SetDebugUtilsObjectName(m_DeviceRef.GetDevice(), VK_OBJECT_TYPE_QUERY_POOL, (uint64_t)frame.TimestampPool,
+                                    ("GpuProfilerTimestamps" + std::to_string(i)).c_str());
+        }
+
+        for (size_t queue = 0; queue < m_StatisticsFlags.size(); queue++)
+        {
+            if (m_StatisticsFlags[queue] == 0)
+                continue;
+
+            VkQueryPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            poolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+            poolInfo.queryCount = MaxScopesPerFrame;
+            poolInfo.pipelineStatistics = m_StatisticsFlags[queue];
+            VK_CHECK_RESULT(vkCreateQueryPool(m_DeviceRef.GetDevice(), &poolInfo, nullptr, &frame.StatisticsPools[queue]));
+        }
+
+        if (m_DeviceRef.SupportsHostQueryReset())
+            ResetQueries(frame);
+    }
+
+    Calibrate();
+}
+
+VulkanGpuProfiler::~VulkanGpuProfiler()
+{
+    for (FrameQueries& frame : m_Frames)
+    {
+        vkDestroyQueryPool(m_DeviceRef.GetDevice(), frame.TimestampPool, nullptr);
+        for (VkQueryPool pool : frame.StatisticsPools)
+            vkDestroyQueryPool(m_DeviceRef.GetDevice(), pool, nullptr);
+    }
+}
+
+void VulkanGpuProfiler::ResetQueries(FrameQueries& frame)
+{
+    if (frame.TimestampPool != VK_NULL_HANDLE)
+        vkResetQueryPool(m_DeviceRef.GetDevice(), frame.TimestampPool, 0, MaxScopesPerFrame * 2);
+    for (VkQueryPool pool : frame.StatisticsPools)
+    {
+        if (pool != VK_NULL_HANDLE)
+            vkResetQueryPool(m_DeviceRef.GetDevice(), pool, 0, MaxScopesPerFrame);
+    }
+    frame.ResetPending = false;
+}
+
+void VulkanGpuProfiler::BeginFrame(uint32_t frameIndex, uint64_t frameNumber)
+{
+    assert(frameIndex < m_Frames.size());
+
+    FrameQueries& frame = m_Frames[frameIndex];
+    Resolve(frame);
+
+    frame.FrameNumber = frameNumber;
+    if (m_DeviceRef.SupportsHostQueryReset())
+        ResetQueries(frame);
+    else
+        frame.ResetPending = true;
+
+    m_CurrentFrame = frameIndex;
+    m_OpenScopes = {};
+
+    // Keeps the GPU and CPU clocks from drifting apart; cheap, but only possible with the extension.
+    if (frameNumber % CalibrationInterval == 0 && m_DeviceRef.SupportsCalibratedTimestamps())
+        Calibrate();
+}
+
+void VulkanGpuProfiler::Calibrate()
+{
+    if (m_DeviceRef.SupportsCalibratedTimestamps())
+        m_DeviceRef.GetCalibratedTimestamps(m_CalibrationTicks, m_CalibrationNanoseconds);
+    else
+        CalibrateWithSubmit();
+}
+
+void VulkanGpuProfiler::CalibrateWithSubmit()
+{
+    if (m_TimestampMasks[static_cast<size_t>(QueueType::Graphics)] == 0)
+        return;
+
+    VkQueryPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount = 1;
+    VkQueryPool pool = VK_NULL_HANDLE;
+    VK_CHECK_RESULT(vkCreateQueryPool(m_DeviceRef.GetDevice(), &poolInfo, nullptr, &pool));
+
+    VkCommandBuffer cmdBuffer = m_DeviceRef.BeginSingleTimeCommands(QueueType::Graphics);
+    vkCmdResetQueryPool(cmdBuffer, pool, 0, 1);
+    vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, pool, 0);
+
+    const auto submitted = std::chrono::steady_clock::now();
+    m_DeviceRef.EndSingleTimeCommand(cmdBuffer, QueueType::Graphics);
+    const auto finished = std::chrono::steady_clock::now();
+
+    uint64_t ticks = 0;
+    VK_CHECK_RESULT(vkGetQueryPoolResults(
+            m_DeviceRef.GetDevice(),
+            pool,
+            0,
+            1,
+            sizeof(ticks),
+            &ticks,
+            sizeof(ticks),
+            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+    vkDestroyQueryPool(m_DeviceRef.GetDevice(), pool, nullptr);
+
+    m_CalibrationTicks = ticks;
+    m_CalibrationNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            (submitted + (finished - submitted) / 2).time_since_epoch()).count();
+}
+
+int64_t VulkanGpuProfiler::ToHostNanoseconds(uint64_t ticks, uint64_t mask) const
+{
+    // Difference in the queue's valid bits, sign-extended so scopes before the calibration come out negative.
+    uint64_t difference = (ticks - m_CalibrationTicks) & mask;
+    if (mask != ~0ull && difference > (mask >> 1))
+        difference |= ~mask;
+    return m_CalibrationNanoseconds + static_cast<int64_t>(static_cast<double>(static_cast<int64_t>(difference)) * m_NanosecondsPerTick);
+}
+
+void VulkanGpuProfiler::RecordReset(VkCommandBuffer cmdBuffer)
+{
+    if (m_CurrentFrame == InvalidScope || !m_Frames[m_CurrentFrame].ResetPending)
+        return;
+
+    FrameQueries& frame = m_Frames[m_CurrentFrame];
+    if (frame.TimestampPool != VK_NULL_HANDLE)
+        vkCmdResetQueryPool(cmdBuffer, frame.TimestampPool, 0, MaxScopesPerFrame * 2);
+    for (VkQueryPool pool : frame.StatisticsPools)
+    {
+        if (pool != VK_NULL_HANDLE)
+            vkCmdResetQueryPool(cmdBuffer, pool, 0, MaxScopesPerFrame);
+    }
+    frame.ResetPending = false;
+}
+
+void VulkanGpuProfiler::Flush()
+{
+    for (FrameQueries& frame : m_Frames)
+    {
+        Resolve(frame);
+        frame.ResetPending = true;
+    }
+    m_CurrentFrame = InvalidScope;
+}
+
+void VulkanGpuProfiler::ClearSamples()
+{
+    for (Scope& scope : m_Scopes)
+    {
+        scope.Milliseconds.clear();
+        scope.PipelineStatistics.clear();
+        scope.NextSample = 0;
+        scope.LastMilliseconds = 0.0;
+    }
+    m_TraceEvents.clear();
+}
+
+uint32_t VulkanGpuProfiler::FindOrAddScope(std::string_view name, QueueType queue, uint32_t depth)
+{
+    // A frame has a handful of scopes, so a linear search beats hashing the name.
+    for (uint32_t i = 0; i < m_Scopes.size(); i++)
+    {
+        if (m_Scopes[i].Queue == queue && m_Scopes[i].Name == name)
+            return i;
+    }
+
+    Scope scope;
+    scope.Name = std::string(name);
+    scope.Queue = queue;
+    scope.Depth = depth;
+    m_Scopes.push_back(std::move(scope));
+    return static_cast<uint32_t>(m_Scopes.size() - 1);
+}
+
+uint32_t VulkanGpuProfiler::BeginScope(VkCommandBuffer cmdBuffer, QueueType queue, std::string_view name)
+{
+    if (m_CurrentFrame == InvalidScope)
+        return InvalidScope;
+
+    FrameQueries& frame = m_Frames[m_CurrentFrame];
+    if (frame.ResetPending || frame.Markers.size() >= MaxScopesPerFrame)
+        return InvalidScope;
+
+    const size_t queueIndex = static_cast<size_t>(queue);
+    const uint32_t depth = m_OpenScopes[queueIndex]++;
+
+    Marker marker{};
+    marker.ScopeIndex = FindOrAddScope(name, queue, depth);
+    marker.Queue = queue;
+    marker.TimestampQuery = InvalidScope;
+    marker.StatisticsQuery = InvalidScope;
+
+    // Only one statistics query may be active per command buffer, so nested scopes are timed only.
+    if (depth == 0 && frame.StatisticsPools[queueIndex] != VK_NULL_HANDLE)
+    {
+        marker.StatisticsQuery = frame.StatisticsCounts[queueIndex]++;
+        vkCmdBeginQuery(cmdBuffer, frame.StatisticsPools[queueIndex], marker.StatisticsQuery, 0);
+    }
+
+    if (m_TimestampMasks[queueIndex] != 0)
+    {
+        marker.TimestampQuery = frame.TimestampCount;
+        frame.TimestampCount += 2;
+        vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.TimestampPool, marker.TimestampQuery);
+    }
+
+    frame.Markers.push_back(marker);
+    return static_cast<uint32_t>(frame.Markers.size() - 1);
+}
+
+void VulkanGpuProfiler::EndScope(VkCommandBuffer cmdBuffer, uint32_t marker)
+{
+    if (marker == InvalidScope || m_CurrentFrame == InvalidScope)
+        return;
+
+    FrameQueries& frame = m_Frames[m_CurrentFrame];
+    Marker& scopeMarker = frame.Markers[marker];
+    assert(!scopeMarker.Ended && "GPU profiler scope ended twice");
+
+    const size_t queueIndex = static_cast<size_t>(scopeMarker.Queue);
+    if (scopeMarker.TimestampQuery != InvalidScope)
+        vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.TimestampPool, scopeMarker.TimestampQuery + 1);
+    if (scopeMarker.StatisticsQuery != InvalidScope)
+        vkCmdEndQuery(cmdBuffer, frame.StatisticsPools[queueIndex], scopeMarker.StatisticsQuery);
+
+    scopeMarker.Ended = true;
+    m_OpenScopes[queueIndex]--;
+}
+
+void VulkanGpuProfiler::ReadResults(VkQueryPool pool, uint32_t count, uint32_t valuesPerQuery, std::vector<uint64_t>& outValues)
+{
+    const uint32_t stride = valuesPerQuery + 1;
+    outValues.assign(static_cast<size_t>(count) * stride, 0);
+    if (count == 0)
+        return;
+
+    // No WAIT_BIT: the slot's fence has signalled, and a query that is somehow not ready is dropped instead
+    // of stalling the frame.
+    VkResult result = vkGetQueryPoolResults(
+            m_DeviceRef.GetDevice(),
+            pool,
+            0,
+            count,
+            outValues.size() * sizeof(uint64_t),
+            outValues.data(),
+            stride * sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (result != VK_SUCCESS && result != VK_NOT_READY)
+        throw std::runtime_error("Failed to read GPU profiler queries!");
+}
+
+void VulkanGpuProfiler::Resolve(FrameQueries& frame)
+{
+    if (frame.Markers.empty())
+        return;
+
+    ReadResults(frame.TimestampPool, frame.TimestampCount, 1, m_TimestampResults);
+    for (size_t queue = 0; queue < frame.StatisticsPools.size(); queue++)
+    {
+        if (frame.StatisticsPools[queue] != VK_NULL_HANDLE)
+            ReadResults(frame.StatisticsPools[queue], frame.StatisticsCounts[queue], std::popcount(m_StatisticsFlags[queue]), m_StatisticsResults[queue]);
+    }
+
+    for (const Marker& marker : frame.Markers)
+    {
+        if (!marker.Ended || marker.TimestampQuery == InvalidScope)
+            continue;
+
+        const uint64_t* begin = &m_TimestampResults[marker.TimestampQuery * 2];
+        const uint64_t* end = begin + 2;
+        if (begin[1] == 0 || end[1] == 0)
+            continue;
+
+        const size_t queueIndex = static_cast<size_t>(marker.Queue);
+        const uint64_t mask = m_TimestampMasks[queueIndex];
+
+        const double durationNanoseconds = static_cast<double>((end[0] - begin[0]) & mask) * m_NanosecondsPerTick;
+
+        GpuPipelineStatistics statistics{};
+        bool hasStatistics = false;
+        if (marker.StatisticsQuery != InvalidScope)
+        {
+            const VkQueryPipelineStatisticFlags flags = m_StatisticsFlags[queueIndex];
+            const uint32_t valueCount = std::popcount(flags);
+            const uint64_t* values = &m_StatisticsResults[queueIndex][marker.StatisticsQuery * (valueCount + 1)];
+            if (values[valueCount] != 0)
+            {
+                // Results only hold the enabled statistics, packed in bit order.
+                uint32_t valueIndex = 0;
+                for (size_t i = 0; i < PipelineStatisticBits.size(); i++)
+                {
+                    if (flags & PipelineStatisticBits[i])
+                        statistics[i] = values[valueIndex++];
+                }
+                hasStatistics = true;
+            }
+        }
+
+        AddSample(marker.ScopeIndex, durationNanoseconds * 1e-6, hasStatistics ? &statistics : nullptr);
+
+        GpuTraceEvent event{};
+        event.ScopeIndex = marker.ScopeIndex;
+        event.FrameNumber = frame.FrameNumber;
+        event.StartNanoseconds = ToHostNanoseconds(begin[0], mask);
+        event.DurationNanoseconds = durationNanoseconds;
+        m_TraceEvents.push_back(event);
+        if (m_TraceEvents.size() > MaxTraceEvents)
+            m_TraceEvents.pop_front();
+    }
+
+    frame.Markers.clear();
+    frame.TimestampCount = 0;
+    frame.StatisticsCounts = {};
+}
+
+void VulkanGpuProfiler::AddSample(uint32_t scopeIndex, double milliseconds, const GpuPipelineStatistics* pipelineStatistics)
+{
+    Scope& scope = m_Scopes[scopeIndex];
+    if (scope.Milliseconds.size() < SampleWindow)
+    {
+        scope.Milliseconds.push_back(milliseconds);
+        scope.PipelineStatistics.push_back(pipelineStatistics ? *pipelineStatistics : GpuPipelineStatistics{});
+    }
+    else
+    {
+        scope.Milliseconds[scope.NextSample] = milliseconds;
+        scope.PipelineStatistics[scope.NextSample] = pipelineStatistics ? *pipelineStatistics : GpuPipelineStatistics{};
+    }
+    scope.NextSample = (scope.NextSample + 1) % SampleWindow;
+    scope.LastMilliseconds = milliseconds;
+    scope.HasPipelineStatistics = scope.HasPipelineStatistics || pipelineStatistics != nullptr;
+}
+
+std::vector<GpuScopeStatistics> VulkanGpuProfiler::GetStatistics() const
+{
+    std::vector<GpuScopeStatistics> result;
+    result.reserve(m_Scopes.size());
+
+    std::vector<double> sorted;
+    for (const Scope& scope : m_Scopes)
+    {
+        if (scope.Milliseconds.empty())
+            continue;
+
+        GpuScopeStatistics statistics;
+        statistics.Name = scope.Name;
+        statistics.Queue = scope.Queue;
+        statistics.Depth = scope.Depth;
+        statistics.SampleCount = static_cast<uint32_t>(scope.Milliseconds.size());
+        statistics.LastMilliseconds = scope.LastMilliseconds;
+
+        sorted.assign(scope.Milliseconds.begin(), scope.Milliseconds.end());
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (double sample : sorted)
+            sum += sample;
+
+        // Nearest rank, so a window of fewer than 100 samples reports its maximum.
+        const size_t p99Rank = static_cast<size_t>(std::ceil(0.99 * static_cast<double>(sorted.size())));
+        statistics.MinMilliseconds = sorted.front();
+        statistics.AvgMilliseconds = sum / static_cast<double>(sorted.size());
+        statistics.P99Milliseconds = sorted[std::max<size_t>(p99Rank, 1) - 1];
+
+        statistics.HasPipelineStatistics = scope.HasPipelineStatistics;
+        if (scope.HasPipelineStatistics)
+        {
+            for (const GpuPipelineStatistics& sample : scope.PipelineStatistics)
+            {
+                for (size_t i = 0; i < sample.size(); i++)
+                    statistics.AvgPipelineStatistics[i] += static_cast<double>(sample[i]);
+            }
+            for (double& value : statistics.AvgPipelineStatistics)
+                value /= static_cast<double>(scope.PipelineStatistics.size());
+        }
+
+        result.push_back(std::move(statistics));
+    }
+    return result;
+}
+
+void VulkanGpuProfiler::WriteJson(std::ostream& out) const
+{
+    const std::vector<GpuScopeStatistics> statistics = GetStatistics();
+
+    out << std::fixed << std::setprecision(4);
+    out << "{\n  \"device\": ";
+    WriteJsonString(out, m_DeviceRef.PhysicalDeviceProperties.deviceName);
+    out << ",\n  \"timestampPeriodNs\": " << m_NanosecondsPerTick;
+    out << ",\n  \"sampleWindow\": " << SampleWindow;
+    out << ",\n  \"scopes\": [";
+
+    for (size_t i = 0; i < statistics.size(); i++)
+    {
+        const GpuScopeStatistics& scope = statistics[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+        WriteJsonString(out, scope.Name);
+        out << ", \"queue\": \"" << GetQueueName(scope.Queue) << "\""
+            << ", \"depth\": " << scope.Depth
+            << ", \"samples\": " << scope.SampleCount
+            << ", \"minMs\": " << scope.MinMilliseconds
+            << ", \"avgMs\": " << scope.AvgMilliseconds
+            << ", \"p99Ms\": " << scope.P99Milliseconds
+            << ", \"lastMs\": " << scope.LastMilliseconds;
+
+        if (scope.HasPipelineStatistics)
+        {
+            out << ", \"pipelineStatistics\": {";
+            for (size_t s = 0; s < scope.AvgPipelineStatistics.size(); s++)
+            {
+                out << (s == 0 ? "" : ", ") << "\"" << GetPipelineStatisticName(static_cast<GpuPipelineStatistic>(s)) << "\": "
+                    << std::setprecision(1) << scope.AvgPipelineStatistics[s] << std::setprecision(4);
+            }
+            out << "}";
+        }
+        out << "}";
+    }
+
+    out << "\n  ]\n}\n";
+}
+
+void VulkanGpuProfiler::WriteChromeTrace(std::ostream& out, bool includeCpuZones) const
+{
+    std::vector<ProfilerZoneEvent> cpuZones;
+    if (includeCpuZones)
+        cpuZones = Profiler::CollectZones();
+
+    // Both timelines are in steady_clock nanoseconds; start the trace at whichever began first.
+    int64_t origin = std::numeric_limits<int64_t>::max();
+    for (const ProfilerZoneEvent& zone : cpuZones)
+        origin = std::min(origin, zone.StartNanoseconds);
+    for (const GpuTraceEvent& event : m_TraceEvents)
+        origin = std::min(origin, event.StartNanoseconds);
+    if (origin == std::numeric_limits<int64_t>::max())
+        origin = 0;
+
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    if (includeCpuZones)
+    {
+        Profiler::WriteChromeTraceEvents(out, cpuZones, origin);
+        out << ",\n";
+    }
+
+    out << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"GPU\"}}";
+    for (QueueType queue : { QueueType::Graphics, QueueType::Compute, QueueType::Transfer })
+    {
+        out << ",\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << static_cast<int>(queue)
+            << ", \"args\": {\"name\": \"" << GetQueueName(queue) << " queue\"}}";
+    }
+
+    out << std::fixed << std::setprecision(3);
+    for (const GpuTraceEvent& event : m_TraceEvents)
+    {
+        const Scope& scope = m_Scopes[event.ScopeIndex];
+        out << ",\n  {\"name\": ";
+        WriteJsonString(out, scope.Name);
+        out << ", \"cat\": \"gpu\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << static_cast<int>(scope.Queue)
+            << ", \"ts\": " << static_cast<double>(event.StartNanoseconds - origin) * 1e-3
+            << ", \"dur\": " << event.DurationNanoseconds * 1e-3
+            << ", \"args\": {\"frame\": " << event.FrameNumber << "}}";
+    }
+
+    out << "\n]}\n";
+}
+
+const char* VulkanGpuProfiler::GetQueueName(QueueType queue)
+{
+    switch (queue)
+    {
+        case QueueType::Graphics: return "graphics";
+        case QueueType::Compute: return "compute";
+        case QueueType::Transfer: return "transfer";
+    }
+    return "unknown";
+}
+
+const char* VulkanGpuProfiler::GetPipelineStatisticName(GpuPipelineStatistic statistic)
+{
+    switch (statistic)
+    {
+        case GpuPipelineStatistic::InputAssemblyVertices: return "inputAssemblyVertices";
+        case GpuPipelineStatistic::VertexShaderInvocations: return "vertexShaderInvocations";
+        case GpuPipelineStatistic::ClippingInvocations: return "clippingInvocations";
+        case GpuPipelineStatistic::ClippingPrimitives: return "clippingPrimitives";
+        case GpuPipelineStatistic::FragmentShaderInvocations: return "fragmentShaderInvocations";
+        case GpuPipelineStatistic::ComputeShaderInvocations: return "computeShaderInvocations";
+        case GpuPipelineStatistic::Count: break;
+    }
+    return "unknown";
+}
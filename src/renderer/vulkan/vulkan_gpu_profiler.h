@@ -0,0 +1,186 @@
+#pragma once
+
+#include "renderer/vulkan/vulkan_device.h"
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Pipeline statistics the profiler collects, in the bit order Vulkan returns them. Queues without graphics
+// support only count compute invocations.
+enum class GpuPipelineStatistic
+{
+    InputAssemblyVertices,
+    VertexShaderInvocations,
+    ClippingInvocations,
+    ClippingPrimitives,
+    FragmentShaderInvocations,
+    ComputeShaderInvocations,
+    Count
+};
+
+using GpuPipelineStatistics = std::array<uint64_t, static_cast<size_t>(GpuPipelineStatistic::Count)>;
+
+// Rolling figures for one named scope over the last VulkanGpuProfiler::SampleWindow frames that recorded it.
+struct GpuScopeStatistics
+{
+    std::string Name;
+    QueueType Queue = QueueType::Graphics;
+    uint32_t Depth = 0;
+    uint32_t SampleCount = 0;
+    double MinMilliseconds = 0.0;
+    double AvgMilliseconds = 0.0;
+    double P99Milliseconds = 0.0;
+    double LastMilliseconds = 0.0;
+    // Averaged over the same window. Only outermost scopes have them: statistics queries cannot nest.
+    bool HasPipelineStatistics = false;
+    std::array<double, static_cast<size_t>(GpuPipelineStatistic::Count)> AvgPipelineStatistics{};
+};
+
+// One resolved scope. The start is in steady_clock nanoseconds, the CPU profiler's time base.
+struct GpuTraceEvent
+{
+    uint32_t ScopeIndex;
+    uint64_t FrameNumber;
+    int64_t StartNanoseconds;
+    double DurationNanoseconds;
+};
+
+// Times named scopes of the frame's command buffers with timestamp queries and, for outermost scopes, counts
+// their pipeline statistics. Every frame in flight has its own query pools; BeginFrame reads back what the
+// slot recorded last time, once its fence has signalled, so results arrive MAX_FRAMES_IN_FLIGHT frames late
+// but nothing ever waits on the GPU. Queues whose family reports no timestamp bits are skipped, and the
+// pools are recycled with host query reset when the device has it, which keeps this usable on lavapipe.
+//
+// Timestamps are mapped onto steady_clock so the trace lines up with the CPU profiler's zones. With
+// VK_EXT_calibrated_timestamps the mapping is refreshed every CalibrationInterval frames; without it, one
+// timestamp is submitted at startup and pinned to the midpoint of the submit and the wait, which is only
+// accurate to that round trip.
+class VulkanGpuProfiler
+{
+public:
+    static constexpr uint32_t MaxScopesPerFrame = 64;
+    static constexpr uint32_t SampleWindow = 256;
+    static constexpr size_t MaxTraceEvents = 1 << 16;
+    static constexpr uint32_t InvalidScope = ~0u;
+    static constexpr uint64_t CalibrationInterval = 256;
+
+    VulkanGpuProfiler(VulkanDevice& deviceRef, uint32_t frameCount);
+    ~VulkanGpuProfiler();
+
+    VulkanGpuProfiler(const VulkanGpuProfiler&) = delete;
+    VulkanGpuProfiler& operator=(const VulkanGpuProfiler&) = delete;
+
+    // Call once the frame slot's previous submission has completed.
+    void BeginFrame(uint32_t frameIndex, uint64_t frameNumber);
+    // Resets the current slot's queries when the device has no host query reset. Record it at the start of
+    // the frame's first submitted command buffer, outside a render pass; until then scopes are dropped.
+    void RecordReset(VkCommandBuffer cmdBuffer);
+    // Reads back every slot. Only call while the device is idle, e.g. before exporting.
+    void Flush();
+    // Drops every scope's samples and the trace, e.g. between benchmark runs. Call after Flush.
+    void ClearSamples();
+
+    // Scopes on one queue nest; the returned marker is passed back to EndScope.
+    uint32_t BeginScope(VkCommandBuffer cmdBuffer, QueueType queue, std::string_view name);
+    void EndScope(VkCommandBuffer cmdBuffer, uint32_t marker);
+
+    [[nodiscard]] std::vector<GpuScopeStatistics> GetStatistics() const;
+    [[nodiscard]] const std::deque<GpuTraceEvent>& GetTraceEvents() const { return m_TraceEvents; }
+    [[nodiscard]] const std::string& GetScopeName(uint32_t scopeIndex) const { return m_Scopes[scopeIndex].Name; }
+    [[nodiscard]] QueueType GetScopeQueue(uint32_t scopeIndex) const { return m_Scopes[scopeIndex].Queue; }
+    [[nodiscard]] uint32_t GetScopeDepth(uint32_t scopeIndex) const { return m_Scopes[scopeIndex].Depth; }
+
+    void WriteJson(std::ostream& out) const;
+    // Chrome trace event format, one track per queue, merged with the CPU profiler's zones unless asked not
+    // to; load it in chrome://tracing or Perfetto.
+    void WriteChromeTrace(std::ostream& out, bool includeCpuZones = true) const;
+
+    static const char* GetQueueName(QueueType queue);
+    static const char* GetPipelineStatisticName(GpuPipelineStatistic statistic);
+
+private:
+    struct Scope
+    {
+        std::string Name;
+        QueueType Queue;
+        uint32_t Depth;
+        bool HasPipelineStatistics = false;
+        // Rings of the last SampleWindow samples, oldest overwritten first.
+        std::vector<double> Milliseconds;
+        std::vector<GpuPipelineStatistics> PipelineStatistics;
+        uint32_t NextSample = 0;
+        double LastMilliseconds = 0.0;
+    };
+
+    struct Marker
+    {
+        uint32_t ScopeIndex;
+        QueueType Queue;
+        uint32_t TimestampQuery;        // Begin query; the end query follows it. InvalidScope without timestamps
+        uint32_t StatisticsQuery;       // Into the queue's statistics pool, or InvalidScope
+        bool Ended = false;
+    };
+
+    struct FrameQueries
+    {
+        VkQueryPool TimestampPool = VK_NULL_HANDLE;
+        std::array<VkQueryPool, 3> StatisticsPools{};
+        uint32_t TimestampCount = 0;
+        std::array<uint32_t, 3> StatisticsCounts{};
+        std::vector<Marker> Markers;
+        uint64_t FrameNumber = 0;
+        bool ResetPending = true;
+    };
+
+    uint32_t FindOrAddScope(std::string_view name, QueueType queue, uint32_t depth);
+    void Calibrate();
+    void CalibrateWithSubmit();
+    [[nodiscard]] int64_t ToHostNanoseconds(uint64_t ticks, uint64_t mask) const;
+    void ResetQueries(FrameQueries& frame);
+    void Resolve(FrameQueries& frame);
+    // count queries of valuesPerQuery values each, followed by a non-zero word when the query is available.
+    void ReadResults(VkQueryPool pool, uint32_t count, uint32_t valuesPerQuery, std::vector<uint64_t>& outValues);
+    void AddSample(uint32_t scopeIndex, double milliseconds, const GpuPipelineStatistics* pipelineStatistics);
+
+private:
+    VulkanDevice& m_DeviceRef;
+    std::vector<FrameQueries> m_Frames;
+    uint32_t m_CurrentFrame = InvalidScope;
+
+    // Per queue type: mask of valid timestamp bits (0 when unsupported) and the statistics the family can count.
+    std::array<uint64_t, 3> m_TimestampMasks{};
+    std::array<VkQueryPipelineStatisticFlags, 3> m_StatisticsFlags{};
+    std::array<uint32_t, 3> m_OpenScopes{};
+    double m_NanosecondsPerTick = 1.0;
+
+    std::vector<Scope> m_Scopes;
+    std::deque<GpuTraceEvent> m_TraceEvents;
+    // A device timestamp and the steady_clock time it was taken at.
+    uint64_t m_CalibrationTicks = 0;
+    int64_t m_CalibrationNanoseconds = 0;
+    std::vector<uint64_t> m_TimestampResults;
+    std::array<std::vector<uint64_t>, 3> m_StatisticsResults;
+};
+
+// Brackets the commands recorded during its lifetime with a profiler scope.
+class ScopedGpuMarker
+{
+public:
+    ScopedGpuMarker(VulkanGpuProfiler& profiler, VkCommandBuffer cmdBuffer, QueueType queue, std::string_view name)
+        : m_Profiler(profiler), m_CmdBuffer(cmdBuffer), m_Marker(profiler.BeginScope(cmdBuffer, queue, name)) {}
+    ~ScopedGpuMarker() { m_Profiler.EndScope(m_CmdBuffer, m_Marker); }
+
+    ScopedGpuMarker(const ScopedGpuMarker&) = delete;
+    ScopedGpuMarker& operator=(const ScopedGpuMarker&) = delete;
+
+private:
+    VulkanGpuProfiler& m_Profiler;
+    VkCommandBuffer m_CmdBuffer;
+    uint32_t m_Marker;
+};
@@ -1,5 +1,6 @@
 #include "vulkan_graphics_pipeline.h"
-#include "core/engine_utils.h"
+#include "core/mapped_file.h"
+#include "core/profiler.h"
 
 #include <stdexcept>
 #include <fstream>
@@ -27,14 +28,16 @@ void VulkanGraphicsPipeline::CreateGraphicsPipeline(const std::string& vertFilep
                                                     const std::string& fragFilepath,
                                                     const PipelineConfigInfo& configInfo)
 {
+    PROFILE_ZONE("CreateGraphicsPipeline");
     assert(configInfo.PipelineLayout != VK_NULL_HANDLE && "Cannot create graphics pipeline: no pipelineLayout provided in configInfo");
     assert(configInfo.RenderPass != VK_NULL_HANDLE && "Cannot create graphics pipeline: no renderPass provided in configInfo");
 
-    auto vertCode = EngineUtils::ReadFile(vertFilepath);
-    auto fragCode = EngineUtils::ReadFile(fragFilepath);
+    // vkCreateShaderModule copies the code, so the mappings only have to live until it returns.
+    MappedFile vertCode(vertFilepath);
+    MappedFile fragCode(fragFilepath);
 
-    CreateShaderModule(vertCode, &m_VertShaderModule);
-    CreateShaderModule(fragCode, &m_FragShaderModule);
+    CreateShaderModule(vertCode.GetSpan(), &m_VertShaderModule);
+    CreateShaderModule(fragCode.GetSpan(), &m_FragShaderModule);
 
     VkPipelineShaderStageCreateInfo shaderStages[2];
 
@@ -99,7 +102,7 @@ void VulkanGraphicsPipeline::CreateGraphicsPipeline(const std::string& vertFilep
     }
 }
 
-void VulkanGraphicsPipeline::CreateShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule)
+void VulkanGraphicsPipeline::CreateShaderModule(std::span<const uint8_t> code, VkShaderModule* shaderModule)
 {
     VkShaderModuleCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -3,6 +3,9 @@
 #include <vulkan/vulkan.h>
 #include "vulkan_device.h"
 
+#include <cstdint>
+#include <span>
+
 class VulkanGraphicsPipeline
 {
 public:
@@ -52,7 +55,7 @@ private:
                                 const std::string& fragFilepath,
                                 const PipelineConfigInfo& configInfo);
 
-    void CreateShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule);
+    void CreateShaderModule(std::span<const uint8_t> code, VkShaderModule* shaderModule);
 
 private:
     VulkanDevice& m_DeviceRef;
@@ -1,6 +1,8 @@
 #include "vulkan_image.h"
 #include "vulkan_utils.h"
+#include "vulkan_barrier.h"
 
+#include <iostream>
 #include <utility>
 
 VulkanImage2D::VulkanImage2D(VulkanDevice& deviceRef, ImageSpecification specification)
@@ -20,7 +22,6 @@ void VulkanImage2D::Release()
         return;
 
     vkDestroyImageView(m_DeviceRef.GetDevice(), m_Info.ImageView, nullptr);
-    vkDestroySampler(m_DeviceRef.GetDevice(), m_Info.Sampler, nullptr);
 
     for(auto& view: m_MipImageViews)
     {
@@ -43,8 +44,8 @@ void VulkanImage2D::Release()
 
     m_Info.Image = nullptr;
     m_Info.ImageView = nullptr;
-    if (m_Specification.CreateSampler)
-        m_Info.Sampler = nullptr;
+    // Samplers belong to the device's cache.
+    m_Info.Sampler = nullptr;
     m_LayerImageViews.clear();
     m_MipImageViews.clear();
 }
@@ -91,27 +92,20 @@ void VulkanImage2D::Invalidate()
     imageCreateInfo.tiling = m_Specification.Usage == ImageUsage::HostRead ? VK_IMAGE_TILING_LINEAR : VK_IMAGE_TILING_OPTIMAL;
     imageCreateInfo.usage = usage;
 
-    if(m_Specification.Usage == ImageUsage::Storage)
-    {
-        QueueFamilyIndices indices = m_DeviceRef.FindQueueFamilies(m_DeviceRef.GetPhysicalDevice());
+    // Storage images are written on the compute queue and sampled on the graphics queue, and textures
+    // are uploaded on the transfer queue, so both are shared across those families unless the owner
+    // moves them between queues itself.
+    std::vector<uint32_t> sharedQueueFamilies;
+    if (m_Specification.Usage == ImageUsage::Storage && !m_Specification.ExclusiveQueueOwnership)
+        sharedQueueFamilies = m_DeviceRef.GetUniqueQueueFamilyIndices({ QueueType::Graphics, QueueType::Compute });
+    else if (m_Specification.Usage == ImageUsage::Texture && !m_Specification.ExclusiveQueueOwnership)
+        sharedQueueFamilies = m_DeviceRef.GetUniqueQueueFamilyIndices({ QueueType::Graphics, QueueType::Compute, QueueType::Transfer });
 
-        bool hasComputeAndGraphicsQueues = indices.ComputeFamily.has_value() && indices.GraphicsFamily.has_value();
-        if(hasComputeAndGraphicsQueues)
-        {
-            bool areDifferent = indices.GraphicsFamily.value() != indices.ComputeFamily.value();
-            if(areDifferent)
-            {
-                std::vector<uint32_t> queueFamilyIndices =
-                {
-                    indices.GraphicsFamily.value(),
-                    indices.ComputeFamily.value()
-                };
-
-                imageCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
-                imageCreateInfo.queueFamilyIndexCount = 2;
-                imageCreateInfo.pQueueFamilyIndices = queueFamilyIndices.data();
-            }
-        }
+    if (sharedQueueFamilies.size() > 1)
+    {
+        imageCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        imageCreateInfo.queueFamilyIndexCount = static_cast<uint32_t>(sharedQueueFamilies.size());
+        imageCreateInfo.pQueueFamilyIndices = sharedQueueFamilies.data();
     }
 
     m_DeviceRef.CreateImageWithInfo(
@@ -159,15 +153,16 @@ void VulkanImage2D::Invalidate()
         samplerCreateInfo.addressModeW = samplerCreateInfo.addressModeU;
         samplerCreateInfo.mipLodBias = 0.0f;
         samplerCreateInfo.minLod = 0.0f;
-        samplerCreateInfo.maxLod = 100.0f;
+        samplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
         samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
-        VK_CHECK_RESULT(vkCreateSampler(m_DeviceRef.GetDevice(), &samplerCreateInfo, nullptr, &m_Info.Sampler));
+        m_Info.Sampler = m_DeviceRef.GetSampler(samplerCreateInfo);
     }
 
     if (m_Specification.Usage == ImageUsage::Storage)
     {
-        // Transition image to GENERAL layout
-        VkCommandBuffer commandBuffer = m_DeviceRef.BeginSingleTimeCommands();
+        // Transition image to GENERAL layout. Exclusively owned storage images start out on the compute queue that writes them.
+        QueueType queueType = m_Specification.ExclusiveQueueOwnership ? QueueType::Compute : QueueType::Graphics;
+        VkCommandBuffer commandBuffer = m_DeviceRef.BeginSingleTimeCommands(queueType);
 
         VkImageSubresourceRange subresourceRange = {};
         subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -175,13 +170,11 @@ void VulkanImage2D::Invalidate()
         subresourceRange.levelCount = m_Specification.Mips;
         subresourceRange.layerCount = m_Specification.Layers;
 
-        ImageUtils::InsertImageMemoryBarrier(commandBuffer, m_Info.Image,
-                                        0, 0,
-                                        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
-                                        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                                        subresourceRange);
+        VulkanBarrierBuilder(m_DeviceRef)
+                .Image(m_Info.Image, subresourceRange, { ResourceAccess::None }, { ResourceAccess::ComputeShaderStorageReadWrite })
+                .Record(commandBuffer);
 
-        m_DeviceRef.EndSingleTimeCommand(commandBuffer);
+        m_DeviceRef.EndSingleTimeCommand(commandBuffer, queueType);
     }
     else if (m_Specification.Usage == ImageUsage::HostRead)
     {
@@ -194,11 +187,9 @@ void VulkanImage2D::Invalidate()
         subresourceRange.levelCount = m_Specification.Mips;
         subresourceRange.layerCount = m_Specification.Layers;
 
-        ImageUtils::InsertImageMemoryBarrier(commandBuffer, m_Info.Image,
-                                        0, 0,
-                                        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                                        subresourceRange);
+        VulkanBarrierBuilder(m_DeviceRef)
+                .Image(m_Info.Image, subresourceRange, { ResourceAccess::None }, { ResourceAccess::CopyWrite })
+                .Record(commandBuffer);
 
         m_DeviceRef.EndSingleTimeCommand(commandBuffer);
     }
@@ -306,6 +297,52 @@ void VulkanImageView::Invalidate()
 
 namespace ImageUtils
 {
+    // Stages that use an image in the given layout, for barriers that do not name them.
+    static VkPipelineStageFlags GetLayoutStageMask(VkImageLayout layout, bool source)
+    {
+        switch (layout)
+        {
+            case VK_IMAGE_LAYOUT_UNDEFINED:
+                return source ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+            case VK_IMAGE_LAYOUT_PREINITIALIZED:
+                return VK_PIPELINE_STAGE_HOST_BIT;
+            case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+            case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+                return VK_PIPELINE_STAGE_TRANSFER_BIT;
+            case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+                return VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+            case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
+                return VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+                return VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+            case VK_IMAGE_LAYOUT_GENERAL:
+                return VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+                return source ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+            default:
+                // A full stall is what CheckBarrier reports as over-broad, so new layouts need their own stages.
+                assert(false && "Image layout has no stage mask; add one");
+                return VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        }
+    }
+
+    static void CheckBarrier(
+            VkPipelineStageFlags srcStageMask, VkAccessFlags srcAccessMask,
+            VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask)
+    {
+#ifndef NDEBUG
+        const char* problem = nullptr;
+        if (!VulkanBarrierBuilder::CheckMasks(srcStageMask, srcAccessMask, dstStageMask, dstAccessMask, &problem))
+            std::cerr << "Over-broad image barrier: " << problem << "\n";
+#else
+        (void) srcStageMask;
+        (void) srcAccessMask;
+        (void) dstStageMask;
+        (void) dstAccessMask;
+#endif
+    }
+
     void SetImageLayout(
             VkCommandBuffer cmdbuffer,
             VkImage image,
@@ -425,7 +462,7 @@ namespace ImageUtils
             case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
                 // Image will be read in a shader (sampler, input attachment)
                 // Make sure any writes to the image have been finished
-                if (imageMemoryBarrier.srcAccessMask == 0)
+                if (imageMemoryBarrier.srcAccessMask == 0 && oldImageLayout != VK_IMAGE_LAYOUT_UNDEFINED)
                 {
                     imageMemoryBarrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
                 }
@@ -435,6 +472,16 @@ namespace ImageUtils
                 break;
         }
 
+        // Reads never need to be made available, only waited on.
+        if (oldImageLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL || oldImageLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+            imageMemoryBarrier.srcAccessMask = 0;
+
+        if (srcStageMask == 0)
+            srcStageMask = GetLayoutStageMask(oldImageLayout, true);
+        if (dstStageMask == 0)
+            dstStageMask = GetLayoutStageMask(newImageLayout, false);
+        CheckBarrier(srcStageMask, imageMemoryBarrier.srcAccessMask, dstStageMask, imageMemoryBarrier.dstAccessMask);
+
         // Put barrier inside setup command buffer
         vkCmdPipelineBarrier(
                 cmdbuffer,
@@ -469,6 +516,7 @@ namespace ImageUtils
         imageMemoryBarrier.image = image;
         imageMemoryBarrier.subresourceRange = subresourceRange;
 
+        CheckBarrier(srcStageMask, srcAccessMask, dstStageMask, dstAccessMask);
         vkCmdPipelineBarrier(
                 cmdbuffer,
                 srcStageMask,
@@ -30,6 +30,15 @@ enum class ImageFormat
 
     SRGB,
 
+    // Block compressed, 4x4 texel blocks
+    BC1,        // RGB + 1-bit alpha, 8 bytes per block
+    BC1SRGB,
+    BC3,        // RGBA, 16 bytes per block
+    BC3SRGB,
+    BC5,        // Two channels (normal maps), 16 bytes per block
+    BC7,        // RGBA, 16 bytes per block
+    BC7SRGB,
+
     DEPTH32FSTENCIL8UINT,
     DEPTH32F,
     DEPTH24STENCIL8,
@@ -82,6 +91,8 @@ struct ImageSpecification
     uint32_t Mips = 1;
     uint32_t Layers = 1;
     bool CreateSampler = true;
+    // Skip concurrent sharing; the owner transfers the image between queue families explicitly.
+    bool ExclusiveQueueOwnership = false;
 };
 
 struct VulkanImageInfo
@@ -114,13 +125,13 @@ public:
     [[nodiscard]] VkDescriptorImageInfo& GetDescriptorInfo() { return m_DescriptorImageInfo; }
 
     ImageSpecification& GetSpecification() { return m_Specification; }
-    [[nodiscard]] Buffer GetBuffer() const { return m_ImageData; }
+    [[nodiscard]] BufferView GetBuffer() const { return m_ImageData; }
     Buffer& GetBuffer() { return m_ImageData; }
 private:
 
     VulkanDevice& m_DeviceRef;
     ImageSpecification m_Specification;
-    BufferSafe m_ImageData;
+    Buffer m_ImageData;
 
     std::vector<VkImageView> m_LayerImageViews;
     std::map<uint32_t, VkImageView> m_MipImageViews;
@@ -146,7 +157,31 @@ namespace ImageUtils
             case ImageFormat::RGBA32F: return 4 * 4;
             case ImageFormat::B10R11G11UF: return 4;
         }
-        assert(false);
+        assert(false && "No per-texel size; use GetImageMemorySize for block-compressed formats");
+    }
+
+    inline bool IsBlockCompressed(ImageFormat format)
+    {
+        switch (format)
+        {
+            case ImageFormat::BC1:
+            case ImageFormat::BC1SRGB:
+            case ImageFormat::BC3:
+            case ImageFormat::BC3SRGB:
+            case ImageFormat::BC5:
+            case ImageFormat::BC7:
+            case ImageFormat::BC7SRGB:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Bytes per 4x4 block.
+    inline uint32_t GetBlockByteSize(ImageFormat format)
+    {
+        assert(IsBlockCompressed(format));
+        return format == ImageFormat::BC1 || format == ImageFormat::BC1SRGB ? 8 : 16;
     }
 
     inline bool IsIntegerBased(const ImageFormat format)
@@ -171,6 +206,13 @@ namespace ImageUtils
             case ImageFormat::RGB:
             case ImageFormat::SRGB:
             case ImageFormat::DEPTH24STENCIL8:
+            case ImageFormat::BC1:
+            case ImageFormat::BC1SRGB:
+            case ImageFormat::BC3:
+            case ImageFormat::BC3SRGB:
+            case ImageFormat::BC5:
+            case ImageFormat::BC7:
+            case ImageFormat::BC7SRGB:
                 return false;
         }
         assert(false);
@@ -192,6 +234,13 @@ namespace ImageUtils
             case ImageFormat::RGBA16F:				return VK_FORMAT_R16G16B16A16_SFLOAT;
             case ImageFormat::RGBA32F:				return VK_FORMAT_R32G32B32A32_SFLOAT;
             case ImageFormat::B10R11G11UF:			return VK_FORMAT_B10G11R11_UFLOAT_PACK32;
+            case ImageFormat::BC1:                  return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+            case ImageFormat::BC1SRGB:              return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+            case ImageFormat::BC3:                  return VK_FORMAT_BC3_UNORM_BLOCK;
+            case ImageFormat::BC3SRGB:              return VK_FORMAT_BC3_SRGB_BLOCK;
+            case ImageFormat::BC5:                  return VK_FORMAT_BC5_UNORM_BLOCK;
+            case ImageFormat::BC7:                  return VK_FORMAT_BC7_UNORM_BLOCK;
+            case ImageFormat::BC7SRGB:              return VK_FORMAT_BC7_SRGB_BLOCK;
             case ImageFormat::DEPTH32FSTENCIL8UINT: return VK_FORMAT_D32_SFLOAT_S8_UINT;
             case ImageFormat::DEPTH32F:				return VK_FORMAT_D32_SFLOAT;
             case ImageFormat::DEPTH24STENCIL8:		return VK_FORMAT_D32_SFLOAT;    // TODO:: Use device depth format.
@@ -207,6 +256,9 @@ namespace ImageUtils
 
     inline uint32_t GetImageMemorySize(ImageFormat format, uint32_t width, uint32_t height)
     {
+        if (IsBlockCompressed(format))
+            return ((width + 3) / 4) * ((height + 3) / 4) * GetBlockByteSize(format);
+
         return width * height * GetImageFormatBPP(format);
     }
 
@@ -229,14 +281,15 @@ namespace ImageUtils
             VkPipelineStageFlags dstStageMask,
             VkImageSubresourceRange subresourceRange);
 
+    // Zero stage masks are inferred from the layouts; VulkanBarrierBuilder infers exact ones from the accesses.
     void SetImageLayout(
             VkCommandBuffer cmdbuffer,
             VkImage image,
             VkImageLayout oldImageLayout,
             VkImageLayout newImageLayout,
             VkImageSubresourceRange subresourceRange,
-            VkPipelineStageFlags srcStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-            VkPipelineStageFlags dstStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+            VkPipelineStageFlags srcStageMask = 0,
+            VkPipelineStageFlags dstStageMask = 0);
 
     void SetImageLayout(
             VkCommandBuffer cmdbuffer,
@@ -244,8 +297,8 @@ namespace ImageUtils
             VkImageAspectFlags aspectMask,
             VkImageLayout oldImageLayout,
             VkImageLayout newImageLayout,
-            VkPipelineStageFlags srcStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-            VkPipelineStageFlags dstStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+            VkPipelineStageFlags srcStageMask = 0,
+            VkPipelineStageFlags dstStageMask = 0);
 }
 
 struct VulkanImageViewSpecification
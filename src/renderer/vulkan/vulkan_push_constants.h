@@ -0,0 +1,48 @@
+#pragma once
+
+#include "renderer/vulkan/vulkan_device.h"
+
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vulkan/vulkan.h>
+
+// Typed push-constant range. The block is validated against the device's
+// maxPushConstantsSize once, at construction, instead of failing at pipeline creation.
+template<typename T>
+class VulkanPushConstants
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Push constant blocks must be trivially copyable");
+    static_assert(sizeof(T) % 4 == 0, "Push constant block size must be a multiple of 4");
+
+public:
+    VulkanPushConstants(VulkanDevice& deviceRef, VkShaderStageFlags stageFlags, uint32_t offset = 0)
+        : m_StageFlags(stageFlags), m_Offset(offset)
+    {
+        const uint32_t maxSize = deviceRef.PhysicalDeviceProperties.limits.maxPushConstantsSize;
+        if (offset % 4 != 0 || offset + sizeof(T) > maxSize)
+        {
+            throw std::runtime_error(
+                    "Push constant block of " + std::to_string(sizeof(T)) + " bytes at offset " +
+                    std::to_string(offset) + " exceeds maxPushConstantsSize (" + std::to_string(maxSize) + ")!");
+        }
+    }
+
+    [[nodiscard]] VkPushConstantRange GetRange() const
+    {
+        return { m_StageFlags, m_Offset, static_cast<uint32_t>(sizeof(T)) };
+    }
+
+    void Push(VkCommandBuffer commandBuffer, VkPipelineLayout layout, const T& data) const
+    {
+        vkCmdPushConstants(commandBuffer, layout, m_StageFlags, m_Offset, sizeof(T), &data);
+    }
+
+    [[nodiscard]] VkShaderStageFlags GetStageFlags() const { return m_StageFlags; }
+    [[nodiscard]] uint32_t GetOffset() const { return m_Offset; }
+    [[nodiscard]] static constexpr uint32_t GetSize() { return sizeof(T); }
+
+private:
+    VkShaderStageFlags m_StageFlags;
+    uint32_t m_Offset;
+};
@@ -0,0 +1,166 @@
+#include "vulkan_queue_ownership.h"
+#include "vulkan_barrier.h"
+#include "vulkan_utils.h"
+
+VulkanQueueOwnershipTransfer::VulkanQueueOwnershipTransfer(
+        VulkanDevice& deviceRef,
+        QueueType srcQueueType,
+        VkPipelineStageFlags srcStageMask,
+        QueueType dstQueueType,
+        VkPipelineStageFlags dstStageMask)
+    : m_DeviceRef(deviceRef),
+      m_SrcQueueType(srcQueueType),
+      m_DstQueueType(dstQueueType),
+      m_SrcFamilyIndex(deviceRef.GetQueueFamilyIndex(srcQueueType)),
+      m_DstFamilyIndex(deviceRef.GetQueueFamilyIndex(dstQueueType)),
+      m_SrcStageMask(srcStageMask),
+      m_DstStageMask(dstStageMask)
+{
+    VkSemaphoreCreateInfo semaphoreCreateInfo{};
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    VK_CHECK_RESULT(vkCreateSemaphore(m_DeviceRef.GetDevice(), &semaphoreCreateInfo, nullptr, &m_Semaphore));
+}
+
+VulkanQueueOwnershipTransfer::~VulkanQueueOwnershipTransfer()
+{
+    vkDestroySemaphore(m_DeviceRef.GetDevice(), m_Semaphore, nullptr);
+}
+
+VulkanQueueOwnershipTransfer& VulkanQueueOwnershipTransfer::AddBuffer(
+        VkBuffer buffer,
+        VkAccessFlags srcAccessMask,
+        VkAccessFlags dstAccessMask,
+        VkDeviceSize offset,
+        VkDeviceSize size)
+{
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccessMask;
+    barrier.buffer = buffer;
+    barrier.offset = offset;
+    barrier.size = size;
+
+    m_Buffers.push_back({ barrier, dstAccessMask });
+    return *this;
+}
+
+VulkanQueueOwnershipTransfer& VulkanQueueOwnershipTransfer::AddImage(
+        VkImage image,
+        const VkImageSubresourceRange& subresourceRange,
+        VkImageLayout oldLayout,
+        VkImageLayout newLayout,
+        VkAccessFlags srcAccessMask,
+        VkAccessFlags dstAccessMask)
+{
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccessMask;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.image = image;
+    barrier.subresourceRange = subresourceRange;
+
+    m_Images.push_back({ barrier, dstAccessMask });
+    return *this;
+}
+
+void VulkanQueueOwnershipTransfer::Clear()
+{
+    m_Buffers.clear();
+    m_Images.clear();
+}
+
+void VulkanQueueOwnershipTransfer::RecordRelease(VkCommandBuffer cmdBuffer) const
+{
+    if (IsRequired())
+        RecordBarriers(cmdBuffer, m_SrcStageMask, VK_PIPELINE_STAGE_2_NONE, true);
+    else
+        RecordBarriers(cmdBuffer, m_SrcStageMask, m_DstStageMask, true);
+}
+
+void VulkanQueueOwnershipTransfer::RecordAcquire(VkCommandBuffer cmdBuffer) const
+{
+    if (IsRequired())
+        RecordBarriers(cmdBuffer, VK_PIPELINE_STAGE_2_NONE, m_DstStageMask, false);
+}
+
+void VulkanQueueOwnershipTransfer::RecordBarriers(
+        VkCommandBuffer cmdBuffer,
+        VkPipelineStageFlags2 srcStageMask,
+        VkPipelineStageFlags2 dstStageMask,
+        bool release) const
+{
+    if (m_Buffers.empty() && m_Images.empty())
+        return;
+
+    // The release makes the source writes available and the acquire makes them visible; each half
+    // leaves the other side's stage and access masks empty. Both halves repeat the same layout transition.
+    // Going through the barrier builder gets the masks checked in debug builds like every other barrier.
+    bool required = IsRequired();
+    uint32_t srcFamilyIndex = required ? m_SrcFamilyIndex : VK_QUEUE_FAMILY_IGNORED;
+    uint32_t dstFamilyIndex = required ? m_DstFamilyIndex : VK_QUEUE_FAMILY_IGNORED;
+
+    VulkanBarrierBuilder barriers(m_DeviceRef);
+    for (const BufferTransfer& transfer : m_Buffers)
+    {
+        VkBufferMemoryBarrier2 barrier{};
+        barrier.srcStageMask = srcStageMask;
+        barrier.srcAccessMask = release ? transfer.Barrier.srcAccessMask : 0;
+        barrier.dstStageMask = dstStageMask;
+        barrier.dstAccessMask = release && required ? 0 : transfer.DstAccessMask;
+        barrier.srcQueueFamilyIndex = srcFamilyIndex;
+        barrier.dstQueueFamilyIndex = dstFamilyIndex;
+        barrier.buffer = transfer.Barrier.buffer;
+        barrier.offset = transfer.Barrier.offset;
+        barrier.size = transfer.Barrier.size;
+        barriers.Buffer(barrier);
+    }
+
+    for (const ImageTransfer& transfer : m_Images)
+    {
+        VkImageMemoryBarrier2 barrier{};
+        barrier.srcStageMask = srcStageMask;
+        barrier.srcAccessMask = release ? transfer.Barrier.srcAccessMask : 0;
+        barrier.dstStageMask = dstStageMask;
+        barrier.dstAccessMask = release && required ? 0 : transfer.DstAccessMask;
+        barrier.oldLayout = transfer.Barrier.oldLayout;
+        barrier.newLayout = transfer.Barrier.newLayout;
+        barrier.srcQueueFamilyIndex = srcFamilyIndex;
+        barrier.dstQueueFamilyIndex = dstFamilyIndex;
+        barrier.image = transfer.Barrier.image;
+        barrier.subresourceRange = transfer.Barrier.subresourceRange;
+        barriers.Image(barrier);
+    }
+
+    barriers.Record(cmdBuffer);
+}
+
+void VulkanQueueOwnershipTransfer::SubmitAndWait(VkCommandBuffer releaseCmdBuffer, VkCommandBuffer acquireCmdBuffer)
+{
+    VK_CHECK_RESULT(vkEndCommandBuffer(releaseCmdBuffer));
+    VK_CHECK_RESULT(vkEndCommandBuffer(acquireCmdBuffer));
+
+    VkSubmitInfo releaseSubmitInfo{};
+    releaseSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    releaseSubmitInfo.commandBufferCount = 1;
+    releaseSubmitInfo.pCommandBuffers = &releaseCmdBuffer;
+    releaseSubmitInfo.signalSemaphoreCount = 1;
+    releaseSubmitInfo.pSignalSemaphores = &m_Semaphore;
+    VK_CHECK_RESULT(vkQueueSubmit(m_DeviceRef.GetQueue(m_SrcQueueType), 1, &releaseSubmitInfo, VK_NULL_HANDLE));
+
+    VkSubmitInfo acquireSubmitInfo{};
+    acquireSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    acquireSubmitInfo.waitSemaphoreCount = 1;
+    acquireSubmitInfo.pWaitSemaphores = &m_Semaphore;
+    acquireSubmitInfo.pWaitDstStageMask = &m_DstStageMask;
+    acquireSubmitInfo.commandBufferCount = 1;
+    acquireSubmitInfo.pCommandBuffers = &acquireCmdBuffer;
+
+    VkQueue dstQueue = m_DeviceRef.GetQueue(m_DstQueueType);
+    VK_CHECK_RESULT(vkQueueSubmit(dstQueue, 1, &acquireSubmitInfo, VK_NULL_HANDLE));
+    VK_CHECK_RESULT(vkQueueWaitIdle(dstQueue));
+
+    // The acquire waited on the release, so the source queue is done with its command buffer too.
+    vkFreeCommandBuffers(m_DeviceRef.GetDevice(), m_DeviceRef.GetCommandPool(m_SrcQueueType), 1, &releaseCmdBuffer);
+    vkFreeCommandBuffers(m_DeviceRef.GetDevice(), m_DeviceRef.GetCommandPool(m_DstQueueType), 1, &acquireCmdBuffer);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "renderer/vulkan/vulkan_device.h"
+
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Moves EXCLUSIVE buffers and images from one queue family to another. The release half is
+// recorded on the source queue and the acquire half on the destination queue, with the owned
+// semaphore ordering the two submits. When both queues share a family no transfer is needed:
+// the release records an ordinary barrier (including any layout change) and the acquire is empty.
+class VulkanQueueOwnershipTransfer
+{
+public:
+    VulkanQueueOwnershipTransfer(
+            VulkanDevice& deviceRef,
+            QueueType srcQueueType,
+            VkPipelineStageFlags srcStageMask,
+            QueueType dstQueueType,
+            VkPipelineStageFlags dstStageMask);
+    ~VulkanQueueOwnershipTransfer();
+
+    VulkanQueueOwnershipTransfer(const VulkanQueueOwnershipTransfer&) = delete;
+    VulkanQueueOwnershipTransfer& operator=(const VulkanQueueOwnershipTransfer&) = delete;
+
+    VulkanQueueOwnershipTransfer& AddBuffer(
+            VkBuffer buffer,
+            VkAccessFlags srcAccessMask,
+            VkAccessFlags dstAccessMask,
+            VkDeviceSize offset = 0,
+            VkDeviceSize size = VK_WHOLE_SIZE);
+
+    VulkanQueueOwnershipTransfer& AddImage(
+            VkImage image,
+            const VkImageSubresourceRange& subresourceRange,
+            VkImageLayout oldLayout,
+            VkImageLayout newLayout,
+            VkAccessFlags srcAccessMask,
+            VkAccessFlags dstAccessMask);
+
+    void Clear();
+
+    void RecordRelease(VkCommandBuffer cmdBuffer) const;
+    void RecordAcquire(VkCommandBuffer cmdBuffer) const;
+
+    // For one-off uploads: submits the release signalling the semaphore and the acquire waiting on it,
+    // blocks until the acquire has executed, then frees both single-time command buffers.
+    void SubmitAndWait(VkCommandBuffer releaseCmdBuffer, VkCommandBuffer acquireCmdBuffer);
+
+    [[nodiscard]] bool IsRequired() const { return m_SrcFamilyIndex != m_DstFamilyIndex; }
+    // Signalled by the submit holding the release, waited on by the submit holding the acquire.
+    [[nodiscard]] VkSemaphore GetSemaphore() const { return m_Semaphore; }
+    [[nodiscard]] VkPipelineStageFlags GetDstStageMask() const { return m_DstStageMask; }
+
+private:
+    struct BufferTransfer
+    {
+        VkBufferMemoryBarrier Barrier;
+        VkAccessFlags DstAccessMask;
+    };
+
+    struct ImageTransfer
+    {
+        VkImageMemoryBarrier Barrier;
+        VkAccessFlags DstAccessMask;
+    };
+
+    void RecordBarriers(
+            VkCommandBuffer cmdBuffer,
+            VkPipelineStageFlags2 srcStageMask,
+            VkPipelineStageFlags2 dstStageMask,
+            bool release) const;
+
+private:
+    VulkanDevice& m_DeviceRef;
+
+    QueueType m_SrcQueueType;
+    QueueType m_DstQueueType;
+    uint32_t m_SrcFamilyIndex;
+    uint32_t m_DstFamilyIndex;
+    VkPipelineStageFlags m_SrcStageMask;
+    VkPipelineStageFlags m_DstStageMask;
+
+    std::vector<BufferTransfer> m_Buffers;
+    std::vector<ImageTransfer> m_Images;
+
+    VkSemaphore m_Semaphore = VK_NULL_HANDLE;
+};
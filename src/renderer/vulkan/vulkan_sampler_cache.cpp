@@ -0,0 +1,79 @@
+#include "vulkan_sampler_cache.h"
+#include "vulkan_utils.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+VulkanSamplerCache::VulkanSamplerCache(VkDevice device, float maxSupportedAnisotropy)
+    : m_Device(device), m_MaxSupportedAnisotropy(maxSupportedAnisotropy)
+{
+}
+
+VulkanSamplerCache::~VulkanSamplerCache()
+{
+    for (auto& [key, sampler] : m_Samplers)
+        vkDestroySampler(m_Device, sampler, nullptr);
+}
+
+size_t VulkanSamplerCache::KeyHash::operator()(const Key& key) const
+{
+    // FNV-1a over the words.
+    uint64_t hash = 14695981039346656037ull;
+    for (uint32_t word : key)
+    {
+        hash ^= word;
+        hash *= 1099511628211ull;
+    }
+    return static_cast<size_t>(hash);
+}
+
+VulkanSamplerCache::Key VulkanSamplerCache::MakeKey(const VkSamplerCreateInfo& createInfo)
+{
+    return {
+        createInfo.flags,
+        static_cast<uint32_t>(createInfo.magFilter),
+        static_cast<uint32_t>(createInfo.minFilter),
+        static_cast<uint32_t>(createInfo.mipmapMode),
+        static_cast<uint32_t>(createInfo.addressModeU),
+        static_cast<uint32_t>(createInfo.addressModeV),
+        static_cast<uint32_t>(createInfo.addressModeW),
+        std::bit_cast<uint32_t>(createInfo.mipLodBias),
+        createInfo.anisotropyEnable,
+        // Ignored by the driver when anisotropy is off, so it must not split the key either.
+        createInfo.anisotropyEnable ? std::bit_cast<uint32_t>(createInfo.maxAnisotropy) : 0u,
+        createInfo.compareEnable,
+        createInfo.compareEnable ? static_cast<uint32_t>(createInfo.compareOp) : 0u,
+        std::bit_cast<uint32_t>(createInfo.minLod),
+        std::bit_cast<uint32_t>(createInfo.maxLod),
+        static_cast<uint32_t>(createInfo.borderColor),
+        createInfo.unnormalizedCoordinates
+    };
+}
+
+VkSampler VulkanSamplerCache::GetSampler(const VkSamplerCreateInfo& createInfo)
+{
+    assert(createInfo.pNext == nullptr && "Sampler cache does not key on pNext chains");
+
+    VkSamplerCreateInfo samplerInfo = createInfo;
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.maxAnisotropy = std::min(samplerInfo.maxAnisotropy, m_MaxSupportedAnisotropy);
+
+    Key key = MakeKey(samplerInfo);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_Samplers.find(key);
+    if (it != m_Samplers.end())
+        return it->second;
+
+    VkSampler sampler = VK_NULL_HANDLE;
+    VK_CHECK_RESULT(vkCreateSampler(m_Device, &samplerInfo, nullptr, &sampler));
+    m_Samplers.emplace(key, sampler);
+    return sampler;
+}
+
+uint32_t VulkanSamplerCache::GetSamplerCount() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return static_cast<uint32_t>(m_Samplers.size());
+}
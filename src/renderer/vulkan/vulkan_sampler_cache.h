@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vulkan/vulkan.h>
+
+// One VkSampler per distinct VkSamplerCreateInfo. Images and textures ask for the sampler state they want
+// instead of creating their own, so the device sees a handful of samplers however many textures are loaded.
+// Samplers live until the cache is destroyed; callers must never destroy what GetSampler returns.
+class VulkanSamplerCache
+{
+public:
+    VulkanSamplerCache(VkDevice device, float maxSupportedAnisotropy);
+    ~VulkanSamplerCache();
+
+    VulkanSamplerCache(const VulkanSamplerCache&) = delete;
+    VulkanSamplerCache& operator=(const VulkanSamplerCache&) = delete;
+
+    // Safe from any thread. pNext chains are not supported. maxAnisotropy is clamped to the device limit
+    // before lookup, so requests that only differ above it share a sampler.
+    VkSampler GetSampler(const VkSamplerCreateInfo& createInfo);
+
+    [[nodiscard]] uint32_t GetSamplerCount() const;
+
+private:
+    // Every field of VkSamplerCreateInfo that affects the sampler, floats by bit pattern.
+    using Key = std::array<uint32_t, 16>;
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    static Key MakeKey(const VkSamplerCreateInfo& createInfo);
+
+private:
+    VkDevice m_Device;
+    float m_MaxSupportedAnisotropy;
+
+    mutable std::mutex m_Mutex;
+    std::unordered_map<Key, VkSampler, KeyHash> m_Samplers;
+};
@@ -0,0 +1,96 @@
+#include "vulkan_staging_ring.h"
+#include "vulkan_utils.h"
+
+#include <cassert>
+#include <stdexcept>
+
+VulkanStagingRing::VulkanStagingRing(VulkanDevice& deviceRef, VkDeviceSize capacity)
+    : m_Capacity(capacity)
+{
+    m_Buffer = std::make_unique<VulkanBuffer>(
+            deviceRef,
+            capacity,
+            1,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    VK_CHECK_RESULT(m_Buffer->Map());
+}
+
+StagingAllocation VulkanStagingRing::Allocate(VkDeviceSize size, VkDeviceSize alignment)
+{
+    assert(size > 0 && "Empty staging allocation.");
+    if (!CanFit(size, alignment))
+        throw std::runtime_error("Staging allocation is larger than the staging ring.");
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    VkDeviceSize offset = 0;
+    m_SpaceFreed.wait(lock, [&]() { return TryPlace(size, alignment, offset); });
+
+    uint64_t id = m_NextId++;
+    m_Blocks.push_back({ id, offset, offset + size, false });
+
+    StagingAllocation allocation;
+    allocation.Buffer = m_Buffer->GetBuffer();
+    allocation.Offset = offset;
+    allocation.Size = size;
+    allocation.Mapped = static_cast<uint8_t*>(m_Buffer->GetMappedMemory()) + offset;
+    allocation.Id = id;
+    return allocation;
+}
+
+void VulkanStagingRing::Free(const StagingAllocation& allocation)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        for (Block& block : m_Blocks)
+        {
+            if (block.Id == allocation.Id)
+            {
+                block.Freed = true;
+                break;
+            }
+        }
+
+        while (!m_Blocks.empty() && m_Blocks.front().Freed)
+            m_Blocks.pop_front();
+    }
+    m_SpaceFreed.notify_all();
+}
+
+bool VulkanStagingRing::TryPlace(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& outOffset) const
+{
+    if (m_Blocks.empty())
+    {
+        outOffset = 0;
+        return true;
+    }
+
+    VkDeviceSize tail = m_Blocks.front().Begin;
+    VkDeviceSize head = (m_Blocks.back().End + alignment - 1) & ~(alignment - 1);
+
+    if (m_Blocks.back().End > tail)
+    {
+        // Live range is [tail, head): use the space after it, or wrap to the front of the buffer.
+        if (head + size <= m_Capacity)
+        {
+            outOffset = head;
+            return true;
+        }
+        if (size <= tail)
+        {
+            outOffset = 0;
+            return true;
+        }
+        return false;
+    }
+
+    // Already wrapped: the only free space is between the newest and the oldest allocation.
+    if (head + size <= tail)
+    {
+        outOffset = head;
+        return true;
+    }
+    return false;
+}
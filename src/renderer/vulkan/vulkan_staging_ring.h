@@ -0,0 +1,61 @@
+#pragma once
+
+#include "renderer/vulkan/vulkan_buffer.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vulkan/vulkan.h>
+
+struct StagingAllocation
+{
+    VkBuffer Buffer = VK_NULL_HANDLE;
+    VkDeviceSize Offset = 0;
+    VkDeviceSize Size = 0;
+    void* Mapped = nullptr;
+    uint64_t Id = 0;
+
+    explicit operator bool() const { return Mapped != nullptr; }
+};
+
+// Persistently mapped, host-coherent upload buffer handed out as a FIFO ring. Any thread may allocate;
+// Allocate blocks until enough space has been freed. Allocations may be freed in any order, but their
+// space only returns to the ring once every older allocation has been freed as well.
+class VulkanStagingRing
+{
+public:
+    VulkanStagingRing(VulkanDevice& deviceRef, VkDeviceSize capacity);
+    ~VulkanStagingRing() = default;
+
+    VulkanStagingRing(const VulkanStagingRing&) = delete;
+    VulkanStagingRing& operator=(const VulkanStagingRing&) = delete;
+
+    StagingAllocation Allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+    void Free(const StagingAllocation& allocation);
+
+    [[nodiscard]] bool CanFit(VkDeviceSize size, VkDeviceSize alignment = 16) const { return size + alignment <= m_Capacity; }
+    [[nodiscard]] VkDeviceSize GetCapacity() const { return m_Capacity; }
+    [[nodiscard]] VkBuffer GetBuffer() const { return m_Buffer->GetBuffer(); }
+
+private:
+    struct Block
+    {
+        uint64_t Id;
+        VkDeviceSize Begin;
+        VkDeviceSize End;
+        bool Freed;
+    };
+
+    bool TryPlace(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& outOffset) const;
+
+private:
+    std::unique_ptr<VulkanBuffer> m_Buffer;
+    VkDeviceSize m_Capacity;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_SpaceFreed;
+    // Live allocations, oldest first.
+    std::deque<Block> m_Blocks;
+    uint64_t m_NextId = 1;
+};
@@ -1,4 +1,5 @@
 #include "renderer/vulkan/vulkan_swapchain.h"
+#include "core/profiler.h"
 
 #include <iostream>
 #include <utility>
@@ -51,6 +52,7 @@ VulkanSwapchain::~VulkanSwapchain()
 
 VkResult VulkanSwapchain::AcquireNextImage(uint32_t* imageIndex, VkSemaphore presentCompleteSemaphore)
 {
+    PROFILE_ZONE("Swapchain::AcquireNextImage");
     VkResult result = vkAcquireNextImageKHR(
             m_DeviceRef.GetDevice(),
             m_Swapchain,
@@ -64,6 +66,7 @@ VkResult VulkanSwapchain::AcquireNextImage(uint32_t* imageIndex, VkSemaphore pre
 
 VkResult VulkanSwapchain::Present(VkQueue queue, uint32_t imageIndex, VkSemaphore waitSemaphore)
 {
+    PROFILE_ZONE("Swapchain::Present");
     VkPresentInfoKHR presentInfo = {};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     presentInfo.pNext = nullptr;
@@ -1,10 +1,16 @@
 #include "vulkan_texture.h"
 #include "vulkan_utils.h"
+#include "vulkan_barrier.h"
+#include "core/mapped_file.h"
+#include "renderer/texture/mip_generator.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
+#include <algorithm>
+#include <cctype>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 namespace TextureUtils
 {
@@ -31,8 +37,11 @@ namespace TextureUtils
         return (VkFilter)0;
     }
 
-    static size_t GetMemorySize(ImageFormat format, uint32_t width, uint32_t height)
+    size_t GetMemorySize(ImageFormat format, uint32_t width, uint32_t height)
     {
+        if (ImageUtils::IsBlockCompressed(format))
+            return ImageUtils::GetImageMemorySize(format, width, height);
+
         switch (format)
         {
             case ImageFormat::RED16UI: return width * height * sizeof(uint16_t);
@@ -42,6 +51,7 @@ namespace TextureUtils
             case ImageFormat::RED8UN: return width * height;
             case ImageFormat::RED8UI: return width * height;
             case ImageFormat::RGBA: return width * height * 4;
+            case ImageFormat::RGBA16F: return width * height * 4 * sizeof(uint16_t);
             case ImageFormat::RGBA32F: return width * height * 4 * sizeof(float);
             case ImageFormat::B10R11G11UF: return width * height * sizeof(float);
         }
@@ -49,85 +59,217 @@ namespace TextureUtils
         return 0;
     }
 
+    size_t GetMipChainMemorySize(ImageFormat format, uint32_t width, uint32_t height, uint32_t mipCount)
+    {
+        size_t size = 0;
+        for (uint32_t mip = 0; mip < mipCount; mip++)
+            size += GetMemorySize(format, std::max(width >> mip, 1u), std::max(height >> mip, 1u));
+        return size;
+    }
+
     Buffer ToBufferFromFile(const std::string& path, ImageFormat& outFormat, uint32_t& outWidth, uint32_t& outHeight)
     {
-        Buffer imageBuffer;
+        void* pixels;
+        uint64_t size;
 
         int width, height, channels;
         if (stbi_is_hdr(path.c_str()))
         {
-            imageBuffer.Data = (byte*)stbi_loadf(path.c_str(), &width, &height, &channels, 4);
-            imageBuffer.Size = width * height * 4 * sizeof(float);
+            pixels = stbi_loadf(path.c_str(), &width, &height, &channels, 4);
+            size = (uint64_t)width * height * 4 * sizeof(float);
             outFormat = ImageFormat::RGBA32F;
         }
         else
         {
-            imageBuffer.Data = stbi_load(path.c_str(), &width, &height, &channels, 4);
-            imageBuffer.Size = width * height * 4;
+            pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+            size = (uint64_t)width * height * 4;
             outFormat = ImageFormat::RGBA;
         }
 
-        if (!imageBuffer.Data)
+        if (!pixels)
             return {};
 
         outWidth = width;
         outHeight = height;
-        return imageBuffer;
+        // stb_image allocates with malloc, so the buffer can free the pixels without stbi_image_free.
+        return Buffer::Adopt(pixels, size, MallocAllocator::Get());
     }
 
-    Buffer ToBufferFromMemory(Buffer buffer, ImageFormat& outFormat, uint32_t& outWidth, uint32_t& outHeight)
+    Buffer ToBufferFromMemory(BufferView buffer, ImageFormat& outFormat, uint32_t& outWidth, uint32_t& outHeight)
     {
-        Buffer imageBuffer;
+        void* pixels;
+        uint64_t size;
 
         int width, height, channels;
         if (stbi_is_hdr_from_memory((const stbi_uc*)buffer.Data, (int)buffer.Size))
         {
-            imageBuffer.Data = (byte*)stbi_loadf_from_memory((const stbi_uc*)buffer.Data, (int)buffer.Size, &width, &height, &channels, STBI_rgb_alpha);
-            imageBuffer.Size = width * height * 4 * sizeof(float);
+            pixels = stbi_loadf_from_memory((const stbi_uc*)buffer.Data, (int)buffer.Size, &width, &height, &channels, STBI_rgb_alpha);
+            size = (uint64_t)width * height * 4 * sizeof(float);
             outFormat = ImageFormat::RGBA32F;
         }
         else
         {
-            imageBuffer.Data = stbi_load_from_memory((const stbi_uc*)buffer.Data, (int)buffer.Size, &width, &height, &channels, STBI_rgb_alpha);
-            imageBuffer.Size = width * height * 4;
+            pixels = stbi_load_from_memory((const stbi_uc*)buffer.Data, (int)buffer.Size, &width, &height, &channels, STBI_rgb_alpha);
+            size = (uint64_t)width * height * 4;
             outFormat = ImageFormat::RGBA;
         }
 
-        if (!imageBuffer.Data)
+        if (!pixels)
             return {};
 
         outWidth = width;
         outHeight = height;
-        return imageBuffer;
+        return Buffer::Adopt(pixels, size, MallocAllocator::Get());
+    }
+
+    bool ReadInfoFromMemory(BufferView encoded, ImageFormat& outFormat, uint32_t& outWidth, uint32_t& outHeight)
+    {
+        int width, height, channels;
+        if (!stbi_info_from_memory((const stbi_uc*)encoded.Data, (int)encoded.Size, &width, &height, &channels))
+            return false;
+
+        outFormat = stbi_is_hdr_from_memory((const stbi_uc*)encoded.Data, (int)encoded.Size) ? ImageFormat::RGBA32F : ImageFormat::RGBA;
+        outWidth = width;
+        outHeight = height;
+        return true;
+    }
+
+    bool DecodeFromMemory(BufferView encoded, ImageFormat format, uint32_t width, uint32_t height, void* destination)
+    {
+        int decodedWidth, decodedHeight, channels;
+        void* pixels = format == ImageFormat::RGBA32F
+                ? (void*)stbi_loadf_from_memory((const stbi_uc*)encoded.Data, (int)encoded.Size, &decodedWidth, &decodedHeight, &channels, STBI_rgb_alpha)
+                : (void*)stbi_load_from_memory((const stbi_uc*)encoded.Data, (int)encoded.Size, &decodedWidth, &decodedHeight, &channels, STBI_rgb_alpha);
+
+        if (!pixels)
+            return false;
+
+        bool matchesInfo = decodedWidth == (int)width && decodedHeight == (int)height;
+        if (matchesInfo)
+            memcpy(destination, pixels, GetMemorySize(format, width, height));
+
+        stbi_image_free(pixels);
+        return matchesInfo;
+    }
+
+    bool IsContainerPath(const std::string& path)
+    {
+        std::string extension = std::filesystem::path(path).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+        return extension == ".ktx2" || extension == ".dds";
+    }
+
+    ImageFormat FromVulkanFormat(VkFormat format)
+    {
+        switch (format)
+        {
+            case VK_FORMAT_R8G8B8A8_UNORM:          return ImageFormat::RGBA;
+            case VK_FORMAT_R16G16B16A16_SFLOAT:     return ImageFormat::RGBA16F;
+            case VK_FORMAT_R32G32B32A32_SFLOAT:     return ImageFormat::RGBA32F;
+            case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:    return ImageFormat::BC1;
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:     return ImageFormat::BC1SRGB;
+            case VK_FORMAT_BC3_UNORM_BLOCK:         return ImageFormat::BC3;
+            case VK_FORMAT_BC3_SRGB_BLOCK:          return ImageFormat::BC3SRGB;
+            case VK_FORMAT_BC5_UNORM_BLOCK:         return ImageFormat::BC5;
+            case VK_FORMAT_BC7_UNORM_BLOCK:         return ImageFormat::BC7;
+            case VK_FORMAT_BC7_SRGB_BLOCK:          return ImageFormat::BC7SRGB;
+            default:                                return ImageFormat::None;
+        }
+    }
+
+    bool ReadContainerInfo(BufferView encoded, TextureContainer& outContainer, TextureSpecification& specification)
+    {
+        if (!ParseTextureContainer((const uint8_t*)encoded.Data, encoded.Size, outContainer))
+            return false;
+
+        ImageFormat format = FromVulkanFormat(outContainer.Format);
+        if (format == ImageFormat::None)
+            return false;
+
+        specification.Format = format;
+        specification.Width = outContainer.Width;
+        specification.Height = outContainer.Height;
+        specification.MipLevels = static_cast<uint32_t>(outContainer.Levels.size());
+        return true;
     }
 
+    bool ShouldGenerateMipsOnCPU(VulkanDevice& deviceRef, const TextureSpecification& specification)
+    {
+        if (!specification.GenerateMips || specification.MipLevels > 1)
+            return false;
+        if (specification.Format != ImageFormat::RGBA && specification.Format != ImageFormat::RGBA32F)
+            return false;
+
+        uint32_t width = specification.Width;
+        uint32_t height = specification.Height;
+        bool powerOfTwo = (width & (width - 1)) == 0 && (height & (height - 1)) == 0;
+        return !powerOfTwo || !deviceRef.SupportsLinearBlit(ImageUtils::VulkanImageFormat(specification.Format));
+    }
+
+    void GenerateMipsOnCPU(TextureSpecification& specification, void* data)
+    {
+        uint32_t mipCount = ImageUtils::CalculateMipCount(specification.Width, specification.Height);
+        size_t levelSize = GetMemorySize(specification.Format, specification.Width, specification.Height);
+
+        if (specification.Format == ImageFormat::RGBA32F)
+            MipGeneration::Generate(static_cast<const float*>(data), specification.Width, specification.Height, mipCount,
+                                    reinterpret_cast<float*>(static_cast<uint8_t*>(data) + levelSize));
+        else
+            MipGeneration::Generate(static_cast<const uint8_t*>(data), specification.Width, specification.Height, mipCount,
+                                    static_cast<uint8_t*>(data) + levelSize);
+
+        specification.MipLevels = mipCount;
+    }
 }
 
 
 VulkanTexture2D::VulkanTexture2D(VulkanDevice& deviceRef, TextureSpecification specification, const std::string& filepath)
     : m_DeviceRef(deviceRef), m_Specification(std::move(specification)), m_Path(filepath)
 {
-    m_ImageData = TextureUtils::ToBufferFromFile(filepath, m_Specification.Format, m_Specification.Width, m_Specification.Height);
-    assert(m_ImageData && "Failed to create Image Buffer from file.");
+    if (TextureUtils::IsContainerPath(filepath))
+    {
+        MappedFile encoded(filepath);
+        TextureContainer container;
+        if (!TextureUtils::ReadContainerInfo(BufferView(encoded.GetData(), encoded.GetSize()), container, m_Specification))
+            throw std::runtime_error("Unsupported texture container: " + filepath);
+
+        m_ImageData.Allocate(container.GetPackedSize());
+        container.CopyLevels(encoded.GetData(), m_ImageData.GetData());
+    }
+    else
+    {
+        m_ImageData = TextureUtils::ToBufferFromFile(filepath, m_Specification.Format, m_Specification.Width, m_Specification.Height);
+        assert(m_ImageData && "Failed to create Image Buffer from file.");
+        m_Specification.MipLevels = 1;
+
+        if (TextureUtils::ShouldGenerateMipsOnCPU(deviceRef, m_Specification))
+        {
+            Buffer chain(TextureUtils::GetMipChainMemorySize(m_Specification.Format, m_Specification.Width, m_Specification.Height,
+                                                             ImageUtils::CalculateMipCount(m_Specification.Width, m_Specification.Height)));
+            memcpy(chain.GetData(), m_ImageData.GetData(), m_ImageData.GetSize());
+            m_ImageData = std::move(chain);
+            TextureUtils::GenerateMipsOnCPU(m_Specification, m_ImageData.GetData());
+        }
+    }
 
     ImageSpecification spec;
     spec.Format = m_Specification.Format;
     spec.Width = m_Specification.Width;
     spec.Height = m_Specification.Height;
-    spec.Mips = specification.GenerateMips ? GetMipLevelCount() : 1;
+    spec.Mips = GetImageMipCount();
     spec.DebugName = specification.DebugName;
     spec.CreateSampler = false;
     m_Image = std::make_shared<VulkanImage2D>(deviceRef, spec);
     Invalidate();
 }
 
-VulkanTexture2D::VulkanTexture2D(VulkanDevice& deviceRef, TextureSpecification specification, Buffer data)
+VulkanTexture2D::VulkanTexture2D(VulkanDevice& deviceRef, TextureSpecification specification, BufferView data)
     : m_DeviceRef(deviceRef), m_Specification(std::move(specification))
 {
     if (m_Specification.Height == 0)
     {
         m_ImageData = TextureUtils::ToBufferFromMemory(
-                Buffer(data.Data, m_Specification.Width),
+                BufferView(data.Data, m_Specification.Width),
                 m_Specification.Format,
                 m_Specification.Width, m_Specification.Height);
 
@@ -136,12 +278,12 @@ VulkanTexture2D::VulkanTexture2D(VulkanDevice& deviceRef, TextureSpecification s
     }
     else if (data)
     {
-        auto size = static_cast<uint32_t>(TextureUtils::GetMemorySize(m_Specification.Format, m_Specification.Width, m_Specification.Height));
-        m_ImageData = Buffer::Copy(data.Data, size);
+        auto size = static_cast<uint32_t>(TextureUtils::GetMipChainMemorySize(m_Specification.Format, m_Specification.Width, m_Specification.Height, m_Specification.MipLevels));
+        m_ImageData = Buffer::Copy(BufferView(data.Data, size));
     }
     else
     {
-        auto size = static_cast<uint32_t>(TextureUtils::GetMemorySize(m_Specification.Format, m_Specification.Width, m_Specification.Height));
+        auto size = static_cast<uint32_t>(TextureUtils::GetMipChainMemorySize(m_Specification.Format, m_Specification.Width, m_Specification.Height, m_Specification.MipLevels));
         m_ImageData.Allocate(size);
         m_ImageData.ZeroInitialize();
     }
@@ -150,7 +292,7 @@ VulkanTexture2D::VulkanTexture2D(VulkanDevice& deviceRef, TextureSpecification s
     spec.Format = m_Specification.Format;
     spec.Width = m_Specification.Width;
     spec.Height = m_Specification.Height;
-    spec.Mips = specification.GenerateMips ? VulkanTexture2D::GetMipLevelCount() : 1;
+    spec.Mips = GetImageMipCount();
     spec.DebugName = specification.DebugName;
     spec.CreateSampler = false;
     if (specification.Storage)
@@ -159,6 +301,25 @@ VulkanTexture2D::VulkanTexture2D(VulkanDevice& deviceRef, TextureSpecification s
     Invalidate();
 }
 
+VulkanTexture2D::VulkanTexture2D(VulkanDevice& deviceRef, TextureSpecification specification, DeferredUploadTag)
+    : m_DeviceRef(deviceRef), m_Specification(std::move(specification)), m_DeferredUpload(true)
+{
+    ImageSpecification spec;
+    spec.Format = m_Specification.Format;
+    spec.Width = m_Specification.Width;
+    spec.Height = m_Specification.Height;
+    spec.Mips = GetImageMipCount();
+    spec.DebugName = m_Specification.DebugName;
+    spec.CreateSampler = false;
+    m_Image = std::make_shared<VulkanImage2D>(deviceRef, spec);
+    CreateImage();
+}
+
+std::shared_ptr<VulkanTexture2D> VulkanTexture2D::CreateForUpload(VulkanDevice& deviceRef, TextureSpecification specification)
+{
+    return std::shared_ptr<VulkanTexture2D>(new VulkanTexture2D(deviceRef, std::move(specification), DeferredUploadTag{}));
+}
+
 
 VulkanTexture2D::~VulkanTexture2D()
 {
@@ -178,28 +339,14 @@ void VulkanTexture2D::Resize(uint32_t width, uint32_t height)
 
 void VulkanTexture2D::Invalidate()
 {
-    m_Image->Release();
-
-    uint32_t mipCount = m_Specification.GenerateMips ? GetMipLevelCount() : 1;
+    CreateImage();
 
-    ImageSpecification& imageSpec = m_Image->GetSpecification();
-    imageSpec.Format = m_Specification.Format;
-    imageSpec.Width = m_Specification.Width;
-    imageSpec.Height = m_Specification.Height;
-    imageSpec.Mips = mipCount;
-    imageSpec.CreateSampler = false;
-    if (!m_ImageData)
-        imageSpec.Usage = ImageUsage::Storage;
-
-    m_Image->Invalidate();
+    uint32_t mipCount = m_Image->GetSpecification().Mips;
     auto& info = m_Image->GetImageInfo();
 
     if(m_ImageData)
     {
-        VkDeviceSize imageSize = m_ImageData.Size;
-
-        VkMemoryAllocateInfo memAllocInfo{};
-        memAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        VkDeviceSize imageSize = m_ImageData.GetSize();
 
         VkBuffer stagingBuffer;
         VkDeviceMemory stagingBufferMemory;
@@ -213,70 +360,16 @@ void VulkanTexture2D::Invalidate()
 
         void* data;
         vkMapMemory(m_DeviceRef.GetDevice(), stagingBufferMemory, 0, imageSize, 0, &data);
-        memcpy(data, m_ImageData.Data, static_cast<size_t>(imageSize));
+        memcpy(data, m_ImageData.GetData(), static_cast<size_t>(imageSize));
         vkUnmapMemory(m_DeviceRef.GetDevice(), stagingBufferMemory);
 
-        VkCommandBuffer copyCommand = m_DeviceRef.BeginSingleTimeCommands();
-
-        // The sub resource range describes the regions of the image that will be transitioned using the memory barriers below
-        VkImageSubresourceRange subresourceRange = {};
-        // Image only contains color data
-        subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        // Start at first mip level
-        subresourceRange.baseMipLevel = 0;
-        subresourceRange.levelCount = 1;
-        subresourceRange.layerCount = 1;
-
-        // Insert a memory dependency at the proper pipeline stages that will execute the image layout transition
-        // Source pipeline stage is host write/read execution (VK_PIPELINE_STAGE_HOST_BIT)
-        // Destination pipeline stage is copy command execution (VK_PIPELINE_STAGE_TRANSFER_BIT)
-        ImageUtils::SetImageLayout(
-                copyCommand,
-                info.Image,
-                VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                subresourceRange,
-                VK_PIPELINE_STAGE_HOST_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
-
-        VkBufferImageCopy bufferCopyRegion = {};
-        bufferCopyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        bufferCopyRegion.imageSubresource.mipLevel = 0;
-        bufferCopyRegion.imageSubresource.baseArrayLayer = 0;
-        bufferCopyRegion.imageSubresource.layerCount = 1;
-        bufferCopyRegion.imageExtent.width = m_Specification.Width;
-        bufferCopyRegion.imageExtent.height = m_Specification.Height;
-        bufferCopyRegion.imageExtent.depth = 1;
-        bufferCopyRegion.bufferOffset = 0;
-
-        // Copy mip levels from staging buffer
-        vkCmdCopyBufferToImage(
-                copyCommand,
-                stagingBuffer,
-                info.Image,
-                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                1,
-                &bufferCopyRegion);
+        // Uploads go through the transfer queue so they can run alongside rendering on a dedicated DMA engine.
+        VkCommandBuffer copyCommand = m_DeviceRef.BeginSingleTimeCommands(QueueType::Transfer);
+        RecordUpload(copyCommand, stagingBuffer, 0);
+        m_DeviceRef.EndSingleTimeCommand(copyCommand, QueueType::Transfer);
 
-        if (mipCount > 1) // Mips to generate
-        {
-            ImageUtils::InsertImageMemoryBarrier(copyCommand, info.Image,
-                                                VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
-                                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                                                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                                                subresourceRange);
-        }
-        else
-        {
-            ImageUtils::InsertImageMemoryBarrier(copyCommand, info.Image,
-                                                VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
-                                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_Image->GetDescriptorInfo().imageLayout,
-                                                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                                                subresourceRange);
-        }
-
-        m_DeviceRef.EndSingleTimeCommand(copyCommand);
         vkDestroyBuffer(m_DeviceRef.GetDevice(), stagingBuffer, nullptr);
         vkFreeMemory(m_DeviceRef.GetDevice(), stagingBufferMemory, nullptr);
-
     }
     else
     {
@@ -285,14 +378,42 @@ void VulkanTexture2D::Invalidate()
         subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         subresourceRange.layerCount = 1;
         subresourceRange.levelCount = mipCount;
-        ImageUtils::SetImageLayout(
-                transitionCommandBuffer,
-                info.Image,
-                VK_IMAGE_LAYOUT_UNDEFINED, m_Image->GetDescriptorInfo().imageLayout,
-                subresourceRange);
+        VulkanBarrierBuilder(m_DeviceRef)
+                .Image(info.Image, subresourceRange,
+                       { ResourceAccess::None },
+                       { ResourceAccess::FragmentShaderSampledRead, ResourceAccess::ComputeShaderSampledRead },
+                       VK_IMAGE_LAYOUT_UNDEFINED, m_Image->GetDescriptorInfo().imageLayout)
+                .Record(transitionCommandBuffer);
         m_DeviceRef.EndSingleTimeCommand(transitionCommandBuffer);
     }
 
+    if (m_ImageData && RequiresMipGeneration())
+        GenerateMips();
+
+    m_ImageData.Release();
+}
+
+void VulkanTexture2D::CreateImage()
+{
+    if (ImageUtils::IsBlockCompressed(m_Specification.Format) && !m_DeviceRef.SupportsTextureCompressionBC())
+        throw std::runtime_error("Block-compressed texture requested but the device does not support BC formats.");
+
+    m_Image->Release();
+
+    uint32_t mipCount = GetImageMipCount();
+
+    ImageSpecification& imageSpec = m_Image->GetSpecification();
+    imageSpec.Format = m_Specification.Format;
+    imageSpec.Width = m_Specification.Width;
+    imageSpec.Height = m_Specification.Height;
+    imageSpec.Mips = mipCount;
+    imageSpec.CreateSampler = false;
+    if (!m_ImageData && !m_DeferredUpload)
+        imageSpec.Usage = ImageUsage::Storage;
+
+    m_Image->Invalidate();
+    auto& info = m_Image->GetImageInfo();
+
     // Create a texture sampler
     VkSamplerCreateInfo samplerInfo{};
     samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
@@ -305,7 +426,9 @@ void VulkanTexture2D::Invalidate()
     samplerInfo.mipLodBias = 0.0f;
     samplerInfo.compareOp = VK_COMPARE_OP_NEVER;
     samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = static_cast<float>(mipCount);
+    // The view already limits sampling to the image's levels, so leaving maxLod unclamped lets textures with
+    // different mip counts share a sampler.
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
 
     // Enable anisotropic filtering
     // This feature is optional, so we must check if it's supported on the device
@@ -313,7 +436,7 @@ void VulkanTexture2D::Invalidate()
     samplerInfo.anisotropyEnable = VK_TRUE;
     samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
 
-    VK_CHECK_RESULT(vkCreateSampler(m_DeviceRef.GetDevice(), &samplerInfo, nullptr, &info.Sampler));
+    info.Sampler = m_DeviceRef.GetSampler(samplerInfo);
     m_Image->UpdateDescriptor();
 
     if (!m_Specification.Storage)
@@ -335,12 +458,86 @@ void VulkanTexture2D::Invalidate()
 
         m_Image->UpdateDescriptor();
     }
+}
 
-    if (m_ImageData && m_Specification.GenerateMips && mipCount > 1)
-        GenerateMips();
+void VulkanTexture2D::RecordUpload(VkCommandBuffer cmdBuffer, VkBuffer stagingBuffer, VkDeviceSize stagingOffset)
+{
+    const auto& info = m_Image->GetImageInfo();
 
-    m_ImageData.Release();
-    m_ImageData = Buffer();
+    // Only mip 0 comes from the staging data when the rest of the chain is blitted afterwards.
+    uint32_t uploadedLevels = RequiresMipGeneration() ? 1 : m_Image->GetSpecification().Mips;
+
+    // The sub resource range describes the regions of the image that will be transitioned using the memory barriers below
+    VkImageSubresourceRange subresourceRange = {};
+    // Image only contains color data
+    subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    // Start at first mip level
+    subresourceRange.baseMipLevel = 0;
+    subresourceRange.levelCount = uploadedLevels;
+    subresourceRange.layerCount = 1;
+
+    // The staging data's host writes are visible once the submit begins, so only the copy waits on the transition.
+    VulkanBarrierBuilder barriers(m_DeviceRef);
+    barriers.Image(info.Image, subresourceRange, { ResourceAccess::None }, { ResourceAccess::CopyWrite })
+            .Record(cmdBuffer);
+
+    // One region per level, tightly packed from mip 0 down. Block-compressed levels are whole 4x4 blocks,
+    // and the extent of the small levels may stop short of a block edge.
+    std::vector<VkBufferImageCopy> bufferCopyRegions(uploadedLevels);
+    VkDeviceSize levelOffset = stagingOffset;
+    for (uint32_t mip = 0; mip < uploadedLevels; mip++)
+    {
+        uint32_t mipWidth = std::max(m_Specification.Width >> mip, 1u);
+        uint32_t mipHeight = std::max(m_Specification.Height >> mip, 1u);
+
+        VkBufferImageCopy& bufferCopyRegion = bufferCopyRegions[mip];
+        bufferCopyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        bufferCopyRegion.imageSubresource.mipLevel = mip;
+        bufferCopyRegion.imageSubresource.baseArrayLayer = 0;
+        bufferCopyRegion.imageSubresource.layerCount = 1;
+        bufferCopyRegion.imageExtent.width = mipWidth;
+        bufferCopyRegion.imageExtent.height = mipHeight;
+        bufferCopyRegion.imageExtent.depth = 1;
+        bufferCopyRegion.bufferOffset = levelOffset;
+
+        levelOffset += TextureUtils::GetMemorySize(m_Specification.Format, mipWidth, mipHeight);
+    }
+
+    // Copy mip levels from staging buffer
+    vkCmdCopyBufferToImage(
+            cmdBuffer,
+            stagingBuffer,
+            info.Image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            static_cast<uint32_t>(bufferCopyRegions.size()),
+            bufferCopyRegions.data());
+
+    if (RequiresMipGeneration())
+    {
+        barriers.Image(info.Image, subresourceRange, { ResourceAccess::CopyWrite }, { ResourceAccess::BlitRead });
+    }
+    else
+    {
+        // A transfer-only queue cannot name shader stages; the wait for the upload orders it before any sampling.
+        barriers.Image(info.Image, subresourceRange,
+                       { ResourceAccess::CopyWrite }, { ResourceAccess::None },
+                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_Image->GetDescriptorInfo().imageLayout);
+    }
+    barriers.Record(cmdBuffer);
+}
+
+bool VulkanTexture2D::RequiresMipGeneration() const
+{
+    return m_Specification.MipLevels <= 1 && m_Image->GetSpecification().Mips > 1;
+}
+
+uint32_t VulkanTexture2D::GetImageMipCount() const
+{
+    // Precomputed chains and BCn data (which cannot be blit targets) are uploaded as they are.
+    if (m_Specification.MipLevels > 1 || ImageUtils::IsBlockCompressed(m_Specification.Format))
+        return std::max(m_Specification.MipLevels, 1u);
+
+    return m_Specification.GenerateMips ? GetMipLevelCount() : 1;
 }
 
 uint32_t VulkanTexture2D::GetMipLevelCount() const
@@ -364,15 +561,16 @@ glm::uvec2 VulkanTexture2D::GetMipSize(uint32_t mip) const
 
 void VulkanTexture2D::GenerateMips()
 {
-    const auto& imageInfo = m_Image->GetImageInfo();
-
     VkCommandBuffer blitCmd = m_DeviceRef.BeginSingleTimeCommands();
+    RecordGenerateMips(blitCmd);
+    m_DeviceRef.EndSingleTimeCommand(blitCmd);
+}
 
-    VkImageMemoryBarrier barrier = {};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.image = imageInfo.Image;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+void VulkanTexture2D::RecordGenerateMips(VkCommandBuffer blitCmd)
+{
+    const auto& imageInfo = m_Image->GetImageInfo();
+
+    VulkanBarrierBuilder barriers(m_DeviceRef);
 
     uint32_t mipLevels = GetMipLevelCount();
     for(uint32_t i = 1; i < mipLevels; i++)
@@ -402,11 +600,8 @@ void VulkanTexture2D::GenerateMips()
         mipSubRange.layerCount = 1;
 
         // Prepare current mip level as image blit destination
-        ImageUtils::InsertImageMemoryBarrier(blitCmd, imageInfo.Image,
-                                        0, VK_ACCESS_TRANSFER_WRITE_BIT,
-                                        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                                        mipSubRange);
+        barriers.Image(imageInfo.Image, mipSubRange, { ResourceAccess::None }, { ResourceAccess::BlitWrite })
+                .Record(blitCmd);
 
         // Blit from previous level
         vkCmdBlitImage(
@@ -420,11 +615,8 @@ void VulkanTexture2D::GenerateMips()
                 TextureUtils::VulkanSamplerFilter(m_Specification.SamplerFilter));
 
         // Prepare current mip level as image blit source for next level
-        ImageUtils::InsertImageMemoryBarrier(blitCmd, imageInfo.Image,
-                                        VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
-                                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                                        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                                        mipSubRange);
+        barriers.Image(imageInfo.Image, mipSubRange, { ResourceAccess::BlitWrite }, { ResourceAccess::BlitRead })
+                .Record(blitCmd);
     }
 
     // After the loop, all mip layers are in TRANSFER_SRC layout, so transition all to SHADER_READ
@@ -433,11 +625,8 @@ void VulkanTexture2D::GenerateMips()
     subresourceRange.layerCount = 1;
     subresourceRange.levelCount = mipLevels;
 
-    ImageUtils::InsertImageMemoryBarrier(blitCmd, imageInfo.Image,
-                                    VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
-                                    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                                    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                                    subresourceRange);
-
-    m_DeviceRef.EndSingleTimeCommand(blitCmd);
+    barriers.Image(imageInfo.Image, subresourceRange,
+                   { ResourceAccess::BlitRead },
+                   { ResourceAccess::FragmentShaderSampledRead, ResourceAccess::ComputeShaderSampledRead })
+            .Record(blitCmd);
 }
@@ -2,6 +2,7 @@
 
 #include "renderer/vulkan/vulkan_image.h"
 #include "renderer/vulkan/vulkan_device.h"
+#include "renderer/texture/texture_container.h"
 #include "core/buffer.h"
 
 #include <glm/glm.hpp>
@@ -18,21 +19,61 @@ struct TextureSpecification
     TextureFilter SamplerFilter = TextureFilter::Linear;
 
     bool GenerateMips = true;
+    // Levels already present in the data, packed from mip 0 down. Above 1, and for block-compressed
+    // formats (which cannot be blit targets), the levels are uploaded as given and GenerateMips is ignored.
+    uint32_t MipLevels = 1;
     bool Storage = false;
     std::string DebugName;
 };
 
+namespace TextureUtils
+{
+    size_t GetMemorySize(ImageFormat format, uint32_t width, uint32_t height);
+    size_t GetMipChainMemorySize(ImageFormat format, uint32_t width, uint32_t height, uint32_t mipCount);
+
+    // Decodes a file with stb_image to RGBA8 or RGBA32F. The buffer owns stb's allocation.
+    Buffer ToBufferFromFile(const std::string& path, ImageFormat& outFormat, uint32_t& outWidth, uint32_t& outHeight);
+    // Header-only probe of an encoded image: the format and extent DecodeFromMemory will produce.
+    bool ReadInfoFromMemory(BufferView encoded, ImageFormat& outFormat, uint32_t& outWidth, uint32_t& outHeight);
+    // Decodes to RGBA8 or RGBA32F and writes the tightly packed pixels to destination, which must hold GetMemorySize bytes.
+    bool DecodeFromMemory(BufferView encoded, ImageFormat format, uint32_t width, uint32_t height, void* destination);
+
+    // KTX2 and DDS files carry their mip chain precomputed.
+    bool IsContainerPath(const std::string& path);
+    ImageFormat FromVulkanFormat(VkFormat format);
+    // Parses a container and sets Format, Width, Height and MipLevels, so the levels upload in one copy
+    // without blitting. Copy the data with outContainer.CopyLevels.
+    bool ReadContainerInfo(BufferView encoded, TextureContainer& outContainer, TextureSpecification& specification);
+
+    // Blits truncate odd extents and need linear blit support for the format; such RGBA and RGBA32F textures
+    // get their chain from MipGeneration instead.
+    bool ShouldGenerateMipsOnCPU(VulkanDevice& deviceRef, const TextureSpecification& specification);
+    // data holds level 0 followed by room for the rest of the chain (GetMipChainMemorySize of the image's
+    // mip count). Fills it in and sets MipLevels so the chain uploads as given.
+    void GenerateMipsOnCPU(TextureSpecification& specification, void* data);
+}
+
 class VulkanTexture2D
 {
 public:
     VulkanTexture2D(VulkanDevice& deviceRef, TextureSpecification specification, const std::string& filepath);
-    explicit VulkanTexture2D(VulkanDevice& deviceRef, TextureSpecification specification, Buffer data = Buffer());
+    explicit VulkanTexture2D(VulkanDevice& deviceRef, TextureSpecification specification, BufferView data = BufferView());
     ~VulkanTexture2D();
 
+    // Creates the image, view and sampler with undefined contents. The caller records RecordUpload on a
+    // transfer-capable queue and, if RequiresMipGeneration, RecordGenerateMips on the graphics queue afterwards.
+    static std::shared_ptr<VulkanTexture2D> CreateForUpload(VulkanDevice& deviceRef, TextureSpecification specification);
+
     void Invalidate();
     void Resize(uint32_t width, uint32_t height);
     void GenerateMips();
 
+    // Copies the levels in the staging data (mip 0 alone when the rest is blitted) from stagingBuffer at
+    // stagingOffset, leaving them ready for RecordGenerateMips or for sampling.
+    void RecordUpload(VkCommandBuffer cmdBuffer, VkBuffer stagingBuffer, VkDeviceSize stagingOffset);
+    void RecordGenerateMips(VkCommandBuffer blitCmd);
+    [[nodiscard]] bool RequiresMipGeneration() const;
+
     [[nodiscard]]ImageFormat GetFormat() const { return m_Specification.Format; }
     [[nodiscard]]uint32_t GetWidth() const { return m_Specification.Width; }
     [[nodiscard]]uint32_t GetHeight() const { return m_Specification.Height; }
@@ -44,11 +85,19 @@ public:
     [[nodiscard]] uint32_t GetMipLevelCount() const;
     [[nodiscard]] glm::uvec2 GetMipSize(uint32_t mip) const;
 
+private:
+    struct DeferredUploadTag {};
+    VulkanTexture2D(VulkanDevice& deviceRef, TextureSpecification specification, DeferredUploadTag);
+
+    void CreateImage();
+    [[nodiscard]] uint32_t GetImageMipCount() const;
+
 private:
 
     VulkanDevice& m_DeviceRef;
     TextureSpecification m_Specification;
     std::string m_Path;
+    bool m_DeferredUpload = false;
 
     Buffer m_ImageData;
     std::shared_ptr<VulkanImage2D> m_Image;
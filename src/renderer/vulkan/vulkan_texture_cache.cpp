@@ -0,0 +1,182 @@
+#include "vulkan_texture_cache.h"
+#include "core/engine_utils.h"
+#include "core/profiler.h"
+
+#include <filesystem>
+#include <iostream>
+#include <utility>
+
+bool VulkanTextureCache::Key::operator==(const Key& other) const
+{
+    return Path == other.Path
+           && SamplerWrap == other.SamplerWrap
+           && SamplerFilter == other.SamplerFilter
+           && GenerateMips == other.GenerateMips
+           && MipLevels == other.MipLevels
+           && Storage == other.Storage;
+}
+
+size_t VulkanTextureCache::KeyHash::operator()(const Key& key) const
+{
+    size_t seed = 0;
+    EngineUtils::HashCombine(seed, key.Path, key.SamplerWrap, key.SamplerFilter, key.GenerateMips, key.MipLevels, key.Storage);
+    return seed;
+}
+
+VulkanTextureCache::VulkanTextureCache(VulkanDevice& deviceRef, VkDeviceSize budgetBytes, uint32_t workerCount)
+    : m_DeviceRef(deviceRef), m_Budget(budgetBytes)
+{
+    m_Loader = std::make_unique<VulkanTextureLoader>(deviceRef, workerCount);
+}
+
+VulkanTextureCache::~VulkanTextureCache()
+{
+    // Nobody can be left waiting on a promise that will never be kept.
+    Flush();
+}
+
+VulkanTextureCache::Key VulkanTextureCache::MakeKey(const std::string& filepath, const TextureSpecification& specification)
+{
+    // Spellings of the same file ("../a/b.png", "../a/./b.png") share an entry. A path that cannot be
+    // resolved keeps its spelling and fails in the loader.
+    std::error_code error;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(filepath, error);
+
+    // Format, Width and Height come from the file, so only what the caller chooses is part of the key.
+    return {
+        error ? filepath : canonical.string(),
+        specification.SamplerWrap,
+        specification.SamplerFilter,
+        specification.GenerateMips,
+        specification.MipLevels,
+        specification.Storage
+    };
+}
+
+TextureFuture VulkanTextureCache::Load(const std::string& filepath, const TextureSpecification& specification)
+{
+    Key key = MakeKey(filepath, specification);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_Entries.find(key);
+    if (it != m_Entries.end())
+    {
+        Entry& entry = it->second;
+        if (entry.Resident)
+        {
+            m_RecentlyUsed.splice(m_RecentlyUsed.begin(), m_RecentlyUsed, entry.LastUse);
+            m_Statistics.Hits++;
+        }
+        else
+        {
+            m_Statistics.Coalesced++;
+        }
+        return entry.Future;
+    }
+
+    Entry entry;
+    entry.Promise = std::make_shared<std::promise<std::shared_ptr<VulkanTexture2D>>>();
+    entry.Future = entry.Promise->get_future().share();
+    TextureFuture future = entry.Future;
+
+    TextureLoadId id = m_Loader->Load(filepath, specification);
+    m_InFlight.emplace(id, key);
+    m_Entries.emplace(std::move(key), std::move(entry));
+    m_Statistics.Misses++;
+    return future;
+}
+
+void VulkanTextureCache::Update()
+{
+    std::vector<LoadedTexture> loaded = m_Loader->Update();
+    Resolve(loaded);
+}
+
+void VulkanTextureCache::Flush()
+{
+    PROFILE_ZONE("TextureCache::Flush");
+    std::vector<LoadedTexture> loaded = m_Loader->Flush();
+    Resolve(loaded);
+}
+
+void VulkanTextureCache::Resolve(std::vector<LoadedTexture>& loaded)
+{
+    // Promises are kept outside the lock, so callbacks woken by them may call Load.
+    std::vector<std::pair<std::shared_ptr<std::promise<std::shared_ptr<VulkanTexture2D>>>, std::shared_ptr<VulkanTexture2D>>> resolved;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        for (LoadedTexture& texture : loaded)
+        {
+            auto inFlight = m_InFlight.find(texture.Id);
+            if (inFlight == m_InFlight.end())
+                continue;
+
+            auto it = m_Entries.find(inFlight->second);
+            m_InFlight.erase(inFlight);
+            if (it == m_Entries.end())
+                continue;
+
+            resolved.emplace_back(it->second.Promise, texture.Texture);
+
+            // Failures are forgotten, so a later request tries the file again.
+            if (!texture.Texture)
+            {
+                std::cerr << "Failed to load texture: " << texture.Path << std::endl;
+                m_Entries.erase(it);
+                continue;
+            }
+
+            Entry& entry = it->second;
+            entry.Promise.reset();
+            entry.Texture = std::move(texture.Texture);
+            entry.Bytes = GetTextureMemorySize(*entry.Texture);
+            entry.Resident = true;
+            m_RecentlyUsed.push_front(it->first);
+            entry.LastUse = m_RecentlyUsed.begin();
+            m_Statistics.ResidentBytes += entry.Bytes;
+        }
+
+        Trim();
+    }
+
+    for (auto& [promise, texture] : resolved)
+        promise->set_value(std::move(texture));
+}
+
+void VulkanTextureCache::SetBudget(VkDeviceSize budgetBytes)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Budget = budgetBytes;
+    Trim();
+}
+
+VulkanTextureCache::Statistics VulkanTextureCache::GetStatistics() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Statistics;
+}
+
+void VulkanTextureCache::Trim()
+{
+    // The cache and the entry's own future hold the only references once every user has let go. Textures
+    // still in use are skipped, so the budget is a target rather than a cap.
+    for (auto it = m_RecentlyUsed.end(); it != m_RecentlyUsed.begin() && m_Statistics.ResidentBytes > m_Budget;)
+    {
+        --it;
+        auto entry = m_Entries.find(*it);
+        if (entry->second.Texture.use_count() > 2)
+            continue;
+
+        m_Statistics.ResidentBytes -= entry->second.Bytes;
+        m_Statistics.Evictions++;
+        m_Entries.erase(entry);
+        it = m_RecentlyUsed.erase(it);
+    }
+}
+
+VkDeviceSize VulkanTextureCache::GetTextureMemorySize(const VulkanTexture2D& texture)
+{
+    return TextureUtils::GetMipChainMemorySize(
+            texture.GetFormat(), texture.GetWidth(), texture.GetHeight(),
+            texture.GetImage()->GetSpecification().Mips);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "renderer/vulkan/vulkan_device.h"
+#include "renderer/vulkan/vulkan_texture.h"
+#include "renderer/vulkan/vulkan_texture_loader.h"
+
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Null when the file could not be read or decoded.
+using TextureFuture = std::shared_future<std::shared_ptr<VulkanTexture2D>>;
+
+// Loads each texture once. Requests are keyed by the canonical path and every specification field that
+// changes the image or sampler, so the same file asked for twice shares one decode and one upload, even
+// when the second request arrives while the first is still on the loader.
+//
+// Finished textures stay cached after their last user lets go, up to a VRAM budget. Past it, Update drops
+// the least recently requested textures that nothing outside the cache still holds.
+class VulkanTextureCache
+{
+public:
+    static constexpr VkDeviceSize DefaultBudget = 512ull * 1024 * 1024;
+
+    struct Statistics
+    {
+        uint64_t Hits = 0;          // Already resident
+        uint64_t Coalesced = 0;     // Joined a load in flight
+        uint64_t Misses = 0;        // Started a load
+        uint64_t Evictions = 0;
+        VkDeviceSize ResidentBytes = 0;
+    };
+
+    explicit VulkanTextureCache(
+            VulkanDevice& deviceRef,
+            VkDeviceSize budgetBytes = DefaultBudget,
+            uint32_t workerCount = ThreadPool::GetDefaultWorkerCount());
+    ~VulkanTextureCache();
+
+    VulkanTextureCache(const VulkanTextureCache&) = delete;
+    VulkanTextureCache& operator=(const VulkanTextureCache&) = delete;
+
+    // Safe from any thread. The future becomes ready during a later Update on the render thread, so that
+    // thread must poll it rather than wait on it.
+    TextureFuture Load(const std::string& filepath, const TextureSpecification& specification = {});
+
+    // Render thread, once per frame: finishes uploads, resolves their futures and trims to the budget.
+    void Update();
+    // Render thread. Blocks until every load issued so far has resolved.
+    void Flush();
+
+    void SetBudget(VkDeviceSize budgetBytes);
+    [[nodiscard]] VkDeviceSize GetBudget() const { return m_Budget; }
+    [[nodiscard]] Statistics GetStatistics() const;
+
+    // Bytes the image's levels occupy, ignoring driver padding.
+    static VkDeviceSize GetTextureMemorySize(const VulkanTexture2D& texture);
+
+private:
+    struct Key
+    {
+        std::string Path;
+        TextureWrap SamplerWrap;
+        TextureFilter SamplerFilter;
+        bool GenerateMips;
+        uint32_t MipLevels;
+        bool Storage;
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry
+    {
+        std::shared_ptr<std::promise<std::shared_ptr<VulkanTexture2D>>> Promise;
+        TextureFuture Future;
+        std::shared_ptr<VulkanTexture2D> Texture;
+        VkDeviceSize Bytes = 0;
+        bool Resident = false;
+        // Position in m_RecentlyUsed, valid once resident.
+        std::list<Key>::iterator LastUse;
+    };
+
+    static Key MakeKey(const std::string& filepath, const TextureSpecification& specification);
+    void Resolve(std::vector<LoadedTexture>& loaded);
+    void Trim();
+
+private:
+    VulkanDevice& m_DeviceRef;
+    VkDeviceSize m_Budget;
+
+    mutable std::mutex m_Mutex;
+    std::unordered_map<Key, Entry, KeyHash> m_Entries;
+    std::unordered_map<TextureLoadId, Key> m_InFlight;
+    // Resident keys, most recently requested first.
+    std::list<Key> m_RecentlyUsed;
+    Statistics m_Statistics;
+
+    std::unique_ptr<VulkanTextureLoader> m_Loader;
+};
@@ -0,0 +1,351 @@
+#include "vulkan_texture_loader.h"
+#include "vulkan_utils.h"
+#include "core/profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    // Files read per AsyncFileReader batch, bounding how much encoded data waits on the decoders at once.
+    constexpr size_t MaxReadBatchSize = 64;
+
+    VkCommandBuffer BeginBatchCommandBuffer(VulkanDevice& deviceRef, QueueType queueType)
+    {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool = deviceRef.GetCommandPool(queueType);
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer cmdBuffer;
+        VK_CHECK_RESULT(vkAllocateCommandBuffers(deviceRef.GetDevice(), &allocInfo, &cmdBuffer));
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        VK_CHECK_RESULT(vkBeginCommandBuffer(cmdBuffer, &beginInfo));
+        return cmdBuffer;
+    }
+}
+
+VulkanTextureLoader::VulkanTextureLoader(VulkanDevice& deviceRef, uint32_t workerCount, VkDeviceSize stagingCapacity)
+    : m_DeviceRef(deviceRef), m_Workers(workerCount)
+{
+    m_StagingRing = std::make_unique<VulkanStagingRing>(deviceRef, stagingCapacity);
+    m_FileReader = std::make_unique<AsyncFileReader>(static_cast<uint32_t>(MaxReadBatchSize));
+}
+
+VulkanTextureLoader::~VulkanTextureLoader()
+{
+    Flush();
+}
+
+TextureLoadId VulkanTextureLoader::Load(const std::string& filepath, TextureSpecification specification)
+{
+    PROFILE_ZONE("TextureLoader::Load");
+    TextureLoadId id = m_NextId++;
+    m_PendingCount++;
+
+    if (specification.DebugName.empty())
+        specification.DebugName = filepath;
+
+    bool startReading;
+    {
+        std::lock_guard<std::mutex> lock(m_ReadMutex);
+        m_PendingReads.push_back({ id, filepath, std::move(specification) });
+        startReading = !m_Reading;
+        m_Reading = true;
+    }
+
+    // One read task at a time drains the queue, so loads issued in a burst are read as one batch.
+    if (startReading)
+        m_Workers.Submit([this]() { ReadPending(); });
+    return id;
+}
+
+void VulkanTextureLoader::ReadPending()
+{
+    PROFILE_ZONE("TextureLoader::Read");
+    while (true)
+    {
+        std::vector<ReadRequest> requests;
+        {
+            std::lock_guard<std::mutex> lock(m_ReadMutex);
+            if (m_PendingReads.empty())
+            {
+                m_Reading = false;
+                return;
+            }
+
+            const size_t count = std::min(m_PendingReads.size(), MaxReadBatchSize);
+            requests.assign(std::make_move_iterator(m_PendingReads.begin()), std::make_move_iterator(m_PendingReads.begin() + count));
+            m_PendingReads.erase(m_PendingReads.begin(), m_PendingReads.begin() + count);
+        }
+
+        std::vector<std::string> filepaths;
+        filepaths.reserve(requests.size());
+        for (const ReadRequest& request : requests)
+            filepaths.push_back(request.Path);
+        std::vector<AsyncFileReader::Result> files = m_FileReader->ReadFiles(filepaths);
+
+        for (size_t i = 0; i < requests.size(); i++)
+        {
+            m_Workers.Submit([this, request = std::move(requests[i]), file = std::move(files[i])]() mutable
+            {
+                Decode(request.Id, request.Path, file, std::move(request.Specification));
+            });
+        }
+    }
+}
+
+std::vector<LoadedTexture> VulkanTextureLoader::Update()
+{
+    std::vector<LoadedTexture> completed;
+    RetireBatches(false, completed);
+    SubmitDecoded(completed);
+    return completed;
+}
+
+std::vector<LoadedTexture> VulkanTextureLoader::Flush()
+{
+    // Workers can be blocked on staging space that only retiring batches frees, so waiting for them to go
+    // idle first could deadlock. Upload and retire whatever is decoded until every load has completed.
+    std::vector<LoadedTexture> completed;
+    while (m_PendingCount > 0)
+    {
+        SubmitDecoded(completed);
+        if (!m_InFlightBatches.empty())
+        {
+            RetireBatches(true, completed);
+            continue;
+        }
+
+        // Nothing holds staging space any more, so the remaining workers are decoding rather than blocked.
+        std::unique_lock<std::mutex> lock(m_DecodedMutex);
+        m_DecodedAvailable.wait(lock, [this]() { return !m_Decoded.empty() || m_PendingCount == 0; });
+    }
+
+    // Every decode has been handed over, so this only waits for the tasks to return.
+    m_Workers.WaitIdle();
+    return completed;
+}
+
+void VulkanTextureLoader::Decode(
+        TextureLoadId id,
+        const std::string& filepath,
+        const AsyncFileReader::Result& encoded,
+        TextureSpecification specification)
+{
+    PROFILE_ZONE("TextureLoader::Decode");
+    DecodedTexture decoded;
+    decoded.Id = id;
+    decoded.Path = filepath;
+    decoded.Failed = !encoded.Success;
+
+    BufferView encodedBuffer(encoded.Data.data(), encoded.Data.size());
+    TextureContainer container;
+    bool isContainer = IsTextureContainer(encoded.Data.data(), encoded.Data.size());
+    if (!decoded.Failed)
+    {
+        if (isContainer)
+            decoded.Failed = !TextureUtils::ReadContainerInfo(encodedBuffer, container, specification) ||
+                             (ImageUtils::IsBlockCompressed(specification.Format) && !m_DeviceRef.SupportsTextureCompressionBC());
+        else
+            decoded.Failed = !TextureUtils::ReadInfoFromMemory(encodedBuffer, specification.Format, specification.Width, specification.Height);
+    }
+    if (!isContainer)
+        specification.MipLevels = 1;
+    bool generateMipsOnCPU = !isContainer && !decoded.Failed && TextureUtils::ShouldGenerateMipsOnCPU(m_DeviceRef, specification);
+
+    if (!decoded.Failed)
+    {
+        VkDeviceSize size;
+        if (isContainer)
+            size = container.GetPackedSize();
+        else if (generateMipsOnCPU)
+            size = TextureUtils::GetMipChainMemorySize(specification.Format, specification.Width, specification.Height,
+                                                       ImageUtils::CalculateMipCount(specification.Width, specification.Height));
+        else
+            size = TextureUtils::GetMemorySize(specification.Format, specification.Width, specification.Height);
+
+        // Blocks while the ring is full, which throttles the workers to the rate the GPU consumes uploads.
+        void* destination;
+        if (m_StagingRing->CanFit(size))
+        {
+            decoded.Staging = m_StagingRing->Allocate(size);
+            destination = decoded.Staging.Mapped;
+        }
+        else
+        {
+            decoded.DedicatedStaging = std::make_unique<VulkanBuffer>(
+                    m_DeviceRef,
+                    size,
+                    1,
+                    VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            VK_CHECK_RESULT(decoded.DedicatedStaging->Map());
+            destination = decoded.DedicatedStaging->GetMappedMemory();
+        }
+
+        // Containers already hold every level, so filling the staging memory is a straight copy.
+        if (isContainer)
+        {
+            container.CopyLevels(encoded.Data.data(), destination);
+        }
+        else if (generateMipsOnCPU)
+        {
+            // The chain is built in ordinary memory, since the filter reads back levels it has written and
+            // staging memory may be write-combined. The worker's scratch arena keeps it off the heap.
+            ScratchScope scratch;
+            Buffer chain(size, scratch.GetArena());
+            decoded.Failed = !TextureUtils::DecodeFromMemory(encodedBuffer, specification.Format, specification.Width, specification.Height, chain.GetData());
+            if (!decoded.Failed)
+            {
+                TextureUtils::GenerateMipsOnCPU(specification, chain.GetData());
+                memcpy(destination, chain.GetData(), size);
+            }
+        }
+        else
+        {
+            decoded.Failed = !TextureUtils::DecodeFromMemory(encodedBuffer, specification.Format, specification.Width, specification.Height, destination);
+        }
+
+        if (decoded.Failed && decoded.Staging)
+        {
+            m_StagingRing->Free(decoded.Staging);
+            decoded.Staging = {};
+        }
+    }
+
+    decoded.Specification = std::move(specification);
+
+    {
+        std::lock_guard<std::mutex> lock(m_DecodedMutex);
+        m_Decoded.push_back(std::move(decoded));
+    }
+    m_DecodedAvailable.notify_one();
+}
+
+void VulkanTextureLoader::SubmitDecoded(std::vector<LoadedTexture>& completed)
+{
+    std::vector<DecodedTexture> decodedTextures;
+    {
+        std::lock_guard<std::mutex> lock(m_DecodedMutex);
+        decodedTextures.swap(m_Decoded);
+    }
+
+    UploadBatch batch;
+    for (DecodedTexture& decoded : decodedTextures)
+    {
+        if (decoded.Failed)
+        {
+            completed.push_back({ decoded.Id, std::move(decoded.Path), nullptr });
+            m_PendingCount--;
+            continue;
+        }
+
+        std::shared_ptr<VulkanTexture2D> texture = VulkanTexture2D::CreateForUpload(m_DeviceRef, decoded.Specification);
+
+        if (!batch.TransferCmd)
+            batch.TransferCmd = BeginBatchCommandBuffer(m_DeviceRef, QueueType::Transfer);
+
+        if (decoded.DedicatedStaging)
+        {
+            texture->RecordUpload(batch.TransferCmd, decoded.DedicatedStaging->GetBuffer(), 0);
+            batch.DedicatedStaging.push_back(std::move(decoded.DedicatedStaging));
+        }
+        else
+        {
+            texture->RecordUpload(batch.TransferCmd, decoded.Staging.Buffer, decoded.Staging.Offset);
+            batch.Staging.push_back(decoded.Staging);
+        }
+
+        // Blits need a graphics queue, so mip generation for the whole batch goes into one graphics submit.
+        if (texture->RequiresMipGeneration())
+        {
+            if (!batch.GraphicsCmd)
+                batch.GraphicsCmd = BeginBatchCommandBuffer(m_DeviceRef, QueueType::Graphics);
+            texture->RecordGenerateMips(batch.GraphicsCmd);
+        }
+
+        batch.Textures.push_back({ decoded.Id, std::move(decoded.Path), std::move(texture) });
+    }
+
+    if (!batch.TransferCmd)
+        return;
+
+    VkFenceCreateInfo fenceCreateInfo{};
+    fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VK_CHECK_RESULT(vkCreateFence(m_DeviceRef.GetDevice(), &fenceCreateInfo, nullptr, &batch.Fence));
+
+    VK_CHECK_RESULT(vkEndCommandBuffer(batch.TransferCmd));
+
+    VkSubmitInfo transferSubmitInfo{};
+    transferSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    transferSubmitInfo.commandBufferCount = 1;
+    transferSubmitInfo.pCommandBuffers = &batch.TransferCmd;
+
+    if (batch.GraphicsCmd)
+    {
+        VK_CHECK_RESULT(vkEndCommandBuffer(batch.GraphicsCmd));
+
+        VkSemaphoreCreateInfo semaphoreCreateInfo{};
+        semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        VK_CHECK_RESULT(vkCreateSemaphore(m_DeviceRef.GetDevice(), &semaphoreCreateInfo, nullptr, &batch.TransferComplete));
+
+        transferSubmitInfo.signalSemaphoreCount = 1;
+        transferSubmitInfo.pSignalSemaphores = &batch.TransferComplete;
+        VK_CHECK_RESULT(vkQueueSubmit(m_DeviceRef.GetTransferQueue(), 1, &transferSubmitInfo, VK_NULL_HANDLE));
+
+        VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        VkSubmitInfo graphicsSubmitInfo{};
+        graphicsSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        graphicsSubmitInfo.waitSemaphoreCount = 1;
+        graphicsSubmitInfo.pWaitSemaphores = &batch.TransferComplete;
+        graphicsSubmitInfo.pWaitDstStageMask = &waitStage;
+        graphicsSubmitInfo.commandBufferCount = 1;
+        graphicsSubmitInfo.pCommandBuffers = &batch.GraphicsCmd;
+        VK_CHECK_RESULT(vkQueueSubmit(m_DeviceRef.GetGraphicsQueue(), 1, &graphicsSubmitInfo, batch.Fence));
+    }
+    else
+    {
+        VK_CHECK_RESULT(vkQueueSubmit(m_DeviceRef.GetTransferQueue(), 1, &transferSubmitInfo, batch.Fence));
+    }
+
+    m_InFlightBatches.push_back(std::move(batch));
+}
+
+void VulkanTextureLoader::RetireBatches(bool wait, std::vector<LoadedTexture>& completed)
+{
+    VkDevice device = m_DeviceRef.GetDevice();
+
+    while (!m_InFlightBatches.empty())
+    {
+        UploadBatch& batch = m_InFlightBatches.front();
+
+        if (wait)
+            VK_CHECK_RESULT(vkWaitForFences(device, 1, &batch.Fence, VK_TRUE, UINT64_MAX));
+        else if (vkGetFenceStatus(device, batch.Fence) != VK_SUCCESS)
+            break;
+
+        for (const StagingAllocation& staging : batch.Staging)
+            m_StagingRing->Free(staging);
+
+        vkFreeCommandBuffers(device, m_DeviceRef.GetTransferCommandPool(), 1, &batch.TransferCmd);
+        if (batch.GraphicsCmd)
+            vkFreeCommandBuffers(device, m_DeviceRef.GetGraphicsCommandPool(), 1, &batch.GraphicsCmd);
+        if (batch.TransferComplete)
+            vkDestroySemaphore(device, batch.TransferComplete, nullptr);
+        vkDestroyFence(device, batch.Fence, nullptr);
+
+        m_PendingCount -= static_cast<uint32_t>(batch.Textures.size());
+        for (LoadedTexture& loaded : batch.Textures)
+            completed.push_back(std::move(loaded));
+
+        m_InFlightBatches.pop_front();
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "renderer/vulkan/vulkan_device.h"
+#include "renderer/vulkan/vulkan_staging_ring.h"
+#include "renderer/vulkan/vulkan_texture.h"
+#include "core/async_file_reader.h"
+#include "core/thread_pool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+using TextureLoadId = uint64_t;
+
+struct LoadedTexture
+{
+    TextureLoadId Id = 0;
+    std::string Path;
+    // Null when the file could not be read or decoded.
+    std::shared_ptr<VulkanTexture2D> Texture;
+};
+
+// Streams textures from disk without stalling the render thread. Files requested together are read as a
+// batch through AsyncFileReader, then workers decode them straight into a persistently mapped staging ring; Update, called once per frame on the render thread, records
+// everything decoded since the last call into one transfer submit (plus one graphics submit when mips are
+// blitted) and hands back the textures whose batch has finished on the GPU.
+class VulkanTextureLoader
+{
+public:
+    static constexpr VkDeviceSize DefaultStagingCapacity = 64ull * 1024 * 1024;
+
+    explicit VulkanTextureLoader(
+            VulkanDevice& deviceRef,
+            uint32_t workerCount = ThreadPool::GetDefaultWorkerCount(),
+            VkDeviceSize stagingCapacity = DefaultStagingCapacity);
+    ~VulkanTextureLoader();
+
+    VulkanTextureLoader(const VulkanTextureLoader&) = delete;
+    VulkanTextureLoader& operator=(const VulkanTextureLoader&) = delete;
+
+    // Returns immediately and may be called from any thread. Format, Width and Height in the specification
+    // are taken from the file, and KTX2/DDS files also supply MipLevels.
+    TextureLoadId Load(const std::string& filepath, TextureSpecification specification = {});
+
+    std::vector<LoadedTexture> Update();
+    // Blocks until every load issued so far has completed.
+    std::vector<LoadedTexture> Flush();
+
+    [[nodiscard]] uint32_t GetPendingCount() const { return m_PendingCount.load(); }
+    [[nodiscard]] uint32_t GetWorkerCount() const { return m_Workers.GetWorkerCount(); }
+
+private:
+    struct DecodedTexture
+    {
+        TextureLoadId Id;
+        std::string Path;
+        TextureSpecification Specification;
+        StagingAllocation Staging;
+        // Only for images too large for the ring.
+        std::unique_ptr<VulkanBuffer> DedicatedStaging;
+        bool Failed = false;
+    };
+
+    struct UploadBatch
+    {
+        VkCommandBuffer TransferCmd = VK_NULL_HANDLE;
+        VkCommandBuffer GraphicsCmd = VK_NULL_HANDLE;
+        VkSemaphore TransferComplete = VK_NULL_HANDLE;
+        VkFence Fence = VK_NULL_HANDLE;
+
+        std::vector<LoadedTexture> Textures;
+        std::vector<StagingAllocation> Staging;
+        std::vector<std::unique_ptr<VulkanBuffer>> DedicatedStaging;
+    };
+
+    struct ReadRequest
+    {
+        TextureLoadId Id;
+        std::string Path;
+        TextureSpecification Specification;
+    };
+
+    void ReadPending();
+    void Decode(TextureLoadId id, const std::string& filepath, const AsyncFileReader::Result& encoded, TextureSpecification specification);
+    void SubmitDecoded(std::vector<LoadedTexture>& completed);
+    void RetireBatches(bool wait, std::vector<LoadedTexture>& completed);
+
+private:
+    VulkanDevice& m_DeviceRef;
+    std::unique_ptr<VulkanStagingRing> m_StagingRing;
+    // Used only by the read task, of which at most one runs at a time.
+    std::unique_ptr<AsyncFileReader> m_FileReader;
+
+    std::mutex m_ReadMutex;
+    std::deque<ReadRequest> m_PendingReads;
+    bool m_Reading = false;
+
+    std::mutex m_DecodedMutex;
+    std::vector<DecodedTexture> m_Decoded;
+    // Signalled by workers as they add to m_Decoded, for Flush.
+    std::condition_variable m_DecodedAvailable;
+
+    std::deque<UploadBatch> m_InFlightBatches;
+    std::atomic<uint32_t> m_PendingCount{0};
+    std::atomic<TextureLoadId> m_NextId{1};
+
+    ThreadPool m_Workers;
+};
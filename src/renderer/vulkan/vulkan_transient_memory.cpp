@@ -0,0 +1,195 @@
+#include "vulkan_transient_memory.h"
+#include "vulkan_utils.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+VulkanTransientMemoryPool::VulkanTransientMemoryPool(VulkanDevice& deviceRef)
+    : m_DeviceRef(deviceRef)
+{
+    vkGetPhysicalDeviceMemoryProperties(m_DeviceRef.GetPhysicalDevice(), &m_MemoryProperties);
+}
+
+VulkanTransientMemoryPool::~VulkanTransientMemoryPool()
+{
+    for (Block& block : m_Blocks)
+        vkFreeMemory(m_DeviceRef.GetDevice(), block.Memory, nullptr);
+}
+
+bool VulkanTransientMemoryPool::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties, uint32_t& outIndex) const
+{
+    for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++)
+    {
+        if ((typeFilter & (1 << i)) && (m_MemoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            outIndex = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+VulkanTransientMemoryPool::Block* VulkanTransientMemoryPool::FindAliasableBlock(
+        std::vector<Block>& blocks,
+        uint32_t memoryTypeIndex,
+        const Lifetime& lifetime)
+{
+    // Every image sits at offset 0 of its block, so a block fits if it is large enough and none of its
+    // images is alive at the same time. First fit is enough for the handful of targets a frame has.
+    for (Block& block : blocks)
+    {
+        if (block.MemoryTypeIndex != memoryTypeIndex || block.Size < lifetime.Size)
+            continue;
+
+        bool overlaps = std::any_of(block.Images.begin(), block.Images.end(), [&](const Lifetime& other)
+        {
+            return lifetime.FirstPass <= other.LastPass && other.FirstPass <= lifetime.LastPass;
+        });
+        if (!overlaps)
+            return &block;
+    }
+    return nullptr;
+}
+
+void VulkanTransientMemoryPool::Bind(VkImage image, const VkImageCreateInfo& createInfo, uint32_t firstPass, uint32_t lastPass, bool lazy)
+{
+    assert(firstPass <= lastPass);
+
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(m_DeviceRef.GetDevice(), image, &requirements);
+
+    uint32_t memoryTypeIndex = 0;
+    lazy = lazy && FindMemoryType(requirements.memoryTypeBits,
+                                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT,
+                                  memoryTypeIndex);
+    if (!lazy && !FindMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, memoryTypeIndex))
+        throw std::runtime_error("Failed to find a memory type for a transient attachment");
+
+    Lifetime lifetime{image, createInfo, firstPass, lastPass, requirements.size, m_NextBindOrder++};
+    lifetime.CreateInfo.pNext = nullptr;
+
+    if (Block* block = FindAliasableBlock(m_Blocks, memoryTypeIndex, lifetime))
+    {
+        VK_CHECK_RESULT(vkBindImageMemory(m_DeviceRef.GetDevice(), image, block->Memory, 0));
+        block->Images.push_back(lifetime);
+        return;
+    }
+
+    Block block;
+    block.Size = requirements.size;
+    block.MemoryTypeIndex = memoryTypeIndex;
+    block.Lazy = lazy;
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = block.Size;
+    allocInfo.memoryTypeIndex = memoryTypeIndex;
+    VK_CHECK_RESULT(vkAllocateMemory(m_DeviceRef.GetDevice(), &allocInfo, nullptr, &block.Memory));
+    VK_CHECK_RESULT(vkBindImageMemory(m_DeviceRef.GetDevice(), image, block.Memory, 0));
+
+    block.Images.push_back(lifetime);
+    m_Blocks.push_back(std::move(block));
+}
+
+void VulkanTransientMemoryPool::Release(VkImage image)
+{
+    for (auto block = m_Blocks.begin(); block != m_Blocks.end(); ++block)
+    {
+        auto it = std::find_if(block->Images.begin(), block->Images.end(), [&](const Lifetime& lifetime)
+        {
+            return lifetime.Image == image;
+        });
+        if (it == block->Images.end())
+            continue;
+
+        block->Images.erase(it);
+        if (block->Images.empty())
+        {
+            vkFreeMemory(m_DeviceRef.GetDevice(), block->Memory, nullptr);
+            m_Blocks.erase(block);
+        }
+        return;
+    }
+
+    assert(false && "Image is not bound to this transient pool");
+}
+
+VulkanTransientMemoryPool::Statistics VulkanTransientMemoryPool::GetStatistics() const
+{
+    return Summarize(m_Blocks);
+}
+
+VulkanTransientMemoryPool::Statistics VulkanTransientMemoryPool::EstimateStatistics(uint32_t width, uint32_t height) const
+{
+    struct Placement
+    {
+        const Lifetime* Image;
+        const Block* Source;
+    };
+
+    // Replayed in the order the images were bound, so the estimate packs them as Bind would have.
+    std::vector<Placement> placements;
+    for (const Block& block : m_Blocks)
+    {
+        for (const Lifetime& lifetime : block.Images)
+            placements.push_back({ &lifetime, &block });
+    }
+    std::sort(placements.begin(), placements.end(), [](const Placement& a, const Placement& b)
+    {
+        return a.Image->BindOrder < b.Image->BindOrder;
+    });
+
+    std::vector<Block> blocks;
+    for (const Placement& placement : placements)
+    {
+        // Requirements depend on the implementation's tiling, so they come from a probe image at the new extent.
+        VkImageCreateInfo createInfo = placement.Image->CreateInfo;
+        createInfo.extent.width = width;
+        createInfo.extent.height = height;
+
+        VkImage probe;
+        VK_CHECK_RESULT(vkCreateImage(m_DeviceRef.GetDevice(), &createInfo, nullptr, &probe));
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(m_DeviceRef.GetDevice(), probe, &requirements);
+        vkDestroyImage(m_DeviceRef.GetDevice(), probe, nullptr);
+
+        Lifetime lifetime = *placement.Image;
+        lifetime.Image = VK_NULL_HANDLE;
+        lifetime.Size = requirements.size;
+
+        if (Block* block = FindAliasableBlock(blocks, placement.Source->MemoryTypeIndex, lifetime))
+        {
+            block->Images.push_back(lifetime);
+            continue;
+        }
+
+        Block block;
+        block.Size = lifetime.Size;
+        block.MemoryTypeIndex = placement.Source->MemoryTypeIndex;
+        block.Lazy = placement.Source->Lazy;
+        block.Images.push_back(lifetime);
+        blocks.push_back(std::move(block));
+    }
+
+    return Summarize(blocks);
+}
+
+VulkanTransientMemoryPool::Statistics VulkanTransientMemoryPool::Summarize(const std::vector<Block>& blocks)
+{
+    Statistics statistics;
+    for (const Block& block : blocks)
+    {
+        statistics.AllocatedBytes += block.Size;
+        if (block.Lazy)
+            statistics.LazyBytes += block.Size;
+        statistics.BlockCount++;
+
+        for (const Lifetime& lifetime : block.Images)
+        {
+            statistics.RequestedBytes += lifetime.Size;
+            statistics.ImageCount++;
+        }
+    }
+    return statistics;
+}
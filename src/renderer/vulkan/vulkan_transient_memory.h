@@ -0,0 +1,74 @@
+#pragma once
+
+#include "renderer/vulkan/vulkan_device.h"
+
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Backs render targets whose contents never outlive the pass that uses them. Each image is bound with the
+// range of passes it is alive in, on a timeline whose passes never execute concurrently; images whose
+// ranges do not overlap are bound to the same memory. Transient images go to lazily allocated memory
+// when the device has it, which tiling GPUs may never commit at all.
+class VulkanTransientMemoryPool
+{
+public:
+    struct Statistics
+    {
+        VkDeviceSize RequestedBytes = 0;    // Sum of every bound image's requirements
+        VkDeviceSize AllocatedBytes = 0;    // Memory actually allocated, including lazily allocated blocks
+        VkDeviceSize LazyBytes = 0;         // Part of AllocatedBytes in lazily allocated memory
+        uint32_t BlockCount = 0;
+        uint32_t ImageCount = 0;
+    };
+
+    explicit VulkanTransientMemoryPool(VulkanDevice& deviceRef);
+    ~VulkanTransientMemoryPool();
+
+    VulkanTransientMemoryPool(const VulkanTransientMemoryPool&) = delete;
+    VulkanTransientMemoryPool& operator=(const VulkanTransientMemoryPool&) = delete;
+
+    // The image must be in VK_IMAGE_LAYOUT_UNDEFINED at the start of each use, since an aliased image may
+    // have been overwritten since. Set lazy only for images created with VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT.
+    // createInfo is what the image was created from, kept for EstimateStatistics; its pNext is ignored.
+    void Bind(VkImage image, const VkImageCreateInfo& createInfo, uint32_t firstPass, uint32_t lastPass, bool lazy);
+    // Call before destroying a bound image. Memory is freed with its last image.
+    void Release(VkImage image);
+
+    [[nodiscard]] Statistics GetStatistics() const;
+    // What the bound images would request and be allocated if they were all recreated at width x height,
+    // placed the same way Bind places them. Nothing is allocated.
+    [[nodiscard]] Statistics EstimateStatistics(uint32_t width, uint32_t height) const;
+
+private:
+    struct Lifetime
+    {
+        VkImage Image;
+        VkImageCreateInfo CreateInfo;
+        uint32_t FirstPass;
+        uint32_t LastPass;
+        VkDeviceSize Size;
+        uint64_t BindOrder;
+    };
+
+    struct Block
+    {
+        VkDeviceMemory Memory = VK_NULL_HANDLE;
+        VkDeviceSize Size = 0;
+        uint32_t MemoryTypeIndex = 0;
+        bool Lazy = false;
+        std::vector<Lifetime> Images;
+    };
+
+    bool FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties, uint32_t& outIndex) const;
+
+    // First block of the memory type that is large enough and has no image alive at the same time, if any.
+    static Block* FindAliasableBlock(std::vector<Block>& blocks, uint32_t memoryTypeIndex, const Lifetime& lifetime);
+    static Statistics Summarize(const std::vector<Block>& blocks);
+
+private:
+    VulkanDevice& m_DeviceRef;
+    VkPhysicalDeviceMemoryProperties m_MemoryProperties{};
+    std::vector<Block> m_Blocks;
+    uint64_t m_NextBindOrder = 0;
+};
@@ -0,0 +1,317 @@
+#include "vulkan_virtual_texture.h"
+#include "vulkan_swapchain.h"
+#include "vulkan_utils.h"
+#include "core/profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    // Width, height, mip count, page size | border << 16; read by SampleVirtualTexture.
+    constexpr VkDeviceSize FeedbackHeaderSize = 4 * sizeof(uint32_t);
+}
+
+VulkanVirtualTexture::VulkanVirtualTexture(
+        VulkanDevice& deviceRef,
+        VulkanBindlessTable& bindlessTableRef,
+        const std::string& filepath,
+        VirtualTextureSpecification specification)
+    : m_DeviceRef(deviceRef),
+      m_BindlessTableRef(bindlessTableRef),
+      m_Specification(specification),
+      m_Workers(std::max(specification.WorkerCount, 1u))
+{
+    m_File = std::make_unique<VirtualTextureFile>(filepath);
+    m_PagePool = std::make_unique<PoolAllocator>("VirtualTexturePages", m_File->GetPageByteSize(), 32);
+    const VirtualTextureLayout& layout = m_File->GetLayout();
+
+    ImageFormat format = TextureUtils::FromVulkanFormat(m_File->GetFormat());
+    if (format == ImageFormat::None)
+        throw std::runtime_error("Unsupported virtual texture format: " + filepath);
+
+    // Indirection entries address slots with 8 bits per axis.
+    uint32_t maxSlotsPerSide = m_DeviceRef.PhysicalDeviceProperties.limits.maxImageDimension2D / layout.GetPaddedPageSize();
+    uint32_t slotsPerSide = std::min({ m_Specification.PhysicalSlotsPerSide, maxSlotsPerSide, 256u });
+    m_Cache = std::make_unique<VirtualPageCache>(layout, slotsPerSide, slotsPerSide);
+
+    CreateResources(format, slotsPerSide);
+    LoadRootPage();
+}
+
+VulkanVirtualTexture::~VulkanVirtualTexture()
+{
+    m_Workers.WaitIdle();
+
+    m_BindlessTableRef.ReleaseTexture(m_PhysicalHandle);
+    m_BindlessTableRef.ReleaseTexture(m_IndirectionHandle);
+    for (FrameResources& frame : m_Frames)
+        m_BindlessTableRef.ReleaseStorageBuffer(frame.FeedbackHandle);
+}
+
+void VulkanVirtualTexture::CreateResources(ImageFormat format, uint32_t slotsPerSide)
+{
+    const VirtualTextureLayout& layout = m_File->GetLayout();
+
+    // Pages carry their own borders, so a clamped bilinear fetch never reaches a neighbouring slot.
+    TextureSpecification physicalSpec{};
+    physicalSpec.Format = format;
+    physicalSpec.Width = slotsPerSide * layout.GetPaddedPageSize();
+    physicalSpec.Height = slotsPerSide * layout.GetPaddedPageSize();
+    physicalSpec.SamplerWrap = TextureWrap::Clamp;
+    physicalSpec.GenerateMips = false;
+    physicalSpec.DebugName = "Virtual Texture Physical Pages";
+    m_Physical = VulkanTexture2D::CreateForUpload(m_DeviceRef, physicalSpec);
+
+    // Read with texelFetch, one level per page level.
+    TextureSpecification indirectionSpec{};
+    indirectionSpec.Format = ImageFormat::RGBA;
+    indirectionSpec.Width = layout.GetGridWidth(0);
+    indirectionSpec.Height = layout.GetGridHeight(0);
+    indirectionSpec.SamplerWrap = TextureWrap::Clamp;
+    indirectionSpec.SamplerFilter = TextureFilter::Nearest;
+    indirectionSpec.GenerateMips = false;
+    indirectionSpec.MipLevels = layout.GetMipCount();
+    indirectionSpec.DebugName = "Virtual Texture Indirection";
+    m_Indirection = VulkanTexture2D::CreateForUpload(m_DeviceRef, indirectionSpec);
+
+    m_PhysicalHandle = m_BindlessTableRef.RegisterTexture(m_Physical->GetDescriptorInfo());
+    m_IndirectionHandle = m_BindlessTableRef.RegisterTexture(m_Indirection->GetDescriptorInfo());
+
+    m_IndirectionRegions.resize(layout.GetMipCount());
+    for (uint32_t mip = 0; mip < layout.GetMipCount(); mip++)
+    {
+        VkBufferImageCopy& region = m_IndirectionRegions[mip];
+        region.bufferOffset = static_cast<VkDeviceSize>(layout.GetGridIndex({ mip, 0, 0 })) * 4;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = mip;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = { layout.GetGridWidth(mip), layout.GetGridHeight(mip), 1 };
+    }
+
+    uint32_t feedbackWords = (layout.GetGridPageCount() + 31) / 32;
+    VkDeviceSize feedbackSize = FeedbackHeaderSize + feedbackWords * sizeof(uint32_t);
+    const uint32_t feedbackHeader[4] = {
+        layout.GetWidth(), layout.GetHeight(), layout.GetMipCount(), layout.GetPageSize() | (layout.GetBorder() << 16)
+    };
+
+    m_Frames.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
+    for (FrameResources& frame : m_Frames)
+    {
+        // Host visible so the bitset is read and cleared in place once the frame's fence has signalled.
+        frame.Feedback = std::make_unique<VulkanBuffer>(
+                m_DeviceRef,
+                feedbackSize,
+                1,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        frame.Feedback->Map();
+        std::memset(frame.Feedback->GetMappedMemory(), 0, feedbackSize);
+        std::memcpy(frame.Feedback->GetMappedMemory(), feedbackHeader, sizeof(feedbackHeader));
+        frame.FeedbackHandle = m_BindlessTableRef.RegisterStorageBuffer(frame.Feedback->DescriptorInfo());
+
+        frame.PageStaging = std::make_unique<VulkanBuffer>(
+                m_DeviceRef,
+                m_File->GetPageByteSize(),
+                m_Specification.MaxUploadsPerFrame,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        frame.PageStaging->Map();
+
+        frame.IndirectionStaging = std::make_unique<VulkanBuffer>(
+                m_DeviceRef,
+                static_cast<VkDeviceSize>(layout.GetGridPageCount()) * 4,
+                1,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        frame.IndirectionStaging->Map();
+    }
+}
+
+void VulkanVirtualTexture::LoadRootPage()
+{
+    // The coarsest page stays resident, so every lookup has something to fall back to.
+    const VirtualTextureLayout& layout = m_File->GetLayout();
+    VirtualPage root = { layout.GetMipCount() - 1, 0, 0 };
+
+    LoadedPage loaded{ root, Buffer(m_File->GetPageByteSize(), *m_PagePool) };
+    if (!m_File->ReadPage(root, loaded.Data.GetData()))
+        throw std::runtime_error("Failed to read the root page of a virtual texture.");
+
+    uint32_t slot = m_Cache->MakeResident(root, 0);
+    m_Cache->Pin(root);
+
+    FrameResources& frame = m_Frames[0];
+    StagePage(frame, loaded, slot);
+    m_Cache->UpdateIndirection(m_IndirectionEntries);
+    StageIndirection(frame);
+
+    // Both images leave UNDEFINED here; every later copy finds them in their shader-read layout.
+    VkCommandBuffer cmdBuffer = m_DeviceRef.BeginSingleTimeCommands(QueueType::Compute);
+    RecordCopies(cmdBuffer, *m_Physical, frame.PageStaging->GetBuffer(), frame.PageCopies,
+                 0, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+    RecordCopies(cmdBuffer, *m_Indirection, frame.IndirectionStaging->GetBuffer(), m_IndirectionRegions,
+                 0, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+    m_DeviceRef.EndSingleTimeCommand(cmdBuffer, QueueType::Compute);
+
+    frame.PageCopies.clear();
+    frame.IndirectionPending = false;
+}
+
+bool VulkanVirtualTexture::Update(uint32_t frameIndex, uint64_t frameNumber)
+{
+    PROFILE_ZONE("VirtualTexture::Update");
+    FrameResources& frame = m_Frames[frameIndex];
+    frame.PageCopies.clear();
+    frame.IndirectionPending = false;
+
+    // Pages wanted by the frame that last used these resources. Requests beyond the read budget are
+    // dropped; they are asked for again by the next frame that still sees them.
+    auto* requestedPages = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(frame.Feedback->GetMappedMemory()) + FeedbackHeaderSize);
+    uint32_t readsInFlight = m_ReadsInFlight.load();
+    uint32_t readBudget = m_Specification.MaxReadsInFlight > readsInFlight ? m_Specification.MaxReadsInFlight - readsInFlight : 0;
+
+    m_Requests.clear();
+    m_Cache->ProcessFeedback(requestedPages, frameNumber, m_Requests, readBudget);
+    std::memset(requestedPages, 0, (m_File->GetLayout().GetGridPageCount() + 31) / 32 * sizeof(uint32_t));
+
+    for (const VirtualPage& page : m_Requests)
+    {
+        m_ReadsInFlight++;
+        m_Workers.Submit([this, page]()
+        {
+            LoadedPage loaded{ page, Buffer(m_File->GetPageByteSize(), *m_PagePool) };
+            loaded.Failed = !m_File->ReadPage(page, loaded.Data.GetData());
+
+            std::lock_guard<std::mutex> lock(m_LoadedMutex);
+            m_Loaded.push_back(std::move(loaded));
+        });
+    }
+
+    std::vector<LoadedPage> uploads;
+    {
+        std::lock_guard<std::mutex> lock(m_LoadedMutex);
+        while (!m_Loaded.empty() && uploads.size() < m_Specification.MaxUploadsPerFrame)
+        {
+            uploads.push_back(std::move(m_Loaded.front()));
+            m_Loaded.pop_front();
+        }
+    }
+
+    for (const LoadedPage& loaded : uploads)
+    {
+        m_ReadsInFlight--;
+        if (loaded.Failed)
+        {
+            std::cerr << "Failed to read virtual texture page " << loaded.Page.Mip << " (" << loaded.Page.X << ", " << loaded.Page.Y << ")" << std::endl;
+            m_Cache->CancelLoad(loaded.Page);
+            continue;
+        }
+
+        // Every slot was touched this frame; the page is requested again once one frees up.
+        uint32_t slot = m_Cache->MakeResident(loaded.Page, frameNumber);
+        if (slot == VirtualPageCache::InvalidSlot)
+        {
+            m_Cache->CancelLoad(loaded.Page);
+            continue;
+        }
+        StagePage(frame, loaded, slot);
+    }
+
+    if (m_Cache->UpdateIndirection(m_IndirectionEntries))
+        StageIndirection(frame);
+
+    return frame.IndirectionPending;
+}
+
+void VulkanVirtualTexture::RecordUploads(VkCommandBuffer cmdBuffer, uint32_t frameIndex)
+{
+    FrameResources& frame = m_Frames[frameIndex];
+
+    // Earlier frames on this queue may still be sampling the slots being replaced.
+    if (!frame.PageCopies.empty())
+    {
+        RecordCopies(cmdBuffer, *m_Physical, frame.PageStaging->GetBuffer(), frame.PageCopies,
+                     VK_ACCESS_SHADER_READ_BIT, m_Physical->GetDescriptorInfo().imageLayout, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    }
+
+    if (frame.IndirectionPending)
+    {
+        RecordCopies(cmdBuffer, *m_Indirection, frame.IndirectionStaging->GetBuffer(), m_IndirectionRegions,
+                     VK_ACCESS_SHADER_READ_BIT, m_Indirection->GetDescriptorInfo().imageLayout, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    }
+}
+
+glm::uvec3 VulkanVirtualTexture::GetHandles(uint32_t frameIndex) const
+{
+    return { m_IndirectionHandle, m_PhysicalHandle, m_Frames[frameIndex].FeedbackHandle };
+}
+
+void VulkanVirtualTexture::StagePage(FrameResources& frame, const LoadedPage& loaded, uint32_t slot)
+{
+    const VirtualTextureLayout& layout = m_File->GetLayout();
+    uint32_t paddedPageSize = layout.GetPaddedPageSize();
+    uint32_t slotsPerRow = m_Cache->GetSlotsPerRow();
+
+    VkDeviceSize offset = frame.PageCopies.size() * static_cast<VkDeviceSize>(m_File->GetPageByteSize());
+    std::memcpy(static_cast<uint8_t*>(frame.PageStaging->GetMappedMemory()) + offset, loaded.Data.GetData(), loaded.Data.GetSize());
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = offset;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {
+        static_cast<int32_t>((slot % slotsPerRow) * paddedPageSize),
+        static_cast<int32_t>((slot / slotsPerRow) * paddedPageSize),
+        0
+    };
+    region.imageExtent = { paddedPageSize, paddedPageSize, 1 };
+    frame.PageCopies.push_back(region);
+}
+
+void VulkanVirtualTexture::StageIndirection(FrameResources& frame)
+{
+    std::memcpy(frame.IndirectionStaging->GetMappedMemory(), m_IndirectionEntries.data(), m_IndirectionEntries.size());
+    frame.IndirectionPending = true;
+}
+
+void VulkanVirtualTexture::RecordCopies(
+        VkCommandBuffer cmdBuffer,
+        VulkanTexture2D& texture,
+        VkBuffer source,
+        const std::vector<VkBufferImageCopy>& regions,
+        VkAccessFlags srcAccessMask,
+        VkImageLayout oldLayout,
+        VkPipelineStageFlags srcStageMask)
+{
+    VkImage image = texture.GetImage()->GetImageInfo().Image;
+    VkImageLayout readLayout = texture.GetDescriptorInfo().imageLayout;
+
+    VkImageSubresourceRange subresourceRange = {};
+    subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    subresourceRange.levelCount = texture.GetImage()->GetSpecification().Mips;
+    subresourceRange.layerCount = 1;
+
+    ImageUtils::InsertImageMemoryBarrier(
+            cmdBuffer, image,
+            srcAccessMask, VK_ACCESS_TRANSFER_WRITE_BIT,
+            oldLayout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            srcStageMask, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            subresourceRange);
+
+    vkCmdCopyBufferToImage(
+            cmdBuffer, source, image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            static_cast<uint32_t>(regions.size()), regions.data());
+
+    ImageUtils::InsertImageMemoryBarrier(
+            cmdBuffer, image,
+            VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, readLayout,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            subresourceRange);
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "renderer/vulkan/vulkan_bindless.h"
+#include "renderer/vulkan/vulkan_buffer.h"
+#include "renderer/vulkan/vulkan_device.h"
+#include "renderer/vulkan/vulkan_texture.h"
+#include "renderer/texture/virtual_page_cache.h"
+#include "renderer/texture/virtual_texture_file.h"
+#include "core/thread_pool.h"
+
+#include <atomic>
+#include <deque>
+#include <glm/glm.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+struct VirtualTextureSpecification
+{
+    // The physical cache is a square atlas of padded pages; 30 slots of 136 texels stay within the
+    // 4096 texel image size every device supports.
+    uint32_t PhysicalSlotsPerSide = 30;
+    uint32_t MaxUploadsPerFrame = 32;
+    uint32_t MaxReadsInFlight = 64;
+    uint32_t WorkerCount = 2;
+};
+
+// A texture far larger than VRAM, paged in from a VirtualTextureFile on demand. Shaders sample it through
+// SampleVirtualTexture (virtual_texture.glsl) with the three bindless handles from GetHandles, and set bits
+// in the frame's feedback buffer for the pages they wanted. Update turns that feedback into page reads on
+// worker threads, and RecordUploads copies finished pages into the physical atlas and refreshes the
+// indirection texture that maps every page to its resident slot or to its nearest resident ancestor.
+class VulkanVirtualTexture
+{
+public:
+    // Throws std::runtime_error when the file cannot be read or its format is not supported by the device.
+    VulkanVirtualTexture(
+            VulkanDevice& deviceRef,
+            VulkanBindlessTable& bindlessTableRef,
+            const std::string& filepath,
+            VirtualTextureSpecification specification = {});
+    ~VulkanVirtualTexture();
+
+    VulkanVirtualTexture(const VulkanVirtualTexture&) = delete;
+    VulkanVirtualTexture& operator=(const VulkanVirtualTexture&) = delete;
+
+    // Call once the fence of the frame that last used frameIndex has signalled, before recording the frame.
+    // Consumes that frame's feedback, queues reads and stages finished pages. Returns true when the image
+    // the shaders see will change, so accumulated samples are stale.
+    bool Update(uint32_t frameIndex, uint64_t frameNumber);
+    // Records the staged copies into the frame's command buffer ahead of any shading that samples them.
+    // The queue must be the one the shaders run on, so the copies are ordered after earlier frames' reads.
+    void RecordUploads(VkCommandBuffer cmdBuffer, uint32_t frameIndex);
+
+    // x: indirection texture, y: physical texture, z: the frame's feedback buffer.
+    [[nodiscard]] glm::uvec3 GetHandles(uint32_t frameIndex) const;
+    [[nodiscard]] const VirtualTextureLayout& GetLayout() const { return m_File->GetLayout(); }
+    [[nodiscard]] const VirtualPageCache::Statistics& GetStatistics() const { return m_Cache->GetStatistics(); }
+
+private:
+    struct LoadedPage
+    {
+        VirtualPage Page;
+        Buffer Data;
+        bool Failed = false;
+    };
+
+    struct FrameResources
+    {
+        std::unique_ptr<VulkanBuffer> Feedback;
+        BindlessHandle FeedbackHandle = InvalidBindlessHandle;
+
+        std::unique_ptr<VulkanBuffer> PageStaging;
+        std::unique_ptr<VulkanBuffer> IndirectionStaging;
+        std::vector<VkBufferImageCopy> PageCopies;
+        bool IndirectionPending = false;
+    };
+
+    void CreateResources(ImageFormat format, uint32_t slotsPerSide);
+    void LoadRootPage();
+    void StagePage(FrameResources& frame, const LoadedPage& loaded, uint32_t slot);
+    void StageIndirection(FrameResources& frame);
+    // Moves the whole image to TRANSFER_DST, copies the regions and hands it back to compute shader reads.
+    void RecordCopies(
+            VkCommandBuffer cmdBuffer,
+            VulkanTexture2D& texture,
+            VkBuffer source,
+            const std::vector<VkBufferImageCopy>& regions,
+            VkAccessFlags srcAccessMask,
+            VkImageLayout oldLayout,
+            VkPipelineStageFlags srcStageMask);
+
+private:
+    VulkanDevice& m_DeviceRef;
+    VulkanBindlessTable& m_BindlessTableRef;
+    VirtualTextureSpecification m_Specification;
+
+    std::unique_ptr<VirtualTextureFile> m_File;
+    std::unique_ptr<VirtualPageCache> m_Cache;
+    // Every page read is the same size, so workers recycle blocks instead of hitting the heap per page.
+    std::unique_ptr<PoolAllocator> m_PagePool;
+
+    std::shared_ptr<VulkanTexture2D> m_Physical;
+    std::shared_ptr<VulkanTexture2D> m_Indirection;
+    BindlessHandle m_PhysicalHandle = InvalidBindlessHandle;
+    BindlessHandle m_IndirectionHandle = InvalidBindlessHandle;
+
+    std::vector<FrameResources> m_Frames;
+    std::vector<uint8_t> m_IndirectionEntries;
+    std::vector<VkBufferImageCopy> m_IndirectionRegions;
+    std::vector<VirtualPage> m_Requests;
+
+    std::mutex m_LoadedMutex;
+    std::deque<LoadedPage> m_Loaded;
+    std::atomic<uint32_t> m_ReadsInFlight{0};
+
+    // Last, so workers are joined before anything they write to is destroyed.
+    ThreadPool m_Workers;
+};
@@ -0,0 +1,417 @@
+#include "wavefront_path_tracer.h"
+#include "renderer/vulkan/vulkan_swapchain.h"
+#include "renderer/vulkan/vulkan_utils.h"
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+
+static_assert(sizeof(WavefrontCounters) == 32, "WavefrontCounters must match the std430 Counters block");
+static_assert(offsetof(WavefrontCounters, ExtendDispatch) == 16, "ExtendDispatch must sit at the uvec4 offset");
+
+// Path state is four vec4s, a hit record one uvec4; see wavefront.glsl.
+static constexpr VkDeviceSize PathStateSize = 64;
+static constexpr VkDeviceSize HitRecordSize = 16;
+
+WavefrontPathTracer::WavefrontPathTracer(
+        VulkanDevice& deviceRef,
+        VulkanDescriptorSetLayout& globalSetLayout,
+        VulkanBindlessTable& bindlessTableRef,
+        SamplerType sampler)
+    : m_DeviceRef(deviceRef),
+      m_BindlessTableRef(bindlessTableRef),
+      m_Sampler(sampler),
+      m_PushConstants(deviceRef, VK_SHADER_STAGE_COMPUTE_BIT)
+{
+    m_SphereBufferInfos.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
+    CreateCounterBuffers();
+    CreateDescriptors();
+    CreatePipelines(globalSetLayout);
+    AllocateCommandBuffers();
+}
+
+WavefrontPathTracer::~WavefrontPathTracer()
+{
+    vkFreeCommandBuffers(
+            m_DeviceRef.GetDevice(),
+            m_DeviceRef.GetComputeCommandPool(),
+            static_cast<uint32_t>(m_CommandBuffers.size()),
+            m_CommandBuffers.data());
+    vkDestroyPipelineLayout(m_DeviceRef.GetDevice(), m_PipelineLayout, nullptr);
+}
+
+void WavefrontPathTracer::CreateCounterBuffers()
+{
+    m_StatisticsBuffers.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
+    for (auto& buffer : m_StatisticsBuffers)
+    {
+        buffer = std::make_unique<VulkanBuffer>(
+                m_DeviceRef,
+                sizeof(uint32_t),
+                1,
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        buffer->Map();
+    }
+
+    m_CounterBuffer = std::make_unique<VulkanBuffer>(
+            m_DeviceRef,
+            sizeof(WavefrontCounters),
+            1,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    m_SortBinBuffer = std::make_unique<VulkanBuffer>(
+            m_DeviceRef,
+            sizeof(uint32_t),
+            SortBinCount,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+}
+
+void WavefrontPathTracer::CreateDescriptors()
+{
+    auto builder = VulkanDescriptorSetLayout::Builder(m_DeviceRef);
+    // Binding 0: SS BO for Spheres
+    builder.AddBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+    // Binding 1: Accumulation storage image
+    builder.AddBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT);
+    // Bindings 2 - 9: Paths, hits, in queue, out queue, counters, sort bins, sort ranks, sorted queue
+    for (uint32_t binding = 2; binding <= 9; binding++)
+        builder.AddBinding(binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+    // Binding 10: This frame's display image
+    builder.AddBinding(10, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT);
+    m_DescriptorSetLayout = builder.Build();
+
+    constexpr uint32_t setCount = VulkanSwapchain::MAX_FRAMES_IN_FLIGHT * 2;
+    m_DescriptorPool = VulkanDescriptorPool::Builder(m_DeviceRef)
+            .SetMaxSets(setCount)
+            .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, setCount * 9)
+            .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, setCount * 2)
+            .Build();
+
+    m_DescriptorSets.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT, { VK_NULL_HANDLE, VK_NULL_HANDLE });
+}
+
+void WavefrontPathTracer::CreatePipelines(VulkanDescriptorSetLayout& globalSetLayout)
+{
+    const std::vector<VkDescriptorSetLayout> descriptorSetLayouts
+    {
+        globalSetLayout.GetDescriptorSetLayout(),
+        m_DescriptorSetLayout->GetDescriptorSetLayout(),
+        m_BindlessTableRef.GetDescriptorSetLayout().GetDescriptorSetLayout()
+    };
+
+    VkPushConstantRange pushConstantRange = m_PushConstants.GetRange();
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    VK_CHECK_RESULT(vkCreatePipelineLayout(m_DeviceRef.GetDevice(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout));
+
+    // Every stage shares the one layout, so the sets stay bound across pipeline switches. Specialization
+    // constant 0 selects the sampler; stages that draw no random numbers ignore it.
+    const std::array<uint32_t, 1> specializationConstants{ static_cast<uint32_t>(m_Sampler) };
+    m_GeneratePipeline = std::make_unique<VulkanComputePipeline>(m_DeviceRef, "../assets/shaders/wavefront_generate.comp.spv", m_PipelineLayout, specializationConstants);
+    m_ExtendPipeline = std::make_unique<VulkanComputePipeline>(m_DeviceRef, "../assets/shaders/wavefront_extend.comp.spv", m_PipelineLayout, specializationConstants);
+    m_SortScanPipeline = std::make_unique<VulkanComputePipeline>(m_DeviceRef, "../assets/shaders/wavefront_sort_scan.comp.spv", m_PipelineLayout, specializationConstants);
+    m_SortScatterPipeline = std::make_unique<VulkanComputePipeline>(m_DeviceRef, "../assets/shaders/wavefront_sort_scatter.comp.spv", m_PipelineLayout, specializationConstants);
+    m_ShadePipeline = std::make_unique<VulkanComputePipeline>(m_DeviceRef, "../assets/shaders/wavefront_shade.comp.spv", m_PipelineLayout, specializationConstants);
+    m_AdvancePipeline = std::make_unique<VulkanComputePipeline>(m_DeviceRef, "../assets/shaders/wavefront_advance.comp.spv", m_PipelineLayout, specializationConstants);
+    m_ConnectPipeline = std::make_unique<VulkanComputePipeline>(m_DeviceRef, "../assets/shaders/wavefront_connect.comp.spv", m_PipelineLayout, specializationConstants);
+}
+
+void WavefrontPathTracer::AllocateCommandBuffers()
+{
+    m_CommandBuffers.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = static_cast<uint32_t>(m_CommandBuffers.size());
+    allocInfo.commandPool = m_DeviceRef.GetComputeCommandPool();
+    VK_CHECK_RESULT(vkAllocateCommandBuffers(m_DeviceRef.GetDevice(), &allocInfo, m_CommandBuffers.data()));
+}
+
+void WavefrontPathTracer::Resize(uint32_t width, uint32_t height)
+{
+    if (width == m_Width && height == m_Height && m_AccumulationImage)
+        return;
+
+    m_Width = width;
+    m_Height = height;
+
+    ImageSpecification spec{};
+    spec.DebugName = "Wavefront Accumulation";
+    spec.Format = ImageFormat::RGBA32F;
+    spec.Usage = ImageUsage::Storage;
+    spec.Width = width;
+    spec.Height = height;
+    spec.ExclusiveQueueOwnership = true;
+    // Read back by PathTracerBenchmark to measure convergence.
+    spec.UsedInTransferOps = true;
+    m_AccumulationImage = std::make_shared<VulkanImage2D>(m_DeviceRef, spec);
+    m_AccumulationImage->Invalidate();
+
+    spec.Format = ImageFormat::RGBA16F;
+    spec.UsedInTransferOps = false;
+    m_DisplayImages.resize(VulkanSwapchain::MAX_FRAMES_IN_FLIGHT);
+    for (uint32_t i = 0; i < VulkanSwapchain::MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        spec.DebugName = "Wavefront Display " + std::to_string(i);
+        m_DisplayImages[i] = std::make_shared<VulkanImage2D>(m_DeviceRef, spec);
+        m_DisplayImages[i]->Invalidate();
+    }
+
+    // One path per pixel; every per-path buffer is sized to the film.
+    const uint32_t pathCount = width * height;
+    constexpr VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    constexpr VkMemoryPropertyFlags memory = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+    m_PathBuffer = std::make_unique<VulkanBuffer>(m_DeviceRef, PathStateSize, pathCount, usage, memory);
+    m_HitBuffer = std::make_unique<VulkanBuffer>(m_DeviceRef, HitRecordSize, pathCount, usage, memory);
+    m_SortRankBuffer = std::make_unique<VulkanBuffer>(m_DeviceRef, sizeof(uint32_t), pathCount, usage, memory);
+    m_SortedQueueBuffer = std::make_unique<VulkanBuffer>(m_DeviceRef, sizeof(uint32_t), pathCount, usage, memory);
+    for (auto& queue : m_QueueBuffers)
+        queue = std::make_unique<VulkanBuffer>(m_DeviceRef, sizeof(uint32_t), pathCount, usage, memory);
+
+    WriteDescriptorSets();
+}
+
+void WavefrontPathTracer::SetSphereBuffer(uint32_t frameIndex, const VkDescriptorBufferInfo& sphereBufferInfo)
+{
+    m_SphereBufferInfos[frameIndex] = sphereBufferInfo;
+    WriteDescriptorSets();
+}
+
+void WavefrontPathTracer::WriteDescriptorSets()
+{
+    if (!m_AccumulationImage)
+        return;
+
+    for (uint32_t i = 0; i < VulkanSwapchain::MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        if (m_SphereBufferInfos[i].buffer == VK_NULL_HANDLE)
+            continue;
+
+        for (uint32_t parity = 0; parity < 2; parity++)
+        {
+            VkDescriptorBufferInfo sphereInfo = m_SphereBufferInfos[i];
+            VkDescriptorImageInfo imageInfo = m_AccumulationImage->GetDescriptorInfo();
+            VkDescriptorBufferInfo pathInfo = m_PathBuffer->DescriptorInfo();
+            VkDescriptorBufferInfo hitInfo = m_HitBuffer->DescriptorInfo();
+            VkDescriptorBufferInfo inQueueInfo = m_QueueBuffers[parity]->DescriptorInfo();
+            VkDescriptorBufferInfo outQueueInfo = m_QueueBuffers[1 - parity]->DescriptorInfo();
+            VkDescriptorBufferInfo counterInfo = m_CounterBuffer->DescriptorInfo();
+            VkDescriptorBufferInfo sortBinInfo = m_SortBinBuffer->DescriptorInfo();
+            VkDescriptorBufferInfo sortRankInfo = m_SortRankBuffer->DescriptorInfo();
+            VkDescriptorBufferInfo sortedQueueInfo = m_SortedQueueBuffer->DescriptorInfo();
+            VkDescriptorImageInfo displayInfo = m_DisplayImages[i]->GetDescriptorInfo();
+
+            VulkanDescriptorWriter writer(*m_DescriptorSetLayout, *m_DescriptorPool);
+            writer.WriteBuffer(0, &sphereInfo)
+                  .WriteImage(1, &imageInfo)
+                  .WriteBuffer(2, &pathInfo)
+                  .WriteBuffer(3, &hitInfo)
+                  .WriteBuffer(4, &inQueueInfo)
+                  .WriteBuffer(5, &outQueueInfo)
+                  .WriteBuffer(6, &counterInfo)
+                  .WriteBuffer(7, &sortBinInfo)
+                  .WriteBuffer(8, &sortRankInfo)
+                  .WriteBuffer(9, &sortedQueueInfo)
+                  .WriteImage(10, &displayInfo);
+
+            if (m_DescriptorSets[i][parity] == VK_NULL_HANDLE)
+                writer.Build(m_DescriptorSets[i][parity]);
+            else
+                writer.Overwrite(m_DescriptorSets[i][parity]);
+        }
+    }
+}
+
+void WavefrontPathTracer::InsertBarrier(
+        VkCommandBuffer cmdBuffer,
+        VkPipelineStageFlags srcStage,
+        VkAccessFlags srcAccess,
+        VkPipelineStageFlags dstStage,
+        VkAccessFlags dstAccess)
+{
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    vkCmdPipelineBarrier(cmdBuffer, srcStage, dstStage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+void WavefrontPathTracer::ComputeBarrier(VkCommandBuffer cmdBuffer)
+{
+    // Each stage consumes the previous stage's buffers, and the counters double as indirect arguments.
+    InsertBarrier(
+            cmdBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_ACCESS_SHADER_WRITE_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+            VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+}
+
+void WavefrontPathTracer::BindQueueSet(VkCommandBuffer cmdBuffer, uint32_t frameIndex, uint32_t parity, VkDescriptorSet globalSet)
+{
+    const std::array<VkDescriptorSet, 3> sets
+    {
+        globalSet,
+        m_DescriptorSets[frameIndex][parity],
+        m_BindlessTableRef.GetDescriptorSet()
+    };
+
+    vkCmdBindDescriptorSets(
+            cmdBuffer,
+            VK_PIPELINE_BIND_POINT_COMPUTE,
+            m_PipelineLayout,
+            0,
+            static_cast<uint32_t>(sets.size()),
+            sets.data(),
+            0,
+            nullptr);
+}
+
+void WavefrontPathTracer::Record(
+        VkCommandBuffer cmdBuffer,
+        uint32_t frameIndex,
+        VkDescriptorSet globalSet,
+        const FramePushConstants& pushConstants)
+{
+    assert(m_DescriptorSets[frameIndex][0] != VK_NULL_HANDLE && "Wavefront path tracer recorded before its sphere buffer and size were set");
+
+    const uint32_t pathCount = m_Width * m_Height;
+    const VkBuffer counterBuffer = m_CounterBuffer->GetBuffer();
+    const uint32_t pixelGroupsX = VulkanComputePipeline::GetGroupCount(m_Width, TileSize);
+    const uint32_t pixelGroupsY = VulkanComputePipeline::GetGroupCount(m_Height, TileSize);
+
+    // The previous submission's stages may still be reading the counters and film.
+    InsertBarrier(
+            cmdBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_ACCESS_TRANSFER_WRITE_BIT);
+    vkCmdFillBuffer(cmdBuffer, counterBuffer, offsetof(WavefrontCounters, RaysTraced), sizeof(uint32_t), 0);
+
+    WavefrontPushConstants wavefrontConstants{};
+    wavefrontConstants.Frame = pushConstants;
+    wavefrontConstants.SortRays = m_SortRays ? 1 : 0;
+
+    for (uint32_t sampleIndex = 0; sampleIndex < pushConstants.SampleCount; sampleIndex++)
+    {
+        wavefrontConstants.SampleIndex = sampleIndex;
+
+        // Every path starts live.
+        WavefrontCounters counters{};
+        counters.ActiveCount = pathCount;
+        counters.ExtendDispatch = { VulkanComputePipeline::GetGroupCount(pathCount, GroupSize), 1, 1 };
+        vkCmdUpdateBuffer(cmdBuffer, counterBuffer, 0, 2 * sizeof(uint32_t), &counters);
+        vkCmdUpdateBuffer(
+                cmdBuffer,
+                counterBuffer,
+                offsetof(WavefrontCounters, ExtendDispatch),
+                sizeof(VkDispatchIndirectCommand),
+                &counters.ExtendDispatch);
+        InsertBarrier(
+                cmdBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_ACCESS_TRANSFER_WRITE_BIT,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+
+        // Generate
+        BindQueueSet(cmdBuffer, frameIndex, 0, globalSet);
+        wavefrontConstants.Bounce = 0;
+        m_PushConstants.Push(cmdBuffer, m_PipelineLayout, wavefrontConstants);
+        m_GeneratePipeline->Bind(cmdBuffer);
+        m_GeneratePipeline->Dispatch(cmdBuffer, pixelGroupsX, pixelGroupsY);
+        ComputeBarrier(cmdBuffer);
+
+        // Bounces run 0..MaxBounceCount inclusive, like the megakernel. Dispatch sizes come from the
+        // previous bounce's compacted queue, so rays that terminated early cost no further work.
+        for (uint32_t bounce = 0; bounce <= pushConstants.MaxBounceCount; bounce++)
+        {
+            const uint32_t parity = bounce % 2;
+            if (bounce != 0)
+                BindQueueSet(cmdBuffer, frameIndex, parity, globalSet);
+
+            wavefrontConstants.Bounce = bounce;
+            m_PushConstants.Push(cmdBuffer, m_PipelineLayout, wavefrontConstants);
+
+            if (m_SortRays)
+            {
+                vkCmdFillBuffer(cmdBuffer, m_SortBinBuffer->GetBuffer(), 0, VK_WHOLE_SIZE, 0);
+                InsertBarrier(
+                        cmdBuffer,
+                        VK_PIPELINE_STAGE_TRANSFER_BIT,
+                        VK_ACCESS_TRANSFER_WRITE_BIT,
+                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+            }
+
+            // Extend
+            m_ExtendPipeline->Bind(cmdBuffer);
+            m_ExtendPipeline->DispatchIndirect(cmdBuffer, counterBuffer, offsetof(WavefrontCounters, ExtendDispatch));
+            ComputeBarrier(cmdBuffer);
+
+            if (m_SortRays)
+            {
+                m_SortScanPipeline->Bind(cmdBuffer);
+                m_SortScanPipeline->Dispatch(cmdBuffer, 1);
+                ComputeBarrier(cmdBuffer);
+
+                m_SortScatterPipeline->Bind(cmdBuffer);
+                m_SortScatterPipeline->DispatchIndirect(cmdBuffer, counterBuffer, offsetof(WavefrontCounters, ExtendDispatch));
+                ComputeBarrier(cmdBuffer);
+            }
+
+            // Shade
+            m_ShadePipeline->Bind(cmdBuffer);
+            m_ShadePipeline->DispatchIndirect(cmdBuffer, counterBuffer, offsetof(WavefrontCounters, ExtendDispatch));
+            ComputeBarrier(cmdBuffer);
+
+            m_AdvancePipeline->Bind(cmdBuffer);
+            m_AdvancePipeline->Dispatch(cmdBuffer, 1);
+            ComputeBarrier(cmdBuffer);
+        }
+
+        // Connect
+        m_ConnectPipeline->Bind(cmdBuffer);
+        m_ConnectPipeline->Dispatch(cmdBuffer, pixelGroupsX, pixelGroupsY);
+        ComputeBarrier(cmdBuffer);
+
+        // The next sample rewrites the counters from the transfer stage.
+        InsertBarrier(
+                cmdBuffer,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                VK_ACCESS_SHADER_WRITE_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT);
+    }
+
+    VkBufferCopy statisticsCopy{};
+    statisticsCopy.srcOffset = offsetof(WavefrontCounters, RaysTraced);
+    statisticsCopy.dstOffset = 0;
+    statisticsCopy.size = sizeof(uint32_t);
+    vkCmdCopyBuffer(cmdBuffer, counterBuffer, m_StatisticsBuffers[frameIndex]->GetBuffer(), 1, &statisticsCopy);
+
+    InsertBarrier(
+            cmdBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_ACCESS_TRANSFER_WRITE_BIT,
+            VK_PIPELINE_STAGE_HOST_BIT,
+            VK_ACCESS_HOST_READ_BIT);
+}
+
+uint64_t WavefrontPathTracer::GetRaysTraced(uint32_t frameIndex) const
+{
+    return *static_cast<const uint32_t*>(m_StatisticsBuffers[frameIndex]->GetMappedMemory());
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "renderer/vulkan/vulkan_device.h"
+#include "renderer/vulkan/vulkan_descriptors.h"
+#include "renderer/vulkan/vulkan_compute_pipeline.h"
+#include "renderer/vulkan/vulkan_push_constants.h"
+#include "renderer/vulkan/vulkan_bindless.h"
+#include "renderer/vulkan/vulkan_buffer.h"
+#include "renderer/vulkan/vulkan_image.h"
+#include "renderer/path_tracer.h"
+#include "renderer/sampler_tables.h"
+#include "core/frame_info.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Matches the WAVEFRONT push constant block in path_tracing.glsl.
+struct WavefrontPushConstants
+{
+    FramePushConstants Frame;
+    uint32_t Bounce = 0;
+    uint32_t SampleIndex = 0;
+    uint32_t SortRays = 0;
+};
+
+// Matches the Counters block in wavefront.glsl.
+struct WavefrontCounters
+{
+    uint32_t ActiveCount = 0;
+    uint32_t NextCount = 0;
+    uint32_t RaysTraced = 0;
+    uint32_t Pad = 0;
+    VkDispatchIndirectCommand ExtendDispatch{};
+    uint32_t DispatchPad = 0;
+};
+
+// Wavefront path tracer: the megakernel is split into generate, extend, shade and connect
+// stages that communicate through path state and ray queues in storage buffers. Shade compacts
+// surviving paths into the next queue so later bounces only launch work for live rays, and
+// can optionally sort rays by material and direction octant before shading.
+class WavefrontPathTracer : public PathTracer
+{
+public:
+    static constexpr uint32_t TileSize = 8;
+    static constexpr uint32_t GroupSize = 64;
+    static constexpr uint32_t SortBinCount = 1024;
+
+    WavefrontPathTracer(
+            VulkanDevice& deviceRef,
+            VulkanDescriptorSetLayout& globalSetLayout,
+            VulkanBindlessTable& bindlessTableRef,
+            SamplerType sampler = SamplerType::Random);
+    ~WavefrontPathTracer() override;
+
+    WavefrontPathTracer(const WavefrontPathTracer&) = delete;
+    WavefrontPathTracer& operator=(const WavefrontPathTracer&) = delete;
+
+    void Resize(uint32_t width, uint32_t height) override;
+    void SetSphereBuffer(uint32_t frameIndex, const VkDescriptorBufferInfo& sphereBufferInfo) override;
+
+    void Record(
+            VkCommandBuffer cmdBuffer,
+            uint32_t frameIndex,
+            VkDescriptorSet globalSet,
+            const FramePushConstants& pushConstants) override;
+
+    [[nodiscard]] uint64_t GetRaysTraced(uint32_t frameIndex) const override;
+
+    // Counting sort of each bounce's queue by (material, direction octant) before shading.
+    void SetSortRays(bool sortRays) { m_SortRays = sortRays; }
+    [[nodiscard]] bool IsSortingRays() const { return m_SortRays; }
+
+    [[nodiscard]] const char* GetName() const override { return m_SortRays ? "Wavefront (sorted)" : "Wavefront"; }
+    [[nodiscard]] VkCommandBuffer GetCommandBuffer(uint32_t frameIndex) const override { return m_CommandBuffers[frameIndex]; }
+    [[nodiscard]] std::shared_ptr<VulkanImage2D> GetOutputImage(uint32_t frameIndex) const override { return m_DisplayImages[frameIndex]; }
+    [[nodiscard]] std::shared_ptr<VulkanImage2D> GetAccumulationImage() const override { return m_AccumulationImage; }
+    [[nodiscard]] uint32_t GetWidth() const override { return m_Width; }
+    [[nodiscard]] uint32_t GetHeight() const override { return m_Height; }
+    [[nodiscard]] SamplerType GetSampler() const { return m_Sampler; }
+
+private:
+    void CreateDescriptors();
+    void CreatePipelines(VulkanDescriptorSetLayout& globalSetLayout);
+    void CreateCounterBuffers();
+    void AllocateCommandBuffers();
+    void WriteDescriptorSets();
+
+    void BindQueueSet(VkCommandBuffer cmdBuffer, uint32_t frameIndex, uint32_t parity, VkDescriptorSet globalSet);
+    static void InsertBarrier(
+            VkCommandBuffer cmdBuffer,
+            VkPipelineStageFlags srcStage,
+            VkAccessFlags srcAccess,
+            VkPipelineStageFlags dstStage,
+            VkAccessFlags dstAccess);
+    static void ComputeBarrier(VkCommandBuffer cmdBuffer);
+
+private:
+    VulkanDevice& m_DeviceRef;
+    VulkanBindlessTable& m_BindlessTableRef;
+    SamplerType m_Sampler;
+
+    uint32_t m_Width = 0;
+    uint32_t m_Height = 0;
+    bool m_SortRays = false;
+    std::shared_ptr<VulkanImage2D> m_AccumulationImage;
+    std::vector<std::shared_ptr<VulkanImage2D>> m_DisplayImages;
+
+    // Per path
+    std::unique_ptr<VulkanBuffer> m_PathBuffer;
+    std::unique_ptr<VulkanBuffer> m_HitBuffer;
+    std::unique_ptr<VulkanBuffer> m_SortRankBuffer;
+    // Ping-ponged between bounces
+    std::array<std::unique_ptr<VulkanBuffer>, 2> m_QueueBuffers;
+    std::unique_ptr<VulkanBuffer> m_SortedQueueBuffer;
+    std::unique_ptr<VulkanBuffer> m_SortBinBuffer;
+    std::unique_ptr<VulkanBuffer> m_CounterBuffer;
+    std::vector<std::unique_ptr<VulkanBuffer>> m_StatisticsBuffers;
+
+    std::unique_ptr<VulkanDescriptorPool> m_DescriptorPool;
+    std::unique_ptr<VulkanDescriptorSetLayout> m_DescriptorSetLayout;
+    // Indexed by [frame][bounce parity]; parity 1 swaps the in and out queues.
+    std::vector<std::array<VkDescriptorSet, 2>> m_DescriptorSets;
+    std::vector<VkDescriptorBufferInfo> m_SphereBufferInfos;
+
+    VulkanPushConstants<WavefrontPushConstants> m_PushConstants;
+    VkPipelineLayout m_PipelineLayout{};
+    std::unique_ptr<VulkanComputePipeline> m_GeneratePipeline;
+    std::unique_ptr<VulkanComputePipeline> m_ExtendPipeline;
+    std::unique_ptr<VulkanComputePipeline> m_SortScanPipeline;
+    std::unique_ptr<VulkanComputePipeline> m_SortScatterPipeline;
+    std::unique_ptr<VulkanComputePipeline> m_ShadePipeline;
+    std::unique_ptr<VulkanComputePipeline> m_AdvancePipeline;
+    std::unique_ptr<VulkanComputePipeline> m_ConnectPipeline;
+
+    std::vector<VkCommandBuffer> m_CommandBuffers;
+};
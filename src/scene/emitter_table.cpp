@@ -0,0 +1,98 @@
+#include "scene/emitter_table.h"
+
+#include <algorithm>
+#include <cstring>
+#include <glm/gtc/constants.hpp>
+
+float EmitterTable::GetEmittedPower(const Sphere& sphere)
+{
+    const glm::vec3 radiance = glm::vec3(sphere.Material.EmissionColor_Strength) * sphere.Material.EmissionColor_Strength.w;
+    const float luminance = glm::dot(radiance, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+    const float radius = sphere.Position_Radius.w;
+    // Radiance times pi over the hemisphere, times the surface area 4 pi r^2.
+    return luminance * 4.0f * glm::pi<float>() * glm::pi<float>() * radius * radius;
+}
+
+EmitterTable EmitterTable::Build(const std::vector<Sphere>& spheres)
+{
+    EmitterTable table;
+
+    std::vector<double> powers;
+    double totalPower = 0.0;
+    for (uint32_t i = 0; i < spheres.size(); i++)
+    {
+        const float power = GetEmittedPower(spheres[i]);
+        if (!(power > 0.0f))
+            continue;
+
+        EmitterEntry entry;
+        entry.SphereIndex = i;
+        table.m_Entries.push_back(entry);
+        powers.push_back(power);
+        totalPower += power;
+    }
+
+    const size_t count = table.m_Entries.size();
+    if (count == 0)
+        return table;
+    table.m_TotalPower = static_cast<float>(totalPower);
+
+    // Vose's method: scale probabilities so the average is 1, then let every underfull slot borrow
+    // the rest of its column from an overfull one.
+    std::vector<double> scaled(count);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        table.m_Entries[i].Probability = static_cast<float>(powers[i] / totalPower);
+        scaled[i] = powers[i] / totalPower * static_cast<double>(count);
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+
+    while (!small.empty() && !large.empty())
+    {
+        const uint32_t less = small.back();
+        small.pop_back();
+        const uint32_t more = large.back();
+
+        table.m_Entries[less].AliasThreshold = static_cast<float>(scaled[less]);
+        table.m_Entries[less].Alias = more;
+
+        scaled[more] -= 1.0 - scaled[less];
+        if (scaled[more] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+
+    // Whatever is left is full up to rounding.
+    for (const std::vector<uint32_t>* leftovers : { &small, &large })
+    {
+        for (uint32_t i : *leftovers)
+        {
+            table.m_Entries[i].AliasThreshold = 1.0f;
+            table.m_Entries[i].Alias = i;
+        }
+    }
+
+    return table;
+}
+
+uint64_t EmitterTable::GetSerializedSize() const
+{
+    return sizeof(Header) + std::max<size_t>(m_Entries.size(), 1) * sizeof(EmitterEntry);
+}
+
+std::vector<uint8_t> EmitterTable::Serialize() const
+{
+    std::vector<uint8_t> bytes(GetSerializedSize(), 0);
+
+    Header header;
+    header.EmitterCount = GetEmitterCount();
+    header.TotalPower = m_TotalPower;
+    std::memcpy(bytes.data(), &header, sizeof(Header));
+    if (!m_Entries.empty())
+        std::memcpy(bytes.data() + sizeof(Header), m_Entries.data(), m_Entries.size() * sizeof(EmitterEntry));
+    return bytes;
+}
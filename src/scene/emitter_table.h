@@ -0,0 +1,47 @@
+#pragma once
+
+#include "scene/scene.h"
+
+#include <cstdint>
+#include <vector>
+
+// Matches EmitterEntry in path_tracing.glsl.
+struct EmitterEntry
+{
+    uint32_t SphereIndex = 0;
+    float Probability = 0.0f;
+    float AliasThreshold = 1.0f;
+    uint32_t Alias = 0;
+};
+
+// The emissive spheres with an alias table over their power, so the shaders pick a light in proportion
+// to how much it contributes with one random number and one lookup, however many lights there are.
+class EmitterTable
+{
+public:
+    // Matches the Emitters block header in path_tracing.glsl.
+    struct Header
+    {
+        uint32_t EmitterCount = 0;
+        float TotalPower = 0.0f;
+        uint32_t Pad[2]{};
+    };
+
+    static EmitterTable Build(const std::vector<Sphere>& spheres);
+
+    // Total flux of a uniformly emitting sphere, by luminance. EmittedPower in path_tracing.glsl must agree.
+    static float GetEmittedPower(const Sphere& sphere);
+
+    // Header then entries, as uploaded. Never empty: without emitters a single unused entry keeps the
+    // buffer valid to bind.
+    [[nodiscard]] std::vector<uint8_t> Serialize() const;
+    [[nodiscard]] uint64_t GetSerializedSize() const;
+
+    [[nodiscard]] const std::vector<EmitterEntry>& GetEntries() const { return m_Entries; }
+    [[nodiscard]] uint32_t GetEmitterCount() const { return static_cast<uint32_t>(m_Entries.size()); }
+    [[nodiscard]] float GetTotalPower() const { return m_TotalPower; }
+
+private:
+    std::vector<EmitterEntry> m_Entries;
+    float m_TotalPower = 0.0f;
+};
@@ -2,6 +2,7 @@
 
 #include <glm/glm.hpp>
 #include "core/buffer.h"
+#include "renderer/vulkan/vulkan_bindless.h"
 
 #include <vector>
 
@@ -10,6 +11,10 @@ struct RayTracingMaterial
     glm::vec4 Color_Smoothness;
     glm::vec4 EmissionColor_Strength;
     glm::vec4 SpecularColor_Probability;
+    // x: albedo texture handle into the bindless table, InvalidBindlessHandle if untextured.
+    // y, z, w: virtual albedo indirection texture, physical page texture and feedback buffer (see
+    // VulkanVirtualTexture::GetHandles); y is InvalidBindlessHandle when the albedo is not virtual.
+    glm::uvec4 TextureHandles{InvalidBindlessHandle};
 };
 
 struct Sphere
@@ -17,6 +22,6 @@ struct Sphere
     glm::vec4 Position_Radius;
     RayTracingMaterial Material;
 
-    static Buffer SpheresToBuffer(std::vector<Sphere>& spheres);
+    static BufferView SpheresToBuffer(std::vector<Sphere>& spheres);
 };
 
@@ -0,0 +1,546 @@
+// CPU microbenchmarks of the asset and math hot paths, with no GPU involved.
+//
+//   re_coo_microbench [--filter SUBSTRING] [--min-time SECONDS] [--repetitions N] [--json PATH]
+//
+// Inputs are generated from fixed seeds into the temp directory on first use, one per range, so the
+// scaling curves compare like with like between runs.
+
+#include "microbenchmark.h"
+#include "core/async_file_reader.h"
+#include "core/engine_utils.h"
+#include "core/flat_hash_map.h"
+#include "core/mapped_file.h"
+#include "renderer/camera.h"
+#include "renderer/vulkan/model.h"
+#include "renderer/vulkan/vulkan_texture.h"
+
+#include <glm/gtc/constants.hpp>
+#ifndef GLM_ENABLE_EXPERIMENTAL
+#define GLM_ENABLE_EXPERIMENTAL
+#endif
+#include <glm/gtx/hash.hpp>
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace
+{
+    std::filesystem::path GetInputDirectory()
+    {
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / "re_coo_microbench";
+        std::filesystem::create_directories(directory);
+        return directory;
+    }
+
+    void WriteFile(const std::filesystem::path& path, const void* data, size_t size)
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        if (!file)
+            throw std::runtime_error("failed to write " + path.string());
+    }
+
+    // segments x segments quads over a bumpy sphere, with positions, UVs and normals shared between the
+    // faces that meet at them, as an exporter would write it.
+    Model::Builder GenerateGrid(uint32_t segments)
+    {
+        std::mt19937 rng(segments);
+        std::uniform_real_distribution<float> bump(0.95f, 1.05f);
+
+        Model::Builder builder{};
+        for (uint32_t ring = 0; ring <= segments; ring++)
+        {
+            const float theta = glm::pi<float>() * (static_cast<float>(ring) + 0.5f) / static_cast<float>(segments + 1);
+            for (uint32_t segment = 0; segment <= segments; segment++)
+            {
+                const float phi = glm::two_pi<float>() * static_cast<float>(segment) / static_cast<float>(segments);
+                const glm::vec3 normal{ std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta) };
+
+                Model::Vertex vertex{};
+                vertex.Position = normal * bump(rng);
+                vertex.Color = glm::vec3(1.0f);
+                vertex.Normal = normal;
+                vertex.UV = { static_cast<float>(segment) / static_cast<float>(segments), static_cast<float>(ring) / static_cast<float>(segments) };
+                builder.Vertices.push_back(vertex);
+            }
+        }
+
+        for (uint32_t ring = 0; ring < segments; ring++)
+        {
+            for (uint32_t segment = 0; segment < segments; segment++)
+            {
+                const uint32_t a = ring * (segments + 1) + segment;
+                const uint32_t b = a + segments + 1;
+                builder.Indices.insert(builder.Indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+            }
+        }
+        return builder;
+    }
+
+    const std::string& GetObjPath(uint32_t segments)
+    {
+        static std::map<uint32_t, std::string> paths;
+        auto it = paths.find(segments);
+        if (it != paths.end())
+            return it->second;
+
+        const Model::Builder grid = GenerateGrid(segments);
+        const std::filesystem::path path = GetInputDirectory() / ("grid_" + std::to_string(segments) + ".obj");
+        std::ofstream file(path);
+        for (const Model::Vertex& vertex : grid.Vertices)
+            file << "v " << vertex.Position.x << " " << vertex.Position.y << " " << vertex.Position.z << "\n";
+        for (const Model::Vertex& vertex : grid.Vertices)
+            file << "vt " << vertex.UV.x << " " << vertex.UV.y << "\n";
+        for (const Model::Vertex& vertex : grid.Vertices)
+            file << "vn " << vertex.Normal.x << " " << vertex.Normal.y << " " << vertex.Normal.z << "\n";
+        for (size_t i = 0; i < grid.Indices.size(); i += 3)
+        {
+            file << "f";
+            for (size_t corner = 0; corner < 3; corner++)
+            {
+                const uint32_t index = grid.Indices[i + corner] + 1;
+                file << " " << index << "/" << index << "/" << index;
+            }
+            file << "\n";
+        }
+        if (!file.flush())
+            throw std::runtime_error("failed to write " + path.string());
+
+        return paths.emplace(segments, path.string()).first->second;
+    }
+
+    uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+    {
+        static const std::array<uint32_t, 256> table = []
+        {
+            std::array<uint32_t, 256> result{};
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t value = i;
+                for (int bit = 0; bit < 8; bit++)
+                    value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+                result[i] = value;
+            }
+            return result;
+        }();
+
+        crc = ~crc;
+        for (size_t i = 0; i < size; i++)
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    void AppendBigEndian(std::vector<uint8_t>& out, uint32_t value)
+    {
+        out.insert(out.end(), { static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value) });
+    }
+
+    void AppendPngChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data)
+    {
+        AppendBigEndian(out, static_cast<uint32_t>(data.size()));
+        std::vector<uint8_t> typed(type, type + 4);
+        typed.insert(typed.end(), data.begin(), data.end());
+        out.insert(out.end(), typed.begin(), typed.end());
+        AppendBigEndian(out, Crc32(typed.data(), typed.size()));
+    }
+
+    // RGBA8 PNG with stored (uncompressed) deflate blocks: no zlib needed to write it, and stb still runs
+    // its full chunk, inflate and unfilter path to read it.
+    const std::string& GetPngPath(uint32_t size)
+    {
+        static std::map<uint32_t, std::string> paths;
+        auto it = paths.find(size);
+        if (it != paths.end())
+            return it->second;
+
+        std::mt19937 rng(size);
+        std::vector<uint8_t> scanlines;
+        for (uint32_t y = 0; y < size; y++)
+        {
+            scanlines.push_back(0);
+            for (uint32_t x = 0; x < size * 4; x++)
+                scanlines.push_back(static_cast<uint8_t>(rng()));
+        }
+
+        std::vector<uint8_t> zlib = { 0x78, 0x01 };
+        for (size_t offset = 0; offset < scanlines.size(); offset += 65535)
+        {
+            const auto length = static_cast<uint16_t>(std::min<size_t>(65535, scanlines.size() - offset));
+            zlib.push_back(offset + length == scanlines.size() ? 1 : 0);
+            zlib.insert(zlib.end(), { static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8), static_cast<uint8_t>(~length), static_cast<uint8_t>(~length >> 8) });
+            zlib.insert(zlib.end(), scanlines.begin() + static_cast<std::ptrdiff_t>(offset), scanlines.begin() + static_cast<std::ptrdiff_t>(offset + length));
+        }
+        uint32_t a = 1, b = 0;
+        for (uint8_t byte : scanlines)
+        {
+            a = (a + byte) % 65521;
+            b = (b + a) % 65521;
+        }
+        AppendBigEndian(zlib, (b << 16) | a);
+
+        std::vector<uint8_t> header;
+        AppendBigEndian(header, size);
+        AppendBigEndian(header, size);
+        header.insert(header.end(), { 8, 6, 0, 0, 0 });
+
+        std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        AppendPngChunk(png, "IHDR", header);
+        AppendPngChunk(png, "IDAT", zlib);
+        AppendPngChunk(png, "IEND", {});
+
+        const std::filesystem::path path = GetInputDirectory() / ("noise_" + std::to_string(size) + ".png");
+        WriteFile(path, png.data(), png.size());
+        return paths.emplace(size, path.string()).first->second;
+    }
+
+    // Flat (not run-length encoded) Radiance RGBE, which takes stb's HDR path to RGBA32F.
+    const std::string& GetHdrPath(uint32_t size)
+    {
+        static std::map<uint32_t, std::string> paths;
+        auto it = paths.find(size);
+        if (it != paths.end())
+            return it->second;
+
+        std::mt19937 rng(size);
+        std::uniform_int_distribution<uint32_t> mantissa(64, 255);
+        std::uniform_int_distribution<uint32_t> exponent(120, 136);
+
+        std::string header = "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y " + std::to_string(size) + " +X " + std::to_string(size) + "\n";
+        std::vector<uint8_t> hdr(header.begin(), header.end());
+        for (uint32_t i = 0; i < size * size; i++)
+        {
+            hdr.insert(hdr.end(), { static_cast<uint8_t>(mantissa(rng)), static_cast<uint8_t>(mantissa(rng)),
+                                    static_cast<uint8_t>(mantissa(rng)), static_cast<uint8_t>(exponent(rng)) });
+        }
+
+        const std::filesystem::path path = GetInputDirectory() / ("noise_" + std::to_string(size) + ".hdr");
+        WriteFile(path, hdr.data(), hdr.size());
+        return paths.emplace(size, path.string()).first->second;
+    }
+
+    const std::string& GetBinaryPath(int64_t size)
+    {
+        static std::map<int64_t, std::string> paths;
+        auto it = paths.find(size);
+        if (it != paths.end())
+            return it->second;
+
+        std::mt19937 rng(static_cast<uint32_t>(size));
+        std::vector<char> data(static_cast<size_t>(size));
+        for (char& byte : data)
+            byte = static_cast<char>(rng());
+
+        const std::filesystem::path path = GetInputDirectory() / ("blob_" + std::to_string(size) + ".bin");
+        WriteFile(path, data.data(), data.size());
+        return paths.emplace(size, path.string()).first->second;
+    }
+
+    // The unwelded corners of a grid in face order: every interior vertex repeats about six times, like the
+    // per-index vertices LoadModel deduplicates.
+    std::vector<Model::Vertex> GetCornerStream(uint32_t segments)
+    {
+        const Model::Builder grid = GenerateGrid(segments);
+        std::vector<Model::Vertex> corners;
+        corners.reserve(grid.Indices.size());
+        for (uint32_t index : grid.Indices)
+            corners.push_back(grid.Vertices[index]);
+        return corners;
+    }
+
+    void BM_ReadFile(MicrobenchmarkState& state)
+    {
+        const std::string& path = GetBinaryPath(state.GetRange());
+        while (state.KeepRunning())
+            DoNotOptimize(EngineUtils::ReadFile(path));
+        state.SetBytesProcessed(static_cast<int64_t>(state.GetIterations()) * state.GetRange());
+    }
+    MICROBENCHMARK(BM_ReadFile, 4 << 10, 64 << 10, 1 << 20, 16 << 20);
+
+    // Mapping reads nothing by itself, so every page is touched to pay for the faults a consumer would take.
+    void BM_MapFile(MicrobenchmarkState& state)
+    {
+        const std::string& path = GetBinaryPath(state.GetRange());
+        while (state.KeepRunning())
+        {
+            const MappedFile file(path);
+            uint8_t sum = 0;
+            for (size_t offset = 0; offset < file.GetSize(); offset += 4096)
+                sum += file.GetData()[offset];
+            DoNotOptimize(sum);
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.GetIterations()) * state.GetRange());
+    }
+    MICROBENCHMARK(BM_MapFile, 4 << 10, 64 << 10, 1 << 20, 16 << 20);
+
+    constexpr int64_t BatchFileSize = 256 << 10;
+
+    std::vector<std::string> GetBatchPaths(int64_t count)
+    {
+        std::vector<std::string> paths;
+        for (int64_t index = 0; index < count; index++)
+        {
+            const std::filesystem::path path = GetInputDirectory() / ("batch_" + std::to_string(index) + ".bin");
+            if (!std::filesystem::exists(path) || std::filesystem::file_size(path) != static_cast<uintmax_t>(BatchFileSize))
+            {
+                const std::vector<char> data(static_cast<size_t>(BatchFileSize), static_cast<char>(index));
+                WriteFile(path, data.data(), data.size());
+            }
+            paths.push_back(path.string());
+        }
+        return paths;
+    }
+
+    // Range: files of BatchFileSize each, read one after another as the asset code does today.
+    void BM_ReadFiles_Sequential(MicrobenchmarkState& state)
+    {
+        const std::vector<std::string> paths = GetBatchPaths(state.GetRange());
+        while (state.KeepRunning())
+        {
+            for (const std::string& path : paths)
+                DoNotOptimize(EngineUtils::ReadFile(path));
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.GetIterations()) * state.GetRange());
+        state.SetBytesProcessed(static_cast<int64_t>(state.GetIterations()) * state.GetRange() * BatchFileSize);
+    }
+    MICROBENCHMARK(BM_ReadFiles_Sequential, 16, 64, 256);
+
+    void BM_ReadFiles_Batched(MicrobenchmarkState& state)
+    {
+        const std::vector<std::string> paths = GetBatchPaths(state.GetRange());
+        AsyncFileReader reader;
+        std::vector<AsyncFileReader::Result> results;
+        while (state.KeepRunning())
+        {
+            reader.ReadFiles(paths, results);
+            DoNotOptimize(results.data());
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.GetIterations()) * state.GetRange());
+        state.SetBytesProcessed(static_cast<int64_t>(state.GetIterations()) * state.GetRange() * BatchFileSize);
+        state.SetCounter("io_uring", reader.IsUsingIoUring() ? 1.0 : 0.0);
+    }
+    MICROBENCHMARK(BM_ReadFiles_Batched, 16, 64, 256);
+
+    // Range: grid segments, so 2 * range^2 triangles.
+    void BM_LoadModel(MicrobenchmarkState& state)
+    {
+        const auto segments = static_cast<uint32_t>(state.GetRange());
+        const std::string& path = GetObjPath(segments);
+        Model::Builder builder{};
+        while (state.KeepRunning())
+        {
+            builder.LoadModel(path);
+            DoNotOptimize(builder.Vertices.data());
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.GetIterations()) * 2 * segments * segments);
+    }
+    MICROBENCHMARK(BM_LoadModel, 16, 64, 256);
+
+    // The vertex hash LoadModel used before the bytewise one: glm's per-vector hashes folded together, with
+    // Tangent left out. Kept as the baseline for the hash and dedup benchmarks.
+    struct LegacyVertexHash
+    {
+        size_t operator()(const Model::Vertex& vertex) const
+        {
+            size_t seed = 0;
+            EngineUtils::HashCombine(seed, vertex.Position, vertex.Color, vertex.Normal, vertex.UV);
+            return seed;
+        }
+    };
+
+    // Counters for how well VertexHash spreads the distinct vertices of the stream: full-width hash
+    // collisions, and the fraction that land on an occupied slot of a power-of-two table at most half full,
+    // indexed by the low bits as FlatHashMap does. A uniformly random hash gives about 0.2 at that load.
+    template<typename VertexHash>
+    void SetVertexHashCounters(MicrobenchmarkState& state, const std::vector<Model::Vertex>& corners)
+    {
+        FlatHashMap<Model::Vertex, uint32_t> uniqueVertices(corners.size());
+        std::vector<size_t> hashes;
+        for (const Model::Vertex& vertex : corners)
+        {
+            if (uniqueVertices.TryEmplace(vertex, 0).second)
+                hashes.push_back(VertexHash{}(vertex));
+        }
+
+        size_t slotCount = 1;
+        while (slotCount < hashes.size() * 2)
+            slotCount *= 2;
+        std::vector<bool> occupied(slotCount, false);
+        size_t slotCollisions = 0;
+        for (size_t hash : hashes)
+        {
+            slotCollisions += occupied[hash & (slotCount - 1)] ? 1 : 0;
+            occupied[hash & (slotCount - 1)] = true;
+        }
+
+        std::sort(hashes.begin(), hashes.end());
+        const auto distinctHashes = static_cast<size_t>(std::unique(hashes.begin(), hashes.end()) - hashes.begin());
+
+        state.SetCounter("unique", static_cast<double>(hashes.size()));
+        state.SetCounter("hash_collisions", static_cast<double>(hashes.size() - distinctHashes));
+        state.SetCounter("slot_collision_rate", hashes.empty() ? 0.0 : static_cast<double>(slotCollisions) / static_cast<double>(hashes.size()));
+    }
+
+    template<typename VertexHash>
+    void RunVertexHash(MicrobenchmarkState& state)
+    {
+        const std::vector<Model::Vertex> corners = GetCornerStream(static_cast<uint32_t>(state.GetRange()));
+        const VertexHash hasher{};
+        while (state.KeepRunning())
+        {
+            size_t combined = 0;
+            for (const Model::Vertex& vertex : corners)
+                combined += hasher(vertex);
+            DoNotOptimize(combined);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.GetIterations() * corners.size()));
+        state.SetBytesProcessed(static_cast<int64_t>(state.GetIterations() * corners.size() * sizeof(Model::Vertex)));
+        SetVertexHashCounters<VertexHash>(state, corners);
+    }
+
+    void BM_VertexHash_Legacy(MicrobenchmarkState& state) { RunVertexHash<LegacyVertexHash>(state); }
+    MICROBENCHMARK(BM_VertexHash_Legacy, 16, 64, 256, 1024);
+
+    void BM_VertexHash(MicrobenchmarkState& state) { RunVertexHash<std::hash<Model::Vertex>>(state); }
+    MICROBENCHMARK(BM_VertexHash, 16, 64, 256, 1024);
+
+    // The deduplication loop LoadModel had before FlatHashMap: std::unordered_map with a double lookup.
+    template<typename VertexHash>
+    void RunUnorderedMapVertexDedup(MicrobenchmarkState& state)
+    {
+        const std::vector<Model::Vertex> corners = GetCornerStream(static_cast<uint32_t>(state.GetRange()));
+        std::vector<Model::Vertex> vertices;
+        std::vector<uint32_t> indices;
+        std::unordered_map<Model::Vertex, uint32_t, VertexHash> uniqueVertices{};
+        while (state.KeepRunning())
+        {
+            uniqueVertices = {};
+            vertices.clear();
+            indices.clear();
+            for (const Model::Vertex& vertex : corners)
+            {
+                if (uniqueVertices.count(vertex) == 0)
+                {
+                    uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
+                    vertices.push_back(vertex);
+                }
+                indices.push_back(uniqueVertices[vertex]);
+            }
+            DoNotOptimize(indices.data());
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.GetIterations() * corners.size()));
+
+        // Share of entries whose bucket holds another entry as well.
+        size_t sharedBucketEntries = 0;
+        for (size_t bucket = 0; bucket < uniqueVertices.bucket_count(); bucket++)
+            sharedBucketEntries += uniqueVertices.bucket_size(bucket) > 1 ? uniqueVertices.bucket_size(bucket) : 0;
+        state.SetCounter("bucket_collision_rate", uniqueVertices.empty() ? 0.0 : static_cast<double>(sharedBucketEntries) / static_cast<double>(uniqueVertices.size()));
+    }
+
+    void BM_VertexDedup_Legacy(MicrobenchmarkState& state) { RunUnorderedMapVertexDedup<LegacyVertexHash>(state); }
+    MICROBENCHMARK(BM_VertexDedup_Legacy, 16, 64, 256, 1024);
+
+    void BM_VertexDedup_UnorderedMap(MicrobenchmarkState& state) { RunUnorderedMapVertexDedup<std::hash<Model::Vertex>>(state); }
+    MICROBENCHMARK(BM_VertexDedup_UnorderedMap, 16, 64, 256, 1024);
+
+    // The deduplication loop of LoadModel on its own.
+    void BM_VertexDedup(MicrobenchmarkState& state)
+    {
+        const std::vector<Model::Vertex> corners = GetCornerStream(static_cast<uint32_t>(state.GetRange()));
+        std::vector<Model::Vertex> vertices;
+        std::vector<uint32_t> indices;
+        // LoadModel sizes the table from the position count, which for the grid is the distinct vertex count.
+        const auto expectedVertexCount = static_cast<size_t>((state.GetRange() + 1) * (state.GetRange() + 1));
+        FlatHashMap<Model::Vertex, uint32_t> uniqueVertices{};
+        while (state.KeepRunning())
+        {
+            uniqueVertices = FlatHashMap<Model::Vertex, uint32_t>(expectedVertexCount);
+            vertices.clear();
+            indices.clear();
+            for (const Model::Vertex& vertex : corners)
+            {
+                const auto [vertexIndex, inserted] = uniqueVertices.TryEmplace(vertex, static_cast<uint32_t>(vertices.size()));
+                if (inserted)
+                    vertices.push_back(vertex);
+                indices.push_back(*vertexIndex);
+            }
+            DoNotOptimize(indices.data());
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.GetIterations() * corners.size()));
+        state.SetCounter("average_probe_length", uniqueVertices.GetAverageProbeLength());
+    }
+    MICROBENCHMARK(BM_VertexDedup, 16, 64, 256, 1024);
+
+    void BM_ComputeTangentBasis(MicrobenchmarkState& state)
+    {
+        const Model::Builder grid = GenerateGrid(static_cast<uint32_t>(state.GetRange()));
+        std::vector<Model::Vertex> vertices;
+        while (state.KeepRunning())
+        {
+            state.PauseTiming();
+            vertices = grid.Vertices;
+            state.ResumeTiming();
+
+            Model::Builder::ComputeTangentBasis(vertices, grid.Indices);
+            DoNotOptimize(vertices.data());
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.GetIterations() * grid.Indices.size() / 3));
+    }
+    MICROBENCHMARK(BM_ComputeTangentBasis, 16, 64, 256, 1024);
+
+    // Range: image width and height.
+    void BM_ToBufferFromFile_PNG(MicrobenchmarkState& state)
+    {
+        const std::string& path = GetPngPath(static_cast<uint32_t>(state.GetRange()));
+        while (state.KeepRunning())
+        {
+            ImageFormat format{};
+            uint32_t width = 0, height = 0;
+            Buffer pixels = TextureUtils::ToBufferFromFile(path, format, width, height);
+            DoNotOptimize(pixels.GetData());
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.GetIterations()) * state.GetRange() * state.GetRange() * 4);
+    }
+    MICROBENCHMARK(BM_ToBufferFromFile_PNG, 64, 256, 1024, 2048);
+
+    void BM_ToBufferFromFile_HDR(MicrobenchmarkState& state)
+    {
+        const std::string& path = GetHdrPath(static_cast<uint32_t>(state.GetRange()));
+        while (state.KeepRunning())
+        {
+            ImageFormat format{};
+            uint32_t width = 0, height = 0;
+            Buffer pixels = TextureUtils::ToBufferFromFile(path, format, width, height);
+            DoNotOptimize(pixels.GetData());
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.GetIterations()) * state.GetRange() * state.GetRange() * 16);
+    }
+    MICROBENCHMARK(BM_ToBufferFromFile_HDR, 64, 256, 1024);
+
+    // Range: views rebuilt per iteration, along an orbit so no two are the same.
+    void BM_CameraUpdateView(MicrobenchmarkState& state)
+    {
+        Camera camera{};
+        const int64_t viewCount = state.GetRange();
+        while (state.KeepRunning())
+        {
+            for (int64_t i = 0; i < viewCount; i++)
+            {
+                camera.SetOrbit({ 0.001f * static_cast<float>(i), 0.5f }, -1.2f);
+                DoNotOptimize(camera.GetView());
+            }
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.GetIterations()) * viewCount);
+    }
+    MICROBENCHMARK(BM_CameraUpdateView, 1, 64, 4096);
+}
+
+int main(int argc, char** argv)
+{
+    return RunMicrobenchmarks(argc, argv);
+}
@@ -0,0 +1,240 @@
+#include "microbenchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    struct Options
+    {
+        std::string Filter;
+        double MinSeconds = 0.2;
+        uint32_t Repetitions = 3;
+        std::string JsonPath;
+    };
+
+    struct RangeResult
+    {
+        int64_t Range = 0;
+        uint64_t Iterations = 0;
+        double NanosecondsPerIteration = 0.0;   // Median over the repetitions
+        double RelativeSpread = 0.0;            // (max - min) / median
+        double ItemsPerSecond = 0.0;
+        double BytesPerSecond = 0.0;
+        std::vector<std::pair<std::string, double>> Counters;
+    };
+
+    struct ComplexityFit
+    {
+        const char* Name = nullptr;
+        double Coefficient = 0.0;   // Nanoseconds per unit of the fitted term
+        double RelativeRms = 0.0;
+    };
+
+    bool ParseArguments(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+                options.Filter = argv[++i];
+            else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+                options.MinSeconds = std::max(0.001, std::atof(argv[++i]));
+            else if (std::strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc)
+                options.Repetitions = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+            else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+                options.JsonPath = argv[++i];
+            else
+                return false;
+        }
+        return true;
+    }
+
+    RangeResult RunRange(const Microbenchmark& benchmark, int64_t range, const Options& options)
+    {
+        // Grow the iteration count until one run fills the minimum time, then repeat at that count.
+        uint64_t iterations = 1;
+        while (true)
+        {
+            MicrobenchmarkState state(range, iterations);
+            benchmark.Function(state);
+
+            const double seconds = state.GetElapsedSeconds();
+            if (seconds >= options.MinSeconds || iterations >= (1ull << 40))
+                break;
+
+            const double scale = seconds > 0.0 ? options.MinSeconds / seconds * 1.4 : 10.0;
+            iterations = std::max(iterations + 1, static_cast<uint64_t>(static_cast<double>(iterations) * std::min(scale, 10.0)));
+        }
+
+        std::vector<double> nanoseconds;
+        std::vector<MicrobenchmarkState> states;
+        for (uint32_t repetition = 0; repetition < options.Repetitions; repetition++)
+        {
+            MicrobenchmarkState state(range, iterations);
+            benchmark.Function(state);
+            nanoseconds.push_back(state.GetElapsedSeconds() * 1e9 / static_cast<double>(iterations));
+            states.push_back(state);
+        }
+
+        std::vector<double> sorted = nanoseconds;
+        std::sort(sorted.begin(), sorted.end());
+        const double median = sorted[sorted.size() / 2];
+        const size_t medianIndex = static_cast<size_t>(std::find(nanoseconds.begin(), nanoseconds.end(), median) - nanoseconds.begin());
+        const MicrobenchmarkState& medianState = states[medianIndex];
+
+        RangeResult result{};
+        result.Range = range;
+        result.Iterations = iterations;
+        result.NanosecondsPerIteration = median;
+        result.RelativeSpread = median > 0.0 ? (sorted.back() - sorted.front()) / median : 0.0;
+        result.Counters = medianState.GetCounters();
+        const double seconds = medianState.GetElapsedSeconds();
+        if (seconds > 0.0)
+        {
+            result.ItemsPerSecond = static_cast<double>(medianState.GetItemsProcessed()) / seconds;
+            result.BytesPerSecond = static_cast<double>(medianState.GetBytesProcessed()) / seconds;
+        }
+        return result;
+    }
+
+    // Least-squares fit of time = coefficient * f(N) for each candidate f, keeping the best relative RMS.
+    ComplexityFit FitComplexity(const std::vector<RangeResult>& results)
+    {
+        struct Candidate
+        {
+            const char* Name;
+            double (*Term)(double);
+        };
+        static const Candidate Candidates[] =
+        {
+            { "O(1)", [](double) { return 1.0; } },
+            { "O(N)", [](double n) { return n; } },
+            { "O(N log N)", [](double n) { return n * std::log2(std::max(n, 2.0)); } },
+            { "O(N^2)", [](double n) { return n * n; } },
+        };
+
+        double meanTime = 0.0;
+        for (const RangeResult& result : results)
+            meanTime += result.NanosecondsPerIteration;
+        meanTime /= static_cast<double>(results.size());
+
+        ComplexityFit best{};
+        best.RelativeRms = 1e300;
+        for (const Candidate& candidate : Candidates)
+        {
+            double termTime = 0.0;
+            double termTerm = 0.0;
+            for (const RangeResult& result : results)
+            {
+                const double term = candidate.Term(static_cast<double>(result.Range));
+                termTime += term * result.NanosecondsPerIteration;
+                termTerm += term * term;
+            }
+            const double coefficient = termTerm > 0.0 ? termTime / termTerm : 0.0;
+
+            double squaredError = 0.0;
+            for (const RangeResult& result : results)
+            {
+                const double error = result.NanosecondsPerIteration - coefficient * candidate.Term(static_cast<double>(result.Range));
+                squaredError += error * error;
+            }
+            const double relativeRms = meanTime > 0.0 ? std::sqrt(squaredError / static_cast<double>(results.size())) / meanTime : 0.0;
+            if (relativeRms < best.RelativeRms)
+                best = { candidate.Name, coefficient, relativeRms };
+        }
+        return best;
+    }
+
+    void PrintRate(double rate, const char* unit)
+    {
+        if (rate <= 0.0)
+            std::printf(" %14s", "");
+        else if (rate >= 1e9)
+            std::printf(" %10.2f G%s", rate * 1e-9, unit);
+        else if (rate >= 1e6)
+            std::printf(" %10.2f M%s", rate * 1e-6, unit);
+        else
+            std::printf(" %10.2f k%s", rate * 1e-3, unit);
+    }
+}
+
+std::vector<Microbenchmark>& GetMicrobenchmarks()
+{
+    static std::vector<Microbenchmark> benchmarks;
+    return benchmarks;
+}
+
+int RunMicrobenchmarks(int argc, char** argv)
+{
+    Options options;
+    if (!ParseArguments(argc, argv, options))
+    {
+        std::fprintf(stderr, "usage: %s [--filter SUBSTRING] [--min-time SECONDS] [--repetitions N] [--json PATH]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::ofstream json;
+    if (!options.JsonPath.empty())
+    {
+        json.open(options.JsonPath);
+        json.precision(9);
+        json << "{\"benchmarks\": [";
+    }
+
+    std::printf("%-40s %14s %12s %8s %14s %14s\n", "benchmark", "ns/iter", "iterations", "spread", "items/s", "bytes/s");
+    bool firstJsonEntry = true;
+    for (const Microbenchmark& benchmark : GetMicrobenchmarks())
+    {
+        if (!options.Filter.empty() && benchmark.Name.find(options.Filter) == std::string::npos)
+            continue;
+
+        std::vector<RangeResult> results;
+        for (int64_t range : benchmark.Ranges)
+        {
+            results.push_back(RunRange(benchmark, range, options));
+            const RangeResult& result = results.back();
+
+            const std::string name = benchmark.Name + "/" + std::to_string(range);
+            std::printf("%-40s %14.1f %12llu %7.1f%%", name.c_str(), result.NanosecondsPerIteration,
+                        static_cast<unsigned long long>(result.Iterations), result.RelativeSpread * 100.0);
+            PrintRate(result.ItemsPerSecond, "/s");
+            PrintRate(result.BytesPerSecond, "B/s");
+            for (const auto& [counterName, value] : result.Counters)
+                std::printf(" %s=%.4g", counterName.c_str(), value);
+            std::printf("\n");
+
+            if (json.is_open())
+            {
+                json << (firstJsonEntry ? "" : ",") << "\n  {\"name\": \"" << name << "\", \"range\": " << range
+                     << ", \"iterations\": " << result.Iterations << ", \"ns_per_iteration\": " << result.NanosecondsPerIteration
+                     << ", \"spread\": " << result.RelativeSpread << ", \"items_per_second\": " << result.ItemsPerSecond
+                     << ", \"bytes_per_second\": " << result.BytesPerSecond;
+                for (const auto& [counterName, value] : result.Counters)
+                    json << ", \"" << counterName << "\": " << value;
+                json << "}";
+                firstJsonEntry = false;
+            }
+        }
+
+        if (results.size() >= 3)
+        {
+            const ComplexityFit fit = FitComplexity(results);
+            std::printf("%-40s %s, %.3g ns per unit, rms %.1f%%\n", (benchmark.Name + "_BigO").c_str(), fit.Name, fit.Coefficient, fit.RelativeRms * 100.0);
+
+            if (json.is_open())
+            {
+                json << ",\n  {\"name\": \"" << benchmark.Name << "_BigO\", \"complexity\": \"" << fit.Name
+                     << "\", \"coefficient\": " << fit.Coefficient << ", \"rms\": " << fit.RelativeRms << "}";
+            }
+        }
+    }
+
+    if (json.is_open())
+        json << "\n]}\n";
+    return EXIT_SUCCESS;
+}
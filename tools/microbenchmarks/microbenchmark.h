@@ -0,0 +1,110 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A small in-tree harness with the shape of Google Benchmark: functions registered with MICROBENCHMARK run
+// once per input size ("range") for enough iterations to fill --min-time, repeated --repetitions times, and
+// report the median time per iteration. Benchmarks with three or more ranges also get a complexity fit
+// (O(1), O(N), O(N log N) or O(N^2)), which is what catches algorithmic regressions as inputs grow.
+class MicrobenchmarkState
+{
+public:
+    MicrobenchmarkState(int64_t range, uint64_t iterations) : m_Range(range), m_Iterations(iterations) {}
+
+    // while (state.KeepRunning()) { ... } runs the body the requested number of times, timed.
+    bool KeepRunning()
+    {
+        if (m_Completed == 0 && !m_Running)
+            ResumeTiming();
+        if (m_Completed++ < m_Iterations)
+            return true;
+
+        PauseTiming();
+        m_Completed = m_Iterations;
+        return false;
+    }
+
+    // Excludes per-iteration setup, e.g. restoring an input the body modifies.
+    void PauseTiming()
+    {
+        if (!m_Running)
+            return;
+        m_Elapsed += std::chrono::steady_clock::now() - m_Start;
+        m_Running = false;
+    }
+
+    void ResumeTiming()
+    {
+        m_Start = std::chrono::steady_clock::now();
+        m_Running = true;
+    }
+
+    [[nodiscard]] int64_t GetRange() const { return m_Range; }
+    [[nodiscard]] uint64_t GetIterations() const { return m_Iterations; }
+    [[nodiscard]] double GetElapsedSeconds() const { return std::chrono::duration<double>(m_Elapsed).count(); }
+
+    // Totals over all iterations, reported as rates.
+    void SetItemsProcessed(int64_t items) { m_ItemsProcessed = items; }
+    void SetBytesProcessed(int64_t bytes) { m_BytesProcessed = bytes; }
+    [[nodiscard]] int64_t GetItemsProcessed() const { return m_ItemsProcessed; }
+    [[nodiscard]] int64_t GetBytesProcessed() const { return m_BytesProcessed; }
+
+    // Extra per-range figures printed beside the timings, e.g. a hash's collision rate.
+    void SetCounter(const std::string& name, double value) { m_Counters.emplace_back(name, value); }
+    [[nodiscard]] const std::vector<std::pair<std::string, double>>& GetCounters() const { return m_Counters; }
+
+private:
+    int64_t m_Range;
+    uint64_t m_Iterations;
+    uint64_t m_Completed = 0;
+    bool m_Running = false;
+    std::chrono::steady_clock::time_point m_Start{};
+    std::chrono::steady_clock::duration m_Elapsed{};
+    int64_t m_ItemsProcessed = 0;
+    int64_t m_BytesProcessed = 0;
+    std::vector<std::pair<std::string, double>> m_Counters;
+};
+
+using MicrobenchmarkFunction = void (*)(MicrobenchmarkState&);
+
+struct Microbenchmark
+{
+    std::string Name;
+    MicrobenchmarkFunction Function;
+    std::vector<int64_t> Ranges;
+};
+
+std::vector<Microbenchmark>& GetMicrobenchmarks();
+
+struct MicrobenchmarkRegistrar
+{
+    MicrobenchmarkRegistrar(const char* name, MicrobenchmarkFunction function, std::vector<int64_t> ranges)
+    {
+        GetMicrobenchmarks().push_back({ name, function, std::move(ranges) });
+    }
+};
+
+// MICROBENCHMARK(BM_Function, 64, 512, 4096) runs BM_Function once per range.
+#define MICROBENCHMARK_CONCAT_INNER(a, b) a##b
+#define MICROBENCHMARK_CONCAT(a, b) MICROBENCHMARK_CONCAT_INNER(a, b)
+#define MICROBENCHMARK(function, ...) \
+    static MicrobenchmarkRegistrar MICROBENCHMARK_CONCAT(microbenchmarkRegistrar, __LINE__)(#function, function, { __VA_ARGS__ })
+
+// Keeps the compiler from discarding a result the benchmark otherwise never reads.
+template<typename T>
+inline void DoNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// Parses --filter, --min-time, --repetitions and --json, then runs the registered benchmarks.
+int RunMicrobenchmarks(int argc, char** argv);
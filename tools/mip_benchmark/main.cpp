@@ -0,0 +1,111 @@
+// Mip chain generation throughput, in MB of level 0 input per second.
+//
+//   re_coo_mipbench [--size WxH] [--iterations N] [--threads N]
+//
+// Runs every filter for RGBA8 (UNORM and sRGB) and RGBA32F, single threaded and on the pool.
+
+#include "core/thread_pool.h"
+#include "renderer/texture/mip_generator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+    struct Options
+    {
+        uint32_t Width = 4096;
+        uint32_t Height = 4096;
+        uint32_t Iterations = 5;
+        uint32_t ThreadCount = ThreadPool::GetDefaultWorkerCount() + 1;
+    };
+
+    bool ParseArguments(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+            {
+                if (std::sscanf(argv[++i], "%ux%u", &options.Width, &options.Height) != 2 || options.Width == 0 || options.Height == 0)
+                    return false;
+            }
+            else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+                options.Iterations = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+            else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+                options.ThreadCount = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+            else
+                return false;
+        }
+        return true;
+    }
+
+    // Best of the iterations, to keep scheduling noise out of the number.
+    template<typename T>
+    double Measure(const Options& options, const std::vector<T>& source, std::vector<T>& chain, uint32_t mipCount, const MipOptions& mipOptions)
+    {
+        double best = 1e30;
+        for (uint32_t i = 0; i < options.Iterations; i++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            MipGeneration::Generate(source.data(), options.Width, options.Height, mipCount, chain.data(), mipOptions);
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        double megabytes = static_cast<double>(source.size() * sizeof(T)) / (1024.0 * 1024.0);
+        return megabytes / best;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseArguments(argc, argv, options))
+    {
+        std::fprintf(stderr, "usage: re_coo_mipbench [--size WxH] [--iterations N] [--threads N]\n");
+        return EXIT_FAILURE;
+    }
+
+    size_t texelCount = static_cast<size_t>(options.Width) * options.Height;
+    uint32_t mipCount = MipGeneration::GetMipCount(options.Width, options.Height);
+    size_t chainTexels = MipGeneration::GetChainTexelCount(options.Width, options.Height, mipCount) - texelCount;
+
+    std::mt19937 rng(1234);
+    std::vector<uint8_t> unorm(texelCount * 4);
+    std::vector<float> hdr(texelCount * 4);
+    for (size_t i = 0; i < unorm.size(); i++)
+    {
+        unorm[i] = static_cast<uint8_t>(rng());
+        hdr[i] = static_cast<float>(unorm[i]) / 16.0f;
+    }
+
+    std::vector<uint8_t> unormChain(chainTexels * 4);
+    std::vector<float> hdrChain(chainTexels * 4);
+
+    ThreadPool pool(std::max(options.ThreadCount - 1, 1u));
+    std::printf("%ux%u, %u levels, best of %u\n", options.Width, options.Height, mipCount, options.Iterations);
+    std::printf("%-8s %-8s %8s %14s\n", "filter", "input", "threads", "MB/s");
+
+    for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser })
+    {
+        const char* filterName = filter == MipFilter::Box ? "box" : "kaiser";
+        for (ThreadPool* threads : { static_cast<ThreadPool*>(nullptr), &pool })
+        {
+            uint32_t threadCount = threads ? pool.GetWorkerCount() + 1 : 1;
+
+            MipOptions mipOptions;
+            mipOptions.Filter = filter;
+            mipOptions.Pool = threads;
+            std::printf("%-8s %-8s %8u %14.1f\n", filterName, "rgba8", threadCount, Measure(options, unorm, unormChain, mipCount, mipOptions));
+            std::printf("%-8s %-8s %8u %14.1f\n", filterName, "rgba32f", threadCount, Measure(options, hdr, hdrChain, mipCount, mipOptions));
+
+            mipOptions.SRGB = true;
+            std::printf("%-8s %-8s %8u %14.1f\n", filterName, "srgb8", threadCount, Measure(options, unorm, unormChain, mipCount, mipOptions));
+        }
+    }
+    return EXIT_SUCCESS;
+}
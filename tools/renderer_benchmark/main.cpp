@@ -0,0 +1,709 @@
+// Deterministic renderer benchmark over scripted scenes.
+//
+//   re_coo_bench [--scene NAME]... [--custom SPHERES,MESHES,TEXTURES]... [--frames N] [--seed N]
+//                [--size WxH] [--tracer-frames N] [--convergence-ms F] [--out PATH] [--baseline PATH] [--threshold F]
+//                [--visible]
+//
+// Every scene is generated from the seed, rendered for a fixed frame count along a fixed camera orbit in a
+// hidden window, and reported as JSON: frame time distribution, GPU pass times, samples per second, memory
+// and startup phases, plus megakernel/wavefront rays per second from PathTracerBenchmark and, after equal GPU
+// time, the RMSE of BSDF sampling against next-event estimation and of each sampler, and the RMSE and GPU time
+// of raw against denoised accumulation at a few frame counts. With --baseline the run's flat "metrics" are
+// compared against a previous report and the exit code is non-zero on a regression.
+//
+// Meshes are uploaded and count towards memory and startup, but the tracers only intersect spheres.
+
+#include "core/window.h"
+#include "renderer/scratch_renderer.h"
+#include "renderer/vulkan/model.h"
+#include "renderer/vulkan/vulkan_gpu_profiler.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    constexpr uint32_t WarmupFrameCount = 8;
+    constexpr uint32_t TracerBounceCount = 4;
+    constexpr uint32_t ConvergenceReferenceFrameCount = 1024;
+    const std::vector<uint32_t> DenoiseFrameCounts = { 1, 4, 16 };
+    constexpr uint32_t MeshSegments = 64;
+    constexpr uint32_t TextureSize = 512;
+
+    struct BenchmarkScene
+    {
+        std::string Name;
+        uint32_t SphereCount;
+        uint32_t MeshCount;
+        uint32_t TextureCount;
+    };
+
+    const BenchmarkScene Presets[] =
+    {
+        { "spheres_small", 16, 0, 0 },
+        { "spheres_large", 256, 0, 0 },
+        { "textured", 64, 0, 16 },
+        { "mixed", 64, 8, 8 },
+    };
+
+    struct Options
+    {
+        std::vector<BenchmarkScene> Scenes;
+        uint32_t FrameCount = 256;
+        uint32_t Seed = 1234;
+        uint32_t Width = 800;
+        uint32_t Height = 600;
+        uint32_t TracerFrameCount = 16;
+        double ConvergenceMilliseconds = 250.0;
+        std::string OutputPath = "re_coo_bench.json";
+        std::string BaselinePath;
+        double Threshold = 0.10;
+        bool Visible = false;
+    };
+
+    bool ParseArguments(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc)
+            {
+                const char* name = argv[++i];
+                auto preset = std::find_if(std::begin(Presets), std::end(Presets), [name](const BenchmarkScene& scene) { return scene.Name == name; });
+                if (preset == std::end(Presets))
+                    return false;
+                options.Scenes.push_back(*preset);
+            }
+            else if (std::strcmp(argv[i], "--custom") == 0 && i + 1 < argc)
+            {
+                BenchmarkScene scene{};
+                if (std::sscanf(argv[++i], "%u,%u,%u", &scene.SphereCount, &scene.MeshCount, &scene.TextureCount) != 3 || scene.SphereCount == 0)
+                    return false;
+                scene.Name = "custom_" + std::to_string(scene.SphereCount) + "_" + std::to_string(scene.MeshCount) + "_" + std::to_string(scene.TextureCount);
+                options.Scenes.push_back(scene);
+            }
+            else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+                options.FrameCount = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+            else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+                options.Seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+            {
+                if (std::sscanf(argv[++i], "%ux%u", &options.Width, &options.Height) != 2 || options.Width == 0 || options.Height == 0)
+                    return false;
+            }
+            else if (std::strcmp(argv[i], "--tracer-frames") == 0 && i + 1 < argc)
+                options.TracerFrameCount = static_cast<uint32_t>(std::max(0, std::atoi(argv[++i])));
+            else if (std::strcmp(argv[i], "--convergence-ms") == 0 && i + 1 < argc)
+                options.ConvergenceMilliseconds = std::max(0.0, std::atof(argv[++i]));
+            else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+                options.OutputPath = argv[++i];
+            else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+                options.BaselinePath = argv[++i];
+            else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+                options.Threshold = std::max(0.0, std::atof(argv[++i]));
+            else if (std::strcmp(argv[i], "--visible") == 0)
+                options.Visible = true;
+            else
+                return false;
+        }
+
+        if (options.Scenes.empty())
+            options.Scenes.assign(std::begin(Presets), std::end(Presets));
+        return true;
+    }
+
+    double MillisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    uint64_t GetPeakResidentBytes()
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+        return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+        return 0;
+#endif
+    }
+
+    // Metric names double as JSON keys, so keep them to identifier characters.
+    std::string ToMetricName(const std::string& name)
+    {
+        std::string result;
+        for (char c : name)
+        {
+            if (std::isalnum(static_cast<unsigned char>(c)))
+                result += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            else if (!result.empty() && result.back() != '_')
+                result += '_';
+        }
+        while (!result.empty() && result.back() == '_')
+            result.pop_back();
+        return result;
+    }
+
+    // Throughput metrics regress when they drop; times and sizes when they grow.
+    bool IsHigherBetter(const std::string& metric)
+    {
+        const std::string suffix = "per_second";
+        return metric.size() >= suffix.size() && metric.compare(metric.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // Counts that should stay at exactly zero, where any occurrence is a regression however small.
+    bool IsAllocationCount(const std::string& metric)
+    {
+        return metric.find("allocations_per_frame") != std::string::npos;
+    }
+
+    std::vector<Sphere> GenerateSpheres(const BenchmarkScene& scene, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::vector<Sphere> spheres;
+        spheres.reserve(scene.SphereCount);
+
+        // The orbit looks at the origin with +Z up, so scatter the spheres over a slab around it.
+        const float extent = 2.0f + std::sqrt(static_cast<float>(scene.SphereCount)) * 0.5f;
+        for (uint32_t i = 0; i < scene.SphereCount; i++)
+        {
+            const bool emissive = i % 8 == 0;
+            const float radius = 0.2f + 0.6f * unit(rng);
+
+            Sphere sphere{};
+            sphere.Position_Radius = { (unit(rng) * 2.0f - 1.0f) * extent, (unit(rng) * 2.0f - 1.0f) * extent, radius + unit(rng), radius };
+            sphere.Material.Color_Smoothness = { unit(rng), unit(rng), unit(rng), unit(rng) };
+            sphere.Material.EmissionColor_Strength = emissive ? glm::vec4(1.0f, 0.9f, 0.8f, 2.0f + 4.0f * unit(rng)) : glm::vec4(0.0f);
+            sphere.Material.SpecularColor_Probability = { 1.0f, 1.0f, 1.0f, 0.5f * unit(rng) };
+            spheres.push_back(sphere);
+        }
+        return spheres;
+    }
+
+    Model::Builder GenerateMesh(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        const glm::vec3 centre{ unit(rng) * 4.0f - 2.0f, unit(rng) * 4.0f - 2.0f, unit(rng) };
+        const glm::vec3 color{ unit(rng), unit(rng), unit(rng) };
+
+        // A UV sphere with a little seeded displacement, so no two meshes are alike.
+        Model::Builder builder{};
+        for (uint32_t ring = 0; ring <= MeshSegments; ring++)
+        {
+            const float theta = glm::pi<float>() * static_cast<float>(ring) / MeshSegments;
+            for (uint32_t segment = 0; segment <= MeshSegments; segment++)
+            {
+                const float phi = glm::two_pi<float>() * static_cast<float>(segment) / MeshSegments;
+                const glm::vec3 normal{ std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta) };
+
+                Model::Vertex vertex{};
+                vertex.Position = centre + normal * (0.5f + 0.05f * unit(rng));
+                vertex.Color = color;
+                vertex.Normal = normal;
+                vertex.Tangent = { -std::sin(phi), std::cos(phi), 0.0f };
+                vertex.UV = { static_cast<float>(segment) / MeshSegments, static_cast<float>(ring) / MeshSegments };
+                builder.Vertices.push_back(vertex);
+            }
+        }
+
+        for (uint32_t ring = 0; ring < MeshSegments; ring++)
+        {
+            for (uint32_t segment = 0; segment < MeshSegments; segment++)
+            {
+                const uint32_t a = ring * (MeshSegments + 1) + segment;
+                const uint32_t b = a + MeshSegments + 1;
+                builder.Indices.insert(builder.Indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+            }
+        }
+        return builder;
+    }
+
+    std::shared_ptr<VulkanTexture2D> GenerateTexture(VulkanDevice& deviceRef, std::mt19937& rng, uint32_t index)
+    {
+        // Seeded checkerboard with per-texel noise, so mips and compression see real variation.
+        std::uniform_int_distribution<uint32_t> byteDistribution(0, 255);
+        const uint32_t checkerSize = 8u << (index % 4);
+        const uint8_t tint[3] = { static_cast<uint8_t>(byteDistribution(rng)), static_cast<uint8_t>(byteDistribution(rng)), static_cast<uint8_t>(byteDistribution(rng)) };
+
+        std::vector<uint8_t> pixels(static_cast<size_t>(TextureSize) * TextureSize * 4);
+        for (uint32_t y = 0; y < TextureSize; y++)
+        {
+            for (uint32_t x = 0; x < TextureSize; x++)
+            {
+                const bool dark = ((x / checkerSize) + (y / checkerSize)) % 2 == 0;
+                uint8_t* texel = &pixels[(static_cast<size_t>(y) * TextureSize + x) * 4];
+                const uint32_t noise = byteDistribution(rng) % 32;
+                for (uint32_t channel = 0; channel < 3; channel++)
+                    texel[channel] = static_cast<uint8_t>(std::min<uint32_t>(255, (dark ? tint[channel] / 4 : tint[channel]) + noise));
+                texel[3] = 255;
+            }
+        }
+
+        TextureSpecification specification{};
+        specification.Format = ImageFormat::RGBA;
+        specification.Width = TextureSize;
+        specification.Height = TextureSize;
+        specification.DebugName = "BenchTexture" + std::to_string(index);
+        return std::make_shared<VulkanTexture2D>(deviceRef, specification, BufferView(pixels.data(), pixels.size()));
+    }
+
+    // The fixed camera path: one orbit over the run with a gentle bob and zoom.
+    void PlaceCamera(Camera& camera, uint32_t frame, uint32_t frameCount)
+    {
+        const float t = static_cast<float>(frame) / static_cast<float>(frameCount);
+        const glm::vec2 angles{ 0.8f + glm::two_pi<float>() * t, 0.5f + 0.15f * std::sin(2.0f * glm::two_pi<float>() * t) };
+        camera.SetOrbit(angles, -2.0f + 0.3f * std::sin(glm::two_pi<float>() * t));
+    }
+
+    struct Distribution
+    {
+        double Min = 0.0;
+        double Avg = 0.0;
+        double P50 = 0.0;
+        double P95 = 0.0;
+        double P99 = 0.0;
+        double Max = 0.0;
+    };
+
+    Distribution Summarize(std::vector<double> samples)
+    {
+        Distribution distribution{};
+        if (samples.empty())
+            return distribution;
+
+        std::sort(samples.begin(), samples.end());
+        double sum = 0.0;
+        for (double sample : samples)
+            sum += sample;
+
+        // Nearest rank.
+        auto percentile = [&samples](double p)
+        {
+            const size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(samples.size())));
+            return samples[std::max<size_t>(rank, 1) - 1];
+        };
+        distribution.Min = samples.front();
+        distribution.Avg = sum / static_cast<double>(samples.size());
+        distribution.P50 = percentile(0.50);
+        distribution.P95 = percentile(0.95);
+        distribution.P99 = percentile(0.99);
+        distribution.Max = samples.back();
+        return distribution;
+    }
+
+    struct SceneResult
+    {
+        BenchmarkScene Scene;
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        std::vector<std::pair<std::string, double>> StartupMilliseconds;
+        Distribution FrameMilliseconds;
+        double SamplesPerSecond = 0.0;
+        std::vector<GpuScopeStatistics> GpuPasses;
+        std::vector<PathTracerBenchmarkResult> Tracers;
+        std::vector<PathTracerConvergenceResult> LightSampling;
+        std::vector<PathTracerConvergenceResult> Samplers;
+        std::vector<PathTracerConvergenceResult> Denoising;
+        uint64_t DeviceLocalBytes = 0;
+        uint64_t PeakResidentBytes = 0;
+        // Buffers allocated from the heap per timed frame; arenas and pools should keep this at zero.
+        double HeapBufferAllocationsPerFrame = 0.0;
+    };
+
+    uint64_t GetHeapBufferAllocationCount()
+    {
+        return HeapAllocator::Get().GetStatistics().Allocations + MallocAllocator::Get().GetStatistics().Allocations;
+    }
+
+    SceneResult RunScene(Window& window, VulkanDevice& deviceRef, const BenchmarkScene& scene, const Options& options)
+    {
+        SceneResult result{};
+        result.Scene = scene;
+
+        // Every scene restarts the generator, so adding or reordering scenes does not change the others.
+        std::mt19937 rng(options.Seed);
+
+        auto phaseStart = std::chrono::steady_clock::now();
+        std::vector<Sphere> spheres = GenerateSpheres(scene, rng);
+        std::vector<Model::Builder> meshBuilders;
+        for (uint32_t i = 0; i < scene.MeshCount; i++)
+            meshBuilders.push_back(GenerateMesh(rng));
+        result.StartupMilliseconds.emplace_back("scene_generate", MillisecondsSince(phaseStart));
+
+        phaseStart = std::chrono::steady_clock::now();
+        RTRenderer renderer(window, deviceRef);
+        renderer.SetSpheres(std::move(spheres));
+        renderer.Initialize();
+        result.StartupMilliseconds.emplace_back("renderer_initialize", MillisecondsSince(phaseStart));
+
+        phaseStart = std::chrono::steady_clock::now();
+        std::vector<std::unique_ptr<Model>> meshes;
+        for (const Model::Builder& builder : meshBuilders)
+            meshes.push_back(std::make_unique<Model>(deviceRef, builder));
+        result.StartupMilliseconds.emplace_back("mesh_upload", MillisecondsSince(phaseStart));
+
+        phaseStart = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < scene.TextureCount; i++)
+        {
+            BindlessHandle handle = renderer.AddTexture(GenerateTexture(deviceRef, rng, i));
+            renderer.SetSphereAlbedo(i % scene.SphereCount, handle);
+        }
+        result.StartupMilliseconds.emplace_back("texture_upload", MillisecondsSince(phaseStart));
+
+        Camera camera{};
+        camera.SetPerspectiveProjection(glm::radians(50.0f), renderer.GetAspectRatio(), 0.1f, 100.0f);
+        result.Width = renderer.GetWidth();
+        result.Height = renderer.GetHeight();
+
+        VulkanGpuProfiler& profiler = deviceRef.GetGpuProfiler();
+        vkDeviceWaitIdle(deviceRef.GetDevice());
+        profiler.Flush();
+        profiler.ClearSamples();
+
+        // Frame times are the intervals between Draw returns, so they include waiting on the frame in flight.
+        std::vector<double> frameMilliseconds;
+        frameMilliseconds.reserve(options.FrameCount);
+        auto runStart = std::chrono::steady_clock::now();
+        auto frameStart = runStart;
+        auto timedStart = runStart;
+        uint64_t timedStartAllocations = GetHeapBufferAllocationCount();
+        for (uint32_t frame = 0; frame < WarmupFrameCount + options.FrameCount; frame++)
+        {
+            PlaceCamera(camera, frame, WarmupFrameCount + options.FrameCount);
+            renderer.Draw(camera);
+
+            auto frameEnd = std::chrono::steady_clock::now();
+            if (frame == 0)
+                result.StartupMilliseconds.emplace_back("first_frame", std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+            if (frame + 1 == WarmupFrameCount)
+            {
+                timedStart = frameEnd;
+                timedStartAllocations = GetHeapBufferAllocationCount();
+            }
+            else if (frame >= WarmupFrameCount)
+                frameMilliseconds.push_back(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+            frameStart = frameEnd;
+        }
+        vkDeviceWaitIdle(deviceRef.GetDevice());
+
+        const double timedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - timedStart).count();
+        const double samples = static_cast<double>(result.Width) * result.Height * options.FrameCount;
+        result.SamplesPerSecond = timedSeconds > 0.0 ? samples / timedSeconds : 0.0;
+        result.FrameMilliseconds = Summarize(std::move(frameMilliseconds));
+        result.HeapBufferAllocationsPerFrame = options.FrameCount > 0
+                ? static_cast<double>(GetHeapBufferAllocationCount() - timedStartAllocations) / options.FrameCount
+                : 0.0;
+
+        profiler.Flush();
+        result.GpuPasses = profiler.GetStatistics();
+        result.DeviceLocalBytes = deviceRef.GetDeviceLocalMemoryUsage();
+        result.PeakResidentBytes = GetPeakResidentBytes();
+
+        if (options.TracerFrameCount > 0)
+        {
+            PlaceCamera(camera, 0, 1);
+            result.Tracers = renderer.CompareTracers(camera, { TracerBounceCount }, options.TracerFrameCount);
+        }
+        if (options.ConvergenceMilliseconds > 0.0)
+        {
+            PlaceCamera(camera, 0, 1);
+            result.LightSampling = renderer.CompareLightSampling(camera, TracerBounceCount, options.ConvergenceMilliseconds, ConvergenceReferenceFrameCount);
+            result.Samplers = renderer.CompareSamplers(camera, TracerBounceCount, options.ConvergenceMilliseconds, ConvergenceReferenceFrameCount);
+            result.Denoising = renderer.CompareDenoising(camera, TracerBounceCount, DenoiseFrameCounts, ConvergenceReferenceFrameCount);
+        }
+
+        vkDeviceWaitIdle(deviceRef.GetDevice());
+        return result;
+    }
+
+    void WriteString(std::ostream& out, const std::string& value)
+    {
+        out << '"';
+        for (char c : value)
+        {
+            if (c == '"' || c == '\\')
+                out << '\\';
+            out << c;
+        }
+        out << '"';
+    }
+
+    void WriteDistribution(std::ostream& out, const Distribution& distribution)
+    {
+        out << "{\"min\": " << distribution.Min << ", \"avg\": " << distribution.Avg << ", \"p50\": " << distribution.P50
+            << ", \"p95\": " << distribution.P95 << ", \"p99\": " << distribution.P99 << ", \"max\": " << distribution.Max << "}";
+    }
+
+    void WriteConvergence(std::ostream& out, const std::vector<PathTracerConvergenceResult>& results)
+    {
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            out << (i ? "," : "") << "\n        {\"name\": ";
+            WriteString(out, results[i].Label);
+            out << ", \"frames\": " << results[i].FrameCount << ", \"gpu_ms\": " << results[i].GpuMilliseconds
+                << ", \"rmse\": " << results[i].Rmse << "}";
+        }
+    }
+
+    // Flattened "<scene>.<metric>" values, the part of the report --baseline compares.
+    std::vector<std::pair<std::string, double>> GetMetrics(const std::vector<std::pair<std::string, double>>& processStartup, const std::vector<SceneResult>& results)
+    {
+        std::vector<std::pair<std::string, double>> metrics;
+        for (const auto& [phase, milliseconds] : processStartup)
+            metrics.emplace_back("startup." + phase + "_ms", milliseconds);
+
+        for (const SceneResult& result : results)
+        {
+            const std::string prefix = result.Scene.Name + ".";
+            for (const auto& [phase, milliseconds] : result.StartupMilliseconds)
+                metrics.emplace_back(prefix + "startup_" + phase + "_ms", milliseconds);
+
+            metrics.emplace_back(prefix + "frame_ms_avg", result.FrameMilliseconds.Avg);
+            metrics.emplace_back(prefix + "frame_ms_p50", result.FrameMilliseconds.P50);
+            metrics.emplace_back(prefix + "frame_ms_p99", result.FrameMilliseconds.P99);
+            metrics.emplace_back(prefix + "samples_per_second", result.SamplesPerSecond);
+            metrics.emplace_back(prefix + "heap_buffer_allocations_per_frame", result.HeapBufferAllocationsPerFrame);
+
+            for (const GpuScopeStatistics& pass : result.GpuPasses)
+            {
+                const std::string name = prefix + "gpu_" + ToMetricName(pass.Name);
+                metrics.emplace_back(name + "_ms_avg", pass.AvgMilliseconds);
+                metrics.emplace_back(name + "_ms_p99", pass.P99Milliseconds);
+            }
+            for (const PathTracerBenchmarkResult& tracer : result.Tracers)
+                metrics.emplace_back(prefix + ToMetricName(tracer.TracerName) + "_rays_per_second", tracer.GetRaysPerSecond());
+            for (const PathTracerConvergenceResult& sampling : result.LightSampling)
+                metrics.emplace_back(prefix + "rmse_" + ToMetricName(sampling.Label), sampling.Rmse);
+            for (const PathTracerConvergenceResult& sampler : result.Samplers)
+                metrics.emplace_back(prefix + "rmse_sampler_" + ToMetricName(sampler.Label), sampler.Rmse);
+            for (const PathTracerConvergenceResult& denoising : result.Denoising)
+            {
+                const std::string name = prefix + "denoise_" + ToMetricName(denoising.Label);
+                metrics.emplace_back(name + "_rmse", denoising.Rmse);
+                metrics.emplace_back(name + "_gpu_ms", denoising.GpuMilliseconds);
+            }
+
+            if (result.DeviceLocalBytes > 0)
+                metrics.emplace_back(prefix + "device_local_bytes", static_cast<double>(result.DeviceLocalBytes));
+        }
+        return metrics;
+    }
+
+    void WriteReport(
+            std::ostream& out,
+            VulkanDevice& deviceRef,
+            const Options& options,
+            const std::vector<std::pair<std::string, double>>& processStartup,
+            const std::vector<SceneResult>& results,
+            const std::vector<std::pair<std::string, double>>& metrics)
+    {
+        out.precision(9);
+        out << "{\n  \"version\": 1,\n  \"device\": ";
+        WriteString(out, deviceRef.PhysicalDeviceProperties.deviceName);
+        out << ",\n  \"seed\": " << options.Seed << ",\n  \"frames\": " << options.FrameCount
+            << ",\n  \"warmup_frames\": " << WarmupFrameCount << ",\n  \"startup_ms\": {";
+        for (size_t i = 0; i < processStartup.size(); i++)
+            out << (i ? ", " : "") << "\"" << processStartup[i].first << "\": " << processStartup[i].second;
+        out << "},\n  \"scenes\": [";
+
+        for (size_t sceneIndex = 0; sceneIndex < results.size(); sceneIndex++)
+        {
+            const SceneResult& result = results[sceneIndex];
+            out << (sceneIndex ? "," : "") << "\n    {\n      \"name\": ";
+            WriteString(out, result.Scene.Name);
+            out << ",\n      \"spheres\": " << result.Scene.SphereCount << ", \"meshes\": " << result.Scene.MeshCount
+                << ", \"textures\": " << result.Scene.TextureCount << ",\n      \"width\": " << result.Width << ", \"height\": " << result.Height
+                << ",\n      \"startup_ms\": {";
+            for (size_t i = 0; i < result.StartupMilliseconds.size(); i++)
+                out << (i ? ", " : "") << "\"" << result.StartupMilliseconds[i].first << "\": " << result.StartupMilliseconds[i].second;
+            out << "},\n      \"frame_ms\": ";
+            WriteDistribution(out, result.FrameMilliseconds);
+            out << ",\n      \"samples_per_second\": " << result.SamplesPerSecond << ",\n      \"gpu_passes\": [";
+            for (size_t i = 0; i < result.GpuPasses.size(); i++)
+            {
+                const GpuScopeStatistics& pass = result.GpuPasses[i];
+                out << (i ? "," : "") << "\n        {\"name\": ";
+                WriteString(out, pass.Name);
+                out << ", \"queue\": \"" << VulkanGpuProfiler::GetQueueName(pass.Queue) << "\", \"depth\": " << pass.Depth
+                    << ", \"samples\": " << pass.SampleCount << ", \"min_ms\": " << pass.MinMilliseconds
+                    << ", \"avg_ms\": " << pass.AvgMilliseconds << ", \"p99_ms\": " << pass.P99Milliseconds << "}";
+            }
+            out << "\n      ],\n      \"tracers\": [";
+            for (size_t i = 0; i < result.Tracers.size(); i++)
+            {
+                const PathTracerBenchmarkResult& tracer = result.Tracers[i];
+                out << (i ? "," : "") << "\n        {\"name\": ";
+                WriteString(out, tracer.TracerName);
+                out << ", \"bounces\": " << tracer.MaxBounceCount << ", \"ms_per_frame\": " << tracer.GetMillisecondsPerFrame()
+                    << ", \"rays_per_second\": " << tracer.GetRaysPerSecond() << "}";
+            }
+            out << "\n      ],\n      \"light_sampling\": [";
+            WriteConvergence(out, result.LightSampling);
+            out << "\n      ],\n      \"samplers\": [";
+            WriteConvergence(out, result.Samplers);
+            out << "\n      ],\n      \"denoising\": [";
+            WriteConvergence(out, result.Denoising);
+            out << "\n      ],\n      \"memory\": {\"device_local_bytes\": " << result.DeviceLocalBytes
+                << ", \"peak_resident_bytes\": " << result.PeakResidentBytes << "}\n    }";
+        }
+
+        out << "\n  ],\n  \"metrics\": {";
+        for (size_t i = 0; i < metrics.size(); i++)
+            out << (i ? "," : "") << "\n    \"" << metrics[i].first << "\": " << metrics[i].second;
+        out << "\n  }\n}\n";
+    }
+
+    // Reads the "metrics" object of a previous report. Only understands the flat shape WriteReport emits.
+    bool ReadBaselineMetrics(const std::string& path, std::map<std::string, double>& outMetrics)
+    {
+        std::ifstream file(path);
+        if (!file)
+            return false;
+        std::stringstream contents;
+        contents << file.rdbuf();
+        const std::string text = contents.str();
+
+        size_t position = text.find("\"metrics\"");
+        if (position == std::string::npos || (position = text.find('{', position)) == std::string::npos)
+            return false;
+        position++;
+
+        while (true)
+        {
+            position = text.find_first_not_of(" \t\r\n,", position);
+            if (position == std::string::npos)
+                return false;
+            if (text[position] == '}')
+                return true;
+            if (text[position] != '"')
+                return false;
+
+            const size_t nameEnd = text.find('"', position + 1);
+            const size_t colon = nameEnd == std::string::npos ? std::string::npos : text.find(':', nameEnd);
+            if (colon == std::string::npos)
+                return false;
+
+            const char* valueStart = text.c_str() + colon + 1;
+            char* valueEnd = nullptr;
+            const double value = std::strtod(valueStart, &valueEnd);
+            if (valueEnd == valueStart)
+                return false;
+
+            outMetrics[text.substr(position + 1, nameEnd - position - 1)] = value;
+            position = static_cast<size_t>(valueEnd - text.c_str());
+        }
+    }
+
+    // Prints every metric the baseline shares with this run and returns how many regressed past the threshold.
+    uint32_t CompareWithBaseline(const std::map<std::string, double>& baseline, const std::vector<std::pair<std::string, double>>& metrics, double threshold)
+    {
+        uint32_t regressionCount = 0;
+        std::printf("\n%-56s %14s %14s %9s\n", "metric", "baseline", "current", "change");
+        for (const auto& [name, value] : metrics)
+        {
+            auto it = baseline.find(name);
+            if (it == baseline.end())
+            {
+                std::printf("%-56s %14s %14.4g %9s\n", name.c_str(), "-", value, "new");
+                continue;
+            }
+
+            const double change = it->second != 0.0 ? (value - it->second) / std::abs(it->second) : 0.0;
+            // Allocations that were zero regress as soon as they show up at all. Other metrics with a zero
+            // baseline, like a timing that rounded to nothing, have no meaningful relative change.
+            const bool regressed = it->second == 0.0
+                    ? IsAllocationCount(name) && value > 0.0
+                    : IsHigherBetter(name) ? change < -threshold : change > threshold;
+            regressionCount += regressed ? 1 : 0;
+            std::printf("%-56s %14.4g %14.4g %+8.1f%%%s\n", name.c_str(), it->second, value, change * 100.0, regressed ? "  REGRESSION" : "");
+        }
+        return regressionCount;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseArguments(argc, argv, options))
+    {
+        std::fprintf(stderr,
+                     "usage: re_coo_bench [--scene NAME]... [--custom SPHERES,MESHES,TEXTURES]... [--frames N] [--seed N]\n"
+                     "                    [--size WxH] [--tracer-frames N] [--convergence-ms F] [--out PATH] [--baseline PATH]\n"
+                     "                    [--threshold F] [--visible]\n"
+                     "scenes:");
+        for (const BenchmarkScene& preset : Presets)
+            std::fprintf(stderr, " %s", preset.Name.c_str());
+        std::fprintf(stderr, "\n");
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        std::vector<std::pair<std::string, double>> processStartup;
+
+        auto phaseStart = std::chrono::steady_clock::now();
+        Window window(static_cast<int>(options.Width), static_cast<int>(options.Height), "re_coo_bench", options.Visible);
+        processStartup.emplace_back("window", MillisecondsSince(phaseStart));
+
+        phaseStart = std::chrono::steady_clock::now();
+        VulkanDevice device(window);
+        processStartup.emplace_back("device", MillisecondsSince(phaseStart));
+
+        std::vector<SceneResult> results;
+        for (const BenchmarkScene& scene : options.Scenes)
+        {
+            std::printf("%s: %u spheres, %u meshes, %u textures, %u frames\n", scene.Name.c_str(), scene.SphereCount, scene.MeshCount, scene.TextureCount, options.FrameCount);
+            results.push_back(RunScene(window, device, scene, options));
+
+            const SceneResult& result = results.back();
+            std::printf("  frame ms avg %.3f p99 %.3f, %.1f Msamples/s\n", result.FrameMilliseconds.Avg, result.FrameMilliseconds.P99, result.SamplesPerSecond * 1e-6);
+        }
+
+        const std::vector<std::pair<std::string, double>> metrics = GetMetrics(processStartup, results);
+        std::ofstream report(options.OutputPath);
+        WriteReport(report, device, options, processStartup, results, metrics);
+        std::printf("Wrote %s\n", options.OutputPath.c_str());
+
+        if (!options.BaselinePath.empty())
+        {
+            std::map<std::string, double> baseline;
+            if (!ReadBaselineMetrics(options.BaselinePath, baseline))
+                throw std::runtime_error("Failed to read baseline metrics from " + options.BaselinePath);
+
+            const uint32_t regressionCount = CompareWithBaseline(baseline, metrics, options.Threshold);
+            if (regressionCount > 0)
+            {
+                std::printf("%u metric(s) regressed by more than %.0f%%\n", regressionCount, options.Threshold * 100.0);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,331 @@
+// Offline texture compressor: PNG/JPG/TGA/HDR in, KTX2 with a full mip chain out.
+//
+//   re_coo_texconv <input> <output.ktx2> [--format bc1|bc3|bc5|bc7|rgba8] [--srgb] [--no-mips] [--mip-filter box|kaiser]
+//                  [--wrap] [--threads N] [--verify] [--virtual]
+//
+// HDR inputs are written as RGBA32F; BC6H is not implemented. --virtual writes a tiled virtual texture
+// (VirtualTextureFile, conventionally .vtex) instead: 128 texel pages with 4 texel borders, LDR inputs only.
+
+#include "core/thread_pool.h"
+#include "renderer/texture/bc_encoder.h"
+#include "renderer/texture/mip_generator.h"
+#include "renderer/texture/texture_container.h"
+#include "renderer/texture/virtual_texture_file.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Options
+    {
+        std::string InputPath;
+        std::string OutputPath;
+        std::string Format = "bc7";
+        bool SRGB = false;
+        bool GenerateMips = true;
+        MipFilter Filter = MipFilter::Kaiser;
+        bool Wrap = false;
+        bool Verify = false;
+        bool Virtual = false;
+        uint32_t ThreadCount = ThreadPool::GetDefaultWorkerCount() + 1;
+    };
+
+    void PrintUsage()
+    {
+        std::cerr << "usage: re_coo_texconv <input> <output.ktx2> [--format bc1|bc3|bc5|bc7|rgba8] [--srgb] [--no-mips]"
+                     " [--mip-filter box|kaiser] [--wrap] [--threads N] [--verify] [--virtual]\n";
+    }
+
+    std::optional<Options> ParseArguments(int argc, char** argv)
+    {
+        if (argc < 3)
+            return std::nullopt;
+
+        Options options;
+        options.InputPath = argv[1];
+        options.OutputPath = argv[2];
+
+        for (int i = 3; i < argc; i++)
+        {
+            if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+                options.Format = argv[++i];
+            else if (std::strcmp(argv[i], "--srgb") == 0)
+                options.SRGB = true;
+            else if (std::strcmp(argv[i], "--no-mips") == 0)
+                options.GenerateMips = false;
+            else if (std::strcmp(argv[i], "--mip-filter") == 0 && i + 1 < argc)
+            {
+                std::string filter = argv[++i];
+                if (filter != "box" && filter != "kaiser")
+                    return std::nullopt;
+                options.Filter = filter == "box" ? MipFilter::Box : MipFilter::Kaiser;
+            }
+            else if (std::strcmp(argv[i], "--wrap") == 0)
+                options.Wrap = true;
+            else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+                options.ThreadCount = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+            else if (std::strcmp(argv[i], "--verify") == 0)
+                options.Verify = true;
+            else if (std::strcmp(argv[i], "--virtual") == 0)
+                options.Virtual = true;
+            else
+                return std::nullopt;
+        }
+        return options;
+    }
+
+    std::optional<BlockFormat> ToBlockFormat(const std::string& name)
+    {
+        if (name == "bc1") return BlockFormat::BC1;
+        if (name == "bc3") return BlockFormat::BC3;
+        if (name == "bc5") return BlockFormat::BC5;
+        if (name == "bc7") return BlockFormat::BC7;
+        return std::nullopt;
+    }
+
+    VkFormat ToVulkanFormat(BlockFormat format, bool srgb)
+    {
+        switch (format)
+        {
+            case BlockFormat::BC1: return srgb ? VK_FORMAT_BC1_RGBA_SRGB_BLOCK : VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+            case BlockFormat::BC3: return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+            case BlockFormat::BC5: return VK_FORMAT_BC5_UNORM_BLOCK;
+            case BlockFormat::BC7: return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+        }
+        return VK_FORMAT_UNDEFINED;
+    }
+
+    double ComputePSNR(const uint8_t* reference, const uint8_t* decoded, size_t texelCount, uint32_t channelCount)
+    {
+        double squaredError = 0.0;
+        for (size_t i = 0; i < texelCount; i++)
+        {
+            for (uint32_t c = 0; c < channelCount; c++)
+            {
+                double delta = static_cast<double>(reference[i * 4 + c]) - static_cast<double>(decoded[i * 4 + c]);
+                squaredError += delta * delta;
+            }
+        }
+
+        double meanSquaredError = squaredError / static_cast<double>(texelCount * channelCount);
+        return meanSquaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) : INFINITY;
+    }
+
+    // Cuts the mip chain into bordered pages. Border texels are clamped at the image edge, or taken from
+    // the opposite edge when the texture wraps.
+    int WriteVirtualTexture(const Options& options, std::optional<BlockFormat> blockFormat, const MipOptions& mipOptions, ThreadPool& pool)
+    {
+        if (stbi_is_hdr(options.InputPath.c_str()) || (!blockFormat && options.SRGB))
+        {
+            std::cerr << "Virtual textures hold BCn or UNORM RGBA8 pages\n";
+            return EXIT_FAILURE;
+        }
+
+        int width, height, channels;
+        stbi_uc* pixels = stbi_load(options.InputPath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels)
+        {
+            std::cerr << "Failed to load " << options.InputPath << ": " << stbi_failure_reason() << "\n";
+            return EXIT_FAILURE;
+        }
+
+        VirtualTextureLayout layout(width, height);
+        uint32_t mipCount = layout.GetMipCount();
+        std::vector<uint8_t> chain(MipGeneration::GetChainTexelCount(width, height, mipCount) * 4);
+        std::memcpy(chain.data(), pixels, static_cast<size_t>(width) * height * 4);
+        stbi_image_free(pixels);
+        MipGeneration::Generate(chain.data(), width, height, mipCount, chain.data() + static_cast<size_t>(width) * height * 4, mipOptions);
+
+        std::vector<size_t> levelOffsets(mipCount, 0);
+        for (uint32_t mip = 1; mip < mipCount; mip++)
+            levelOffsets[mip] = levelOffsets[mip - 1] + static_cast<size_t>(layout.GetLevelWidth(mip - 1)) * layout.GetLevelHeight(mip - 1) * 4;
+
+        uint32_t paddedPageSize = layout.GetPaddedPageSize();
+        std::vector<uint8_t> page(static_cast<size_t>(paddedPageSize) * paddedPageSize * 4);
+        auto resolve = [&options](int64_t coordinate, uint32_t extent)
+        {
+            if (options.Wrap)
+                return static_cast<uint32_t>(((coordinate % extent) + extent) % extent);
+            return static_cast<uint32_t>(std::clamp<int64_t>(coordinate, 0, extent - 1));
+        };
+
+        VkFormat format = blockFormat ? ToVulkanFormat(*blockFormat, options.SRGB) : VK_FORMAT_R8G8B8A8_UNORM;
+        bool written = VirtualTextureFile::Write(options.OutputPath, layout, format, [&](const VirtualPage& virtualPage, std::vector<uint8_t>& output)
+        {
+            uint32_t levelWidth = layout.GetLevelWidth(virtualPage.Mip);
+            uint32_t levelHeight = layout.GetLevelHeight(virtualPage.Mip);
+            const uint8_t* level = chain.data() + levelOffsets[virtualPage.Mip];
+            int64_t originX = static_cast<int64_t>(virtualPage.X) * layout.GetPageSize() - layout.GetBorder();
+            int64_t originY = static_cast<int64_t>(virtualPage.Y) * layout.GetPageSize() - layout.GetBorder();
+
+            for (uint32_t y = 0; y < paddedPageSize; y++)
+            {
+                const uint8_t* row = level + static_cast<size_t>(resolve(originY + y, levelHeight)) * levelWidth * 4;
+                for (uint32_t x = 0; x < paddedPageSize; x++)
+                    std::memcpy(&page[(static_cast<size_t>(y) * paddedPageSize + x) * 4], row + static_cast<size_t>(resolve(originX + x, levelWidth)) * 4, 4);
+            }
+
+            if (blockFormat)
+                BlockCompression::CompressImage(*blockFormat, page.data(), paddedPageSize, paddedPageSize, output.data(), &pool);
+            else
+                std::memcpy(output.data(), page.data(), page.size());
+        });
+
+        if (!written)
+        {
+            std::cerr << "Failed to write " << options.OutputPath << "\n";
+            return EXIT_FAILURE;
+        }
+
+        std::cout << options.InputPath << " -> " << options.OutputPath << ": " << width << "x" << height << ", "
+                  << mipCount << " levels, " << layout.GetStoredPageCount() << " pages of " << paddedPageSize << "x" << paddedPageSize << "\n";
+        return EXIT_SUCCESS;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::optional<Options> parsed = ParseArguments(argc, argv);
+    if (!parsed)
+    {
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+    const Options& options = *parsed;
+
+    std::optional<BlockFormat> blockFormat = ToBlockFormat(options.Format);
+    if (!blockFormat && options.Format != "rgba8")
+    {
+        std::cerr << "Unknown format: " << options.Format << "\n";
+        return EXIT_FAILURE;
+    }
+
+    ThreadPool pool(std::max(options.ThreadCount - 1, 1u));
+    auto start = std::chrono::steady_clock::now();
+
+    int width, height, channels;
+    TextureContainer container;
+    size_t sourceBytes = 0;
+
+    MipOptions mipOptions;
+    mipOptions.Filter = options.Filter;
+    mipOptions.SRGB = options.SRGB;
+    mipOptions.Wrap = options.Wrap;
+    mipOptions.Pool = &pool;
+
+    if (options.Virtual)
+        return WriteVirtualTexture(options, blockFormat, mipOptions, pool);
+
+    if (stbi_is_hdr(options.InputPath.c_str()))
+    {
+        float* pixels = stbi_loadf(options.InputPath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels)
+        {
+            std::cerr << "Failed to load " << options.InputPath << ": " << stbi_failure_reason() << "\n";
+            return EXIT_FAILURE;
+        }
+
+        std::cout << "HDR input, writing RGBA32F\n";
+        container.Format = VK_FORMAT_R32G32B32A32_SFLOAT;
+        container.Width = width;
+        container.Height = height;
+
+        uint32_t mipCount = options.GenerateMips ? MipGeneration::GetMipCount(width, height) : 1;
+        std::vector<float> chain(MipGeneration::GetChainTexelCount(width, height, mipCount) * 4);
+        std::memcpy(chain.data(), pixels, static_cast<size_t>(width) * height * 4 * sizeof(float));
+        stbi_image_free(pixels);
+        MipGeneration::Generate(chain.data(), width, height, mipCount, chain.data() + static_cast<size_t>(width) * height * 4, mipOptions);
+
+        size_t offset = 0;
+        for (uint32_t mip = 0; mip < mipCount; mip++)
+        {
+            uint32_t levelWidth = MipGeneration::GetMipExtent(width, mip);
+            uint32_t levelHeight = MipGeneration::GetMipExtent(height, mip);
+            size_t levelFloats = static_cast<size_t>(levelWidth) * levelHeight * 4;
+            sourceBytes += levelFloats * sizeof(float);
+            container.AddLevel(levelWidth, levelHeight, chain.data() + offset, levelFloats * sizeof(float));
+            offset += levelFloats;
+        }
+    }
+    else
+    {
+        stbi_uc* pixels = stbi_load(options.InputPath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels)
+        {
+            std::cerr << "Failed to load " << options.InputPath << ": " << stbi_failure_reason() << "\n";
+            return EXIT_FAILURE;
+        }
+
+        container.Format = blockFormat ? ToVulkanFormat(*blockFormat, options.SRGB)
+                                       : (options.SRGB ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM);
+        container.Width = width;
+        container.Height = height;
+
+        uint32_t mipCount = options.GenerateMips ? MipGeneration::GetMipCount(width, height) : 1;
+        std::vector<uint8_t> chain(MipGeneration::GetChainTexelCount(width, height, mipCount) * 4);
+        std::memcpy(chain.data(), pixels, static_cast<size_t>(width) * height * 4);
+        stbi_image_free(pixels);
+        MipGeneration::Generate(chain.data(), width, height, mipCount, chain.data() + static_cast<size_t>(width) * height * 4, mipOptions);
+
+        double worstPSNR = INFINITY;
+        size_t offset = 0;
+        for (uint32_t mip = 0; mip < mipCount; mip++)
+        {
+            uint32_t levelWidth = MipGeneration::GetMipExtent(width, mip);
+            uint32_t levelHeight = MipGeneration::GetMipExtent(height, mip);
+            const uint8_t* level = chain.data() + offset;
+            size_t levelBytes = static_cast<size_t>(levelWidth) * levelHeight * 4;
+            offset += levelBytes;
+            sourceBytes += levelBytes;
+
+            if (blockFormat)
+            {
+                std::vector<uint8_t> compressed(BlockCompression::GetCompressedSize(*blockFormat, levelWidth, levelHeight));
+                BlockCompression::CompressImage(*blockFormat, level, levelWidth, levelHeight, compressed.data(), &pool);
+                container.AddLevel(levelWidth, levelHeight, compressed.data(), compressed.size());
+
+                if (options.Verify)
+                {
+                    std::vector<uint8_t> decoded(levelBytes);
+                    BlockCompression::DecompressImage(*blockFormat, compressed.data(), levelWidth, levelHeight, decoded.data());
+                    uint32_t comparedChannels = *blockFormat == BlockFormat::BC5 ? 2 : (*blockFormat == BlockFormat::BC1 ? 3 : 4);
+                    double psnr = ComputePSNR(level, decoded.data(), static_cast<size_t>(levelWidth) * levelHeight, comparedChannels);
+                    std::cout << "  mip " << mip << " (" << levelWidth << "x" << levelHeight << "): " << psnr << " dB\n";
+                    worstPSNR = std::min(worstPSNR, psnr);
+                }
+            }
+            else
+            {
+                container.AddLevel(levelWidth, levelHeight, level, levelBytes);
+            }
+        }
+
+        if (options.Verify && blockFormat)
+            std::cout << "Worst mip PSNR: " << worstPSNR << " dB\n";
+    }
+
+    if (!Ktx2::Write(options.OutputPath, container))
+    {
+        std::cerr << "Failed to write " << options.OutputPath << "\n";
+        return EXIT_FAILURE;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << options.InputPath << " -> " << options.OutputPath << ": "
+              << width << "x" << height << ", " << container.Levels.size() << " levels, "
+              << sourceBytes / 1024 << " KiB -> " << container.Data.size() / 1024 << " KiB in "
+              << seconds * 1000.0 << " ms (" << (static_cast<double>(sourceBytes) / (1024.0 * 1024.0)) / seconds << " MB/s, "
+              << pool.GetWorkerCount() + 1 << " threads)\n";
+    return EXIT_SUCCESS;
+}
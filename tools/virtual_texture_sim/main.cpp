@@ -0,0 +1,230 @@
+// Drives the virtual texture page cache with synthetic feedback, no GPU needed.
+//
+//   re_coo_vtsim [--size N] [--frames N] [--slots N] [--latency N] [--max-loads N] [--seed N]
+//
+// A camera pans and zooms over an N x N virtual texture. Every frame its visible pages are turned into the
+// same feedback bitset the shaders write, loads complete after a fixed latency under a per-frame cap, and
+// the cache's tables and indirection are checked. Exits non-zero on the first inconsistency.
+
+#include "renderer/texture/virtual_page_cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Options
+    {
+        uint32_t Size = 16384;
+        uint32_t Frames = 1200;
+        uint32_t SlotsPerSide = 30;
+        uint32_t Latency = 3;
+        uint32_t MaxLoads = 32;
+        uint32_t Seed = 1;
+    };
+
+    bool ParseArguments(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            if (i + 1 >= argc)
+                return false;
+
+            uint32_t value = static_cast<uint32_t>(std::max(0, std::atoi(argv[i + 1])));
+            if (std::strcmp(argv[i], "--size") == 0 && value > 0)
+                options.Size = value;
+            else if (std::strcmp(argv[i], "--frames") == 0 && value > 0)
+                options.Frames = value;
+            else if (std::strcmp(argv[i], "--slots") == 0 && value > 1 && value <= 256)
+                options.SlotsPerSide = value;
+            else if (std::strcmp(argv[i], "--latency") == 0)
+                options.Latency = value;
+            else if (std::strcmp(argv[i], "--max-loads") == 0 && value > 0)
+                options.MaxLoads = value;
+            else if (std::strcmp(argv[i], "--seed") == 0)
+                options.Seed = value;
+            else
+                return false;
+            i++;
+        }
+        return true;
+    }
+
+    struct PendingLoad
+    {
+        VirtualPage Page;
+        uint32_t ReadyFrame;
+    };
+
+    constexpr uint32_t ScreenWidth = 1920;
+    constexpr uint32_t ScreenHeight = 1080;
+    // One feedback sample per SampleStride pixels in each direction, like a shader writing at reduced rate.
+    constexpr uint32_t SampleStride = 16;
+
+    // Mirrors SampleVirtualTexture in virtual_texture.glsl.
+    VirtualPage GetRequestedPage(const VirtualTextureLayout& layout, float u, float v, float uvFootprint)
+    {
+        float level = std::floor(std::log2(std::max(uvFootprint * static_cast<float>(layout.GetWidth()), 1.0f)));
+        auto mip = static_cast<uint32_t>(std::clamp(level, 0.0f, static_cast<float>(layout.GetMipCount() - 1)));
+
+        u -= std::floor(u);
+        v -= std::floor(v);
+        auto x = static_cast<uint32_t>(u * static_cast<float>(layout.GetLevelWidth(mip))) / layout.GetPageSize();
+        auto y = static_cast<uint32_t>(v * static_cast<float>(layout.GetLevelHeight(mip))) / layout.GetPageSize();
+        return { mip, std::min(x, layout.GetPageCountX(mip) - 1), std::min(y, layout.GetPageCountY(mip) - 1) };
+    }
+
+    // Every stored page must resolve to itself or an ancestor that actually owns the slot it names.
+    bool ValidateIndirection(const VirtualPageCache& cache, const std::vector<uint8_t>& entries, std::string& error)
+    {
+        const VirtualTextureLayout& layout = cache.GetLayout();
+        for (uint32_t mip = 0; mip < layout.GetMipCount(); mip++)
+        {
+            for (uint32_t y = 0; y < layout.GetPageCountY(mip); y++)
+            {
+                for (uint32_t x = 0; x < layout.GetPageCountX(mip); x++)
+                {
+                    VirtualPage page = { mip, x, y };
+                    const uint8_t* entry = &entries[static_cast<size_t>(layout.GetGridIndex(page)) * 4];
+                    if (entry[3] == 0 || entry[2] < mip)
+                    {
+                        error = "page (" + std::to_string(mip) + ", " + std::to_string(x) + ", " + std::to_string(y) + ") has no resident fallback";
+                        return false;
+                    }
+
+                    VirtualPage resident = page;
+                    while (resident.Mip < entry[2])
+                        resident = layout.GetParent(resident);
+
+                    uint32_t slot = entry[1] * cache.GetSlotsPerRow() + entry[0];
+                    if (cache.GetSlot(resident) != slot)
+                    {
+                        error = "page (" + std::to_string(mip) + ", " + std::to_string(x) + ", " + std::to_string(y) + ") names a slot its ancestor does not own";
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseArguments(argc, argv, options))
+    {
+        std::fprintf(stderr, "usage: re_coo_vtsim [--size N] [--frames N] [--slots N] [--latency N] [--max-loads N] [--seed N]\n");
+        return EXIT_FAILURE;
+    }
+
+    VirtualTextureLayout layout(options.Size, options.Size);
+    VirtualPageCache cache(layout, options.SlotsPerSide, options.SlotsPerSide);
+
+    VirtualPage root = { layout.GetMipCount() - 1, 0, 0 };
+    cache.MakeResident(root, 0);
+    cache.Pin(root);
+
+    std::mt19937 rng(options.Seed);
+    std::uniform_real_distribution<float> jitter(0.0f, 1.0f);
+
+    std::vector<uint32_t> feedback((layout.GetGridPageCount() + 31) / 32);
+    std::vector<VirtualPage> requested;
+    std::vector<VirtualPage> loads;
+    std::vector<uint8_t> indirection;
+    std::deque<PendingLoad> pending;
+
+    uint64_t samples = 0;
+    uint64_t exactSamples = 0;
+    uint64_t fallbackLevels = 0;
+    uint64_t rejectedLoads = 0;
+    uint32_t peakPending = 0;
+
+    for (uint32_t frame = 1; frame <= options.Frames; frame++)
+    {
+        // Completed reads go resident first, as the renderer uploads them before reading new feedback.
+        uint32_t uploaded = 0;
+        while (!pending.empty() && pending.front().ReadyFrame <= frame && uploaded < options.MaxLoads)
+        {
+            if (cache.MakeResident(pending.front().Page, frame) == VirtualPageCache::InvalidSlot)
+            {
+                cache.CancelLoad(pending.front().Page);
+                rejectedLoads++;
+            }
+            pending.pop_front();
+            uploaded++;
+        }
+
+        std::string error;
+        if (cache.UpdateIndirection(indirection) && !ValidateIndirection(cache, indirection, error))
+        {
+            std::fprintf(stderr, "frame %u: indirection invalid: %s\n", frame, error.c_str());
+            return EXIT_FAILURE;
+        }
+
+        // A slow Lissajous pan with a zoom that sweeps from the whole texture down to magnified texels.
+        float t = static_cast<float>(frame) / 240.0f;
+        float centerU = 0.5f + 0.35f * std::sin(t * 1.3f);
+        float centerV = 0.5f + 0.35f * std::sin(t * 0.7f + 1.0f);
+        float viewWidth = std::exp2(-7.0f + 6.5f * (0.5f + 0.5f * std::cos(t * 0.4f)));
+        float viewHeight = viewWidth * static_cast<float>(ScreenHeight) / static_cast<float>(ScreenWidth);
+        float footprint = viewWidth / static_cast<float>(ScreenWidth);
+
+        std::fill(feedback.begin(), feedback.end(), 0u);
+        requested.clear();
+        for (uint32_t py = 0; py < ScreenHeight; py += SampleStride)
+        {
+            for (uint32_t px = 0; px < ScreenWidth; px += SampleStride)
+            {
+                float u = centerU + viewWidth * ((static_cast<float>(px) + jitter(rng) * SampleStride) / ScreenWidth - 0.5f);
+                float v = centerV + viewHeight * ((static_cast<float>(py) + jitter(rng) * SampleStride) / ScreenHeight - 0.5f);
+                VirtualPage page = GetRequestedPage(layout, u, v, footprint);
+                requested.push_back(page);
+
+                uint32_t gridIndex = layout.GetGridIndex(page);
+                feedback[gridIndex / 32] |= 1u << (gridIndex % 32);
+            }
+        }
+
+        // What the shader would have sampled this frame, from the indirection it saw.
+        for (const VirtualPage& page : requested)
+        {
+            uint8_t residentMip = indirection[static_cast<size_t>(layout.GetGridIndex(page)) * 4 + 2];
+            samples++;
+            exactSamples += residentMip == page.Mip;
+            fallbackLevels += residentMip - page.Mip;
+        }
+
+        loads.clear();
+        cache.ProcessFeedback(feedback.data(), frame, loads, options.MaxLoads);
+        for (const VirtualPage& page : loads)
+            pending.push_back({ page, frame + options.Latency });
+        peakPending = std::max(peakPending, static_cast<uint32_t>(pending.size()));
+
+        if (!cache.Validate(&error))
+        {
+            std::fprintf(stderr, "frame %u: cache invalid: %s\n", frame, error.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    const VirtualPageCache::Statistics& stats = cache.GetStatistics();
+    std::printf("%ux%u, %u levels, %llu pages, %u slots, %u frames, latency %u, %u loads/frame\n",
+                options.Size, options.Size, layout.GetMipCount(), static_cast<unsigned long long>(layout.GetStoredPageCount()),
+                cache.GetSlotCount(), options.Frames, options.Latency, options.MaxLoads);
+    std::printf("page hit rate       %8.2f%%\n", 100.0 * static_cast<double>(stats.Hits) / static_cast<double>(std::max<uint64_t>(stats.Requested, 1)));
+    std::printf("exact mip samples   %8.2f%%\n", 100.0 * static_cast<double>(exactSamples) / static_cast<double>(std::max<uint64_t>(samples, 1)));
+    std::printf("mean fallback mips  %8.3f\n", static_cast<double>(fallbackLevels) / static_cast<double>(std::max<uint64_t>(samples, 1)));
+    std::printf("loads               %8llu\n", static_cast<unsigned long long>(stats.Loads));
+    std::printf("evictions           %8llu\n", static_cast<unsigned long long>(stats.Evictions));
+    std::printf("rejected loads      %8llu\n", static_cast<unsigned long long>(rejectedLoads));
+    std::printf("peak pending reads  %8u\n", peakPending);
+    return EXIT_SUCCESS;
+}